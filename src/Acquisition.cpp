@@ -0,0 +1,157 @@
+#include "Acquisition.h"
+#include <cmath>
+#include <algorithm>
+
+#include "CaCode.h"
+
+// Samples in 1 ms, or 0 if that is not a power of two
+static int blockSamples(double sampleRate) {
+    double s = sampleRate / 1000.0;
+    long n = std::lround(s);
+    if (std::fabs(s - n) > 1e-6 || n < 2 || (n & (n - 1))) return 0;
+    return (int)n;
+}
+
+AcquisitionEngine::AcquisitionEngine(const AcquisitionConfig& config)
+    : config(config)
+    , n(blockSamples(config.sampleRate))
+    , bins(2 * (int)std::lround(config.dopplerRange / config.dopplerStep) + 1)
+    , offsets(std::max(1, (int)std::lround(1000.0 / config.dopplerStep)))
+    , fft(n > 0 ? n : 1)
+{
+    if (!valid()) return;
+    const CaCodeTable& codes = CaCodeTable::instance();
+    const int P = CaCodeTable::MAX_PRN;
+
+    // Local replica of one code period, sampled at fs, as a conjugated spectrum
+    codeRe.resize((size_t)P * n);
+    codeIm.resize((size_t)P * n);
+    for (int prn = 1; prn <= P; prn++) {
+        float* cr = &codeRe[(size_t)(prn - 1) * n];
+        float* ci = &codeIm[(size_t)(prn - 1) * n];
+        for (int j = 0; j < n; j++) {
+            int chip = (int)(j * CaCodeTable::CHIP_RATE / config.sampleRate) % CaCodeTable::CHIPS;
+            cr[j] = 1.0f - 2.0f * codes.chip(prn, chip);
+            ci[j] = 0.0f;
+        }
+        fft.forward(cr, ci);
+        for (int k = 0; k < n; k++) ci[k] = -ci[k];
+    }
+
+    wipeRe.resize((size_t)offsets * n);
+    wipeIm.resize((size_t)offsets * n);
+    for (int o = 0; o < offsets; o++)
+        for (int j = 0; j < n; j++) {
+            double a = -2 * M_PI * (o * config.dopplerStep) * j / config.sampleRate;
+            wipeRe[(size_t)o * n + j] = (float)std::cos(a);
+            wipeIm[(size_t)o * n + j] = (float)std::sin(a);
+        }
+
+    specRe.resize((size_t)config.blocks * offsets * n);
+    specIm.resize((size_t)config.blocks * offsets * n);
+    workRe.resize(n);
+    workIm.resize(n);
+    power.resize((size_t)bins * n);
+}
+
+void AcquisitionEngine::spectra(const float* re, const float* im) {
+    for (int b = 0; b < config.blocks; b++)
+        for (int o = 0; o < offsets; o++) {
+            const float* __restrict xr = re + (size_t)b * n;
+            const float* __restrict xi = im + (size_t)b * n;
+            const float* __restrict wr = &wipeRe[(size_t)o * n];
+            const float* __restrict wi = &wipeIm[(size_t)o * n];
+            float* __restrict sr = &specRe[((size_t)b * offsets + o) * n];
+            float* __restrict si = &specIm[((size_t)b * offsets + o) * n];
+            #pragma omp simd
+            for (int j = 0; j < n; j++) {
+                sr[j] = xr[j] * wr[j] - xi[j] * wi[j];
+                si[j] = xr[j] * wi[j] + xi[j] * wr[j];
+            }
+            fft.forward(sr, si);
+        }
+}
+
+// work[k] = S[k + shift] * C[k] for k in [from, to)
+static inline void correlateRange(const float* __restrict sr, const float* __restrict si,
+                                  const float* __restrict cr, const float* __restrict ci,
+                                  float* __restrict wr, float* __restrict wi,
+                                  int from, int to, int shift)
+{
+    #pragma omp simd
+    for (int k = from; k < to; k++) {
+        float a = sr[k + shift], b = si[k + shift];
+        wr[k] = a * cr[k] - b * ci[k];
+        wi[k] = a * ci[k] + b * cr[k];
+    }
+}
+
+void AcquisitionEngine::search(const float* re, const float* im, const int* prns, int count,
+                               AcquisitionResult* out)
+{
+    if (!valid()) return;
+    spectra(re, im);
+
+    const int chips2 = (int)std::ceil(2.0 * n / CaCodeTable::CHIPS);     // 2 chips in samples
+    for (int p = 0; p < count; p++) {
+        const int prn = prns[p];
+        const float* cr = &codeRe[(size_t)(prn - 1) * n];
+        const float* ci = &codeIm[(size_t)(prn - 1) * n];
+        std::fill(power.begin(), power.end(), 0.0f);
+
+        for (int d = 0; d < bins; d++) {
+            // Doppler = whole kHz (spectrum rotation) + sub-kHz offset (wipe table)
+            double f = -config.dopplerRange + d * config.dopplerStep;
+            int whole = (int)std::floor(f / 1000.0);
+            int o = (int)std::lround((f - whole * 1000.0) / config.dopplerStep);
+            if (o == offsets) { o = 0; whole++; }
+            int shift = ((whole % n) + n) % n;
+
+            float* pw = &power[(size_t)d * n];
+            for (int b = 0; b < config.blocks; b++) {
+                const float* sr = &specRe[((size_t)b * offsets + o) * n];
+                const float* si = &specIm[((size_t)b * offsets + o) * n];
+                correlateRange(sr, si, cr, ci, workRe.data(), workIm.data(), 0, n - shift, shift);
+                correlateRange(sr, si, cr, ci, workRe.data(), workIm.data(), n - shift, n, shift - n);
+                fft.inverse(workRe.data(), workIm.data());
+                const float* __restrict wr = workRe.data();
+                const float* __restrict wi = workIm.data();
+                #pragma omp simd
+                for (int k = 0; k < n; k++) pw[k] += wr[k] * wr[k] + wi[k] * wi[k];
+            }
+        }
+
+        // ===== Peak, noise floor and strongest distinct second peak =====
+        size_t best = 0;
+        double sum = 0.0;
+        for (size_t c = 0; c < power.size(); c++) {
+            sum += power[c];
+            if (power[c] > power[best]) best = c;
+        }
+        int bestCode = (int)(best % n);
+        size_t second = best;
+        float secondPower = -1.0f;
+        for (size_t c = 0; c < power.size(); c++) {
+            int dist = std::abs((int)(c % n) - bestCode);
+            if (std::min(dist, n - dist) <= chips2) continue;
+            if (power[c] > secondPower) { secondPower = power[c]; second = c; }
+        }
+
+        double mean = sum / power.size();
+        auto phaseOf = [&](size_t c) {
+            double chips = (n - (int)(c % n)) * (double)CaCodeTable::CHIPS / n;
+            return chips >= CaCodeTable::CHIPS ? chips - CaCodeTable::CHIPS : chips;
+        };
+        auto dopplerOf = [&](size_t c) { return -config.dopplerRange + (int)(c / n) * config.dopplerStep; };
+
+        AcquisitionResult& r = out[p];
+        r.prn             = prn;
+        r.peakMetric      = mean > 0 ? power[best] / mean : 0.0;
+        r.acquired        = r.peakMetric > config.threshold;
+        r.codePhase       = phaseOf(best);
+        r.doppler         = dopplerOf(best);
+        r.secondMetric    = mean > 0 ? secondPower / mean : 0.0;
+        r.secondCodePhase = phaseOf(second);
+        r.secondDoppler   = dopplerOf(second);
+    }
+}
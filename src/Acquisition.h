@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include "Fft.h"
+
+struct AcquisitionConfig {
+    double sampleRate   = 4.096e6;  // Hz; one millisecond must be a power-of-two sample count
+    double dopplerRange = 5000.0;   // searched +-, Hz
+    double dopplerStep  = 500.0;    // Hz, must divide 1 kHz
+    int    blocks       = 4;        // 1 ms coherent blocks summed noncoherently
+    double threshold    = 8.0;      // peak / mean cell power to declare a signal
+};
+
+struct AcquisitionResult {
+    int    prn;
+    bool   acquired;
+    double codePhase;       // chips at the first sample, [0, 1023)
+    double doppler;         // Hz
+    double peakMetric;      // strongest cell / mean cell power
+    // Strongest cell more than 2 chips from the peak (any Doppler): a
+    // second copy of the code, as a spoofer produces, shows up here
+    double secondCodePhase;
+    double secondDoppler;
+    double secondMetric;
+};
+
+// Parallel code-phase search. For each 1 ms block and each Doppler bin the
+// circular correlation with the local code over all code phases is one
+// pointwise product and one inverse FFT; the conjugated code spectra are
+// computed once per PRN in the constructor.
+//
+// Carrier wipe-off is split: the sub-kHz part of each Doppler bin is
+// removed by multiplying the block with a precomputed phasor table (a
+// vectorized complex multiply), once per distinct offset, and the whole-kHz
+// part is a rotation of that spectrum by whole bins (1 ms blocks have 1 kHz
+// bins), so it costs nothing. search() does not allocate.
+class AcquisitionEngine {
+private:
+    AcquisitionConfig config;
+    int n;                                  // samples per block (1 ms)
+    int bins;                               // Doppler bins
+    int offsets;                            // distinct sub-kHz offsets
+    Fft fft;
+    std::vector<float> codeRe, codeIm;      // [(prn - 1) * n + k], conj(FFT(code))
+    std::vector<float> wipeRe, wipeIm;      // [offset * n + j]
+    std::vector<float> specRe, specIm;      // [(block * offsets + offset) * n + k]
+    std::vector<float> workRe, workIm;
+    std::vector<float> power;               // [bin * n + code phase]
+
+    void spectra(const float* re, const float* im);
+
+public:
+    explicit AcquisitionEngine(const AcquisitionConfig& config = AcquisitionConfig());
+
+    // False if a millisecond is not a power-of-two number of samples
+    bool valid() const { return n > 0; }
+    int samplesNeeded() const { return config.blocks * n; }
+
+    // Searches `count` PRNs in the first samplesNeeded() samples
+    void search(const float* re, const float* im, const int* prns, int count,
+                AcquisitionResult* out);
+};
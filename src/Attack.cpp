@@ -0,0 +1,125 @@
+#include "Attack.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Spoofer.h"
+#include "Instrument.h"
+#include "SignalPath.h"
+
+bool AttackProfile::onlySatellites(const int* systems, const int* prns, int count) {
+    for (int w = 0; w < SYSTEM_COUNT; w++) mask[w] = 0;
+    others = false;
+    bool ok = true;
+    for (int i = 0; i < count; i++) ok &= includeSatellite(systems[i], prns[i], true);
+    return ok;
+}
+
+bool AttackProfile::includeSatellite(int system, int prn, bool on) {
+    if (system < 0 || system >= SYSTEM_COUNT || prn < 1 || prn > MAX_MASK_PRN) return false;
+    uint64_t bit = 1ull << (prn - 1);
+    if (on) mask[system] |= bit;
+    else    mask[system] &= ~bit;
+    return true;
+}
+
+AttackProfile AttackProfile::fromSpoofer(const Spoofer& s) {
+    AttackProfile p;
+    p.offsetX = s.getFakeX();
+    p.offsetY = s.getFakeY();
+    p.offsetZ = s.getFakeZ();
+    p.powerStart = p.powerEnd = s.getPower();
+    return p;
+}
+
+// ===== Per-epoch spoofer state =====
+
+namespace {
+
+// Active spoofers at one epoch, evaluated once before the satellite pass
+struct ActiveSet {
+    double fx[AttackEngine::MAX_ACTIVE], fy[AttackEngine::MAX_ACTIVE], fz[AttackEngine::MAX_ACTIVE];
+    double weight[AttackEngine::MAX_ACTIVE];
+    double bias[AttackEngine::MAX_ACTIVE];      // clock bias + delay
+    // Per spoofer the profile's words, one per system, then a word standing
+    // for satellites the mask cannot name: all ones or all zeros. The blend
+    // reads them through `mask`; indexing `words` directly keeps it scalar.
+    uint64_t words[AttackEngine::MAX_ACTIVE][SYSTEM_COUNT + 1];
+    const uint64_t* mask[AttackEngine::MAX_ACTIVE];
+    int count = 0;
+};
+
+inline bool onAir(const AttackProfile& p, double t) {
+    return t >= p.start && t < p.end;
+}
+
+// The blend for K simultaneous spoofers. K is a compile-time constant so
+// the spoofer loop unrolls and the satellite loop is a straight run of
+// multiply-adds, one signal path per spoofer and a mask-bit lookup.
+template <int K>
+void blend(const ActiveSet& a, const EpochView& epoch, double* out) {
+    const double* pos = epoch.pos;
+    const double* vel = epoch.vel;
+    const double* in = epoch.ranges;
+    const uint8_t* systems = epoch.systems;
+    const int* prns = epoch.prns;
+    const int n = epoch.count;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        // Bit of (system, PRN) in the mask words; PRN 0 (none) wraps past
+        // MAX_MASK_PRN with the out-of-range ones to the last word
+        const unsigned bit = (unsigned)prns[i] - 1u;
+        const unsigned b = bit < (unsigned)MAX_MASK_PRN ? 64u * systems[i] + bit : 64u * SYSTEM_COUNT;
+        double w[K], fake[K], total = 0.0;
+        for (int k = 0; k < K; k++) {
+            fake[k] = signalRange(pos + 3 * i, vel + 3 * i, a.fx[k], a.fy[k], a.fz[k]) + a.bias[k];
+            w[k] = a.weight[k] * (double)((a.mask[k][b >> 6] >> (b & 63)) & 1);
+            total += w[k];
+        }
+        // Overlapping spoofers share the signal instead of exceeding it
+        const double scale = 1.0 / std::max(1.0, total);
+        double r = (1.0 - total * scale) * in[i];
+        for (int k = 0; k < K; k++) r += w[k] * scale * fake[k];
+        out[i] = r;
+    }
+}
+
+} // namespace
+
+int AttackEngine::activeAt(double t) const {
+    int n = 0;
+    for (const AttackProfile& p : profiles) n += onAir(p, t);
+    return std::min(n, MAX_ACTIVE);
+}
+
+void AttackEngine::apply(double t, double rx, double ry, double rz, double clockBias,
+                         const EpochView& epoch, double* out) const
+{
+    GNSS_STAGE(STAGE_SPOOFING);
+    ActiveSet a;
+    for (const AttackProfile& p : profiles) {
+        if (a.count == MAX_ACTIVE) break;
+        if (!onAir(p, t)) continue;
+        const int k = a.count++;
+        const double age = t - p.start;
+        const double anchor = p.followReceiver ? 1.0 : 0.0;
+        a.fx[k] = anchor * rx + p.offsetX + p.velocityX * age;
+        a.fy[k] = anchor * ry + p.offsetY + p.velocityY * age;
+        a.fz[k] = anchor * rz + p.offsetZ + p.velocityZ * age;
+        const double ramp = p.rampTime > 0 ? std::min(1.0, age / p.rampTime) : 1.0;
+        a.weight[k] = p.powerStart + (p.powerEnd - p.powerStart) * ramp;
+        a.bias[k] = clockBias + p.delay;
+        std::copy(p.mask, p.mask + SYSTEM_COUNT, a.words[k]);
+        a.words[k][SYSTEM_COUNT] = p.others ? ~0ull : 0ull;
+        a.mask[k] = a.words[k];
+    }
+
+    switch (a.count) {
+    case 0:
+        if (out != epoch.ranges) std::copy(epoch.ranges, epoch.ranges + epoch.count, out);
+        break;
+    case 1: blend<1>(a, epoch, out); break;
+    case 2: blend<2>(a, epoch, out); break;
+    case 3: blend<3>(a, epoch, out); break;
+    default: blend<4>(a, epoch, out); break;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "EpochBuffer.h"
+#include "GnssSystems.h"
+
+class Spoofer;
+
+// Satellites a spoofer transmits counterfeits for, keyed by system and PRN
+// (EpochView::systems, EpochView::prns): one word per GnssSystem, bit
+// prn - 1 for PRNs 1..MAX_MASK_PRN, which covers every system's PRN range.
+// Satellites without such a PRN follow AttackProfile::others.
+static const int MAX_MASK_PRN = 64;
+
+// One spoofer's schedule. While active (start <= t < end) it pulls every
+// masked satellite's pseudorange towards the range to its counterfeit
+// position, which moves with a constant velocity from `start`:
+//
+//   fake(t) = anchor + offset + velocity * (t - start)
+//
+// where the anchor is the origin (offset is an absolute ECEF position) or,
+// with followReceiver, the victim's true position (a drag-off that starts
+// on the victim and walks away from it). The counterfeit weight ramps
+// linearly from powerStart to powerEnd over rampTime seconds, then holds.
+// `delay` adds a common range delay (m), e.g. a meaconer replaying the
+// real signals from its own antenna.
+struct AttackProfile {
+    double start = 0.0, end = 1e300;        // active window (s)
+    bool   followReceiver = false;
+    double offsetX = 0, offsetY = 0, offsetZ = 0;            // m
+    double velocityX = 0, velocityY = 0, velocityZ = 0;      // m/s
+    double powerStart = 1.0, powerEnd = 1.0, rampTime = 0.0;
+    double delay = 0.0;
+    uint64_t mask[SYSTEM_COUNT] = {~0ull, ~0ull, ~0ull, ~0ull};
+    bool     others = true;     // satellites the mask cannot name
+
+    // Restricts the attack to the given (system, PRN) pairs. Both return
+    // false, and leave the mask as it was for that satellite, if a pair
+    // is outside the mask.
+    bool onlySatellites(const int* systems, const int* prns, int count);
+    bool includeSatellite(int system, int prn, bool on);
+
+    // The static, constant-power attack a Spoofer models, active throughout
+    static AttackProfile fromSpoofer(const Spoofer& s);
+};
+
+// Applies a set of attack profiles to epochs of pseudoranges.
+//
+// Up to MAX_ACTIVE spoofers may be on the air in one epoch (further
+// active profiles are ignored, in the order they were added). Per epoch
+// each active spoofer's counterfeit position and weight are evaluated once;
+// then one branch-free pass over the epoch's satellites blends
+//
+//   out = (1 - W) * range + sum_k w_k * (|fake_k - sat| + clockBias + delay_k)
+//
+// with w_k the spoofer's weight times its mask bit for the satellite and
+// W = sum_k w_k (all w_k scaled down so W <= 1 when spoofers overlap). With
+// one always-on, unmasked, static profile this is Spoofer::spoofPseudoranges.
+//
+// apply() is const and keeps its per-epoch state on the stack, so one
+// engine can serve any number of pipelines and threads, and sweeping
+// attack variants over recorded epochs allocates nothing.
+class AttackEngine {
+public:
+    static const int MAX_ACTIVE = 4;
+
+private:
+    std::vector<AttackProfile> profiles;
+
+public:
+    AttackEngine() = default;
+    explicit AttackEngine(const AttackProfile& p) { add(p); }
+
+    void reserve(int n) { profiles.reserve(n); }
+    void clear() { profiles.clear(); }
+    void add(const AttackProfile& p) { profiles.push_back(p); }
+
+    int size() const { return (int)profiles.size(); }
+    AttackProfile&       profile(int i)       { return profiles[i]; }
+    const AttackProfile& profile(int i) const { return profiles[i]; }
+
+    // Number of profiles on the air at time t (capped at MAX_ACTIVE)
+    int activeAt(double t) const;
+
+    // Spoofs one epoch at sim time t for a victim truly at (rx, ry, rz).
+    // Writes epoch.count values to `out`, which may alias epoch.ranges.
+    void apply(double t, double rx, double ry, double rz, double clockBias,
+               const EpochView& epoch, double* out) const;
+};
@@ -0,0 +1,38 @@
+#include "CaCode.h"
+#include <cstring>
+
+// G2 phase-selector taps (1-based) per PRN, IS-GPS-200 table 3-Ia
+static const int G2_TAPS[CaCodeTable::MAX_PRN][2] = {
+    {2, 6}, {3, 7}, {4, 8}, {5, 9}, {1, 9}, {2, 10}, {1, 8}, {2, 9},
+    {3, 10}, {2, 3}, {3, 4}, {5, 6}, {6, 7}, {7, 8}, {8, 9}, {9, 10},
+    {1, 4}, {2, 5}, {3, 6}, {4, 7}, {5, 8}, {6, 9}, {1, 3}, {4, 6},
+    {5, 7}, {6, 8}, {7, 9}, {8, 10}, {1, 6}, {2, 7}, {3, 8}, {4, 9},
+};
+
+const CaCodeTable& CaCodeTable::instance() {
+    static const CaCodeTable table;
+    return table;
+}
+
+CaCodeTable::CaCodeTable() {
+    std::memset(bits, 0, sizeof(bits));
+    for (int p = 0; p < MAX_PRN; p++) {
+        // G1 = 1 + x^3 + x^10, G2 = 1 + x^2 + x^3 + x^6 + x^8 + x^9 + x^10,
+        // both starting all ones; g[0] is stage 1
+        int g1[10], g2[10];
+        for (int k = 0; k < 10; k++) g1[k] = g2[k] = 1;
+        for (int c = 0; c < CHIPS + 64; c++) {
+            int k = c % CHIPS;
+            if (c == k) {
+                int bit = g1[9] ^ g2[G2_TAPS[p][0] - 1] ^ g2[G2_TAPS[p][1] - 1];
+                int f1 = g1[2] ^ g1[9];
+                int f2 = g2[1] ^ g2[2] ^ g2[5] ^ g2[7] ^ g2[8] ^ g2[9];
+                for (int s = 9; s > 0; s--) { g1[s] = g1[s - 1]; g2[s] = g2[s - 1]; }
+                g1[0] = f1; g2[0] = f2;
+                bits[p][c >> 6] |= (uint64_t)bit << (c & 63);
+            } else {
+                bits[p][c >> 6] |= (uint64_t)chip(p + 1, k) << (c & 63);
+            }
+        }
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// GPS L1 C/A Gold codes (IS-GPS-200, PRN 1-32), generated once and stored
+// bit-packed: chip k of a PRN is bit (k & 63) of word k >> 6. The first 64
+// chips are repeated after chip 1022, so any chip index below
+// CHIPS + 64 can be read without a modulo.
+class CaCodeTable {
+public:
+    static const int MAX_PRN = 32;
+    static const int CHIPS   = 1023;
+    static const int WORDS   = (CHIPS + 64 + 63) / 64;
+    static constexpr double CHIP_RATE = 1.023e6;      // chips/s
+    static constexpr double L1_FREQ   = 1575.42e6;    // Hz
+
+    static const CaCodeTable& instance();
+
+    // 0 or 1; k in [0, CHIPS + 64)
+    int chip(int prn, int k) const { return (int)(bits[prn - 1][k >> 6] >> (k & 63)) & 1; }
+    const uint64_t* code(int prn) const { return bits[prn - 1]; }
+
+private:
+    uint64_t bits[MAX_PRN][WORDS];
+
+    CaCodeTable();
+};
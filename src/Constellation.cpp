@@ -0,0 +1,206 @@
+#include "Constellation.h"
+#include <cmath>
+
+#include "Instrument.h"
+
+const double MU = 3.986e14; // Earth's gravitational parameter
+
+void Constellation::reserve(int n) {
+    radius.reserve(n); phase.reserve(n); omega.reserve(n);
+    cosIncl.reserve(n); sinIncl.reserve(n); raan.reserve(n);
+    px.reserve(n); py.reserve(n); qx.reserve(n); qy.reserve(n); qz.reserve(n);
+    rCosPhase.reserve(n); rSinPhase.reserve(n);
+    shell.reserve(n);
+    systemOf.reserve(n); prnOf.reserve(n);
+    cosWt.reserve(n); sinWt.reserve(n);
+    xs.reserve(n); ys.reserve(n); zs.reserve(n);
+    planeCos.reserve(n); planeSin.reserve(n);
+    stepCos.reserve(n); stepSin.reserve(n);
+}
+
+int Constellation::add(double orbitalRadius, double initialPhase, double incl, double node,
+                       int system, int prn) {
+    // Angular velocity for circular orbit
+    double w = std::sqrt(MU / (orbitalRadius * orbitalRadius * orbitalRadius));
+
+    // Satellites at the same radius share a shell (and so one sin/cos per epoch)
+    int sh = -1;
+    for (int k = 0; k < (int)shellOmega.size(); k++)
+        if (shellOmega[k] == w) { sh = k; break; }
+    if (sh < 0) {
+        sh = (int)shellOmega.size();
+        shellOmega.push_back(w);
+        shellCos.push_back(1.0);
+        shellSin.push_back(0.0);
+    }
+
+    radius.push_back(orbitalRadius);
+    phase.push_back(initialPhase);
+    omega.push_back(w);
+    double ci = std::cos(incl), si = std::sin(incl);
+    double cn = std::cos(node), sn = std::sin(node);
+    cosIncl.push_back(ci);
+    sinIncl.push_back(si);
+    raan.push_back(node);
+    px.push_back(cn);
+    py.push_back(sn);
+    qx.push_back(-ci * sn);
+    qy.push_back(ci * cn);
+    qz.push_back(si);
+    rCosPhase.push_back(orbitalRadius * std::cos(initialPhase));
+    rSinPhase.push_back(orbitalRadius * std::sin(initialPhase));
+    shell.push_back(sh);
+    systemOf.push_back((uint8_t)system);
+    prnOf.push_back(prn);
+    cosWt.push_back(1.0);
+    sinWt.push_back(0.0);
+
+    xs.push_back(orbitalRadius * cn);
+    ys.push_back(orbitalRadius * sn);
+    zs.push_back(0.0);
+    planeCos.push_back(orbitalRadius);
+    planeSin.push_back(0.0);
+    stepCos.push_back(1.0);
+    stepSin.push_back(0.0);
+    stepIndex = -1;     // a new satellite has no step state
+    return (int)xs.size() - 1;
+}
+
+void Constellation::update(double time) {
+    GNSS_STAGE(STAGE_PROPAGATION);
+    const int n = size();
+    const int nShells = (int)shellOmega.size();
+
+    // One sin/cos per shell, broadcast to every satellite in that shell
+    double* cw = shellCos.data();
+    double* sw = shellSin.data();
+    for (int k = 0; k < nShells; k++) {
+        double a = shellOmega[k] * time;
+        cw[k] = std::cos(a);
+        sw[k] = std::sin(a);
+    }
+    const int* sh = shell.data();
+    double* cwt = cosWt.data();
+    double* swt = sinWt.data();
+    for (int i = 0; i < n; i++) {
+        cwt[i] = cw[sh[i]];
+        swt[i] = sw[sh[i]];
+    }
+
+    // Rotate every satellite: angle = omega*t + phase
+    //   cos(angle) = cos(wt)cos(phase) - sin(wt)sin(phase)
+    //   sin(angle) = sin(wt)cos(phase) + cos(wt)sin(phase)
+    // then place it in its orbit plane: r cos(angle) P + r sin(angle) Q
+    const double* __restrict rc = rCosPhase.data();
+    const double* __restrict rs = rSinPhase.data();
+    const double* __restrict pX = px.data();
+    const double* __restrict pY = py.data();
+    const double* __restrict qX = qx.data();
+    const double* __restrict qY = qy.data();
+    const double* __restrict qZ = qz.data();
+    double* __restrict ox = xs.data();
+    double* __restrict oy = ys.data();
+    double* __restrict oz = zs.data();
+    for (int i = 0; i < n; i++) {
+        double rcos = cwt[i] * rc[i] - swt[i] * rs[i];
+        double rsin = swt[i] * rc[i] + cwt[i] * rs[i];
+        ox[i] = rcos * pX[i] + rsin * qX[i];
+        oy[i] = rcos * pY[i] + rsin * qY[i];
+        oz[i] = rsin * qZ[i];
+    }
+}
+
+// In-plane position from the rotation update() just applied
+void Constellation::seedSteps() {
+    const int n = size();
+    for (int i = 0; i < n; i++) {
+        planeCos[i] = cosWt[i] * rCosPhase[i] - sinWt[i] * rSinPhase[i];
+        planeSin[i] = sinWt[i] * rCosPhase[i] + cosWt[i] * rSinPhase[i];
+    }
+}
+
+void Constellation::beginSteps(double time, double dt) {
+    update(time);
+    seedSteps();
+    for (int i = 0; i < size(); i++) {
+        stepCos[i] = std::cos(omega[i] * dt);
+        stepSin[i] = std::sin(omega[i] * dt);
+    }
+    stepStart = time;
+    stepDt    = dt;
+    stepIndex = 0;
+}
+
+void Constellation::step() {
+    stepIndex++;
+    if (stepIndex % RESYNC_INTERVAL == 0) {
+        // Re-seed from the direct formula: bounds the phase drift
+        update(stepTime());
+        seedSteps();
+        return;
+    }
+    GNSS_STAGE(STAGE_PROPAGATION);
+    const int n = size();
+    const double* __restrict cd = stepCos.data();
+    const double* __restrict sd = stepSin.data();
+    const double* __restrict pX = px.data();
+    const double* __restrict pY = py.data();
+    const double* __restrict qX = qx.data();
+    const double* __restrict qY = qy.data();
+    const double* __restrict qZ = qz.data();
+    double* __restrict pc = planeCos.data();
+    double* __restrict ps = planeSin.data();
+    double* __restrict ox = xs.data();
+    double* __restrict oy = ys.data();
+    double* __restrict oz = zs.data();
+    for (int i = 0; i < n; i++) {
+        double c = pc[i] * cd[i] - ps[i] * sd[i];
+        double s = ps[i] * cd[i] + pc[i] * sd[i];
+        pc[i] = c; ps[i] = s;
+        ox[i] = c * pX[i] + s * qX[i];
+        oy[i] = c * pY[i] + s * qY[i];
+        oz[i] = s * qZ[i];
+    }
+    if (stepIndex % RENORM_INTERVAL == 0) {
+        // Pull the radius back: |(cos, sin) step| differs from 1 by rounding
+        const double* __restrict r = radius.data();
+        for (int i = 0; i < n; i++) {
+            double k = r[i] / std::sqrt(pc[i] * pc[i] + ps[i] * ps[i]);
+            pc[i] *= k; ps[i] *= k;
+        }
+    }
+}
+
+void Constellation::propagate(double time) {
+    if (stepIndex >= 0 && std::fabs(time - (stepStart + (stepIndex + 1) * stepDt)) < 1e-9) step();
+    else update(time);
+}
+
+void Constellation::updateOne(int i, double time) {
+    double angle = omega[i] * time + phase[i];
+
+    // In the orbit frame (node along x):
+    //   x = r * cos(angle)                          (in-plane, equatorial direction)
+    //   y = r * sin(angle) * cos(inclination)       (in-plane, cross-equatorial)
+    //   z = r * sin(angle) * sin(inclination)       (out-of-plane, polar component)
+    // then rotated about the polar axis by the RAAN.
+    double c = radius[i] * std::cos(angle);
+    double s = radius[i] * std::sin(angle);
+    xs[i] = c * px[i] + s * qx[i];
+    ys[i] = c * py[i] + s * qy[i];
+    zs[i] = s * qz[i];
+}
+
+void Constellation::getVelocity(int i, double v[3]) const {
+    // position = r cos(u) P + r sin(u) Q, so r cos(u) = pos.P, r sin(u) = pos.Q
+    // and velocity = omega (-r sin(u) P + r cos(u) Q)
+    double rcos = xs[i] * px[i] + ys[i] * py[i];
+    double rsin = xs[i] * qx[i] + ys[i] * qy[i] + zs[i] * qz[i];
+    v[0] = omega[i] * (-rsin * px[i] + rcos * qx[i]);
+    v[1] = omega[i] * (-rsin * py[i] + rcos * qy[i]);
+    v[2] = omega[i] * rcos * qz[i];
+}
+
+double Constellation::getInclination(int i) const {
+    return std::atan2(sinIncl[i], cosIncl[i]);
+}
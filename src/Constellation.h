@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Satellite.h"
+
+// Structure-of-arrays store for a whole constellation of circular-orbit
+// satellites. Elements and positions live in contiguous arrays so the
+// entire set is propagated by one batch call instead of one update() per
+// object.
+//
+// Satellites that share an orbital radius (a "shell") share a mean motion,
+// so update() evaluates one sin/cos pair per shell and then rotates every
+// satellite with the angle-addition identity — a pure multiply-add loop the
+// compiler can vectorize.
+//
+// For fixed-step runs (10-100 Hz epochs) beginSteps()/step() drop the trig
+// altogether: each satellite's in-plane position is rotated by the
+// constant angle omega*dt with the same identity. Rounding would slowly
+// change the radius and the phase, so the radius is re-normalized every
+// RENORM_INTERVAL steps and the state is re-seeded from the direct formula
+// every RESYNC_INTERVAL steps.
+class Constellation {
+public:
+    static const int RENORM_INTERVAL = 256;
+    static const int RESYNC_INTERVAL = 1 << 16;
+
+private:
+    // Per-satellite elements (precomputed once in add())
+    std::vector<double> radius;
+    std::vector<double> phase;
+    std::vector<double> omega;
+    std::vector<double> cosIncl;
+    std::vector<double> sinIncl;
+    std::vector<double> raan;
+    std::vector<double> rCosPhase;   // radius * cos(phase)
+    std::vector<double> rSinPhase;   // radius * sin(phase)
+    // Inertial unit vectors of the orbit plane: position = r(cos u * P + sin u * Q)
+    std::vector<double> px, py;              // P = (cos raan, sin raan, 0)
+    std::vector<double> qx, qy, qz;          // Q = (-cos i sin raan, cos i cos raan, sin i)
+    std::vector<int>    shell;       // index into shellOmega
+    std::vector<uint8_t> systemOf;   // GnssSystem
+    std::vector<int>     prnOf;
+
+    // Per-shell mean motion and per-epoch rotation
+    std::vector<double> shellOmega;
+    std::vector<double> shellCos, shellSin;   // per-shell scratch, sized in add()
+    std::vector<double> cosWt, sinWt;     // per-satellite scratch, filled per epoch
+
+    // Positions (ECEF-like inertial frame, metres)
+    std::vector<double> xs, ys, zs;
+
+    // Fixed-step state: in-plane position and per-satellite step rotation
+    std::vector<double> planeCos, planeSin;   // r cos(u), r sin(u)
+    std::vector<double> stepCos, stepSin;     // cos, sin of omega * dt
+    double    stepStart = 0.0, stepDt = 0.0;
+    long long stepIndex = -1;                 // -1 when not stepping
+
+    void seedSteps();
+
+public:
+    Constellation() = default;
+
+    void reserve(int n);
+
+    // Adds a satellite on a circular orbit of the given radius; returns its index.
+    // `raan` rotates the orbit plane about the polar axis. `system` is the
+    // satellite's GnssSystem and `prn` its number within that system.
+    int add(double orbitalRadius, double initialPhase, double incl, double raan = 0.0,
+            int system = 0, int prn = 0);
+
+    int size() const { return (int)xs.size(); }
+
+    // Propagates every satellite to `time` in one pass
+    void update(double time);
+
+    // Propagates a single satellite (direct formula, used by Satellite views)
+    void updateOne(int i, double time);
+
+    // Starts a fixed-step sequence: positions at `time`, then step() moves
+    // every satellite on by `dt` without trig
+    void beginSteps(double time, double dt);
+    void step();
+    bool isStepping() const { return stepIndex >= 0; }
+    double stepTime() const { return stepStart + stepIndex * stepDt; }
+
+    // step() if `time` is the next step of the sequence, else update(time)
+    void propagate(double time);
+
+    Satellite operator[](int i) { return Satellite(*this, i); }
+
+    double getX(int i) const { return xs[i]; }
+    double getY(int i) const { return ys[i]; }
+    double getZ(int i) const { return zs[i]; }
+
+    const double* x() const { return xs.data(); }
+    const double* y() const { return ys.data(); }
+    const double* z() const { return zs.data(); }
+
+    // Velocity (m/s) at the last propagated position. Derived from the
+    // position and orbit plane, so update() does no extra work for it.
+    void getVelocity(int i, double v[3]) const;
+
+    double getRadius(int i) const { return radius[i]; }
+    double getPhase(int i) const { return phase[i]; }
+    double getOmega(int i) const { return omega[i]; }
+    double getInclination(int i) const;
+    double getRaan(int i) const { return raan[i]; }
+    int    getSystem(int i) const { return systemOf[i]; }
+    int    getPrn(int i) const { return prnOf[i]; }
+    const uint8_t* systems() const { return systemOf.data(); }
+};
@@ -1,122 +1,298 @@
 #include "Detector.h"
 #include <cmath>
-#include <sstream>
+#include <cstdio>
 #include <algorithm>
 
-Detector::Detector()
-    : maxPhysicalSpeed(300.0)       // 300 m/s max drone speed
-    , residualThreshold(50.0)
-    , clockJumpThreshold(100.0)
+#include "GnssSystems.h"
+#include "Instrument.h"
+#include "SignalPath.h"
+
+void RunningWindow::rebase() {
+    double m = sum / count;
+    sum = sumSq = 0.0;
+    for (int i = 0; i < count; i++) {
+        values[i] -= m;
+        sum += values[i];
+        sumSq += values[i] * values[i];
+    }
+    shift += m;
+}
+
+Detector::Detector(int window)
+    : window(std::max(1, window))
+    , posHistory(this->window * 3, 0.0)
+    , clockHistory(this->window, 0.0)
+    , pseudoCount(this->window, 0)
+    , residualWindow(this->window)
+    , clockWindow(this->window)
+    , speedWindow(this->window)
+    , powerWindow(this->window)
+    , innovationZ(upperNormalQuantile(1e-7))
+    , minCn0(30.0)
+    , minLock(0.5)
 {}
 
+void Detector::reserve(int maxSatellites) {
+    integrity.reserve(maxSatellites);
+    if (maxSatellites <= rangeStride) return;
+    // Re-lay the stored epochs out at the wider stride
+    std::vector<double> wider((size_t)window * maxSatellites, 0.0);
+    for (int s = 0; s < window; s++)
+        std::copy(pseudoHistory.begin() + (size_t)s * rangeStride,
+                  pseudoHistory.begin() + (size_t)s * rangeStride + pseudoCount[s],
+                  wider.begin() + (size_t)s * maxSatellites);
+    pseudoHistory.swap(wider);
+    rangeStride = maxSatellites;
+}
+
+void Detector::reset() {
+    historyHead = historyCount = 0;
+    residualWindow.clear();
+    clockWindow.clear();
+    speedWindow.clear();
+    powerWindow.clear();
+}
+
 double Detector::computeResidualScore(
-    const std::vector<std::vector<double>>& satPositions,
-    const std::vector<double>& pseudoranges,
+    const EpochView& epoch,
     double estX, double estY, double estZ, double clockBias)
 {
     double total = 0.0;
-    int n = satPositions.size();
+    int n = epoch.count;
+    #pragma omp simd reduction(+:total)
     for (int i = 0; i < n; i++) {
-        double dx = estX - satPositions[i][0];
-        double dy = estY - satPositions[i][1];
-        double dz = estZ - satPositions[i][2];
-        double range = sqrt(dx*dx + dy*dy + dz*dz);
-        total += fabs(pseudoranges[i] - (range + clockBias));
+        double range = signalRange(epoch.sat(i), epoch.velocity(i), estX, estY, estZ);
+        total += fabs(epoch.ranges[i] - (range + clockBias));
     }
     return total / n;
 }
 
+void Detector::scoreSignal(const SignalQualityView& signal, DetectionResult& result) {
+    // A spoofer drags every channel at once (each in its own direction), so
+    // the scores are means over the locked channels, of the asymmetry's
+    // magnitude: a skew on all channels stands out of per-channel noise
+    double asym = 0.0, flat = 0.0, power = 0.0, cn0 = 0.0;
+    int used = 0;
+    for (int c = 0; c < signal.count; c++) {
+        if (signal.lock[c] < minLock || signal.cn0[c] < minCn0) continue;
+        asym  += fabs(signal.asymmetry[c]);
+        flat  += signal.flatness[c];
+        power += signal.promptPower[c];
+        cn0   += signal.cn0[c];
+        used++;
+    }
+    if (used == 0) return;
+
+    result.asymmetryScore = asym / used;
+    result.flatnessScore  = flat / used;
+    result.cn0Mean        = cn0 / used;
+    double powerDb = 10 * log10(power / used);
+    if (powerWindow.size() > 0) result.powerScore = powerDb - powerWindow.mean();
+    powerWindow.push(powerDb);
+}
+
 DetectionResult Detector::analyze(
     double estX, double estY, double estZ, double clockBias,
     double dt,
-    const std::vector<std::vector<double>>& satPositions,
-    const std::vector<double>& pseudoranges)
+    const EpochView& epoch,
+    const SignalQualityView* signal,
+    const FilterInnovations* innovations)
 {
+    GNSS_STAGE(STAGE_DETECTION);
     DetectionResult result;
     result.spoofingDetected = false;
     result.confidence       = 0.0;
     result.residualScore    = 0.0;
     result.velocityScore    = 0.0;
     result.clockScore       = 0.0;
-    result.reason           = "OK";
+    result.reasons          = REASON_NONE;
+    result.asymmetryScore   = 0.0;
+    result.flatnessScore    = 0.0;
+    result.powerScore       = 0.0;
+    result.cn0Mean          = 0.0;
+    result.innovationScore  = 0.0;
+    result.innovationThreshold = 0.0;
+    result.innovationCount  = 0;
+    result.positionDelta    = 0.0;
+    result.rangeDelta       = 0.0;
 
     result.residualScore = computeResidualScore(
-        satPositions, pseudoranges, estX, estY, estZ, clockBias);
+        epoch, estX, estY, estZ, clockBias);
 
     // ===== Velocity check — key spoofing indicator =====
     // If position jumped further than physically possible, flag it
-    double velocityConf = 0.0;
-    if (!posHistory.empty()) {
-        auto& prev = posHistory.back();
+    const double* prev = &posHistory[historyHead * 3];
+    if (historyCount > 0) {
         double dx = estX - prev[0];
         double dy = estY - prev[1];
         double dz = estZ - prev[2];
         double dist = sqrt(dx*dx + dy*dy + dz*dz);
-        double speed = (dt > 0) ? dist / dt : 0.0;
-        result.velocityScore = speed;
-        velocityConf = std::min(1.0, speed / maxPhysicalSpeed);
+        result.velocityScore = (dt > 0) ? dist / dt : 0.0;
     }
 
     // ===== Clock jump check =====
-    double clockConf = 0.0;
-    if (!clockHistory.empty()) {
-        double jump = fabs(clockBias - clockHistory.back());
-        result.clockScore = jump;
-        clockConf = std::min(1.0, jump / clockJumpThreshold);
-    }
+    if (historyCount > 0)
+        result.clockScore = fabs(clockBias - clockHistory[historyHead]);
 
     // ===== Pseudorange consistency check =====
     // Compare current pseudoranges against what we'd expect from
     // the previous position — spoofed signals are inconsistent with motion
-    double consistencyConf = 0.0;
-    if (!posHistory.empty() && !pseudoHistory.empty()) {
-        auto& prevPos = posHistory.back();
-        auto& prevPR  = pseudoHistory.back();
+    if (historyCount > 0) {
+        const double* prevPR = &pseudoHistory[(size_t)historyHead * rangeStride];
 
         // How much did pseudoranges change vs how much position changed
         double prDelta = 0.0;
-        int n = std::min(pseudoranges.size(), prevPR.size());
+        int n = std::min(epoch.count, pseudoCount[historyHead]);
         for (int i = 0; i < n; i++)
-            prDelta += fabs(pseudoranges[i] - prevPR[i]);
-        prDelta /= n;
-
-        double posDelta = sqrt(
-            pow(estX-prevPos[0],2) +
-            pow(estY-prevPos[1],2) +
-            pow(estZ-prevPos[2],2));
-
-        // In normal operation pseudoranges change proportionally to position
-        // Spoofed: position jumps but pseudoranges stay suspiciously similar
-        if (posDelta > 100.0 && prDelta < 1.0)
-            consistencyConf = std::min(1.0, posDelta / 10000.0);
+            prDelta += fabs(epoch.ranges[i] - prevPR[i]);
+        result.rangeDelta = prDelta / n;
+
+        double dx = estX - prev[0], dy = estY - prev[1], dz = estZ - prev[2];
+        result.positionDelta = sqrt(dx*dx + dy*dy + dz*dz);
     }
 
-    // Update history
-    posHistory.push_back({estX, estY, estZ});
-    if (posHistory.size() > 10) posHistory.pop_front();
-    clockHistory.push_back(clockBias);
-    if (clockHistory.size() > 10) clockHistory.pop_front();
-    pseudoHistory.push_back(pseudoranges);
-    if (pseudoHistory.size() > 10) pseudoHistory.pop_front();
-
-    double residualConf = std::min(1.0, result.residualScore / residualThreshold);
-
-    // Weighted — consistency check is most powerful here
-    result.confidence = 0.1 * residualConf
-                      + 0.3 * velocityConf
-                      + 0.1 * clockConf
-                      + 0.5 * consistencyConf;
-
-    if (result.confidence > 0.4) {
-        result.spoofingDetected = true;
-        std::ostringstream oss;
-        oss << "SPOOFING DETECTED (confidence=" << (int)(result.confidence*100) << "%)";
-        if (consistencyConf > 0.3)
-            oss << " — pseudoranges unchanged despite position shift";
-        if (velocityConf > 0.3)
-            oss << " — impossible speed (" << (int)result.velocityScore << " m/s)";
-        result.reason = oss.str();
+    // Update history (overwrites the oldest slot once the ring is full)
+    if (epoch.count > rangeStride) reserve(epoch.count);
+    if (++historyHead == window) historyHead = 0;
+    if (historyCount < window) historyCount++;
+    double* pos = &posHistory[historyHead * 3];
+    pos[0] = estX; pos[1] = estY; pos[2] = estZ;
+    clockHistory[historyHead] = clockBias;
+    std::copy(epoch.ranges, epoch.ranges + epoch.count,
+              pseudoHistory.begin() + (size_t)historyHead * rangeStride);
+    pseudoCount[historyHead] = epoch.count;
+
+    residualWindow.push(result.residualScore);
+    clockWindow.push(clockBias);
+    if (historyCount > 1) speedWindow.push(result.velocityScore);
+    result.residualMean   = residualWindow.mean();
+    result.residualStdDev = sqrt(residualWindow.variance());
+    result.clockMean      = clockWindow.mean();
+    result.clockStdDev    = sqrt(clockWindow.variance());
+    result.speedMean      = speedWindow.mean();
+
+    // ===== Integrity check: which satellites disagree with the rest =====
+    // A spoofer that takes over only some satellites, or fades in, leaves
+    // the set inconsistent; the satellites FDE excludes are the suspects
+    result.raim = integrity.check(epoch, estX, estY, estZ, clockBias);
+
+    // ===== Filter innovation check =====
+    if (innovations && innovations->count > 0) {
+        const int dof = innovations->count;
+        result.innovationCount = dof;
+        result.innovationScore = innovations->nis / dof;
+        result.innovationThreshold = chiSquareThreshold(dof, innovationZ);
     }
 
+    // ===== Correlator-level checks (tracking loops, if present) =====
+    if (signal) scoreSignal(*signal, result);
+
+    result.confidence = judgeDetection(limits, result, &result.reasons);
+    result.spoofingDetected = result.confidence > limits.alarmLevel;
+    if (result.spoofingDetected) GNSS_COUNT(COUNTER_DETECTIONS, 1);
     return result;
-}
\ No newline at end of file
+}
+
+// Shared by checkConfidences() and judgeDetection(); inlined so a verdict
+// keeps the confidences in registers
+static inline void confidencesOf(const DetectorThresholds& limits, const DetectionResult& r,
+                                 double conf[CHECK_COUNT])
+{
+    conf[CHECK_RESIDUAL] = std::min(1.0, r.residualScore / limits.residualThreshold);
+    conf[CHECK_VELOCITY] = std::min(1.0, r.velocityScore / limits.maxPhysicalSpeed);
+    conf[CHECK_CLOCK]    = std::min(1.0, r.clockScore / limits.clockJumpThreshold);
+
+    // In normal operation pseudoranges change proportionally to position
+    // Spoofed: position jumps but pseudoranges stay suspiciously similar
+    conf[CHECK_CONSISTENCY] = 0.0;
+    if (r.positionDelta > 100.0 && r.rangeDelta < 1.0)
+        conf[CHECK_CONSISTENCY] = std::min(1.0, r.positionDelta / 10000.0);
+
+    conf[CHECK_RAIM] = 0.0;
+    if (r.raim.fault)
+        conf[CHECK_RAIM] = std::min(1.0, r.raim.statistic / r.raim.threshold - 1.0);
+
+    // 0 at the expected NIS (one per range), 1 at the threshold
+    conf[CHECK_INNOVATION] = 0.0;
+    if (r.innovationCount > 0) {
+        const int dof = r.innovationCount;
+        conf[CHECK_INNOVATION] = std::min(1.0, std::max(0.0, (r.innovationScore - 1.0) * dof
+                                                             / (r.innovationThreshold - dof)));
+    }
+
+    // Correlator scores are 0 without signal input
+    conf[CHECK_DISTORTION] = std::max(std::min(1.0, r.asymmetryScore / limits.asymmetryThreshold),
+                                      std::min(1.0, std::max(0.0, r.flatnessScore) / limits.flatnessThreshold));
+    conf[CHECK_POWER] = std::min(1.0, std::max(0.0, r.powerScore) / limits.powerJumpThreshold);
+}
+
+void checkConfidences(const DetectorThresholds& limits, const DetectionResult& r,
+                      double conf[CHECK_COUNT])
+{
+    confidencesOf(limits, r, conf);
+}
+
+double judgeDetection(const DetectorThresholds& limits, const DetectionResult& r, uint32_t* reasons) {
+    double conf[CHECK_COUNT];
+    confidencesOf(limits, r, conf);
+
+    // The terms are non-negative, so capping once at the end is the same
+    // as capping after each
+    double confidence = weightedConfidence(limits.weights, 1, conf);
+    confidence = std::min(1.0, confidence);
+
+    if (reasons) {
+        *reasons = REASON_NONE;
+        if (confidence > limits.alarmLevel) {
+            if (conf[CHECK_CONSISTENCY] > 0.3) *reasons |= REASON_FROZEN_RANGES;
+            if (conf[CHECK_VELOCITY] > 0.3)    *reasons |= REASON_IMPOSSIBLE_SPEED;
+            if (conf[CHECK_DISTORTION] > 0.6)  *reasons |= REASON_PEAK_DISTORTION;
+            if (conf[CHECK_POWER] > 0.6)       *reasons |= REASON_POWER_JUMP;
+            if (conf[CHECK_RAIM] > 0.6)        *reasons |= REASON_RAIM_FAULT;
+            if (conf[CHECK_INNOVATION] > 0.6)  *reasons |= REASON_INNOVATION;
+        }
+    }
+    return confidence;
+}
+
+std::string formatReason(const DetectionResult& r) {
+    if (!r.spoofingDetected) return "OK";
+    char buf[160];
+    std::string s;
+    std::snprintf(buf, sizeof(buf), "SPOOFING DETECTED (confidence=%d%%)", (int)(r.confidence * 100));
+    s = buf;
+    if (r.reasons & REASON_FROZEN_RANGES)
+        s += " — pseudoranges unchanged despite position shift";
+    if (r.reasons & REASON_IMPOSSIBLE_SPEED) {
+        std::snprintf(buf, sizeof(buf), " — impossible speed (%d m/s)", (int)r.velocityScore);
+        s += buf;
+    }
+    if (r.reasons & REASON_PEAK_DISTORTION)
+        s += " — correlation peaks distorted";
+    if (r.reasons & REASON_POWER_JUMP) {
+        std::snprintf(buf, sizeof(buf), " — signal power up %.1f dB", r.powerScore);
+        s += buf;
+    }
+    if (r.reasons & REASON_INNOVATION) {
+        std::snprintf(buf, sizeof(buf), " — ranges off the track (NIS %.1f)", r.innovationScore);
+        s += buf;
+    }
+    if (r.reasons & REASON_RAIM_FAULT) {
+        s += " — pseudoranges inconsistent";
+        if (r.raim.isolated) {
+            s += ", excluded satellite";
+            if (r.raim.excludedCount > 1) s += "s";
+            // System letter and PRN, e.g. G05; the satellite id if the
+            // epoch carried no PRN
+            for (int k = 0; k < r.raim.excludedCount; k++) {
+                if (r.raim.excludedPrn[k] > 0)
+                    std::snprintf(buf, sizeof(buf), " %c%02d", systemLetter(r.raim.excludedSystem[k]),
+                                  r.raim.excludedPrn[k]);
+                else
+                    std::snprintf(buf, sizeof(buf), " #%d", r.raim.excluded[k]);
+                s += buf;
+            }
+        }
+    }
+    return s;
+}
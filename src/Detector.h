@@ -1,8 +1,22 @@
 #pragma once
 #include <vector>
-#include <deque>
 #include <string>
-#include <array>
+#include <cstdint>
+#include "EpochBuffer.h"
+#include "Tracking.h"
+#include "Raim.h"
+#include "NavFilter.h"
+
+// Why an epoch was flagged; combined as a bitmask in DetectionResult::reasons
+enum DetectionReason : uint32_t {
+    REASON_NONE              = 0,
+    REASON_FROZEN_RANGES     = 1u << 0,   // pseudoranges unchanged despite a position shift
+    REASON_IMPOSSIBLE_SPEED  = 1u << 1,   // position moved faster than the platform can
+    REASON_PEAK_DISTORTION   = 1u << 2,   // correlation peaks skewed or flattened across channels
+    REASON_POWER_JUMP        = 1u << 3,   // prompt power rose well above its recent level
+    REASON_RAIM_FAULT        = 1u << 4,   // pseudoranges inconsistent with any one position
+    REASON_INNOVATION        = 1u << 5,   // pseudoranges far from the navigation filter's prediction
+};
 
 struct DetectionResult {
     bool spoofingDetected;
@@ -10,31 +24,200 @@ struct DetectionResult {
     double residualScore;
     double velocityScore;
     double clockScore;
-    std::string reason;
+    uint32_t reasons;           // DetectionReason bits, REASON_NONE if clean
+
+    // Correlator-level scores over the locked channels; 0 without signal input
+    double asymmetryScore;      // mean magnitude of the early/late asymmetry
+    double flatnessScore;       // mean correlation-peak flattening
+    double powerScore;          // dB of mean prompt power above its window mean
+    double cn0Mean;             // dB-Hz
+
+    // Mean normalized innovation square of the navigation filter's update
+    // (about 1 when the ranges follow the motion model); 0 without a filter
+    double innovationScore;
+    double innovationThreshold;     // chi-square threshold for the epoch's NIS
+    int    innovationCount;         // ranges in the update (degrees of freedom)
+
+    // Pseudorange consistency: fix movement and mean pseudorange change
+    // since the previous epoch (0 without history)
+    double positionDelta, rangeDelta;
+
+    // Statistics over the detector window, including this epoch
+    double residualMean, residualStdDev;
+    double clockMean, clockStdDev;
+    double speedMean;
+
+    // Integrity check of this epoch's pseudoranges: whether they are
+    // consistent, and which satellites (if any) were excluded as faulty
+    RaimResult raim;
+};
+
+// The detector's individual checks. Each turns its score into a
+// confidence in [0, 1]; the verdict weighs them together.
+enum DetectorCheck {
+    CHECK_RESIDUAL,         // mean |pseudorange residual|
+    CHECK_VELOCITY,         // implied speed
+    CHECK_CLOCK,            // clock bias jump
+    CHECK_CONSISTENCY,      // fix moved, pseudoranges did not
+    CHECK_RAIM,             // chi-square excess of the integrity test
+    CHECK_INNOVATION,       // filter NIS excess
+    CHECK_DISTORTION,       // correlation-peak asymmetry / flattening
+    CHECK_POWER,            // prompt power jump
+    CHECK_COUNT
+};
+
+// Limits the detector's scores are judged against, and how the checks
+// combine. Each score counts in full at its limit and proportionally
+// below it; the confidence is the weighted sum of the checks, capped at 1,
+// and spoofing is reported when it exceeds alarmLevel.
+struct DetectorThresholds {
+    double maxPhysicalSpeed   = 300.0;  // m/s, max drone speed
+    double residualThreshold  = 50.0;   // m, mean |pseudorange residual|
+    double clockJumpThreshold = 100.0;  // m, clock bias change per epoch
+    double asymmetryThreshold = 0.1;    // mean |E - L| / (E + L) of dragged DLLs
+    double flatnessThreshold  = 0.5;
+    double powerJumpThreshold = 3.0;    // dB
+
+    // Consistency check is most powerful here
+    double weights[CHECK_COUNT] = {0.1, 0.3, 0.1, 0.5, 0.5, 0.5, 0.5, 0.5};
+    double alarmLevel = 0.4;
+};
+
+// Unclamped weighted sum of the confidences, the weight of check c at
+// w[c * stride]. The terms are added in a fixed order, so judgeDetection
+// and DetectorEvaluation, which replays its verdicts per weight set, agree
+// bit for bit.
+inline double weightedConfidence(const double* w, int stride, const double conf[CHECK_COUNT]) {
+    static_assert(CHECK_COUNT == 8, "one term per check");
+    double v = w[0] * conf[0] + w[stride] * conf[1] + w[2 * stride] * conf[2] + w[3 * stride] * conf[3];
+    v += w[4 * stride] * conf[4];
+    v += w[5 * stride] * conf[5];
+    v += w[6 * stride] * conf[6] + w[7 * stride] * conf[7];
+    return v;
+}
+
+// Per-check confidences from the scores of `r` (DetectorCheck order)
+void checkConfidences(const DetectorThresholds& limits, const DetectionResult& r,
+                      double conf[CHECK_COUNT]);
+
+// Weighted confidence in [0, 1] from the scores of `r` (and the reasons,
+// if asked for); spoofing is reported above limits.alarmLevel. analyze()
+// ends with this; a threshold sweep re-judges stored scores with it
+// instead of running the detector again.
+double judgeDetection(const DetectorThresholds& limits, const DetectionResult& r,
+                      uint32_t* reasons = nullptr);
+
+// Human-readable reason ("OK" or "SPOOFING DETECTED (...) — ..."). Builds a
+// string, so call it for display only, never on the per-epoch path.
+std::string formatReason(const DetectionResult& r);
+
+// Fixed-capacity sliding window with running sum and sum of squares, so the
+// mean and variance cost O(1) per sample instead of a rescan. Samples are
+// stored relative to a reference value that is moved to the window mean
+// every time the ring wraps; the sums are rebuilt then as well, so rounding
+// error cannot build up over long runs (amortized O(1)).
+class RunningWindow {
+private:
+    std::vector<double> values;
+    int    head  = 0;           // next slot to write
+    int    count = 0;
+    double shift = 0.0;
+    double sum   = 0.0;
+    double sumSq = 0.0;
+
+    void rebase();
+
+public:
+    explicit RunningWindow(int capacity = 1) : values(capacity, 0.0) {}
+
+    void clear() { head = count = 0; sum = sumSq = 0.0; }
+
+    void push(double v) {
+        if (count == 0) shift = v;
+        double d = v - shift;
+        if (count == (int)values.size()) {
+            double old = values[head];
+            sum -= old; sumSq -= old * old;
+        } else {
+            count++;
+        }
+        values[head] = d;
+        sum += d; sumSq += d * d;
+        if (++head == (int)values.size()) { head = 0; rebase(); }
+    }
+
+    int size() const { return count; }
+    double mean() const { return count ? shift + sum / count : 0.0; }
+    double variance() const {
+        if (count < 2) return 0.0;
+        double m = sum / count;
+        double v = (sumSq - count * m * m) / (count - 1);
+        return v > 0 ? v : 0.0;
+    }
 };
 
 class Detector {
 private:
-    std::deque<std::array<double,3>>      posHistory;
-    std::deque<double>                    clockHistory;
-    std::deque<std::vector<double>>       pseudoHistory;  // NEW
+    // History rings of `window` epochs. Pseudoranges are one flat block of
+    // window x rangeStride values so recording an epoch never allocates once
+    // reserve() has seen the largest satellite count.
+    int window;
+    std::vector<double> posHistory;      // [slot * 3 + axis]
+    std::vector<double> clockHistory;    // [slot]
+    std::vector<double> pseudoHistory;   // [slot * rangeStride + sat]
+    std::vector<int>    pseudoCount;     // [slot]
+    int rangeStride  = 0;
+    int historyHead  = 0;   // slot of the most recent epoch
+    int historyCount = 0;
 
-    double maxPhysicalSpeed;
-    double residualThreshold;
-    double clockJumpThreshold;
+    RunningWindow residualWindow;
+    RunningWindow clockWindow;
+    RunningWindow speedWindow;
+    RunningWindow powerWindow;          // mean prompt power, dB
+    Raim          integrity;
+
+    DetectorThresholds limits;
+    double innovationZ;                 // normal quantile of the innovation test's false-alarm rate
+    double minCn0;                      // dB-Hz for a channel to count
+    double minLock;
 
     double computeResidualScore(
-        const std::vector<std::vector<double>>& satPositions,
-        const std::vector<double>& pseudoranges,
+        const EpochView& epoch,
         double estX, double estY, double estZ, double clockBias);
 
+    // Fills the correlator scores of `result`
+    void scoreSignal(const SignalQualityView& signal, DetectionResult& result);
+
 public:
-    Detector();
+    // `window` is the number of past epochs kept for the windowed statistics
+    explicit Detector(int window = 10);
+
+    int getWindow() const { return window; }
+
+    // Pre-sizes history so epochs with up to maxSatellites never allocate
+    void reserve(int maxSatellites);
 
+    void reset();
+
+    // Thresholds only affect the verdict, not the scores or the history
+    void setThresholds(const DetectorThresholds& t) { limits = t; }
+    const DetectorThresholds& thresholds() const { return limits; }
+
+    // RAIM/FDE settings (range sigma, false-alarm rate, exclusions)
+    Raim&       raim()       { return integrity; }
+    const Raim& raim() const { return integrity; }
+
+    // `signal` optionally adds the tracking loops' correlator measurements:
+    // a spoofer dragging the tracking points off distorts the correlation
+    // peaks and raises the received power before the fix moves at all.
+    // `innovations`, from a navigation filter's update of this epoch, adds
+    // a test of the ranges against the filter's prediction: a counterfeit
+    // that pulls the fix is inconsistent with the motion so far.
     DetectionResult analyze(
         double estX, double estY, double estZ, double clockBias,
         double dt,
-        const std::vector<std::vector<double>>& satPositions,
-        const std::vector<double>& pseudoranges
+        const EpochView& epoch,
+        const SignalQualityView* signal = nullptr,
+        const FilterInnovations* innovations = nullptr
     );
-};
\ No newline at end of file
+};
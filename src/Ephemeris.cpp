@@ -0,0 +1,171 @@
+#include "Ephemeris.h"
+#include <cmath>
+#include <algorithm>
+
+const double GPS_MU        = 3.986005e14;       // WGS-84 value used by IS-GPS-200
+const double GALILEO_MU    = 3.986004418e14;    // Galileo OS SIS ICD
+const double EARTH_ROT     = 7.2921151467e-5;   // rad/s
+const double GPS_REL_F     = -4.442807633e-10;  // relativistic clock constant, -2 sqrt(mu) / c^2
+const double GALILEO_REL_F = -4.442807309e-10;
+const double SECONDS_WEEK  = 604800.0;
+
+// sin/cos of a small angle (|a| < 1e-3 rad) by series; exact to double precision
+static inline void smallSinCos(double a, double& s, double& c) {
+    double a2 = a * a;
+    s = a * (1.0 - a2 * (1.0 / 6.0));
+    c = 1.0 - a2 * (0.5 - a2 * (1.0 / 24.0));
+}
+
+EphemerisPropagator::Record EphemerisPropagator::derive(const BroadcastEphemeris& eph) {
+    // QZSS broadcasts in GPS's frame and constants
+    const bool galileo = eph.system == 'E';
+    const double mu = galileo ? GALILEO_MU : GPS_MU;
+    Record r;
+    r.toe      = eph.toe;
+    r.toeSow   = std::fmod(eph.toe, SECONDS_WEEK);
+    r.toc      = eph.toc;
+    r.A        = eph.sqrtA * eph.sqrtA;
+    r.n        = std::sqrt(mu / (r.A * r.A * r.A)) + eph.deltaN;
+    r.e        = eph.e;
+    r.sqrt1mE2 = std::sqrt(1.0 - eph.e * eph.e);
+    r.m0       = eph.m0;
+    r.cosW     = std::cos(eph.omega);
+    r.sinW     = std::sin(eph.omega);
+    r.cosI0    = std::cos(eph.i0);
+    r.sinI0    = std::sin(eph.i0);
+    r.idot     = eph.idot;
+    r.omegaAtToe = eph.omega0 - EARTH_ROT * r.toeSow;
+    r.omegaRate  = eph.omegaDot - EARTH_ROT;
+    r.cuc = eph.cuc; r.cus = eph.cus;
+    r.crc = eph.crc; r.crs = eph.crs;
+    r.cic = eph.cic; r.cis = eph.cis;
+    r.af0 = eph.af0; r.af1 = eph.af1; r.af2 = eph.af2;
+    r.relF = (galileo ? GALILEO_REL_F : GPS_REL_F) * eph.e * eph.sqrtA;
+    return r;
+}
+
+void EphemerisPropagator::load(const std::vector<BroadcastEphemeris>& ephemerides) {
+    tracks.clear();
+    for (const auto& eph : ephemerides) {
+        if (eph.sqrtA <= 0) continue;
+        auto it = std::find_if(tracks.begin(), tracks.end(), [&](const Track& t) {
+            return t.system == eph.system && t.prn == eph.prn;
+        });
+        if (it == tracks.end()) {
+            tracks.push_back(Track());
+            it = tracks.end() - 1;
+            it->system = eph.system;
+            it->prn    = eph.prn;
+        }
+        it->records.push_back(derive(eph));
+    }
+    for (auto& tr : tracks)
+        std::stable_sort(tr.records.begin(), tr.records.end(),
+                         [](const Record& a, const Record& b) { return a.toe < b.toe; });
+    std::sort(tracks.begin(), tracks.end(), [](const Track& a, const Track& b) {
+        return a.system != b.system ? a.system < b.system : a.prn < b.prn;
+    });
+
+    int n = (int)tracks.size();
+    xs.assign(n, 0.0); ys.assign(n, 0.0); zs.assign(n, 0.0);
+    clockBias.assign(n, 0.0);
+    keplerIterations = 0;
+}
+
+// Uses the record whose toe is closest to t; a switch drops the warm start
+void EphemerisPropagator::selectRecord(Track& tr, double t) {
+    int k = tr.active;
+    int last = (int)tr.records.size() - 1;
+    while (k < last && std::fabs(tr.records[k + 1].toe - t) <= std::fabs(tr.records[k].toe - t)) k++;
+    while (k > 0 && std::fabs(tr.records[k - 1].toe - t) < std::fabs(tr.records[k].toe - t)) k--;
+    if (k != tr.active) { tr.active = k; tr.warm = false; }
+}
+
+void EphemerisPropagator::update(double gpsTime) {
+    const int n = (int)tracks.size();
+    for (int i = 0; i < n; i++) {
+        Track& tr = tracks[i];
+        selectRecord(tr, gpsTime);
+        const Record& r = tr.records[tr.active];
+
+        double tk = gpsTime - r.toe;
+        double M  = r.m0 + r.n * tk;
+
+        // ===== Kepler's equation  M = E - e sinE  (Newton) =====
+        // Warm start: advance last epoch's E by dM / (dM/dE). Convergence is
+        // quadratic, so once a step is below 1e-8 the remaining error is
+        // ~1e-16 and sin/cos of the final E follow from a first-order update.
+        double E = tr.warm ? tr.E + (M - tr.M) / (1.0 - r.e * tr.cosE)
+                           : M + r.e * std::sin(M);
+        double sinE = 0, cosE = 1;
+        for (int it = 0; it < 12; it++) {
+            sinE = std::sin(E);
+            cosE = std::cos(E);
+            double dE = (E - r.e * sinE - M) / (1.0 - r.e * cosE);
+            E -= dE;
+            keplerIterations++;
+            if (std::fabs(dE) < 1e-8) {
+                double s0 = sinE;
+                sinE -= cosE * dE;
+                cosE += s0 * dE;
+                break;
+            }
+        }
+        tr.E = E; tr.M = M; tr.cosE = cosE; tr.warm = true;
+
+        // True anomaly without atan2: sin/cos of v from E
+        double den  = 1.0 - r.e * cosE;
+        double sinV = r.sqrt1mE2 * sinE / den;
+        double cosV = (cosE - r.e) / den;
+
+        // Argument of latitude phi = v + omega
+        double sinP = sinV * r.cosW + cosV * r.sinW;
+        double cosP = cosV * r.cosW - sinV * r.sinW;
+        double sin2P = 2.0 * sinP * cosP;
+        double cos2P = cosP * cosP - sinP * sinP;
+
+        // Second-harmonic corrections
+        double du = r.cus * sin2P + r.cuc * cos2P;
+        double dr = r.crs * sin2P + r.crc * cos2P;
+        double di = r.cis * sin2P + r.cic * cos2P + r.idot * tk;
+
+        double sdu, cdu, sdi, cdi;
+        smallSinCos(du, sdu, cdu);
+        smallSinCos(di, sdi, cdi);
+        double sinU = sinP * cdu + cosP * sdu;
+        double cosU = cosP * cdu - sinP * sdu;
+        double sinI = r.sinI0 * cdi + r.cosI0 * sdi;
+        double cosI = r.cosI0 * cdi - r.sinI0 * sdi;
+
+        double radius = r.A * den + dr;
+        double xp = radius * cosU;
+        double yp = radius * sinU;
+
+        // Longitude of ascending node in ECEF
+        double node = r.omegaAtToe + r.omegaRate * tk;
+        double sinO = std::sin(node), cosO = std::cos(node);
+
+        xs[i] = xp * cosO - yp * cosI * sinO;
+        ys[i] = xp * sinO + yp * cosI * cosO;
+        zs[i] = yp * sinI;
+
+        double dtc = gpsTime - r.toc;
+        clockBias[i] = r.af0 + dtc * (r.af1 + dtc * r.af2) + r.relF * sinE;
+    }
+}
+
+double EphemerisPropagator::firstToe() const {
+    double t = 0; bool any = false;
+    for (const auto& tr : tracks)
+        for (const auto& r : tr.records)
+            if (!any || r.toe < t) { t = r.toe; any = true; }
+    return t;
+}
+
+double EphemerisPropagator::lastToe() const {
+    double t = 0; bool any = false;
+    for (const auto& tr : tracks)
+        for (const auto& r : tr.records)
+            if (!any || r.toe > t) { t = r.toe; any = true; }
+    return t;
+}
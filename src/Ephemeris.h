@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+
+// One broadcast-ephemeris record (IS-GPS-200 naming). Times are absolute
+// GPS seconds since 1980-01-06 with the week number already folded in, so
+// records from different weeks can be compared directly.
+struct BroadcastEphemeris {
+    char   system = 'G';    // 'G' GPS, 'E' Galileo, 'J' QZSS
+    int    prn    = 0;
+    double toc    = 0;      // clock reference time
+    double af0 = 0, af1 = 0, af2 = 0;
+    double iode = 0, crs = 0, deltaN = 0, m0 = 0;
+    double cuc = 0, e = 0, cus = 0, sqrtA = 0;
+    double toe = 0;         // ephemeris reference time
+    double cic = 0, omega0 = 0, cis = 0;
+    double i0 = 0, crc = 0, omega = 0, omegaDot = 0;
+    double idot = 0;
+    double week = 0;
+    double health = 0, tgd = 0;
+};
+
+// Keplerian broadcast-orbit propagator for a whole constellation.
+//
+// Everything that depends only on the ephemeris record (semi-major axis,
+// corrected mean motion, sqrt(1-e^2), sin/cos of the argument of perigee
+// and reference inclination, the node rate) is computed once when the
+// record is loaded. The per-epoch path solves Kepler's equation, warm-
+// started from the previous epoch's eccentric anomaly, and applies the
+// harmonic corrections using double-angle identities instead of fresh
+// trig calls. Positions are written to contiguous x/y/z arrays (ECEF).
+class EphemerisPropagator {
+private:
+    struct Record {
+        double toe, toeSow, toc;
+        double A, n, e, sqrt1mE2, m0;
+        double cosW, sinW;            // argument of perigee
+        double cosI0, sinI0, idot;
+        double omegaAtToe, omegaRate; // Omega0 - wE*toeSow, OmegaDot - wE
+        double cuc, cus, crc, crs, cic, cis;
+        double af0, af1, af2, relF;   // relF = F * e * sqrtA
+    };
+
+    struct Track {
+        char system;
+        int  prn;
+        std::vector<Record> records;  // sorted by toe
+        int    active = 0;
+        bool   warm   = false;        // E/M hold the previous epoch's solution
+        double E = 0, M = 0, cosE = 1;
+    };
+
+    std::vector<Track>  tracks;
+    std::vector<double> xs, ys, zs;
+    std::vector<double> clockBias;    // satellite clock offset, seconds
+    long long keplerIterations = 0;
+
+    static Record derive(const BroadcastEphemeris& eph);
+    void selectRecord(Track& tr, double t);
+
+public:
+    // Groups records by satellite and derives per-record constants
+    void load(const std::vector<BroadcastEphemeris>& ephemerides);
+
+    int size() const { return (int)xs.size(); }
+
+    // Propagates every satellite to absolute GPS time `gpsTime`
+    void update(double gpsTime);
+
+    const double* x() const { return xs.data(); }
+    const double* y() const { return ys.data(); }
+    const double* z() const { return zs.data(); }
+
+    double getX(int i) const { return xs[i]; }
+    double getY(int i) const { return ys[i]; }
+    double getZ(int i) const { return zs[i]; }
+    double getClockBias(int i) const { return clockBias[i]; }
+    int    getPrn(int i) const { return tracks[i].prn; }
+    char   getSystem(int i) const { return tracks[i].system; }
+
+    // Earliest / latest toe across all loaded records
+    double firstToe() const;
+    double lastToe() const;
+
+    long long getKeplerIterations() const { return keplerIterations; }
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Read-only view of one epoch's measurements: `count` satellites with
+// positions and velocities packed as x,y,z triples, one pseudorange, one
+// satellite id (constellation index), GnssSystem and PRN each. Positions
+// and velocities are at the receive time; see SignalPath.h.
+struct EpochView {
+    const double* pos;      // count * 3, row-major
+    const double* ranges;   // count
+    int count;
+    const int* sats;        // count
+    const uint8_t* systems; // count
+    const double* vel;      // count * 3, row-major (m/s)
+    const int* prns;        // count; 0 if the source did not give one
+
+    const double* sat(int i) const { return pos + 3 * i; }
+    const double* velocity(int i) const { return vel + 3 * i; }
+};
+
+// Reusable per-epoch measurement store. Storage grows only when an epoch
+// sees more satellites than ever before, so after warm-up (or an explicit
+// reserve) filling and passing an epoch around allocates nothing.
+class EpochBuffer {
+private:
+    std::vector<double> pos;
+    std::vector<double> vel;
+    std::vector<double> range;
+    std::vector<int>    id;
+    std::vector<uint8_t> sys;
+    std::vector<int>    prn;
+    int n = 0;
+
+public:
+    void reserve(int capacity) {
+        if ((int)range.size() < capacity) {
+            pos.resize(3 * capacity);
+            vel.resize(3 * capacity);
+            range.resize(capacity);
+            id.resize(capacity);
+            sys.resize(capacity);
+            prn.resize(capacity);
+        }
+    }
+
+    void clear() { n = 0; }
+
+    void push(double sx, double sy, double sz, double pseudorange, int sat, int system = 0,
+              int satPrn = 0) {
+        const double still[3] = {0.0, 0.0, 0.0};
+        push(sx, sy, sz, still, pseudorange, sat, system, satPrn);
+    }
+
+    // With the satellite's velocity (m/s), for the light-time correction.
+    // `sat` is the caller's satellite id (a constellation index); `satPrn`
+    // is the PRN within `system`, for reports.
+    void push(double sx, double sy, double sz, const double v[3], double pseudorange, int sat,
+              int system = 0, int satPrn = 0) {
+        if (n == (int)range.size()) reserve(n < 8 ? 16 : 2 * n);
+        double* p = &pos[3 * n];
+        p[0] = sx; p[1] = sy; p[2] = sz;
+        double* w = &vel[3 * n];
+        w[0] = v[0]; w[1] = v[1]; w[2] = v[2];
+        range[n] = pseudorange;
+        id[n] = sat;
+        sys[n] = (uint8_t)system;
+        prn[n] = satPrn;
+        n++;
+    }
+
+    int size() const { return n; }
+
+    double*       ranges()          { return range.data(); }
+    const double* ranges() const    { return range.data(); }
+    const double* positions() const { return pos.data(); }
+    const double* velocities() const { return vel.data(); }
+    const int*    satellites() const { return id.data(); }
+
+    EpochView view() const {
+        return {pos.data(), range.data(), n, id.data(), sys.data(), vel.data(), prn.data()};
+    }
+};
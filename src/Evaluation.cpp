@@ -0,0 +1,210 @@
+#include "Evaluation.h"
+#include <cmath>
+#include <algorithm>
+
+#include "MonteCarlo.h"
+#include "ThreadPool.h"
+
+DetectorEvaluation::DetectorEvaluation(const std::vector<CheckWeights>& weightSets,
+                                       double latencyStep, int latencyBins)
+    : setCount((int)weightSets.size())
+    , weightsByCheck((size_t)CHECK_COUNT * weightSets.size())
+    , latencyStep(latencyStep > 0 ? latencyStep : 1.0)
+    , latencyBins(std::max(1, latencyBins))
+    , clean((size_t)setCount * (LEVELS + 1), 0)
+    , spoofed((size_t)setCount * (LEVELS + 1), 0)
+    , firstAlarm((size_t)setCount * this->latencyBins * (LEVELS + 1), 0)
+    , runMax(setCount, 0)
+    , score(setCount, 0.0)
+{
+    for (int k = 0; k < CHECK_COUNT; k++)
+        for (int s = 0; s < setCount; s++)
+            weightsByCheck[(size_t)k * setCount + s] = weightSets[s][k];
+}
+
+CheckWeights DetectorEvaluation::weights(int set) const {
+    CheckWeights w;
+    for (int k = 0; k < CHECK_COUNT; k++) w[k] = weightsByCheck[(size_t)k * setCount + set];
+    return w;
+}
+
+size_t DetectorEvaluation::memoryBytes() const {
+    return sizeof(*this) + (weightsByCheck.size() + score.size()) * sizeof(double)
+         + (clean.size() + spoofed.size() + firstAlarm.size()) * sizeof(long long)
+         + runMax.size() * sizeof(int);
+}
+
+// Number of levels the score alarms at: the j with s > level(j). The
+// product rounds, so the estimate is nudged until it agrees with the
+// comparison itself.
+int DetectorEvaluation::cut(double s) const {
+    if (!(s > 0.0)) return 0;
+    int c = (int)std::min<double>(LEVELS, std::ceil(s * LEVELS));
+    while (c > 0 && !(s > level(c - 1))) c--;
+    while (c < LEVELS && s > level(c)) c++;
+    return c;
+}
+
+// ===== Accumulation =====
+
+void DetectorEvaluation::beginRun(double onsetTime) {
+    if (inRun) endRun();
+    inRun = true;
+    onset = onsetTime;
+    runSpoofedEpochs = 0;
+    std::fill(runMax.begin(), runMax.end(), 0);
+}
+
+void DetectorEvaluation::addEpoch(double time, const double conf[CHECK_COUNT]) {
+    // The detector's own sum, so level 0.4 with the default weights
+    // reproduces its verdicts exactly
+    double* s = score.data();
+    const double* w = weightsByCheck.data();
+    const int n = setCount;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) s[i] = weightedConfidence(w + i, n, conf);
+
+    const bool positive = onset >= 0 && time >= onset;
+    if (!positive) {
+        cleanEpochs++;
+        for (int i = 0; i < setCount; i++) clean[(size_t)i * (LEVELS + 1) + cut(std::min(1.0, s[i]))]++;
+        return;
+    }
+    spoofedEpochs++;
+    runSpoofedEpochs++;
+    const int bin = std::min(latencyBins - 1, (int)((time - onset) / latencyStep));
+    for (int i = 0; i < setCount; i++) {
+        const int c = cut(std::min(1.0, s[i]));
+        spoofed[(size_t)i * (LEVELS + 1) + c]++;
+        if (c > runMax[i]) {
+            // Levels [runMax, c) first alarm now
+            long long* row = &firstAlarm[((size_t)i * latencyBins + bin) * (LEVELS + 1)];
+            row[runMax[i]]++;
+            row[c]--;
+            runMax[i] = c;
+        }
+    }
+}
+
+void DetectorEvaluation::endRun() {
+    if (!inRun) return;
+    inRun = false;
+    if (onset < 0) cleanRuns++;
+    else if (runSpoofedEpochs > 0) spoofedRuns++;
+}
+
+void DetectorEvaluation::merge(const DetectorEvaluation& o) {
+    for (size_t i = 0; i < clean.size(); i++) clean[i] += o.clean[i];
+    for (size_t i = 0; i < spoofed.size(); i++) spoofed[i] += o.spoofed[i];
+    for (size_t i = 0; i < firstAlarm.size(); i++) firstAlarm[i] += o.firstAlarm[i];
+    cleanEpochs   += o.cleanEpochs;
+    spoofedEpochs += o.spoofedEpochs;
+    cleanRuns     += o.cleanRuns;
+    spoofedRuns   += o.spoofedRuns;
+}
+
+void DetectorEvaluation::clear() {
+    std::fill(clean.begin(), clean.end(), 0);
+    std::fill(spoofed.begin(), spoofed.end(), 0);
+    std::fill(firstAlarm.begin(), firstAlarm.end(), 0);
+    cleanEpochs = spoofedEpochs = cleanRuns = spoofedRuns = 0;
+    inRun = false;
+}
+
+// ===== Curves =====
+
+long long DetectorEvaluation::falseAlarms(int set, int j) const {
+    const long long* h = &clean[(size_t)set * (LEVELS + 1)];
+    long long n = 0;
+    for (int c = j + 1; c <= LEVELS; c++) n += h[c];
+    return n;
+}
+
+long long DetectorEvaluation::detections(int set, int j) const {
+    const long long* h = &spoofed[(size_t)set * (LEVELS + 1)];
+    long long n = 0;
+    for (int c = j + 1; c <= LEVELS; c++) n += h[c];
+    return n;
+}
+
+double DetectorEvaluation::falseAlarmRate(int set, int j) const {
+    return cleanEpochs ? (double)falseAlarms(set, j) / cleanEpochs : 0.0;
+}
+
+double DetectorEvaluation::detectionRate(int set, int j) const {
+    return spoofedEpochs ? (double)detections(set, j) / spoofedEpochs : 0.0;
+}
+
+double DetectorEvaluation::auc(int set) const {
+    if (cleanEpochs == 0 || spoofedEpochs == 0) return 0.0;
+    const long long* neg = &clean[(size_t)set * (LEVELS + 1)];
+    const long long* pos = &spoofed[(size_t)set * (LEVELS + 1)];
+    // P(spoofed score > clean score) + P(tie) / 2, by cut
+    double wins = 0.0, below = 0.0;
+    for (int c = 0; c <= LEVELS; c++) {
+        wins  += pos[c] * (below + 0.5 * neg[c]);
+        below += neg[c];
+    }
+    return wins / ((double)cleanEpochs * spoofedEpochs);
+}
+
+int DetectorEvaluation::levelForFalseAlarmRate(int set, double rate) const {
+    const long long* h = &clean[(size_t)set * (LEVELS + 1)];
+    long long above = 0;    // clean epochs with cut > j
+    const long long allowed = (long long)std::floor(rate * cleanEpochs);
+    for (int j = LEVELS - 1; j >= 0; j--) {
+        if (above + h[j + 1] > allowed) return j + 1;
+        above += h[j + 1];
+    }
+    return 0;
+}
+
+long long DetectorEvaluation::detectedRuns(int set, int j, std::vector<long long>* perBin) const {
+    long long total = 0;
+    if (perBin) perBin->assign(latencyBins, 0);
+    for (int b = 0; b < latencyBins; b++) {
+        const long long* row = &firstAlarm[((size_t)set * latencyBins + b) * (LEVELS + 1)];
+        long long n = 0;
+        for (int l = 0; l <= j; l++) n += row[l];
+        if (perBin) (*perBin)[b] = n;
+        total += n;
+    }
+    return total;
+}
+
+double DetectorEvaluation::runDetectionRate(int set, int j) const {
+    return spoofedRuns ? (double)detectedRuns(set, j, nullptr) / spoofedRuns : 0.0;
+}
+
+double DetectorEvaluation::latencyQuantile(int set, int j, double q) const {
+    std::vector<long long> bins;
+    long long total = detectedRuns(set, j, &bins);
+    if (total == 0) return -1.0;
+    long long rank = std::max(1LL, (long long)std::ceil(q * total));
+    long long seen = 0;
+    for (int b = 0; b < latencyBins; b++) {
+        seen += bins[b];
+        if (seen >= rank) return (b + 1) * latencyStep;
+    }
+    return latencyBins * latencyStep;
+}
+
+// ===== Monte Carlo source =====
+
+void evaluateMonteCarlo(long long runs, uint64_t baseSeed, int threads, DetectorEvaluation& eval) {
+    const int RUNS_PER_CHUNK = 32;
+    int chunks = (int)((runs + RUNS_PER_CHUNK - 1) / RUNS_PER_CHUNK);
+    ThreadPool pool(threads);
+
+    // One evaluation per worker, merged at the end
+    std::vector<DetectorEvaluation> partial(pool.size(), eval);
+    for (auto& p : partial) p.clear();
+
+    pool.parallelFor(chunks, [&](int chunk, int worker) {
+        long long begin = (long long)chunk * RUNS_PER_CHUNK;
+        long long end   = std::min(runs, begin + RUNS_PER_CHUNK);
+        for (long long i = begin; i < end; i++)
+            runScenario(randomScenario(baseSeed, i), &partial[worker]);
+    });
+    for (auto& p : partial) eval.merge(p);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "Detector.h"
+
+// Weights of one candidate combination of the checks (DetectorCheck order)
+typedef std::array<double, CHECK_COUNT> CheckWeights;
+
+// ROC and detection-latency statistics of the detector's combined
+// confidence, for several weight sets and every alarm level at once.
+//
+// Labelled runs are streamed in epoch by epoch as per-check confidences
+// (checkConfidences). Each weight set's confidence s = min(1, w . c) is
+// placed on a fixed grid of alarm levels a_j = j / LEVELS: the epoch alarms
+// at level a_j iff s > a_j, i.e. for every j below its cut index. Counting
+// epochs by cut index is a counting sort of the scores, so a whole ROC
+// curve is one suffix-sum pass over LEVELS + 1 counters: no score is
+// stored and no level is evaluated on its own. Clean epochs (clean runs,
+// and spoofed runs before the onset) count towards false alarms, spoofed
+// epochs towards detections.
+//
+// Latency is per spoofed run: time from onset to the first spoofed epoch
+// over the level. The lower the level the earlier the first alarm, so a
+// run's latency over all levels is a staircase traced by the running
+// maximum of its cut: an epoch that raises the maximum from m to c is the
+// first alarm for levels [m, c). Each step is two updates of a difference
+// array over levels, per latency bin; levels a run never reaches are
+// misses.
+//
+// Memory is fixed at construction, (LEVELS + 1) x (2 + latency bins)
+// counters per weight set, however many epochs are added. Counts are
+// integers, so merging per-thread evaluations is exact in any order.
+class DetectorEvaluation {
+public:
+    static const int LEVELS = 1000;     // alarm level step 0.001, so 0.4 is on the grid
+
+private:
+    int setCount;
+    std::vector<double> weightsByCheck;     // [check * setCount + set]
+    double latencyStep;
+    int    latencyBins;                     // the last bin also takes every later alarm
+    std::vector<long long> clean;           // [set * (LEVELS + 1) + cut]
+    std::vector<long long> spoofed;
+    std::vector<long long> firstAlarm;      // [(set * latencyBins + bin) * (LEVELS + 1) + level], differences
+    long long cleanEpochs = 0, spoofedEpochs = 0;
+    long long cleanRuns = 0, spoofedRuns = 0;
+
+    // Current run
+    bool   inRun = false;
+    double onset = -1.0;
+    long long runSpoofedEpochs = 0;
+    std::vector<int> runMax;                // [set] highest cut since onset
+    std::vector<double> score;              // [set] scratch
+
+    int cut(double s) const;
+    long long detectedRuns(int set, int level, std::vector<long long>* perBin) const;
+
+public:
+    // latencyBins bins of latencyStep seconds each
+    explicit DetectorEvaluation(const std::vector<CheckWeights>& weightSets,
+                                double latencyStep = 1.0, int latencyBins = 120);
+
+    static double level(int j) { return (double)j / LEVELS; }
+
+    // Starts a run whose spoofing begins at `onsetTime` (negative: a clean
+    // run); ends the previous run if it is still open
+    void beginRun(double onsetTime);
+    void addEpoch(double time, const double conf[CHECK_COUNT]);
+    void endRun();
+
+    // Adds another evaluation of the same weight sets and latency bins
+    void merge(const DetectorEvaluation& other);
+    // Drops every count, keeping the weight sets and bins
+    void clear();
+
+    int weightSets() const { return setCount; }
+    CheckWeights weights(int set) const;
+    long long getCleanEpochs() const { return cleanEpochs; }
+    long long getSpoofedEpochs() const { return spoofedEpochs; }
+    long long getCleanRuns() const { return cleanRuns; }
+    long long getSpoofedRuns() const { return spoofedRuns; }
+    size_t memoryBytes() const;
+
+    // Per epoch, at level j (alarm when the confidence exceeds level(j))
+    double falseAlarmRate(int set, int j) const;
+    double detectionRate(int set, int j) const;
+    long long falseAlarms(int set, int j) const;
+    long long detections(int set, int j) const;
+
+    // Area under the ROC curve over the level grid (ties count half)
+    double auc(int set) const;
+
+    // Lowest level whose false-alarm rate is at most `rate`. LEVELS (1.0,
+    // which never alarms) if no level below it meets the rate.
+    int levelForFalseAlarmRate(int set, double rate) const;
+
+    // Per spoofed run, at level j: the fraction detected at all, and the
+    // q-quantile of the latency of those detected (s, the upper edge of its
+    // bin; -1 if none is)
+    double runDetectionRate(int set, int j) const;
+    double latencyQuantile(int set, int j, double q) const;
+};
+
+// Runs `runs` randomized scenarios (randomScenario) on `threads` workers
+// (0 = all cores) and adds every epoch to `eval`, judged with each
+// scenario's detector thresholds
+void evaluateMonteCarlo(long long runs, uint64_t baseSeed, int threads, DetectorEvaluation& eval);
@@ -0,0 +1,53 @@
+#include "Fft.h"
+#include <cmath>
+#include <utility>
+
+Fft::Fft(int n) : n(n), log2n(0) {
+    while ((1 << log2n) < n) log2n++;
+    bitrev.resize(n);
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < log2n; b++) r |= ((i >> b) & 1) << (log2n - 1 - b);
+        bitrev[i] = r;
+    }
+    twRe.resize(n > 1 ? n - 1 : 1);
+    twIm.resize(n > 1 ? n - 1 : 1);
+    for (int h = 1; h < n; h *= 2)
+        for (int k = 0; k < h; k++) {
+            double a = -M_PI * k / h;
+            twRe[h - 1 + k] = (float)std::cos(a);
+            twIm[h - 1 + k] = (float)std::sin(a);
+        }
+}
+
+void Fft::forward(float* re, float* im) const {
+    for (int i = 0; i < n; i++) {
+        int j = bitrev[i];
+        if (j > i) { std::swap(re[i], re[j]); std::swap(im[i], im[j]); }
+    }
+
+    // Length-2 stage: twiddle is 1
+    for (int i = 0; i + 1 < n; i += 2) {
+        float ar = re[i], ai = im[i], br = re[i + 1], bi = im[i + 1];
+        re[i] = ar + br; im[i] = ai + bi;
+        re[i + 1] = ar - br; im[i + 1] = ai - bi;
+    }
+
+    for (int h = 2; h < n; h *= 2) {
+        const float* __restrict wr = &twRe[h - 1];
+        const float* __restrict wi = &twIm[h - 1];
+        for (int start = 0; start < n; start += 2 * h) {
+            float* __restrict ar = re + start;
+            float* __restrict ai = im + start;
+            float* __restrict br = re + start + h;
+            float* __restrict bi = im + start + h;
+            #pragma omp simd
+            for (int k = 0; k < h; k++) {
+                float tr = br[k] * wr[k] - bi[k] * wi[k];
+                float ti = br[k] * wi[k] + bi[k] * wr[k];
+                br[k] = ar[k] - tr; bi[k] = ai[k] - ti;
+                ar[k] = ar[k] + tr; ai[k] = ai[k] + ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+
+// In-place radix-2 complex FFT of one power-of-two size on split real /
+// imaginary float arrays. The bit-reversal permutation and the twiddles of
+// every stage are precomputed, each stage's twiddles contiguous so the
+// butterfly loop vectorizes; transforms never allocate.
+class Fft {
+private:
+    int n, log2n;
+    std::vector<int>   bitrev;
+    std::vector<float> twRe, twIm;      // stage with half-size h starts at offset h - 1
+
+public:
+    explicit Fft(int n);    // n must be a power of two
+
+    int size() const { return n; }
+
+    // X[k] = sum x[j] e^(-2 pi i jk/n)
+    void forward(float* re, float* im) const;
+    // Unscaled inverse: x[j] = sum X[k] e^(+2 pi i jk/n)
+    void inverse(float* re, float* im) const { forward(im, re); }
+};
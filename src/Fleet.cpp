@@ -0,0 +1,163 @@
+#include "Fleet.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Scenario.h"
+#include "Geodesy.h"
+#include "ThreadPool.h"
+#include "Instrument.h"
+#include "SignalPath.h"
+
+void FleetStats::merge(const FleetStats& o) {
+    receiverEpochs += o.receiverEpochs;
+    solved         += o.solved;
+    spoofedEpochs  += o.spoofedEpochs;
+    truePositives  += o.truePositives;
+    falseAlarms    += o.falseAlarms;
+    maxCleanError   = std::max(maxCleanError, o.maxCleanError);
+}
+
+Fleet::Fleet(Constellation& satellites, const FleetConfig& config)
+    : satellites(satellites), config(config)
+{
+    const int n = config.receivers;
+    startX.resize(n); startY.resize(n); startZ.resize(n);
+    velX.resize(n); velY.resize(n); velZ.resize(n);
+    clockBias.resize(n);
+    spoofed.resize(n);
+    estX.assign(n, 0.0); estY.assign(n, 0.0); estZ.assign(n, 0.0);
+    detected.assign(n, 0);
+    spoofers.reserve(n);
+    noise.reserve(n);
+    detectors.resize(n);
+    if (config.errorModels != ERROR_NONE) sites.resize(n);
+
+    for (int r = 0; r < n; r++) {
+        Rng rng(deriveSeed(config.seed, (uint64_t)r));
+        double lat = rng.uniform(43.55, 43.77), lon = rng.uniform(-79.75, -79.28);
+        auto p = lla_to_ecef(lat, lon, rng.uniform(80, 300));
+        startX[r] = p[0]; startY[r] = p[1]; startZ[r] = p[2];
+
+        // Level flight: velocity along a random heading in the local horizontal
+        double la = lat * M_PI / 180, lo = lon * M_PI / 180;
+        double heading = rng.uniform(0, 2 * M_PI), speed = rng.uniform(8, 40);
+        double ve = speed * sin(heading), vn = speed * cos(heading);
+        velX[r] = -sin(lo) * ve - sin(la) * cos(lo) * vn;
+        velY[r] =  cos(lo) * ve - sin(la) * sin(lo) * vn;
+        velZ[r] =  cos(la) * vn;
+
+        clockBias[r] = rng.uniform(-1000, 1000);
+        spoofed[r] = rng.uniform() < config.spoofedFraction;
+        auto fake = lla_to_ecef(lat + rng.uniform(-0.15, 0.15), lon + rng.uniform(-0.15, 0.15), 200);
+        spoofers.emplace_back(fake[0], fake[1], fake[2], spoofed[r] ? rng.uniform(0.2, 1.0) : 0.0);
+        noise.emplace_back(rng.next());
+        detectors[r].reserve(satellites.size());
+        detectors[r].raim().setRangeSigma(std::max(1.0, config.rangeNoise));
+    }
+
+    solvers.resize((n + LANES - 1) / LANES);
+    for (auto& s : solvers) s.reserve(satellites.size());
+    int chunks = (groups() + GROUPS_PER_CHUNK - 1) / GROUPS_PER_CHUNK;
+    partial.resize(chunks);
+}
+
+void Fleet::runChunk(int chunk, int worker) {
+    Scratch& s = scratch[worker];
+    FleetStats st;
+    const double elapsed = epoch * config.epochInterval;
+    RangeErrors errors;
+    if (config.errorModels != ERROR_NONE) {
+        errors.model = &defaultMeasurementErrors();
+        errors.components = config.errorModels;
+        errors.scratch = s.errors.data();
+    }
+
+    int gEnd = std::min(groups(), (chunk + 1) * GROUPS_PER_CHUNK);
+    for (int g = chunk * GROUPS_PER_CHUNK; g < gEnd; g++) {
+        EpochView views[LANES];
+        double trueX[LANES], trueY[LANES], trueZ[LANES];
+        bool   attack[LANES];
+
+        // ===== Measurements: visibility, ranges, noise, spoofing =====
+        for (int l = 0; l < LANES; l++) {
+            int r = g * LANES + l;
+            EpochBuffer& buf = s.lanes[l];
+            buf.clear();
+            attack[l] = false;
+            if (r >= config.receivers) { views[l] = buf.view(); continue; }
+
+            double rx = startX[r] + velX[r] * elapsed;
+            double ry = startY[r] + velY[r] * elapsed;
+            double rz = startZ[r] + velZ[r] * elapsed;
+            trueX[l] = rx; trueY[l] = ry; trueZ[l] = rz;
+            visibility.visible(rx, ry, rz, s.visible);
+            if (errors.components != ERROR_NONE) errors.site = &sites[r];
+            formPseudoranges(satellites, s.visible, epochTime, rx, ry, rz, clockBias[r],
+                             config.rangeNoise, noise[r], errors, buf);
+            GNSS_COUNT(COUNTER_EPOCHS, 1);
+            GNSS_COUNT(COUNTER_VISIBLE, buf.size());
+            attack[l] = spoofed[r] && elapsed >= config.spoofStart;
+            if (attack[l] && buf.size() >= 4)
+                spoofers[r].spoofPseudoranges(buf.view(), clockBias[r], buf.ranges());
+            views[l] = buf.view();
+        }
+
+        // ===== One solve for the whole group, then per-receiver detection =====
+        PositionFix fix[LANES];
+        solvers[g].solve(views, fix);
+        for (int l = 0; l < LANES; l++) {
+            int r = g * LANES + l;
+            if (r >= config.receivers) break;
+            st.receiverEpochs++;
+            if (attack[l]) st.spoofedEpochs++;
+            if (!fix[l].valid) { detected[r] = 0; continue; }
+            st.solved++;
+            estX[r] = fix[l].x; estY[r] = fix[l].y; estZ[r] = fix[l].z;
+            DetectionResult d = detectors[r].analyze(fix[l].x, fix[l].y, fix[l].z, fix[l].clockBias,
+                                                     config.epochInterval, views[l]);
+            detected[r] = d.spoofingDetected;
+            if (d.spoofingDetected) (attack[l] ? st.truePositives : st.falseAlarms)++;
+            if (!attack[l]) {
+                double ex = fix[l].x - trueX[l], ey = fix[l].y - trueY[l], ez = fix[l].z - trueZ[l];
+                st.maxCleanError = std::max(st.maxCleanError, sqrt(ex*ex + ey*ey + ez*ez));
+            }
+        }
+    }
+    partial[chunk].stats = st;
+}
+
+FleetStats Fleet::step(ThreadPool& pool) {
+    // Scratch is per worker: size it for this pool (only reallocates if the
+    // pool grows)
+    if ((int)scratch.size() < pool.size()) {
+        scratch.resize(pool.size());
+        for (auto& s : scratch) {
+            for (auto& b : s.lanes) b.reserve(satellites.size());
+            s.visible.reserve(satellites.size());
+            s.errors.resize(VisibleSet::padded(satellites.size()));
+        }
+    }
+
+    epochTime = 3600.0 * (double)(config.seed % 24) + epoch * config.epochInterval;
+    satellites.update(epochTime);               // once for the whole fleet
+    visibility.update(satellites);
+
+    // Captures only `this`, so the std::function stays in its inline buffer
+    pool.parallelFor((int)partial.size(), [this](int chunk, int worker) {
+        runChunk(chunk, worker);
+    });
+    epoch++;
+
+    FleetStats total;
+    for (auto& p : partial) total.merge(p.stats);
+    return total;
+}
+
+FleetStats runFleet(const FleetConfig& config, int threads) {
+    Constellation satellites = buildGpsConstellation();
+    Fleet fleet(satellites, config);
+    ThreadPool pool(threads);
+    FleetStats total;
+    for (int e = 0; e < config.epochs; e++) total.merge(fleet.step(pool));
+    return total;
+}
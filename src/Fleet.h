@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Constellation.h"
+#include "Spoofer.h"
+#include "Detector.h"
+#include "Solver.h"
+#include "EpochBuffer.h"
+#include "Random.h"
+#include "Visibility.h"
+#include "MeasurementErrors.h"
+
+class ThreadPool;
+
+// Parameters of a fleet run: `receivers` drones flying straight lines at
+// random headings over the GTA, a fraction of them spoofed from `spoofStart`
+struct FleetConfig {
+    int      receivers       = 10000;
+    int      epochs          = 60;
+    double   epochInterval   = 1.0;     // s
+    double   spoofedFraction = 0.25;
+    double   spoofStart      = 30.0;    // s after the first epoch
+    double   rangeNoise      = 2.0;     // m, 1-sigma
+    uint32_t errorModels     = ERROR_NONE;  // ErrorComponent mask (defaultMeasurementErrors)
+    uint64_t seed            = 1;
+};
+
+// Per-epoch or whole-run totals. merge() is applied in chunk order so the
+// result does not depend on the thread count.
+struct FleetStats {
+    long long receiverEpochs = 0;
+    long long solved         = 0;
+    long long spoofedEpochs  = 0;
+    long long truePositives  = 0;
+    long long falseAlarms    = 0;
+    double    maxCleanError  = 0.0;     // m, largest error of an unspoofed fix
+
+    void merge(const FleetStats& other);
+};
+
+// Many receivers in one sky. Each epoch the constellation is propagated and
+// binned into sky cells once and then only read; per-receiver state
+// (trajectory, clock, spoofer, noise stream, detector and, with error
+// models, the receiver's ReceiverSite) is kept in parallel arrays indexed
+// by receiver. Ranges are formed by formPseudoranges(), as in EpochPipeline.
+// Receivers are processed in groups of LANES that share one
+// BatchPositionSolver, and groups are dealt to the thread pool in chunks.
+// Nothing is allocated per epoch once the first epoch has run.
+class Fleet {
+public:
+    static const int LANES = 8;
+    static const int GROUPS_PER_CHUNK = 8;      // 64 receivers per task
+
+private:
+    Constellation& satellites;
+    FleetConfig    config;
+    int            epoch = 0;
+    double         epochTime = 0.0;     // s, of the epoch being run
+
+    // Receiver state, [receiver]
+    std::vector<double>   startX, startY, startZ;
+    std::vector<double>   velX, velY, velZ;
+    std::vector<double>   clockBias;
+    std::vector<uint8_t>  spoofed;
+    std::vector<Spoofer>  spoofers;
+    std::vector<Rng>      noise;
+    std::vector<Detector> detectors;
+    std::vector<ReceiverSite> sites;    // only with config.errorModels
+
+    // Latest fix, [receiver]
+    std::vector<double>   estX, estY, estZ;
+    std::vector<uint8_t>  detected;
+
+    std::vector<BatchPositionSolver<LANES>> solvers;   // [group]
+    VisibilityEngine visibility;                       // sky cells rebuilt per epoch
+
+    // Per-worker measurement scratch and per-chunk statistics
+    struct Scratch { EpochBuffer lanes[LANES]; VisibleSet visible; std::vector<double> errors; };
+    struct alignas(64) Slot { FleetStats stats; };
+    std::vector<Scratch> scratch;
+    std::vector<Slot>    partial;
+
+    void runChunk(int chunk, int worker);
+
+public:
+    Fleet(Constellation& satellites, const FleetConfig& config);
+
+    int size() const { return config.receivers; }
+    int groups() const { return (int)solvers.size(); }
+
+    // Satellites below this elevation are not tracked (default 5 degrees)
+    void setElevationMask(double deg) { visibility.setMask(deg); }
+
+    // Advances every receiver by one epoch on `pool`; returns that epoch's totals
+    FleetStats step(ThreadPool& pool);
+
+    double getEstX(int r) const { return estX[r]; }
+    double getEstY(int r) const { return estY[r]; }
+    double getEstZ(int r) const { return estZ[r]; }
+    bool   isDetected(int r) const { return detected[r] != 0; }
+};
+
+// Runs `config.epochs` epochs of a fresh fleet over the scenario
+// constellation on `threads` workers (0 = all cores)
+FleetStats runFleet(const FleetConfig& config, int threads);
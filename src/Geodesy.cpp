@@ -0,0 +1,137 @@
+#include "Geodesy.h"
+#include <cmath>
+
+std::array<double,3> lla_to_ecef(double lat_deg,double lon_deg,double alt_m){
+    const double a=6378137.0, e2=0.00669437999014;
+    double lat=lat_deg*M_PI/180, lon=lon_deg*M_PI/180;
+    double N=a/sqrt(1-e2*sin(lat)*sin(lat));
+    return {(N+alt_m)*cos(lat)*cos(lon),(N+alt_m)*cos(lat)*sin(lon),(N*(1-e2)+alt_m)*sin(lat)};
+}
+
+std::array<double,3> ecef_to_lla(double x,double y,double z){
+    const double a=6378137.0, e2=0.00669437999014;
+    const double b=a*sqrt(1-e2), ep2=e2/(1-e2);
+    double p=sqrt(x*x+y*y);
+    double lon=atan2(y,x);
+    // Bowring's estimate (sub-millimetre near the surface), then fixed-point
+    // refinement, which only iterates for points far above the ellipsoid
+    double beta=atan2(z*a,p*b);
+    double sb=sin(beta), cb=cos(beta);
+    double lat=atan2(z+ep2*b*sb*sb*sb,p-e2*a*cb*cb*cb);
+    for(int i=0;i<8;i++){
+        double s=sin(lat), N=a/sqrt(1-e2*s*s);
+        double next=atan2(z+e2*N*s,p);
+        bool done=fabs(next-lat)<1e-13;
+        lat=next;
+        if(done) break;
+    }
+    // Height along the normal; valid at the poles as well
+    double s=sin(lat), c=cos(lat);
+    double alt=p*c+z*s-a*sqrt(1-e2*s*s);
+    return {lat*180/M_PI,lon*180/M_PI,alt};
+}
+
+// ===== Batch kernels =====
+
+namespace {
+const double WGS_A=6378137.0, WGS_E2=0.00669437999014;
+const double TO_DEG=180/M_PI, TO_RAD=M_PI/180;
+
+// sin and cos on [-pi/4, pi/4], and atan on |t| <= 7/16: fdlibm's kernel
+// polynomials, within 1 ulp
+inline double sinKernel(double r){
+    const double z=r*r;
+    return r+r*z*(-1.66666666666666324348e-01+z*(8.33333333332248946124e-03+z*(-1.98412698298579493134e-04
+           +z*(2.75573137070700676789e-06+z*(-2.50507602534068634195e-08+z*1.58969099521155010221e-10)))));
+}
+
+inline double cosKernel(double r){
+    const double z=r*r;
+    return 1-0.5*z+z*z*(4.16666666666666019037e-02+z*(-1.38888888888741095749e-03+z*(2.48015872894767294178e-05
+           +z*(-2.75573143513906633035e-07+z*(2.08757232129817482790e-09+z*-1.13596475577881948265e-11)))));
+}
+
+inline double atanKernel(double t){
+    const double z=t*t, w=z*z;
+    const double odd=z*(3.33333333333329318027e-01+w*(1.42857142725034663711e-01+w*(9.09088713343650656196e-02
+                      +w*(6.66107313738753120669e-02+w*(4.97687799461593236017e-02+w*1.62858201153657823623e-02)))));
+    const double even=w*(-1.99999999998764832476e-01+w*(-1.11111104054623557880e-01+w*(-7.69187620504482999495e-02
+                       +w*(-5.83357013379057348645e-02+w*-3.65315727442169155270e-02))));
+    return t-t*(odd+even);
+}
+
+// cos and sin of an angle in degrees. The quadrant is reduced in degrees,
+// where deg - 90 q is exact, so no extended-precision pi is needed.
+inline void cosSinDeg(double deg,double& c,double& s){
+    const double v=deg*(1.0/90)+0.5;
+    long long q=(long long)v;
+    q-=(double)q>v?1:0;                 // floor, for negative angles
+    const double r=(deg-90.0*(double)q)*TO_RAD;
+    const double sr=sinKernel(r), cr=cosKernel(r);
+    const double s0=(q&1)?cr:sr, c0=(q&1)?sr:cr;
+    s=(q&2)?-s0:s0;
+    c=((q+1)&2)?-c0:c0;
+}
+
+// atan2 in degrees: the ratio is reduced to [0, 1], then below tan(pi/8)
+// by atan(a) = pi/4 + atan((a - 1) / (a + 1))
+inline double atan2Deg(double y,double x){
+    const double ax=std::fabs(x), ay=std::fabs(y);
+    const bool steep=ay>ax;
+    const double hi=steep?ay:ax, lo=steep?ax:ay;
+    const double a=lo/(hi>0?hi:1.0);
+    const bool upper=a>0.41421356237309503;
+    double r=(upper?M_PI/4:0.0)+atanKernel(upper?(a-1)/(a+1):a);
+    r=steep?M_PI/2-r:r;
+    r=x<0?M_PI-r:r;
+    return std::copysign(r*TO_DEG,y);
+}
+} // namespace
+
+void lla_to_ecef(const double* lat_deg,const double* lon_deg,const double* alt_m,int n,
+                 double* x,double* y,double* z){
+    #pragma omp simd
+    for(int i=0;i<n;i++){
+        double cl,sl,co,so;
+        cosSinDeg(lat_deg[i],cl,sl);
+        cosSinDeg(lon_deg[i],co,so);
+        const double N=WGS_A/std::sqrt(1-WGS_E2*sl*sl), h=alt_m[i];
+        x[i]=(N+h)*cl*co; y[i]=(N+h)*cl*so; z[i]=(N*(1-WGS_E2)+h)*sl;
+    }
+}
+
+void ecef_to_lla(const double* x,const double* y,const double* z,int n,
+                 double* lat_deg,double* lon_deg,double* alt_m){
+    const double a=WGS_A, e2=WGS_E2;
+    const double b=a*std::sqrt(1-e2), ep2=e2/(1-e2);
+    #pragma omp simd
+    for(int i=0;i<n;i++){
+        const double p=std::sqrt(x[i]*x[i]+y[i]*y[i]), zi=z[i];
+        // Bowring: parametric latitude beta from tan(beta) = z a / (p b),
+        // its sine and cosine by normalizing rather than by trig
+        const double u=zi*a, v=p*b, ib=1/std::sqrt(u*u+v*v);
+        const double sb=u*ib, cb=v*ib;
+        double num=zi+ep2*b*sb*sb*sb, den=p-e2*a*cb*cb*cb;
+        double il=1/std::sqrt(num*num+den*den);
+        // One fixed-point step tan(lat) = (z + e2 N sin(lat)) / p
+        const double s0=num*il, N=a/std::sqrt(1-e2*s0*s0);
+        num=zi+e2*N*s0; den=p;
+        il=1/std::sqrt(num*num+den*den);
+        const double s=num*il, c=den*il;
+        lat_deg[i]=atan2Deg(num,den);
+        lon_deg[i]=atan2Deg(y[i],x[i]);
+        alt_m[i]=p*c+zi*s-a*std::sqrt(1-e2*s*s);
+    }
+}
+
+LocalFrame localFrame(double lat_deg,double lon_deg,double alt_m){
+    LocalFrame f;
+    auto o=lla_to_ecef(lat_deg,lon_deg,alt_m);
+    double lat=lat_deg*M_PI/180, lon=lon_deg*M_PI/180;
+    double sl=sin(lat), cl=cos(lat), so=sin(lon), co=cos(lon);
+    f.origin[0]=o[0]; f.origin[1]=o[1]; f.origin[2]=o[2];
+    f.east[0]=-so;     f.east[1]=co;      f.east[2]=0;
+    f.north[0]=-sl*co; f.north[1]=-sl*so; f.north[2]=cl;
+    f.up[0]=cl*co;     f.up[1]=cl*so;     f.up[2]=sl;
+    return f;
+}
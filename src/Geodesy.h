@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+
+// WGS-84 geodetic (degrees, metres) to ECEF (metres)
+std::array<double,3> lla_to_ecef(double lat_deg, double lon_deg, double alt_m);
+
+// ECEF (metres) to WGS-84 geodetic {lat deg, lon deg, alt m}
+std::array<double,3> ecef_to_lla(double x, double y, double z);
+
+// Batch forms over n points in separate arrays, for fleets and trajectory
+// blocks. Both are branch-free and vectorize across points. The
+// trigonometry is polynomial and the quadrant is picked by selects, so no
+// libm call blocks the loop. lla_to_ecef agrees with the single-point form
+// to 1e-7 m.
+//
+// ecef_to_lla is closed form, with no iteration. It takes Bowring's
+// latitude estimate, then applies one fixed-point correction. The result
+// is within 4 nm at the surface and 0.1 mm out to geostationary height.
+// The Earth's centre has no geodetic position and gives NaN.
+void lla_to_ecef(const double* lat_deg, const double* lon_deg, const double* alt_m, int n,
+                 double* x, double* y, double* z);
+void ecef_to_lla(const double* x, const double* y, const double* z, int n,
+                 double* lat_deg, double* lon_deg, double* alt_m);
+
+// East-north-up frame at a geodetic point. A point's local offsets take
+// one rotation, with no trigonometry per point. Horizontal distances from
+// the origin are then a few multiply-adds. Over a few km, Earth curvature
+// changes them by millimetres.
+struct LocalFrame {
+    double origin[3];                   // ECEF
+    double east[3], north[3], up[3];    // unit axes, ECEF
+
+    void enu(double x, double y, double z, double& e, double& n, double& u) const {
+        const double dx = x - origin[0], dy = y - origin[1], dz = z - origin[2];
+        e = east[0] * dx + east[1] * dy;
+        n = north[0] * dx + north[1] * dy + north[2] * dz;
+        u = up[0] * dx + up[1] * dy + up[2] * dz;
+    }
+
+    // Squared distance from the origin on the local horizontal plane
+    double horizontalDistanceSq(double x, double y, double z) const {
+        const double dx = x - origin[0], dy = y - origin[1], dz = z - origin[2];
+        const double e = east[0] * dx + east[1] * dy;
+        const double n = north[0] * dx + north[1] * dy + north[2] * dz;
+        return e * e + n * n;
+    }
+};
+
+LocalFrame localFrame(double lat_deg, double lon_deg, double alt_m);
@@ -0,0 +1,98 @@
+#include "GnssSystems.h"
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+
+static const char* NAMES[SYSTEM_COUNT]   = {"GPS", "Galileo", "GLONASS", "BeiDou"};
+static const char  LETTERS[SYSTEM_COUNT] = {'G', 'E', 'R', 'C'};
+
+const char* systemName(int system) {
+    return system >= 0 && system < SYSTEM_COUNT ? NAMES[system] : "?";
+}
+
+char systemLetter(int system) {
+    return system >= 0 && system < SYSTEM_COUNT ? LETTERS[system] : '?';
+}
+
+static std::string upper(std::string s) {
+    for (auto& c : s) c = (char)std::toupper((unsigned char)c);
+    return s;
+}
+
+int systemFromName(const std::string& name) {
+    std::string n = upper(name);
+    for (int k = 0; k < SYSTEM_COUNT; k++) {
+        if (n == upper(NAMES[k])) return k;
+        if (n.size() == 1 && n[0] == LETTERS[k]) return k;
+    }
+    if (n == "BDS") return SYSTEM_BEIDOU;
+    return -1;
+}
+
+bool loadConstellations(const std::string& path,
+                        std::vector<WalkerShell>& out,
+                        std::string* error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::istringstream fields(line);
+        std::string name, walker;
+        double radiusKm, inclDeg, raanDeg, offsetNs;
+        WalkerShell s;
+        char slash1 = 0, slash2 = 0;
+        bool ok = bool(fields >> name >> walker >> radiusKm >> inclDeg >> raanDeg
+                              >> s.firstPrn >> offsetNs);
+        if (ok) {
+            std::istringstream tpf(walker);
+            ok = bool(tpf >> s.total >> slash1 >> s.planes >> slash2 >> s.phasing)
+                 && slash1 == '/' && slash2 == '/';
+        }
+        s.system = systemFromName(name);
+        if (!ok || s.system < 0 || s.planes <= 0 || s.total <= 0 || s.total % s.planes != 0
+            || radiusKm <= 0) {
+            if (error) *error = path + ":" + std::to_string(lineNo) + ": bad constellation line";
+            return false;
+        }
+        s.radius      = radiusKm * 1000.0;
+        s.inclination = inclDeg * M_PI / 180.0;
+        s.raan0       = raanDeg * M_PI / 180.0;
+        s.timeOffset  = offsetNs * 1e-9;
+        out.push_back(s);
+    }
+    return true;
+}
+
+void addWalkerShell(Constellation& c, const WalkerShell& shell) {
+    const int perPlane = shell.total / shell.planes;
+    const double slot  = 2 * M_PI / perPlane;
+    const double shift = 2 * M_PI * shell.phasing / shell.total;
+    const double node  = 2 * M_PI / shell.planes;
+    int prn = shell.firstPrn;
+    for (int p = 0; p < shell.planes; p++) {
+        double raan = shell.raan0 + p * node;
+        for (int s = 0; s < perPlane; s++)
+            c.add(shell.radius, s * slot + p * shift, shell.inclination, raan, shell.system, prn++);
+    }
+}
+
+Constellation buildConstellation(const std::vector<WalkerShell>& shells) {
+    Constellation c;
+    int n = 0;
+    for (const WalkerShell& s : shells) n += s.total;
+    c.reserve(n);
+    for (const WalkerShell& s : shells) addWalkerShell(c, s);
+    return c;
+}
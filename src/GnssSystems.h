@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Constellation.h"
+
+// Satellite systems. Stored per satellite (Constellation::getSystem,
+// EpochView::systems); the solver gives each its own receiver clock.
+enum GnssSystem : uint8_t {
+    SYSTEM_GPS,
+    SYSTEM_GALILEO,
+    SYSTEM_GLONASS,
+    SYSTEM_BEIDOU,
+    SYSTEM_COUNT
+};
+
+const char* systemName(int system);
+
+// RINEX system letter (G, E, R, C)
+char systemLetter(int system);
+
+// GnssSystem for a name ("GPS", "Galileo", ...) or RINEX letter; -1 if unknown
+int systemFromName(const std::string& name);
+
+// One Walker-delta shell t/p/f: t satellites in p equally spaced planes,
+// with neighbouring planes' satellites offset by f * 360/t degrees in
+// argument of latitude
+struct WalkerShell {
+    int    system;
+    int    total, planes, phasing;  // t/p/f
+    double radius;                  // m
+    double inclination;             // rad
+    double raan0;                   // rad, first plane's node
+    int    firstPrn;
+    double timeOffset;              // s, system time minus GPS time
+};
+
+// Reads Walker shells from a text file, one per line:
+//
+//   <system> <t>/<p>/<f> <radius km> <incl deg> <raan0 deg> <first prn> <time offset ns>
+//
+// '#' starts a comment. Returns false and sets `error` if the file cannot
+// be opened or a line does not parse.
+bool loadConstellations(const std::string& path,
+                        std::vector<WalkerShell>& out,
+                        std::string* error = nullptr);
+
+// Appends the shell's satellites, plane by plane, numbered from firstPrn
+void addWalkerShell(Constellation& c, const WalkerShell& shell);
+
+// All shells in one constellation
+Constellation buildConstellation(const std::vector<WalkerShell>& shells);
@@ -0,0 +1,187 @@
+#include "Instrument.h"
+
+#ifdef GNSS_INSTRUMENT
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+
+static const char* STAGE_NAMES[STAGE_COUNT] = {
+    "propagation", "sky_grid", "visibility", "ranges", "spoofing", "solve", "filter", "detection", "tracking",
+};
+static const char* COUNTER_NAMES[COUNTER_COUNT] = {
+    "epochs", "visible_satellites", "fixes", "solver_iterations", "detections",
+};
+
+void InstrumentData::merge(const InstrumentData& o) {
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        calls[s] += o.calls[s];
+        ticks[s] += o.ticks[s];
+        if (o.maxTicks[s] > maxTicks[s]) maxTicks[s] = o.maxTicks[s];
+        for (int b = 0; b < BUCKETS; b++) histogram[s][b] += o.histogram[s][b];
+    }
+    for (int c = 0; c < COUNTER_COUNT; c++) counters[c] += o.counters[c];
+    for (int i = 0; i <= MAX_ITERATIONS; i++) iterations[i] += o.iterations[i];
+}
+
+// One per thread, linked into the registry while the thread lives and
+// folded into the retired totals when it exits
+struct ThreadBlock {
+    InstrumentData data;
+    ThreadBlock*   next = nullptr;
+
+    ThreadBlock();
+    ~ThreadBlock();
+};
+
+struct Registry {
+    std::mutex     lock;
+    ThreadBlock*   live = nullptr;
+    InstrumentData retired;
+    int            threads = 0;
+    uint64_t       startTicks;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+static void reportAtExit() {
+    instrumentReport();
+    if (const char* path = std::getenv("GNSS_INSTRUMENT_JSON"))
+        if (!instrumentWriteJson(path))
+            std::fprintf(stderr, "instrument: cannot write %s\n", path);
+}
+
+// Created on first use and never destroyed, so thread blocks that exit
+// during static destruction still have somewhere to merge into
+static Registry& registry() {
+    static Registry* r = [] {
+        Registry* reg = new Registry();
+        std::memset(&reg->retired, 0, sizeof(reg->retired));
+        reg->startTicks = instrumentTicks();
+        reg->startTime  = std::chrono::steady_clock::now();
+        std::atexit(reportAtExit);
+        return reg;
+    }();
+    return *r;
+}
+
+ThreadBlock::ThreadBlock() {
+    std::memset(&data, 0, sizeof(data));
+    Registry& r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    next = r.live;
+    r.live = this;
+    r.threads++;
+}
+
+ThreadBlock::~ThreadBlock() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    r.retired.merge(data);
+    for (ThreadBlock** p = &r.live; *p; p = &(*p)->next)
+        if (*p == this) { *p = next; break; }
+}
+
+InstrumentData& instrumentLocal() {
+    static thread_local ThreadBlock block;
+    return block.data;
+}
+
+// Totals over every thread so far, and the tick rate to convert them
+static void snapshot(InstrumentData& total, double& ticksPerNs, int& threads) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> g(r.lock);
+    total = r.retired;
+    for (ThreadBlock* b = r.live; b; b = b->next) total.merge(b->data);
+    threads = r.threads;
+#if defined(__x86_64__) || defined(__i386__)
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - r.startTime).count();
+    ticksPerNs = ns > 1e6 ? (double)(instrumentTicks() - r.startTicks) / ns : 1.0;
+#else
+    ticksPerNs = 1.0;
+#endif
+}
+
+// Upper edge (ns) of the histogram bucket holding fraction q of the calls,
+// capped at the slowest call seen
+static double percentileNs(const InstrumentData& d, int stage, double q, double ticksPerNs) {
+    uint64_t target = (uint64_t)std::ceil(q * d.calls[stage]), seen = 0;
+    for (int b = 0; b < InstrumentData::BUCKETS; b++) {
+        seen += d.histogram[stage][b];
+        if (seen >= target && seen > 0)
+            return std::min(std::ldexp(1.0, b), (double)d.maxTicks[stage]) / ticksPerNs;
+    }
+    return 0.0;
+}
+
+void instrumentReport() {
+    InstrumentData d;
+    double tpn;
+    int threads;
+    snapshot(d, tpn, threads);
+
+    std::fprintf(stderr, "\ngnss instrumentation (%.3f ticks/ns, %d thread%s)\n",
+                 tpn, threads, threads == 1 ? "" : "s");
+    std::fprintf(stderr, "  %-12s %12s %12s %10s %10s %10s %12s\n",
+                 "stage", "calls", "total ms", "mean ns", "p50 ns <=", "p99 ns <=", "max ns");
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        if (!d.calls[s]) continue;
+        std::fprintf(stderr, "  %-12s %12llu %12.3f %10.1f %10.0f %10.0f %12.0f\n",
+                     STAGE_NAMES[s], (unsigned long long)d.calls[s], d.ticks[s] / tpn * 1e-6,
+                     d.ticks[s] / tpn / d.calls[s], percentileNs(d, s, 0.5, tpn),
+                     percentileNs(d, s, 0.99, tpn), d.maxTicks[s] / tpn);
+    }
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        std::fprintf(stderr, "  %-20s %12llu\n", COUNTER_NAMES[c], (unsigned long long)d.counters[c]);
+    if (d.counters[COUNTER_FIXES]) {
+        std::fprintf(stderr, "  solver iterations per fix (mean %.2f):",
+                     (double)d.counters[COUNTER_SOLVER_ITERATIONS] / d.counters[COUNTER_FIXES]);
+        for (int i = 0; i <= InstrumentData::MAX_ITERATIONS; i++)
+            if (d.iterations[i])
+                std::fprintf(stderr, " %d%s:%llu", i, i == InstrumentData::MAX_ITERATIONS ? "+" : "",
+                             (unsigned long long)d.iterations[i]);
+        std::fprintf(stderr, "\n");
+    }
+}
+
+bool instrumentWriteJson(const char* path) {
+    InstrumentData d;
+    double tpn;
+    int threads;
+    snapshot(d, tpn, threads);
+
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"ticks_per_ns\": %.6f,\n  \"threads\": %d,\n  \"stages\": {\n", tpn, threads);
+    bool first = true;
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        if (!d.calls[s]) continue;
+        std::fprintf(f, "%s    \"%s\": {\"calls\": %llu, \"total_ns\": %.0f, \"max_ns\": %.0f, "
+                        "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"histogram_le_ns\": [",
+                     first ? "" : ",\n", STAGE_NAMES[s], (unsigned long long)d.calls[s],
+                     d.ticks[s] / tpn, d.maxTicks[s] / tpn,
+                     percentileNs(d, s, 0.5, tpn), percentileNs(d, s, 0.99, tpn));
+        bool firstBucket = true;
+        for (int b = 0; b < InstrumentData::BUCKETS; b++) {
+            if (!d.histogram[s][b]) continue;
+            std::fprintf(f, "%s[%.0f, %llu]", firstBucket ? "" : ", ",
+                         std::ldexp(1.0, b) / tpn, (unsigned long long)d.histogram[s][b]);
+            firstBucket = false;
+        }
+        std::fprintf(f, "]}");
+        first = false;
+    }
+    std::fprintf(f, "\n  },\n  \"counters\": {");
+    for (int c = 0; c < COUNTER_COUNT; c++)
+        std::fprintf(f, "%s\"%s\": %llu", c ? ", " : "", COUNTER_NAMES[c], (unsigned long long)d.counters[c]);
+    std::fprintf(f, "},\n  \"solver_iterations\": [");
+    for (int i = 0; i <= InstrumentData::MAX_ITERATIONS; i++)
+        std::fprintf(f, "%s%llu", i ? ", " : "", (unsigned long long)d.iterations[i]);
+    std::fprintf(f, "]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+#endif
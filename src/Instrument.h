@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+
+// Per-stage instrumentation: scoped stage timers, counters and latency
+// histograms, switched at compile time (cmake -DGNSS_INSTRUMENT=ON).
+//
+// Hot paths mark themselves with the macros below. Without GNSS_INSTRUMENT
+// every macro expands to nothing, so the markers cost nothing and can stay
+// in production builds. With it, each thread records into its own
+// thread-local block (no atomics, no locks); blocks are merged when a
+// thread exits and when the report is printed. The report goes to stderr
+// at process exit, and also as JSON to $GNSS_INSTRUMENT_JSON if set.
+//
+// Timers read the TSC on x86 and steady_clock elsewhere; ticks are
+// converted to ns when the report is built.
+
+// Stages timed by GNSS_STAGE
+enum InstrumentStage {
+    STAGE_PROPAGATION,      // Constellation::update
+    STAGE_SKY_GRID,         // VisibilityEngine::update (fleet sky cells)
+    STAGE_VISIBILITY,       // one receiver's visible-satellite selection
+    STAGE_RANGES,           // pseudorange formation and noise
+    STAGE_SPOOFING,         // Spoofer::spoofPseudoranges
+    STAGE_SOLVE,            // least-squares position fix (one call, any lane count)
+    STAGE_FILTER,           // NavFilter::update (EKF measurement update)
+    STAGE_DETECTION,        // Detector::analyze
+    STAGE_TRACKING,         // TrackingBank::process (correlators and loops)
+    STAGE_COUNT
+};
+
+// Event counters bumped by GNSS_COUNT
+enum InstrumentCounter {
+    COUNTER_EPOCHS,             // receiver-epochs measured
+    COUNTER_VISIBLE,            // visible satellites, summed over epochs
+    COUNTER_FIXES,              // position fixes attempted
+    COUNTER_SOLVER_ITERATIONS,  // Gauss-Newton iterations over all fixes
+    COUNTER_DETECTIONS,         // epochs the detector flagged
+    COUNTER_COUNT
+};
+
+#ifdef GNSS_INSTRUMENT
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Everything one thread has recorded. Histograms have one bucket per
+// power of two of the duration in ticks.
+struct InstrumentData {
+    static const int BUCKETS = 48;
+    static const int MAX_ITERATIONS = 32;   // last iteration bucket is "32 or more"
+
+    uint64_t calls[STAGE_COUNT];
+    uint64_t ticks[STAGE_COUNT];
+    uint64_t maxTicks[STAGE_COUNT];
+    uint64_t histogram[STAGE_COUNT][BUCKETS];
+    uint64_t counters[COUNTER_COUNT];
+    uint64_t iterations[MAX_ITERATIONS + 1];   // fixes by solver iteration count
+
+    void merge(const InstrumentData& other);
+};
+
+// This thread's block (registered with the report on first use)
+InstrumentData& instrumentLocal();
+
+inline uint64_t instrumentTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline void instrumentRecord(InstrumentStage stage, uint64_t ticks) {
+    InstrumentData& d = instrumentLocal();
+    d.calls[stage]++;
+    d.ticks[stage] += ticks;
+    if (ticks > d.maxTicks[stage]) d.maxTicks[stage] = ticks;
+    int bucket = 64 - __builtin_clzll(ticks | 1);
+    d.histogram[stage][bucket < InstrumentData::BUCKETS ? bucket : InstrumentData::BUCKETS - 1]++;
+}
+
+inline void instrumentCount(InstrumentCounter counter, uint64_t n) {
+    instrumentLocal().counters[counter] += n;
+}
+
+inline void instrumentSolverIterations(int iterations) {
+    InstrumentData& d = instrumentLocal();
+    d.counters[COUNTER_FIXES]++;
+    d.counters[COUNTER_SOLVER_ITERATIONS] += iterations;
+    d.iterations[iterations < InstrumentData::MAX_ITERATIONS ? iterations : InstrumentData::MAX_ITERATIONS]++;
+}
+
+// Times the enclosing scope as one call of `stage`
+class InstrumentScope {
+private:
+    InstrumentStage stage;
+    uint64_t start;
+
+public:
+    explicit InstrumentScope(InstrumentStage stage) : stage(stage), start(instrumentTicks()) {}
+    ~InstrumentScope() { instrumentRecord(stage, instrumentTicks() - start); }
+
+    InstrumentScope(const InstrumentScope&) = delete;
+    InstrumentScope& operator=(const InstrumentScope&) = delete;
+};
+
+// Text report of every thread's totals so far. Call while workers are idle.
+void instrumentReport();
+// Same data as JSON; returns false if the file cannot be written
+bool instrumentWriteJson(const char* path);
+
+#define GNSS_INSTRUMENT_CAT2(a, b) a##b
+#define GNSS_INSTRUMENT_CAT(a, b) GNSS_INSTRUMENT_CAT2(a, b)
+#define GNSS_STAGE(stage) InstrumentScope GNSS_INSTRUMENT_CAT(gnssStage_, __LINE__)(stage)
+#define GNSS_COUNT(counter, n) instrumentCount(counter, (uint64_t)(n))
+#define GNSS_SOLVER_ITERATIONS(n) instrumentSolverIterations(n)
+
+#else
+
+#define GNSS_STAGE(stage) ((void)0)
+#define GNSS_COUNT(counter, n) ((void)0)
+#define GNSS_SOLVER_ITERATIONS(n) ((void)0)
+
+#endif
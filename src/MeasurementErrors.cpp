@@ -0,0 +1,344 @@
+#include "MeasurementErrors.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Geodesy.h"
+#include "Random.h"
+#include "Visibility.h"
+
+namespace {
+const double C = 299792458.0;
+const double CLOCK_UPLOAD = 7200.0;     // s between broadcast clock uploads
+
+// Niell coefficients at latitudes 15, 30, 45, 60, 75 degrees
+const double NIELL_LAT[5] = {15, 30, 45, 60, 75};
+const double DRY_AVG[3][5] = {
+    {1.2769934e-3, 1.2683230e-3, 1.2465397e-3, 1.2196049e-3, 1.2045996e-3},
+    {2.9153695e-3, 2.9152299e-3, 2.9288445e-3, 2.9022565e-3, 2.9024912e-3},
+    {62.610505e-3, 62.837393e-3, 63.721774e-3, 63.824265e-3, 64.258455e-3}};
+const double DRY_AMP[3][5] = {
+    {0.0, 1.2709626e-5, 2.6523662e-5, 3.4000452e-5, 4.1202191e-5},
+    {0.0, 2.1414979e-5, 3.0160779e-5, 7.2562722e-5, 11.723375e-5},
+    {0.0, 9.0128400e-5, 4.3497037e-5, 84.795348e-5, 170.37206e-5}};
+const double WET[3][5] = {
+    {5.8021897e-4, 5.6794847e-4, 5.8118019e-4, 5.9727542e-4, 6.1641693e-4},
+    {1.4275268e-3, 1.5138625e-3, 1.4572752e-3, 1.5007428e-3, 1.7599082e-3},
+    {4.3472961e-2, 4.6729510e-2, 4.3908931e-2, 4.4626982e-2, 5.4736038e-2}};
+const double HEIGHT[3] = {2.53e-5, 5.49e-3, 1.14e-3};
+
+// Marini continued fraction normalized to 1 at zenith
+inline double marini(double sinE, double a, double b, double c) {
+    return (1.0 + a / (1.0 + b / (1.0 + c))) / (sinE + a / (sinE + b / (sinE + c)));
+}
+
+// Coefficient row k of a Niell table at |latitude| (deg), linear between nodes
+inline double niellAt(const double table[3][5], int k, double absLat) {
+    if (absLat <= NIELL_LAT[0]) return table[k][0];
+    if (absLat >= NIELL_LAT[4]) return table[k][4];
+    int i = (int)(absLat / 15.0) - 1;
+    double f = (absLat - NIELL_LAT[i]) / 15.0;
+    return table[k][i] + f * (table[k][i + 1] - table[k][i]);
+}
+
+// Klobuchar amplitude (s) and period (s) at geomagnetic latitude phiM
+// (semicircles)
+inline double klobucharAmplitude(const KlobucharCoefficients& k, double phiM) {
+    const double* a = k.alpha;
+    return std::max(0.0, a[0] + phiM * (a[1] + phiM * (a[2] + phiM * a[3])));
+}
+
+inline double klobucharPeriod(const KlobucharCoefficients& k, double phiM) {
+    const double* b = k.beta;
+    return std::max(72000.0, b[0] + phiM * (b[1] + phiM * (b[2] + phiM * b[3])));
+}
+
+// Klobuchar vertical delay (s) at local time t (s)
+inline double klobucharVertical(double amplitude, double period, double t) {
+    double x = 2 * M_PI * (t - 50400.0) / period;
+    double x2 = x * x;
+    return 5e-9 + (std::fabs(x) < 1.57 ? amplitude * (1.0 - 0.5 * x2 + x2 * x2 / 24.0) : 0.0);
+}
+
+// Clamps without a comparison. GCC does not if-convert floating-point
+// compares under the default -ftrapping-math, and a branch keeps the
+// satellite loops scalar; these cost a rounding of ~1 ulp.
+inline double maxOf(double a, double b) { return 0.5 * (a + b + std::fabs(a - b)); }
+inline double minOf(double a, double b) { return 0.5 * (a + b - std::fabs(a - b)); }
+
+// floor() for |x| < 2^63 that vectorizes without -fno-trapping-math
+inline double floorOf(double x) {
+    double t = (double)(long long)x;
+    return t - (t > x ? 1.0 : 0.0);
+}
+
+// t modulo period, in [0, period); the period is a constant at every use,
+// so the division folds into a multiplication
+inline double wrap(double t, double period) {
+    return t - period * floorOf(t * (1.0 / period));
+}
+
+// cos and sin of a small angle d (rad), by series: within 3e-5 for |d| < 1
+inline void cosSinSmall(double d, double& c, double& s) {
+    const double d2 = d * d;
+    c = 1.0 - d2 * (1.0 / 2 - d2 * (1.0 / 24 - d2 * (1.0 / 720)));
+    s = d * (1.0 - d2 * (1.0 / 6 - d2 * (1.0 / 120 - d2 * (1.0 / 5040))));
+}
+
+// cos(2 pi v), by a series over the half period: within 2e-5
+inline double cosCycles(double v) {
+    const double x = M_PI * (v - floorOf(v) - 0.5), x2 = x * x;
+    const double sn = x * (1.0 - x2 * (1.0 / 6 - x2 * (1.0 / 120 - x2 * (1.0 / 5040 - x2 * (1.0 / 362880)))));
+    return 2.0 * sn * sn - 1.0;
+}
+} // namespace
+
+// GPS broadcast values (2004-01-01), a moderate-activity ionosphere
+const KlobucharCoefficients MeasurementErrors::DEFAULT_KLOBUCHAR = {
+    {0.1118e-07, -0.7451e-08, -0.5961e-07, 0.1192e-06},
+    {0.1167e+06, -0.2294e+06, -0.1311e+06, 0.1049e+07}};
+
+// ===== Analytic models =====
+
+double klobucharDelay(const KlobucharCoefficients& k, double lat, double lon,
+                      double elevation, double azimuth, double timeOfDay) {
+    double E = elevation / M_PI;
+    double psi = 0.0137 / (E + 0.11) - 0.022;
+    double phiI = std::max(-0.416, std::min(0.416, lat / M_PI + psi * cos(azimuth)));
+    double lamI = lon / M_PI + psi * sin(azimuth) / cos(phiI * M_PI);
+    double phiM = phiI + 0.064 * cos((lamI - 1.617) * M_PI);
+    double t = wrap(43200.0 * lamI + timeOfDay, 86400.0);
+    double F = 1.0 + 16.0 * std::pow(0.53 - E, 3);
+    return C * F * klobucharVertical(klobucharAmplitude(k, phiM), klobucharPeriod(k, phiM), t);
+}
+
+void saastamoinenZenith(double lat, double heightM, double& dry, double& wet) {
+    // Standard atmosphere, 70 % relative humidity
+    double h = std::max(0.0, std::min(10000.0, heightM));
+    double P = 1013.25 * std::pow(1.0 - 2.2557e-5 * h, 5.2568);
+    double T = 15.0 - 6.5e-3 * h + 273.16;
+    double e = 6.108 * 0.7 * std::exp((17.15 * T - 4684.0) / (T - 38.45));
+    dry = 0.0022768 * P / (1.0 - 0.00266 * cos(2 * lat) - 0.00028 * h / 1000.0);
+    wet = 0.002277 * (1255.0 / T + 0.05) * e;
+}
+
+void niellMapping(double lat, double heightM, int dayOfYear, double elevation,
+                  double& dry, double& wet) {
+    double absLat = std::fabs(lat) * 180 / M_PI;
+    // Seasonal term peaks on day 28 in the north, half a year later in the south
+    double season = cos(2 * M_PI * (dayOfYear - 28.0) / 365.25 + (lat < 0 ? M_PI : 0.0));
+    double c[3];
+    for (int k = 0; k < 3; k++) c[k] = niellAt(DRY_AVG, k, absLat) - niellAt(DRY_AMP, k, absLat) * season;
+    double sinE = sin(elevation);
+    dry = marini(sinE, c[0], c[1], c[2])
+        + (1.0 / sinE - marini(sinE, HEIGHT[0], HEIGHT[1], HEIGHT[2])) * heightM / 1000.0;
+    wet = marini(sinE, niellAt(WET, 0, absLat), niellAt(WET, 1, absLat), niellAt(WET, 2, absLat));
+}
+
+// ===== Tables =====
+
+MeasurementErrors::MeasurementErrors(int dayOfYear, const KlobucharCoefficients& coefficients,
+                                     double multipathMetres, uint64_t seed)
+    : klobuchar(coefficients), dayOfYear(dayOfYear), multipathScale(multipathMetres)
+{
+    const int NE = ELEVATION_STEPS + 1;
+    obliquity.resize(NE); earthAngle.resize(NE);
+    heightMapping.resize(NE); multipathAmplitude.resize(NE);
+    niell.resize((size_t)(LATITUDE_ROWS + 1) * NE * 2);
+    for (int j = 0; j < NE; j++) {
+        double sinE = (double)j / ELEVATION_STEPS;
+        double elev = asin(sinE);
+        double E = elev / M_PI;
+        obliquity[j]  = 1.0 + 16.0 * std::pow(0.53 - E, 3);
+        earthAngle[j] = 0.0137 / (E + 0.11) - 0.022;
+        heightMapping[j] = 1.0 - sinE * marini(sinE, HEIGHT[0], HEIGHT[1], HEIGHT[2]);
+        multipathAmplitude[j] = multipathScale * std::exp(-(elev * 180 / M_PI) / 15.0);
+        // Rows at sea level; the height correction is added per site
+        for (int r = 0; r <= LATITUDE_ROWS; r++) {
+            double lat = (-90.0 + 180.0 * r / LATITUDE_ROWS) * M_PI / 180;
+            double dry = 1.0, wet = 1.0;
+            if (j > 0) niellMapping(lat, 0.0, dayOfYear, elev, dry, wet);
+            double* cell = &niell[((size_t)r * NE + j) * 2];
+            cell[0] = j > 0 ? sinE * dry : 1.0;
+            cell[1] = j > 0 ? sinE * wet : 1.0;
+        }
+    }
+
+
+    Rng rng(seed);
+    clockOffset.resize(CLOCK_SLOTS); clockDrift.resize(CLOCK_SLOTS); clockPhase.resize(CLOCK_SLOTS);
+    multipathRate.resize(CLOCK_SLOTS); multipathPhase.resize(CLOCK_SLOTS);
+    for (int i = 0; i < CLOCK_SLOTS; i++) {
+        clockOffset[i]    = 0.5 * rng.gaussian();           // m
+        clockDrift[i]     = 2e-5 * rng.gaussian();          // m/s
+        clockPhase[i]     = rng.uniform(0, CLOCK_UPLOAD);
+        multipathRate[i]  = 1.0 / rng.uniform(120, 600);    // reflector geometry period
+        multipathPhase[i] = rng.uniform();
+    }
+}
+
+size_t MeasurementErrors::tableBytes() const {
+    return sizeof(double) * (obliquity.size() + earthAngle.size() + heightMapping.size()
+                             + multipathAmplitude.size() + niell.size()
+                             + clockOffset.size() + clockDrift.size() + clockPhase.size()
+                             + multipathRate.size() + multipathPhase.size());
+}
+
+void MeasurementErrors::locate(ReceiverSite& site, double x, double y, double z) const {
+    if (site.valid) {
+        double dx = x - site.x, dy = y - site.y, dz = z - site.z;
+        if (dx*dx + dy*dy + dz*dz < SITE_RADIUS * SITE_RADIUS) return;
+    }
+    auto lla = ecef_to_lla(x, y, z);
+    site.valid = true;
+    site.x = x; site.y = y; site.z = z;
+    std::fill(site.ionoSat.begin(), site.ionoSat.end(), -1);
+    site.lat = lla[0] / 180.0;
+    site.lon = lla[1] / 180.0;
+    site.heightKm = lla[2] / 1000.0;
+    saastamoinenZenith(lla[0] * M_PI / 180, lla[2], site.zenithDry, site.zenithWet);
+    // Pierce points lie within 0.07 semicircles of the site (after the
+    // latitude clamp), so their trig is the site's plus a short series
+    double anchor = std::max(-0.416, std::min(0.416, site.lat));
+    site.cosLat = cos(anchor * M_PI);
+    site.sinLat = sin(anchor * M_PI);
+    site.cosPole = cos((site.lon - 1.617) * M_PI);
+    site.sinPole = sin((site.lon - 1.617) * M_PI);
+
+    // The troposphere is then one table: the latitude rows blended, the
+    // height term added and both mappings scaled by the zenith delays
+    const int NE = ELEVATION_STEPS + 1;
+    double pos = (lla[0] + 90.0) / 180.0 * LATITUDE_ROWS;
+    int row = std::max(0, std::min(LATITUDE_ROWS - 1, (int)pos));
+    double w = std::max(0.0, std::min(1.0, pos - row));
+    const double* r0 = &niell[(size_t)row * NE * 2];
+    const double* r1 = r0 + NE * 2;
+    site.slantTropo.resize(NE);
+    for (int j = 0; j < NE; j++) {
+        double dry = r0[2 * j] + w * (r1[2 * j] - r0[2 * j]) + heightMapping[j] * site.heightKm;
+        double wet = r0[2 * j + 1] + w * (r1[2 * j + 1] - r0[2 * j + 1]);
+        site.slantTropo[j] = site.zenithDry * dry + site.zenithWet * wet;
+    }
+}
+
+// ===== Per-epoch errors =====
+
+void MeasurementErrors::compute(double time, ReceiverSite& site, const VisibleSet& visible,
+                                uint32_t components, double* errors) const {
+    const double* east  = visible.eastData();
+    const double* north = visible.northData();
+    const double* up    = visible.upData();
+    const int* ids = visible.satelliteData();
+    const double tod = wrap(time, 86400.0);
+    // Tables as locals: the vectorized loops then know they do not alias
+    const double* tropoTab = site.slantTropo.data();
+    const double* obl = obliquity.data();
+    const double* psiTab = earthAngle.data();
+    const double* mpTab = multipathAmplitude.data();
+    const double* mpRate = multipathRate.data();
+    const double* mpPhase = multipathPhase.data();
+    const double* clkOffset = clockOffset.data();
+    const double* clkDrift = clockDrift.data();
+    const double* clkPhase = clockPhase.data();
+    const double a0 = klobuchar.alpha[0], a1 = klobuchar.alpha[1], a2 = klobuchar.alpha[2], a3 = klobuchar.alpha[3];
+    const double b0 = klobuchar.beta[0], b1 = klobuchar.beta[1], b2 = klobuchar.beta[2], b3 = klobuchar.beta[3];
+    const double siteLat = site.lat, siteLon = site.lon;
+    const double anchor = minOf(0.416, maxOf(-0.416, siteLat));
+    const double cosLat = site.cosLat, sinLat = site.sinLat;
+    const double cosPole = site.cosPole, sinPole = site.sinPole;
+    // Components as weights: one pass adds them all, without a branch per lane
+    const double wIono  = (components & ERROR_IONOSPHERE) ? 1.0 : 0.0;
+    const double wTropo = (components & ERROR_TROPOSPHERE) ? 1.0 : 0.0;
+    const double wMp    = (components & ERROR_MULTIPATH) ? 1.0 : 0.0;
+    const double wClock = (components & ERROR_SATELLITE_CLOCK) ? 1.0 : 0.0;
+
+    const int CHUNK = VisibleSet::PADDING;
+    // Held delays cover the set's whole storage, so they grow only when it does
+    const int blocks = visible.capacity() / CHUNK;
+    if ((int)site.ionoTime.size() < blocks) {
+        site.ionoSat.resize((size_t)blocks * CHUNK, -1);
+        site.ionoDelay.resize((size_t)blocks * CHUNK, 0.0);
+        site.ionoTime.resize(blocks, 0.0);
+    }
+
+    // Satellites in chunks of one vector: geometry for the chunk, the
+    // ionosphere when its held delays are due, then the sum. Every pass
+    // runs the full fixed width with no scalar remainder: a short last
+    // chunk reads the visible set's padding, and its results land in the
+    // padding of `errors`.
+    for (int base = 0; base < visible.size(); base += CHUNK) {
+        const int n = std::min(CHUNK, visible.size() - base);
+        double invSinE[CHUNK], frac[CHUNK], cosA[CHUNK], sinA[CHUNK];
+        int idx[CHUNK], slot[CHUNK];
+        #pragma omp simd
+        for (int i = 0; i < CHUNK; i++) {
+            const double e = east[base + i], nn = north[base + i], u = up[base + i];
+            slot[i] = (int)((unsigned)ids[base + i] % CLOCK_SLOTS);
+            // One division for the three reciprocals: 1/r, 1/h and 1/sin E
+            // are each q times the other two factors. At the zenith e = n = 0
+            // and the azimuth terms vanish; the 1e-30 keeps that (and zeroed
+            // padding) finite.
+            const double h2 = e * e + nn * nn + 1e-30;
+            const double r = std::sqrt(h2 + u * u), h = std::sqrt(h2);
+            const double height = maxOf(0.05 * r, u);      // r sin E
+            const double q = 1.0 / (r * h * height);
+            const double sinE = height * (q * h * height);
+            const double pos = sinE * ELEVATION_STEPS;
+            const int j = std::min((int)pos, ELEVATION_STEPS - 1);
+            idx[i] = j;
+            frac[i] = pos - j;
+            invSinE[i] = q * r * r * h;
+            const double hinv = q * r * height;
+            cosA[i] = nn * hinv;
+            sinA[i] = e * hinv;
+        }
+
+        // Held delays are re-evaluated IONO_HOLD seconds after the last
+        // time, or as soon as a satellite of the chunk is not the one they
+        // were evaluated for
+        int* heldSat = site.ionoSat.data() + base;
+        double* held = site.ionoDelay.data() + base;
+        bool due = false;
+        if (components & ERROR_IONOSPHERE) {
+            due = !(std::fabs(time - site.ionoTime[base / CHUNK]) < IONO_HOLD);
+            for (int i = 0; i < n; i++) due |= heldSat[i] != ids[base + i];
+        }
+        if (due) {
+            site.ionoTime[base / CHUNK] = time;
+            #pragma omp simd
+            for (int i = 0; i < CHUNK; i++) {
+                const int j = idx[i];
+                const double f = frac[i];
+                const double F = obl[j] + f * (obl[j + 1] - obl[j]);
+                const double psi = psiTab[j] + f * (psiTab[j + 1] - psiTab[j]);
+                const double phiI = minOf(0.416, maxOf(-0.416, siteLat + psi * cosA[i]));
+                double c, sn;
+                cosSinSmall((phiI - anchor) * M_PI, c, sn);
+                const double dLam = psi * sinA[i] / (cosLat * c - sinLat * sn);
+                const double lamI = siteLon + dLam;
+                cosSinSmall(dLam * M_PI, c, sn);
+                const double phiM = phiI + 0.064 * (cosPole * c - sinPole * sn);
+                const double amp = maxOf(0.0, a0 + phiM * (a1 + phiM * (a2 + phiM * a3)));
+                const double per = maxOf(72000.0, b0 + phiM * (b1 + phiM * (b2 + phiM * b3)));
+                const double t = wrap(43200.0 * lamI + tod, 86400.0);
+                held[i] = C * F * klobucharVertical(amp, per, t);
+                heldSat[i] = ids[base + i];
+            }
+        }
+
+        #pragma omp simd
+        for (int i = 0; i < CHUNK; i++) {
+            const int j = idx[i], s = slot[i];
+            const double f = frac[i];
+            const double slant = tropoTab[j] + f * (tropoTab[j + 1] - tropoTab[j]);
+            const double mpAmp = mpTab[j] + f * (mpTab[j + 1] - mpTab[j]);
+            const double mp = mpAmp * cosCycles(time * mpRate[s] + mpPhase[s]);
+            const double clock = clkOffset[s] + clkDrift[s] * wrap(time + clkPhase[s], CLOCK_UPLOAD);
+            errors[base + i] = wIono * held[i] + wTropo * slant * invSinE[i] + wMp * mp + wClock * clock;
+        }
+    }
+}
+
+const MeasurementErrors& defaultMeasurementErrors() {
+    static const MeasurementErrors model;
+    return model;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class VisibleSet;
+
+// Error sources MeasurementErrors can add to a pseudorange (bit mask)
+enum ErrorComponent : uint32_t {
+    ERROR_NONE            = 0,
+    ERROR_IONOSPHERE      = 1u << 0,    // Klobuchar, L1
+    ERROR_TROPOSPHERE     = 1u << 1,    // Saastamoinen zenith delays, Niell mapping
+    ERROR_MULTIPATH       = 1u << 2,    // elevation-dependent, per-satellite oscillation
+    ERROR_SATELLITE_CLOCK = 1u << 3,    // broadcast clock residual
+    ERROR_ALL             = 15,
+};
+
+// Broadcast ionosphere coefficients (alpha: s/semicircle^n, beta: s/semicircle^n)
+struct KlobucharCoefficients {
+    double alpha[4];
+    double beta[4];
+};
+
+// Per-receiver terms of the models, re-derived only when the receiver has
+// moved more than MeasurementErrors::SITE_RADIUS
+struct ReceiverSite {
+    bool   valid = false;
+    double x = 0, y = 0, z = 0;     // ECEF where the terms were derived
+    double lat = 0, lon = 0;        // semicircles
+    double heightKm = 0;
+    double zenithDry = 0, zenithWet = 0;    // m
+    double cosLat = 1, sinLat = 0;  // latitude clamped to the pierce point band
+    double cosPole = 1, sinPole = 0;    // longitude from the geomagnetic pole
+    std::vector<double> slantTropo; // zenith delays x mapping (x sin E), per table step
+    // Ionospheric delays held between evaluations, per position in the
+    // visible set, and when each block of VisibleSet::PADDING was evaluated
+    std::vector<int>    ionoSat;
+    std::vector<double> ionoDelay;
+    std::vector<double> ionoTime;
+};
+
+// Analytic forms of the models, used to build the tables (and to check
+// them). Angles in radians, times in seconds of the day, delays in metres.
+double klobucharDelay(const KlobucharCoefficients& k, double lat, double lon,
+                      double elevation, double azimuth, double timeOfDay);
+void   saastamoinenZenith(double lat, double heightM, double& dry, double& wet);
+void   niellMapping(double lat, double heightM, int dayOfYear, double elevation,
+                    double& dry, double& wet);
+
+// Pseudorange errors of the signal's path and the satellite clock.
+//
+// The models are the receiver-side standards: Klobuchar ionosphere, a
+// Saastamoinen zenith delay for a standard atmosphere mapped with Niell's
+// functions, an elevation-dependent multipath oscillation and a residual
+// broadcast clock error per satellite (an offset plus a drift since the
+// last 2-hour upload). Their trigonometric and continued-fraction parts
+// are evaluated once, at construction, into tables interpolated linearly:
+//
+//   sin(elevation)                 Klobuchar obliquity and Earth angle,
+//                                  Niell height correction, multipath amplitude
+//   latitude x sin(elevation)      Niell dry and wet mapping (x sin E), 5 deg rows,
+//                                  blended per site with its zenith delays
+//
+// The Klobuchar amplitude and period are cubics in geomagnetic latitude and
+// the vertical delay a quartic in local time, all evaluated directly: an
+// interpolated period moves epochs across the step to the night-time floor,
+// and a table over time of day would smear it. Pierce points lie close to
+// the receiver, so their trig is the site's plus a short series, as is the
+// multipath phase's cosine.
+//
+// The ionosphere is the costliest part and the slowest to change (a few
+// mm/s), so each site holds its delays per satellite and re-evaluates them
+// every IONO_HOLD seconds, or as soon as the visible set changes: held
+// delays are within about a centimetre, and the night-time step lands up
+// to IONO_HOLD late.
+//
+// Everything that depends only on the receiver's position (zenith delays,
+// the blended troposphere table, the site's trig) is derived in locate();
+// a satellite then costs two square roots, a division and a few table
+// reads, and two more divisions when its ionosphere is re-evaluated. The line of sight comes from the VisibleSet in the receiver's
+// east/north/up frame, so elevation and azimuth need no trig either. Table
+// interpolation stays within about a centimetre of the analytic models.
+//
+// Tables are built once and read-only afterwards; one instance can serve
+// any number of threads.
+class MeasurementErrors {
+public:
+    static const int ELEVATION_STEPS = 256;     // over sin(elevation) in [0, 1]
+    static const int LATITUDE_ROWS   = 36;      // Niell, -90 .. 90 deg
+    static const int CLOCK_SLOTS     = 256;     // satellite ids, modulo
+    static constexpr double SITE_RADIUS = 1000.0;   // m
+    static constexpr double IONO_HOLD   = 5.0;      // s
+
+private:
+    KlobucharCoefficients klobuchar;
+    int dayOfYear;
+    double multipathScale;
+
+    std::vector<double> obliquity, earthAngle;      // [ELEVATION_STEPS + 1]
+    std::vector<double> heightMapping, multipathAmplitude;
+    std::vector<double> niell;                      // [(row * (ELEVATION_STEPS + 1) + j) * 2 + dry/wet]
+    std::vector<double> clockOffset, clockDrift, clockPhase;    // [CLOCK_SLOTS]
+    std::vector<double> multipathRate, multipathPhase;          // cycles/s, cycles
+
+public:
+    static const KlobucharCoefficients DEFAULT_KLOBUCHAR;
+
+    // `seed` draws the satellites' clock and multipath parameters;
+    // `multipathMetres` is the amplitude at the horizon
+    explicit MeasurementErrors(int dayOfYear = 180,
+                               const KlobucharCoefficients& coefficients = DEFAULT_KLOBUCHAR,
+                               double multipathMetres = 1.5, uint64_t seed = 1);
+
+    // Re-derives `site` for a receiver at (x, y, z) (ECEF) unless it is
+    // within SITE_RADIUS of where it was last derived
+    void locate(ReceiverSite& site, double x, double y, double z) const;
+
+    // Errors (m) of the pseudoranges to every satellite of `visible` at
+    // `time` (s; seconds of the day taken modulo 86400), in its order.
+    // `errors` holds VisibleSet::padded(visible.size()); the entries past
+    // visible.size() are overwritten. Updates the ionospheric
+    // delays `site` holds
+    void compute(double time, ReceiverSite& site, const VisibleSet& visible,
+                 uint32_t components, double* errors) const;
+
+    size_t tableBytes() const;
+};
+
+// Shared instance with the default parameters (built on first use)
+const MeasurementErrors& defaultMeasurementErrors();
@@ -0,0 +1,161 @@
+#include "MonteCarlo.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Scenario.h"
+#include "Geodesy.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "Evaluation.h"
+
+// Runs per reduction chunk. Fixed (not derived from the thread count) so
+// the summation order — and therefore every floating-point total — is the
+// same however many workers execute the chunks.
+const int RUNS_PER_CHUNK = 32;
+
+void MonteCarloStats::add(const RunResult& r) {
+    runs++;
+    epochs        += r.epochs;
+    spoofedEpochs += r.spoofedEpochs;
+    truePositives += r.truePositives;
+    falseAlarms   += r.falseAlarms;
+    if (r.spoofedEpochs > 0) spoofedRuns++;
+    if (r.detectionDelay >= 0) { detectedRuns++; sumDetectionDelay += r.detectionDelay; }
+    if (r.enteredNoFly) noFlyRuns++;
+    maxPositionError = std::max(maxPositionError, r.maxPositionError);
+}
+
+void MonteCarloStats::merge(const MonteCarloStats& o) {
+    runs          += o.runs;
+    spoofedRuns   += o.spoofedRuns;
+    detectedRuns  += o.detectedRuns;
+    epochs        += o.epochs;
+    spoofedEpochs += o.spoofedEpochs;
+    truePositives += o.truePositives;
+    falseAlarms   += o.falseAlarms;
+    noFlyRuns     += o.noFlyRuns;
+    sumDetectionDelay += o.sumDetectionDelay;
+    maxPositionError = std::max(maxPositionError, o.maxPositionError);
+}
+
+ScenarioConfig randomScenario(uint64_t baseSeed, long long index) {
+    ScenarioConfig c;
+    c.seed = deriveSeed(baseSeed, (uint64_t)index);
+    Rng rng(c.seed);
+
+    // Route: 2-5 waypoints wandering around the GTA at drone altitude
+    int nWp = 2 + (int)(rng.uniform() * 4);
+    double lat = rng.uniform(43.60, 43.72), lon = rng.uniform(-79.70, -79.33);
+    double alt = rng.uniform(80, 300);
+    for (int i = 0; i < nWp; i++) {
+        c.route.push_back({lat, lon, alt});
+        lat = std::max(43.55, std::min(43.77, lat + rng.uniform(-0.03, 0.03)));
+        lon = std::max(-79.75, std::min(-79.28, lon + rng.uniform(-0.05, 0.05)));
+    }
+    c.speed         = rng.uniform(8, 40);
+    c.epochInterval = 1.0;
+    c.rangeNoise    = rng.uniform(0.5, 5.0);
+
+    // Spoofer: a quarter of the runs are clean to measure false alarms
+    bool spoofed   = rng.uniform() >= 0.25;
+    c.fakeLat      = c.route[0][0] + rng.uniform(-0.15, 0.15);
+    c.fakeLon      = c.route[0][1] + rng.uniform(-0.15, 0.15);
+    c.fakeAlt      = c.route[0][2];
+    c.spooferPower = spoofed ? rng.uniform(0.2, 1.0) : 0.0;
+    c.spoofStart   = rng.uniform(30, 300);
+    return c;
+}
+
+std::vector<std::array<double,3>> scenarioTrack(const ScenarioConfig& c) {
+    // Route as an ECEF polyline with cumulative arc length
+    std::vector<std::array<double,3>> pts;
+    std::vector<double> arc(1, 0.0);
+    for (auto& w : c.route) pts.push_back(lla_to_ecef(w[0], w[1], w[2]));
+    for (size_t i = 1; i < pts.size(); i++) {
+        double dx = pts[i][0]-pts[i-1][0], dy = pts[i][1]-pts[i-1][1], dz = pts[i][2]-pts[i-1][2];
+        arc.push_back(arc.back() + sqrt(dx*dx + dy*dy + dz*dz));
+    }
+    double duration = arc.back() / c.speed;
+    int epochs = std::min(3600, (int)(duration / c.epochInterval) + 1);
+
+    std::vector<std::array<double,3>> track(epochs);
+    size_t seg = 0;
+    for (int e = 0; e < epochs; e++) {
+        double t = e * c.epochInterval;
+        double s = std::min(arc.back(), t * c.speed);
+        while (seg + 2 < arc.size() && s > arc[seg + 1]) seg++;
+        double len = arc[seg + 1] - arc[seg];
+        double f = len > 0 ? (s - arc[seg]) / len : 0.0;
+        for (int k = 0; k < 3; k++) track[e][k] = pts[seg][k] + f * (pts[seg+1][k] - pts[seg][k]);
+    }
+    return track;
+}
+
+double scenarioStartTime(const ScenarioConfig& c) {
+    return 3600.0 * (double)(c.seed % 24);
+}
+
+RunResult runScenario(const ScenarioConfig& c, DetectorEvaluation* evaluation) {
+    RunResult r = {0, 0, 0, 0, -1.0, 0.0, false};
+    std::vector<std::array<double,3>> track = scenarioTrack(c);
+
+    auto fake    = lla_to_ecef(c.fakeLat, c.fakeLon, c.fakeAlt);
+    const NoFlyZone noFly = pearsonNoFlyZone();
+
+    Constellation satellites = buildGpsConstellation();
+    EpochPipeline pipeline(satellites, Spoofer(fake[0], fake[1], fake[2], c.spooferPower), 0.12);
+    pipeline.setRangeNoise(c.rangeNoise, c.seed);
+    pipeline.setMeasurementErrors(&defaultMeasurementErrors(), c.errorModels);
+    pipeline.setDetectorThresholds(c.detector);
+
+    const double t0 = scenarioStartTime(c);
+    if (evaluation) evaluation->beginRun(c.spooferPower > 0 ? c.spoofStart : -1.0);
+    for (int e = 0; e < (int)track.size(); e++) {
+        double t = e * c.epochInterval;
+        double rx = track[e][0], ry = track[e][1], rz = track[e][2];
+
+        bool spoofNow = c.spooferPower > 0 && t >= c.spoofStart;
+        EpochResult out = pipeline.step(t0 + t, rx, ry, rz, c.epochInterval, spoofNow);
+        if (!out.valid) continue;
+
+        r.epochs++;
+        if (spoofNow) r.spoofedEpochs++;
+        bool det = out.detection.spoofingDetected;
+        if (det && spoofNow) {
+            r.truePositives++;
+            if (r.detectionDelay < 0) r.detectionDelay = t - c.spoofStart;
+        }
+        if (det && !spoofNow) r.falseAlarms++;
+        if (evaluation) {
+            double conf[CHECK_COUNT];
+            checkConfidences(c.detector, out.detection, conf);
+            evaluation->addEpoch(t, conf);
+        }
+
+        double ex = out.estX - rx, ey = out.estY - ry, ez = out.estZ - rz;
+        r.maxPositionError = std::max(r.maxPositionError, sqrt(ex*ex + ey*ey + ez*ez));
+        if (noFly.contains(rx, ry, rz)) r.enteredNoFly = true;
+    }
+    if (evaluation) evaluation->endRun();
+    return r;
+}
+
+MonteCarloStats runMonteCarlo(long long runs, uint64_t baseSeed, int threads) {
+    int chunks = (int)((runs + RUNS_PER_CHUNK - 1) / RUNS_PER_CHUNK);
+    // One cache-line-aligned slot per chunk: no locking, no false sharing
+    struct alignas(64) Slot { MonteCarloStats stats; };
+    std::vector<Slot> partial(chunks);
+
+    ThreadPool pool(threads);
+    pool.parallelFor(chunks, [&](int chunk, int) {
+        long long begin = (long long)chunk * RUNS_PER_CHUNK;
+        long long end   = std::min(runs, begin + RUNS_PER_CHUNK);
+        MonteCarloStats& st = partial[chunk].stats;
+        for (long long i = begin; i < end; i++)
+            st.add(runScenario(randomScenario(baseSeed, i)));
+    });
+
+    MonteCarloStats total;
+    for (auto& p : partial) total.merge(p.stats);
+    return total;
+}
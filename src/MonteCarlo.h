@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "Detector.h"
+#include "MeasurementErrors.h"
+
+// Randomized parameters of one spoofing scenario run
+struct ScenarioConfig {
+    std::vector<std::array<double,3>> route;   // waypoints, lat/lon deg + alt m
+    double   speed;            // m/s along the route
+    double   epochInterval;    // s
+    double   fakeLat, fakeLon, fakeAlt;
+    double   spooferPower;     // 0 = clean run
+    double   spoofStart;       // s after take-off
+    double   rangeNoise;       // m, 1-sigma
+    uint32_t errorModels = ERROR_ALL;  // ErrorComponent mask (defaultMeasurementErrors)
+    uint64_t seed;
+    DetectorThresholds detector;
+};
+
+// Per-run outcome
+struct RunResult {
+    int    epochs;
+    int    spoofedEpochs;
+    int    truePositives;
+    int    falseAlarms;
+    double detectionDelay;     // s from spoof onset to first detection, -1 if none
+    double maxPositionError;   // m
+    bool   enteredNoFly;
+};
+
+// Aggregate over many runs. merge() is applied in a fixed order so totals
+// do not depend on how runs were spread over threads.
+struct MonteCarloStats {
+    long long runs = 0, spoofedRuns = 0, detectedRuns = 0;
+    long long epochs = 0, spoofedEpochs = 0;
+    long long truePositives = 0, falseAlarms = 0;
+    long long noFlyRuns = 0;
+    double    sumDetectionDelay = 0.0;
+    double    maxPositionError = 0.0;
+
+    void add(const RunResult& r);
+    void merge(const MonteCarloStats& other);
+};
+
+// Draws run `index` of a batch seeded with `baseSeed`
+ScenarioConfig randomScenario(uint64_t baseSeed, long long index);
+
+// Receiver position at every epoch: the route flown at constant speed,
+// sampled every epochInterval (at most 3600 epochs)
+std::vector<std::array<double,3>> scenarioTrack(const ScenarioConfig& config);
+
+// Constellation time of the first epoch (varies the satellite geometry)
+double scenarioStartTime(const ScenarioConfig& config);
+
+class DetectorEvaluation;
+
+// Flies one randomized scenario through the epoch pipeline; with an
+// evaluation, every valid epoch's check confidences are added to it as a
+// labelled run
+RunResult runScenario(const ScenarioConfig& config, DetectorEvaluation* evaluation = nullptr);
+
+// Runs `runs` randomized scenarios on `threads` workers (0 = all cores).
+// Results are bit-identical for any thread count.
+MonteCarloStats runMonteCarlo(long long runs, uint64_t baseSeed, int threads);
@@ -0,0 +1,138 @@
+#include "NavFilter.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Instrument.h"
+#include "SignalPath.h"
+
+// (value, rate) state pairs of the constant-rate model: F adds dt * rate
+// to value. Position/velocity for N = 8, then clock bias/drift.
+template<int N> struct RatePairs;
+template<> struct RatePairs<8> {
+    static const int COUNT = 4;
+    static constexpr int value[COUNT] = {0, 1, 2, 6};
+    static constexpr int rate[COUNT]  = {3, 4, 5, 7};
+};
+template<> struct RatePairs<5> {
+    static const int COUNT = 1;
+    static constexpr int value[COUNT] = {3};
+    static constexpr int rate[COUNT]  = {4};
+};
+
+template<int N>
+void NavFilter<N>::reset() {
+    for (int i = 0; i < N; i++) {
+        x[i] = 0.0;
+        for (int j = 0; j < N; j++) P[i][j] = 0.0;
+    }
+    time = 0.0;
+    initialized = false;
+}
+
+template<int N>
+void NavFilter<N>::initialize(double t, const PositionFix& fix, double posSigma, double velSigma) {
+    reset();
+    x[0] = fix.x; x[1] = fix.y; x[2] = fix.z;
+    x[CLOCK] = fix.clockBias;
+    for (int k = 0; k < 3; k++) P[k][k] = posSigma * posSigma;
+    if (HAS_VELOCITY)
+        for (int k = 3; k < 6; k++) P[k][k] = velSigma * velSigma;
+    P[CLOCK][CLOCK] = posSigma * posSigma;
+    P[DRIFT][DRIFT] = velSigma * velSigma;
+    time = t;
+    initialized = true;
+}
+
+template<int N>
+void NavFilter<N>::predict(double t) {
+    const double dt = t - time;
+    if (!(dt > 0)) return;
+    time = t;
+    typedef RatePairs<N> R;
+
+    // x = F x, then P = (F P) F^T as row then column additions
+    for (int p = 0; p < R::COUNT; p++) x[R::value[p]] += dt * x[R::rate[p]];
+    for (int p = 0; p < R::COUNT; p++)
+        for (int j = 0; j < N; j++) P[R::value[p]][j] += dt * P[R::rate[p]][j];
+    for (int p = 0; p < R::COUNT; p++)
+        for (int i = 0; i < N; i++) P[i][R::value[p]] += dt * P[i][R::rate[p]];
+
+    // Process noise: white acceleration per axis (white velocity without
+    // velocity states) and a phase + frequency random-walk clock
+    const double dt2 = dt * dt, dt3 = dt2 * dt;
+    for (int k = 0; k < 3; k++) {
+        if (HAS_VELOCITY) {
+            P[k][k]         += accelPsd * dt3 / 3.0;
+            P[k][k + 3]     += accelPsd * dt2 / 2.0;
+            P[k + 3][k]     += accelPsd * dt2 / 2.0;
+            P[k + 3][k + 3] += accelPsd * dt;
+        } else {
+            P[k][k] += accelPsd * dt;
+        }
+    }
+    P[CLOCK][CLOCK] += clockPsd * dt + driftPsd * dt3 / 3.0;
+    P[CLOCK][DRIFT] += driftPsd * dt2 / 2.0;
+    P[DRIFT][CLOCK] += driftPsd * dt2 / 2.0;
+    P[DRIFT][DRIFT] += driftPsd * dt;
+}
+
+template<int N>
+FilterInnovations NavFilter<N>::update(const EpochView& epoch) {
+    GNSS_STAGE(STAGE_FILTER);
+    FilterInnovations out = {0, 0.0, 0.0};
+    const double x0[4] = {x[0], x[1], x[2], x[CLOCK]};
+
+    // Satellites in chunks: line-of-sight and predicted range for a whole
+    // chunk at the prior in one vectorizable pass, then the scalar updates
+    const int CHUNK = 16;
+    const double* pos = epoch.pos;
+    const double* vel = epoch.vel;
+    const uint8_t* systems = epoch.systems;
+    const unsigned own = (unsigned)clockSystem;
+    for (int base = 0; base < epoch.count; base += CHUNK) {
+        const int n = std::min(CHUNK, epoch.count - base);
+        double ux[CHUNK], uy[CHUNK], uz[CHUNK], prefit[CHUNK], use[CHUNK];
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            double sx, sy, sz;
+            signalPath(pos + 3 * (base + i), vel + 3 * (base + i), x0[0], x0[1], x0[2], sx, sy, sz);
+            double dx = x0[0] - sx, dy = x0[1] - sy, dz = x0[2] - sz;
+            double r2 = dx*dx + dy*dy + dz*dz;
+            double range = std::sqrt(r2 >= 1.0 ? r2 : 1.0);
+            use[i] = r2 >= 1.0 ? 1.0 : 0.0;
+            ux[i] = dx / range; uy[i] = dy / range; uz[i] = dz / range;
+            prefit[i] = epoch.ranges[base + i] - (range + x0[3]);
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (use[i] == 0.0 || systems[base + i] != own) continue;
+            // h = (unit line of sight, 0..., 1 at CLOCK, 0); the innovation
+            // also carries the correction made by the ranges before it
+            const double hx = ux[i], hy = uy[i], hz = uz[i];
+            const double nu = prefit[i] - (hx * (x[0] - x0[0]) + hy * (x[1] - x0[1])
+                                           + hz * (x[2] - x0[2]) + (x[CLOCK] - x0[3]));
+
+            // P is symmetric, so P h^T is a combination of four rows
+            double PHt[N];
+            for (int c = 0; c < N; c++)
+                PHt[c] = hx * P[0][c] + hy * P[1][c] + hz * P[2][c] + P[CLOCK][c];
+            const double S = hx * PHt[0] + hy * PHt[1] + hz * PHt[2] + PHt[CLOCK] + rangeVar;
+            const double invS = 1.0 / S;
+
+            for (int r = 0; r < N; r++) {
+                const double kr = PHt[r] * invS;
+                x[r] += kr * nu;
+                for (int c = 0; c < N; c++) P[r][c] -= kr * PHt[c];
+            }
+
+            const double z2 = nu * nu * invS;
+            out.count++;
+            out.nis += z2;
+            out.maxNormalized = std::fmax(out.maxNormalized, std::sqrt(z2));
+        }
+    }
+    return out;
+}
+
+template class NavFilter<5>;
+template class NavFilter<8>;
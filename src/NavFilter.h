@@ -0,0 +1,92 @@
+#pragma once
+#include "EpochBuffer.h"
+#include "Solver.h"
+
+// Innovations of one filter update, for the detector's consistency test
+struct FilterInnovations {
+    int    count;           // pseudoranges processed
+    double nis;             // sum of normalized innovation squares nu^2 / S
+    double maxNormalized;   // largest |nu| / sqrt(S)
+};
+
+// Extended Kalman filter navigation engine, with the state dimension N a
+// compile-time constant so every matrix is a fixed-size array and the
+// update loops unroll:
+//
+//   N = 8   position, velocity, clock bias, clock drift (constant velocity)
+//   N = 5   position, clock bias, clock drift (near-static receivers)
+//
+// predict() moves the state on with the constant-rate model. F is the
+// identity plus dt on each (value, rate) pair, so F P F^T is applied as
+// row and column additions instead of matrix products; white acceleration
+// and two-state clock noise are added in closed form.
+//
+// update() processes one pseudorange at a time (the range noise is
+// independent per satellite), so each is a scalar update: no matrix is
+// inverted and the gain is P h^T / S. All ranges are linearized at the
+// predicted state, in one vectorizable pass, which leaves only multiply-
+// adds and one division per range on the sequential path; the result is
+// the batch EKF update. The per-epoch innovations are summed as normalized
+// squares for the detector.
+//
+// There is one clock state, so the filter uses the ranges of one system,
+// clockSystem (GPS unless set), and skips the others: inter-system biases
+// are not states. initialize() takes the fix's clockBias, which is that
+// system's clock when the solver keeps its default system mapping.
+//
+// Units: metres, seconds; the clock states are in metres and m/s.
+template<int N>
+class NavFilter {
+    static_assert(N == 5 || N == 8, "NavFilter supports 5 or 8 states");
+
+public:
+    static const bool HAS_VELOCITY = N == 8;
+    static const int CLOCK = N - 2;
+    static const int DRIFT = N - 1;
+
+private:
+    double x[N];
+    double P[N][N];
+    double time = 0.0;
+    bool   initialized = false;
+    int    clockSystem = 0;         // GnssSystem whose ranges are used (0: GPS)
+
+    double rangeVar    = 25.0;      // m^2
+    double accelPsd    = 1.0;       // m^2/s^3 (position psd for N = 5)
+    double clockPsd    = 0.1;       // m^2/s, clock phase
+    double driftPsd    = 0.01;      // m^2/s^3, clock frequency
+
+public:
+    NavFilter() { reset(); }
+
+    void reset();
+    bool isInitialized() const { return initialized; }
+
+    void setRangeSigma(double metres) { rangeVar = metres * metres; }
+    void setProcessNoise(double accel, double clockPhase, double clockFrequency) {
+        accelPsd = accel; clockPsd = clockPhase; driftPsd = clockFrequency;
+    }
+    void setClockSystem(int system) { clockSystem = system; }
+    int  getClockSystem() const { return clockSystem; }
+
+    // Starts from a snapshot fix at time t, velocity and drift zero, with
+    // the given 1-sigma uncertainties (m, m/s)
+    void initialize(double t, const PositionFix& fix, double posSigma = 30.0, double velSigma = 20.0);
+
+    // Propagates state and covariance to time t (no-op for t <= current)
+    void predict(double t);
+
+    // Sequential scalar updates with every clockSystem pseudorange of the
+    // epoch
+    FilterInnovations update(const EpochView& epoch);
+
+    double getX() const { return x[0]; }
+    double getY() const { return x[1]; }
+    double getZ() const { return x[2]; }
+    double getVelocity(int axis) const { return HAS_VELOCITY ? x[3 + axis] : 0.0; }
+    double getClockBias() const { return x[CLOCK]; }
+    double getClockDrift() const { return x[DRIFT]; }
+    double getTime() const { return time; }
+    double state(int i) const { return x[i]; }
+    double covariance(int i, int j) const { return P[i][j]; }
+};
@@ -0,0 +1,242 @@
+#include "Playback_gl.h"
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glcorearb.h>
+#endif
+#include <cmath>
+#include <algorithm>
+
+#include "Renderer_gl.h"
+
+// ===== Layout (normalized device coordinates) =====
+static const double X0 = -0.97, X1 = 0.97;
+static const double MAP_Y0 = -0.05, MAP_Y1 = 0.97;
+static const double BAND_Y0 = -0.17, BAND_Y1 = -0.08;
+static const double STRIP_Y0 = -0.86, STRIP_Y1 = -0.20;
+static const double BAR_Y0 = -0.95, BAR_Y1 = -0.91;
+
+static const char* VS = R"(#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 colour;
+out vec4 vColour;
+void main() {
+    gl_Position = vec4(position, 0.0, 1.0);
+    vColour = colour;
+}
+)";
+
+static const char* FS = R"(#version 330 core
+in vec4 vColour;
+out vec4 fragColor;
+void main() {
+    fragColor = vColour;
+}
+)";
+
+struct Colour { float r, g, b, a; };
+
+static const Colour TRUE_TRACK = {0.9f, 0.9f, 0.9f, 0.85f};
+static const Colour NO_FLY     = {1.0f, 0.25f, 0.25f, 0.95f};
+static const Colour EST_TRACK  = {0.2f, 1.0f, 0.4f, 0.9f};
+static const Colour DETECTED   = {1.0f, 0.45f, 0.1f, 0.95f};
+static const Colour SPOOFED    = {1.0f, 0.15f, 0.15f, 0.55f};
+static const Colour ENVELOPE   = {0.2f, 0.8f, 0.4f, 0.45f};
+static const Colour ERROR_LINE = {0.3f, 1.0f, 0.5f, 0.9f};
+static const Colour CONFIDENCE = {0.3f, 0.8f, 1.0f, 0.8f};
+static const Colour FRAME      = {0.35f, 0.38f, 0.48f, 1.0f};
+static const Colour CURSOR     = {1.0f, 0.9f, 0.2f, 0.9f};
+
+static void vertex(std::vector<float>& v, double x, double y, const Colour& c) {
+    v.insert(v.end(), {(float)x, (float)y, c.r, c.g, c.b, c.a});
+}
+
+static void segment(std::vector<float>& v, double x0, double y0, double x1, double y1, const Colour& c) {
+    vertex(v, x0, y0, c);
+    vertex(v, x1, y1, c);
+}
+
+static void quad(std::vector<float>& v, double x0, double y0, double x1, double y1, const Colour& c) {
+    vertex(v, x0, y0, c); vertex(v, x1, y0, c); vertex(v, x1, y1, c);
+    vertex(v, x0, y0, c); vertex(v, x1, y1, c); vertex(v, x0, y1, c);
+}
+
+static double mid(const TraceSpan& s, int c) { return 0.5 * ((double)s.lo[c] + s.hi[c]); }
+
+bool PlaybackView::init(std::string* err) {
+    program = linkProgram(VS, FS, err);
+    if (!program) return false;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
+    glBindVertexArray(0);
+    capacity = 0;
+    ready = true;
+    return true;
+}
+
+void PlaybackView::release() {
+    if (!ready) return;
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program);
+    ready = false;
+}
+
+double PlaybackView::timeAt(double x, int width, const PlaybackWindow& view) const {
+    double ndc = 2.0 * x / std::max(1, width) - 1.0;
+    return view.start + (ndc - X0) / (X1 - X0) * (view.end - view.start);
+}
+
+bool PlaybackView::onStrip(double y, int height) const {
+    double ndc = 1.0 - 2.0 * y / std::max(1, height);
+    return ndc >= BAR_Y0 && ndc <= BAND_Y1;
+}
+
+void PlaybackView::draw(int width, int height, const PlaybackWindow& view) {
+    tris.clear();
+    lines.clear();
+    spans.clear();
+    const int runs = std::max(0, std::min(MAX_RUNS, pyramid.runCount() - firstRun));
+    const double px = 2.0 / std::max(1, width), py = 2.0 / std::max(1, height);
+    const double length = std::max(view.end - view.start, 1e-9);
+    auto tx = [&](double t) {
+        return std::max(X0, std::min(X1, X0 + (X1 - X0) * (t - view.start) / length));
+    };
+
+    // ===== Queries: one window-wide and one up to the cursor per run =====
+    const int perRun = std::max(64, 2 * width / std::max(1, runs));
+    spans.reserve((size_t)(perRun + 66) * 2 * runs);
+    size_t stripBegin[MAX_RUNS + 1], mapBegin[MAX_RUNS + 1];
+    level = 99;
+    for (int r = 0; r < runs; r++) {
+        stripBegin[r] = spans.size();
+        level = std::min(level, pyramid.query(firstRun + r, view.start, view.end, perRun, spans));
+        mapBegin[r] = spans.size();
+        pyramid.query(firstRun + r, view.start, view.cursor, perRun, spans);
+    }
+    stripBegin[runs] = mapBegin[runs] = spans.size();
+    if (runs == 0) level = 0;
+
+    // ===== Map: tracks from the window start to the cursor =====
+    const TraceSpan& all = pyramid.overall();
+    double lat0 = all.lo[CHANNEL_TRUE_LAT], lat1 = all.hi[CHANNEL_TRUE_LAT];
+    double lon0 = all.lo[CHANNEL_TRUE_LON], lon1 = all.hi[CHANNEL_TRUE_LON];
+    if (all.valid > 0) {
+        lat0 = std::min(lat0, (double)all.lo[CHANNEL_EST_LAT]); lat1 = std::max(lat1, (double)all.hi[CHANNEL_EST_LAT]);
+        lon0 = std::min(lon0, (double)all.lo[CHANNEL_EST_LON]); lon1 = std::max(lon1, (double)all.hi[CHANNEL_EST_LON]);
+    }
+    // Equal metres per pixel on both axes, centred in the map area
+    const double shrink = std::cos(0.5 * (lat0 + lat1) * M_PI / 180);
+    const double spanX = std::max((lon1 - lon0) * shrink, 1e-6), spanY = std::max(lat1 - lat0, 1e-6);
+    const double areaW = (X1 - X0) / px, areaH = (MAP_Y1 - MAP_Y0) / py;
+    const double scale = 0.95 * std::min(areaW / spanX, areaH / spanY);
+    auto mapX = [&](double lon) { return 0.5 * (X0 + X1) + (lon - 0.5 * (lon0 + lon1)) * shrink * scale * px; };
+    auto mapY = [&](double lat) { return 0.5 * (MAP_Y0 + MAP_Y1) + (lat - 0.5 * (lat0 + lat1)) * scale * py; };
+
+    for (int r = 0; r < runs; r++) {
+        bool haveEst = false;
+        double tX = 0, tY = 0, eX = 0, eY = 0;
+        const Colour* estColour = &EST_TRACK;
+        for (size_t i = mapBegin[r]; i < stripBegin[r + 1]; i++) {
+            const TraceSpan& s = spans[i];
+            double x = mapX(mid(s, CHANNEL_TRUE_LON)), y = mapY(mid(s, CHANNEL_TRUE_LAT));
+            if (i > mapBegin[r]) segment(lines, tX, tY, x, y, s.hi[CHANNEL_NO_FLY] > 0 ? NO_FLY : TRUE_TRACK);
+            tX = x; tY = y;
+            if (s.valid == 0) { haveEst = false; continue; }
+            estColour = s.hi[CHANNEL_DETECTED] > 0 ? &DETECTED : &EST_TRACK;
+            x = mapX(mid(s, CHANNEL_EST_LON)); y = mapY(mid(s, CHANNEL_EST_LAT));
+            if (haveEst) segment(lines, eX, eY, x, y, *estColour);
+            eX = x; eY = y;
+            haveEst = true;
+        }
+        if (mapBegin[r] == stripBegin[r + 1]) continue;
+        // Markers at the cursor: a cross on the truth, a box on the fix
+        const double m = 6;
+        segment(lines, tX - m * px, tY - m * py, tX + m * px, tY + m * py, CURSOR);
+        segment(lines, tX - m * px, tY + m * py, tX + m * px, tY - m * py, CURSOR);
+        if (haveEst) {
+            segment(lines, eX - m * px, eY - m * py, eX + m * px, eY - m * py, *estColour);
+            segment(lines, eX + m * px, eY - m * py, eX + m * px, eY + m * py, *estColour);
+            segment(lines, eX + m * px, eY + m * py, eX - m * px, eY + m * py, *estColour);
+            segment(lines, eX - m * px, eY + m * py, eX - m * px, eY - m * py, *estColour);
+            segment(lines, tX, tY, eX, eY, *estColour);
+        }
+    }
+
+    // ===== Strip chart: error envelope and confidence over the window =====
+    double errMax = 1.0;
+    for (int r = 0; r < runs; r++)
+        for (size_t i = stripBegin[r]; i < mapBegin[r]; i++)
+            if (spans[i].valid > 0) errMax = std::max(errMax, (double)spans[i].hi[CHANNEL_ERROR]);
+    errMax *= 1.1;
+    auto errY  = [&](double e) { return STRIP_Y0 + (STRIP_Y1 - STRIP_Y0) * e / errMax; };
+    auto confY = [&](double c) { return STRIP_Y0 + (STRIP_Y1 - STRIP_Y0) * std::max(0.0, std::min(1.0, c)); };
+    const double rowH = (BAND_Y1 - BAND_Y0) / std::max(1, runs);
+
+    for (int r = 0; r < runs; r++) {
+        double rowTop = BAND_Y1 - r * rowH;
+        bool havePrev = false;
+        double pX = 0, pE = 0, pC = 0;
+        for (size_t i = stripBegin[r]; i < mapBegin[r]; i++) {
+            const TraceSpan& s = spans[i];
+            // A span reaches to the next one, so bands and envelopes have no gaps
+            double x0 = tx(s.t0), x1 = std::max(tx(i + 1 < mapBegin[r] ? spans[i + 1].t0 : s.t1), x0 + px);
+            if (s.hi[CHANNEL_SPOOF_ACTIVE] > 0) quad(tris, x0, rowTop - 0.5 * rowH, x1, rowTop, SPOOFED);
+            if (s.hi[CHANNEL_DETECTED] > 0)     quad(tris, x0, rowTop - rowH, x1, rowTop - 0.5 * rowH, DETECTED);
+            if (s.valid == 0) { havePrev = false; continue; }
+            quad(tris, x0, errY(s.lo[CHANNEL_ERROR]), x1, std::max(errY(s.hi[CHANNEL_ERROR]), errY(s.lo[CHANNEL_ERROR]) + py),
+                 ENVELOPE);
+            double x = tx(0.5 * (s.t0 + s.t1)), e = errY(mid(s, CHANNEL_ERROR)), c = confY(mid(s, CHANNEL_CONFIDENCE));
+            if (havePrev) {
+                segment(lines, pX, pE, x, e, ERROR_LINE);
+                segment(lines, pX, pC, x, c, CONFIDENCE);
+            }
+            pX = x; pE = e; pC = c;
+            havePrev = true;
+        }
+    }
+
+    // ===== Frame, cursor and the window's place in the trace =====
+    segment(lines, X0, STRIP_Y0, X1, STRIP_Y0, FRAME);
+    segment(lines, X0, STRIP_Y1, X1, STRIP_Y1, FRAME);
+    segment(lines, X0, STRIP_Y0, X0, STRIP_Y1, FRAME);
+    segment(lines, X1, STRIP_Y0, X1, STRIP_Y1, FRAME);
+    if (view.cursor >= view.start && view.cursor <= view.end)
+        segment(lines, tx(view.cursor), STRIP_Y0, tx(view.cursor), BAND_Y1, CURSOR);
+    quad(tris, X0, BAR_Y0, X1, BAR_Y1, {0.18f, 0.2f, 0.28f, 1});
+    if (all.records > 0) {
+        const double total = std::max(all.t1 - all.t0, 1e-9);
+        auto bx = [&](double t) { return X0 + (X1 - X0) * std::max(0.0, std::min(1.0, (t - all.t0) / total)); };
+        quad(tris, bx(view.start), BAR_Y0, std::max(bx(view.end), bx(view.start) + px), BAR_Y1, FRAME);
+        double c = bx(view.cursor);
+        segment(lines, c, BAR_Y0 - 2 * py, c, BAR_Y1 + 2 * py, CURSOR);
+    }
+
+    // ===== Upload and draw: triangles, then lines =====
+    const int nTris = (int)tris.size() / 6, nLines = (int)lines.size() / 6;
+    vertices = nTris + nLines;
+    glViewport(0, 0, width, height);
+    glClearColor(0.07f, 0.09f, 0.13f, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if ((size_t)vertices > capacity) capacity = std::max((size_t)vertices, 2 * capacity);
+    glBufferData(GL_ARRAY_BUFFER, capacity * 6 * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, tris.size() * sizeof(float), tris.data());
+    glBufferSubData(GL_ARRAY_BUFFER, tris.size() * sizeof(float), lines.size() * sizeof(float), lines.data());
+    glUseProgram(program);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, nTris);
+    glDrawArrays(GL_LINES, nTris, nLines);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "TracePyramid.h"
+
+class TraceReader;
+
+// Time window on screen and the play cursor (trace time, s)
+struct PlaybackWindow {
+    double start = 0, end = 1, cursor = 0;
+};
+
+// 2D playback of a recorded trace (OpenGL 3.3 core).
+//
+// Top: a map of each run's true track (white) and estimated track (green,
+// orange once the detector fires) from the window start up to the cursor.
+// Bottom: a strip chart over the whole window with the position error as
+// a min/max envelope, the detector confidence, and one band row per run
+// marking spoofed (red) and detected (orange) epochs. A bar under the strip
+// shows where the window sits in the trace.
+//
+// Every series is a TracePyramid query sized to the viewport width, so a
+// frame uploads and draws a bounded number of vertices however many epochs
+// the window covers. At most MAX_RUNS runs are drawn, from firstRun on.
+class PlaybackView {
+public:
+    static const int MAX_RUNS = 8;
+    int firstRun = 0;
+
+private:
+    TracePyramid pyramid;
+    unsigned program = 0, vao = 0, vbo = 0;
+    size_t capacity = 0;                        // vertices
+    std::vector<float> tris, lines;             // x, y, r, g, b, a per vertex (NDC)
+    std::vector<TraceSpan> spans;               // query results, all drawn runs
+    int vertices = 0, level = 0;
+    bool ready = false;
+
+public:
+    bool init(std::string* err = nullptr);
+    void release();
+
+    // Starts summarizing `trace`; load() continues it a slice at a time
+    void open(const TraceReader& trace) { pyramid.reset(trace); }
+    void load(uint64_t records) { pyramid.build(records); }
+    const TracePyramid& summary() const { return pyramid; }
+
+    void draw(int width, int height, const PlaybackWindow& view);
+
+    // Window time under a framebuffer x (pixels), and whether a framebuffer
+    // y (pixels, from the top) falls on the strip chart
+    double timeAt(double x, int width, const PlaybackWindow& view) const;
+    bool   onStrip(double y, int height) const;
+
+    int lastVertexCount() const { return vertices; }
+    int lastLevel() const { return level; }         // finest pyramid level drawn, -1 records
+};
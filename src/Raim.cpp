@@ -0,0 +1,199 @@
+#include "Raim.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Solver.h"
+#include "SignalPath.h"
+
+// Upper-tail standard normal quantile (Abramowitz & Stegun 26.2.23,
+// |error| < 4.5e-4), for 0 < p <= 0.5
+double upperNormalQuantile(double p) {
+    double t = std::sqrt(-2.0 * std::log(p));
+    return t - (2.515517 + 0.802853 * t + 0.010328 * t * t)
+             / (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+}
+
+// Solves the symmetric k x k system M w = b (k <= 3) by Cholesky; false if
+// M is not comfortably positive definite
+static bool solveSmall(int k, const double M[3][3], const double b[3], double w[3]) {
+    double L[3][3] = {{0}};
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j <= i; j++) {
+            double s = M[i][j];
+            for (int m = 0; m < j; m++) s -= L[i][m] * L[j][m];
+            if (i == j) {
+                if (!(s > 1e-9)) return false;
+                L[i][i] = std::sqrt(s);
+            } else {
+                L[i][j] = s / L[j][j];
+            }
+        }
+    }
+    double y[3];
+    for (int i = 0; i < k; i++) {
+        double s = b[i];
+        for (int m = 0; m < i; m++) s -= L[i][m] * y[m];
+        y[i] = s / L[i][i];
+    }
+    for (int i = k - 1; i >= 0; i--) {
+        double s = y[i];
+        for (int m = i + 1; m < k; m++) s -= L[m][i] * w[m];
+        w[i] = s / L[i][i];
+    }
+    return true;
+}
+
+Raim::Raim() {
+    setFalseAlarmRate(falseAlarm);
+}
+
+void Raim::setFalseAlarmRate(double p) {
+    falseAlarm = std::min(0.5, std::max(1e-12, p));
+    normalQuantile = upperNormalQuantile(falseAlarm);
+}
+
+void Raim::setMaxExclusions(int k) {
+    maxExclusions = std::max(0, std::min(RaimResult::MAX_EXCLUDED, k));
+}
+
+void Raim::reserve(int maxSatellites) {
+    if ((int)e.size() >= maxSatellites) return;
+    h.resize(4 * maxSatellites);
+    u.resize(4 * maxSatellites);
+    e.resize(maxSatellites);
+    leverage.resize(maxSatellites);
+}
+
+double chiSquareThreshold(int dof, double z) {
+    double a = 2.0 / (9.0 * dof);
+    double c = 1.0 - a + z * std::sqrt(a);
+    return dof * c * c * c;
+}
+
+double Raim::threshold(int dof) const {
+    return chiSquareThreshold(dof, normalQuantile);
+}
+
+RaimResult Raim::check(const EpochView& epoch, double x, double y, double z, double clockBias) {
+    RaimResult out;
+    out.available = out.fault = out.isolated = false;
+    out.excludedCount = 0;
+    out.statistic = out.threshold = out.subsetStatistic = 0.0;
+    out.subsetsTested = 0;
+    out.x = x; out.y = y; out.z = z; out.clockBias = clockBias;
+
+    const int n = epoch.count;
+    if (n < 5) return out;
+    for (int i = 1; i < n; i++)
+        if (epoch.systems[i] != epoch.systems[0]) return out;
+    reserve(n);
+
+    // ===== Linearize at the fix: rows, normal matrix, prefit residuals =====
+    // Rows in one vectorizable pass, then the sums
+    double* H = h.data();
+    double* E = e.data();
+    const double* pos = epoch.pos;
+    const double* vel = epoch.vel;
+    const double* ranges = epoch.ranges;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        double sx, sy, sz;
+        double range = signalPath(pos + 3 * i, vel + 3 * i, x, y, z, sx, sy, sz);
+        double inv = 1.0 / range;
+        H[4 * i] = (x - sx) * inv; H[4 * i + 1] = (y - sy) * inv; H[4 * i + 2] = (z - sz) * inv;
+        H[4 * i + 3] = 1.0;
+        E[i] = ranges[i] - (range + clockBias);
+    }
+    double N[4][4] = {{0}}, g[4] = {0};
+    for (int i = 0; i < n; i++) {
+        const double* hi = &h[4 * i];
+        for (int r = 0; r < 4; r++) {
+            g[r] += hi[r] * e[i];
+            for (int c = r; c < 4; c++) N[r][c] += hi[r] * hi[c];
+        }
+    }
+
+    // N^-1 column by column; the solver's fix has converged, so dx is a
+    // small final correction
+    double Ninv[4][4];
+    for (int c = 0; c < 4; c++) {
+        double unit[4] = {0, 0, 0, 0}, col[4];
+        unit[c] = 1.0;
+        if (!cholesky4Solve(N, unit, col)) return out;
+        for (int r = 0; r < 4; r++) Ninv[r][c] = col[r];
+    }
+    double dx[4];
+    for (int r = 0; r < 4; r++)
+        dx[r] = Ninv[r][0] * g[0] + Ninv[r][1] * g[1] + Ninv[r][2] * g[2] + Ninv[r][3] * g[3];
+
+    // ===== Full-set test =====
+    double sse = 0.0;
+    for (int i = 0; i < n; i++) {
+        const double* hi = &h[4 * i];
+        double* ui = &u[4 * i];
+        e[i] -= hi[0] * dx[0] + hi[1] * dx[1] + hi[2] * dx[2] + hi[3] * dx[3];
+        sse += e[i] * e[i];
+        for (int r = 0; r < 4; r++)
+            ui[r] = Ninv[r][0] * hi[0] + Ninv[r][1] * hi[1] + Ninv[r][2] * hi[2] + Ninv[r][3] * hi[3];
+        leverage[i] = hi[0] * ui[0] + hi[1] * ui[1] + hi[2] * ui[2] + hi[3] * ui[3];
+    }
+    const double var = sigma * sigma;
+    out.available = true;
+    out.statistic = out.subsetStatistic = sse / var;
+    out.threshold = threshold(n - 4);
+    out.x += dx[0]; out.y += dx[1]; out.z += dx[2]; out.clockBias += dx[3];
+    if (out.statistic <= out.threshold) return out;
+    out.fault = true;
+
+    // ===== Exclusion: best subset of each size, smallest size that passes =====
+    for (int k = 1; k <= maxExclusions && n - k >= 5; k++) {
+        int idx[RaimResult::MAX_EXCLUDED], best[RaimResult::MAX_EXCLUDED];
+        double bestSse = 1e300, bestW[3] = {0, 0, 0};
+        for (int m = 0; m < k; m++) idx[m] = m;
+        while (true) {
+            // Downdate by the k rows in idx: SSE_S = SSE - e_S^T (I - P_SS)^-1 e_S
+            double M[3][3], eS[3], w[3];
+            for (int a = 0; a < k; a++) {
+                const double* ha = &h[4 * idx[a]];
+                eS[a] = e[idx[a]];
+                M[a][a] = 1.0 - leverage[idx[a]];
+                for (int b = 0; b < a; b++) {
+                    const double* ub = &u[4 * idx[b]];
+                    M[a][b] = M[b][a] = -(ha[0] * ub[0] + ha[1] * ub[1] + ha[2] * ub[2] + ha[3] * ub[3]);
+                }
+            }
+            out.subsetsTested++;
+            if (solveSmall(k, M, eS, w)) {
+                double s = sse;
+                for (int a = 0; a < k; a++) s -= eS[a] * w[a];
+                if (s < bestSse) {
+                    bestSse = s;
+                    for (int a = 0; a < k; a++) { best[a] = idx[a]; bestW[a] = w[a]; }
+                }
+            }
+            // Next combination of k out of n
+            int m = k - 1;
+            while (m >= 0 && idx[m] == n - k + m) m--;
+            if (m < 0) break;
+            idx[m]++;
+            for (int q = m + 1; q < k; q++) idx[q] = idx[q - 1] + 1;
+        }
+        if (bestSse >= 1e300 || std::max(0.0, bestSse) / var > threshold(n - k - 4)) continue;
+
+        // dx_S = dx - sum_a u_a w_a
+        out.isolated = true;
+        out.excludedCount = k;
+        out.subsetStatistic = std::max(0.0, bestSse) / var;
+        double fix[4] = {out.x, out.y, out.z, out.clockBias};
+        for (int a = 0; a < k; a++) {
+            const double* ua = &u[4 * best[a]];
+            for (int r = 0; r < 4; r++) fix[r] -= ua[r] * bestW[a];
+            out.excluded[a] = epoch.sats[best[a]];
+            out.excludedSystem[a] = epoch.systems[best[a]];
+            out.excludedPrn[a] = epoch.prns[best[a]];
+        }
+        out.x = fix[0]; out.y = fix[1]; out.z = fix[2]; out.clockBias = fix[3];
+        break;
+    }
+    return out;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <vector>
+#include "EpochBuffer.h"
+
+// Upper-tail standard normal quantile: z with P(Z > z) = p, 0 < p <= 0.5
+double upperNormalQuantile(double p);
+
+// Chi-square value exceeded with the probability whose upper-tail normal
+// quantile is z (Wilson-Hilferty; slightly high at 1-2 degrees of freedom)
+double chiSquareThreshold(int dof, double z);
+
+// Outcome of one epoch's integrity check
+struct RaimResult {
+    static const int MAX_EXCLUDED = 3;
+
+    bool   available;           // at least 5 satellites of one system, so the set can be tested
+    bool   fault;               // the full set failed the consistency test
+    bool   isolated;            // ...and excluding `excluded` made it pass
+    int    excludedCount;
+    int    excluded[MAX_EXCLUDED];  // satellite ids (EpochView::sats)
+    int    excludedSystem[MAX_EXCLUDED];    // ...their GnssSystem
+    int    excludedPrn[MAX_EXCLUDED];       // ...and PRN (EpochView::prns)
+    double statistic;           // full set: sum of squared residuals / sigma^2
+    double threshold;           // chi-square threshold for the full set
+    double subsetStatistic;     // after the exclusion (= statistic if none)
+    int    subsetsTested;
+    double x, y, z, clockBias;  // fix without the excluded satellites
+};
+
+// Receiver autonomous integrity monitoring with fault detection and
+// exclusion.
+//
+// The epoch is linearized once at the solver's fix: line-of-sight rows H,
+// the normal matrix N = H^T H and its inverse, and the post-fit residuals
+// e with their sum of squares SSE. The full set passes if SSE / sigma^2 is
+// under the chi-square threshold for n - 4 degrees of freedom at the
+// configured false-alarm rate.
+//
+// A failed set is searched for the subset of 1..maxExclusions satellites
+// whose removal leaves the smallest SSE; the first size whose best subset
+// passes is excluded. Removing satellite j is a rank-one downdate of N,
+// N - h_j h_j^T, so by Sherman-Morrison its solution and SSE follow from the
+// full set's without a new solve:
+//
+//   SSE_j = SSE - e_j^2 / (1 - p_jj),   dx_j = dx - N^-1 h_j e_j / (1 - p_jj)
+//
+// with p_jj = h_j^T N^-1 h_j the satellite's leverage. Removing k satellites
+// is k such downdates, done at once with the k x k form of the identity.
+// With u_j = N^-1 h_j precomputed, a leave-one-out subset costs a few
+// multiply-adds and all n of them about as much as one solve iteration.
+//
+// Thresholds use the Wilson-Hilferty approximation of the chi-square
+// quantile, which errs slightly high (conservative) at 1-2 degrees of
+// freedom. Scratch grows to the largest epoch seen, then is reused.
+//
+// The model has a single receiver clock, so only single-system epochs are
+// tested: an inter-system bias (GLONASS is tens of metres off GPS) would
+// read as a fault. Epochs that mix systems come back unavailable.
+class Raim {
+private:
+    double sigma = 5.0;                 // pseudorange 1-sigma (m)
+    double falseAlarm = 1e-5;           // per test
+    int    maxExclusions = 1;
+    double normalQuantile;              // upper-tail z for falseAlarm
+    std::vector<double> h;              // [sat * 4 + k] line-of-sight rows
+    std::vector<double> u;              // [sat * 4 + k] N^-1 h_j
+    std::vector<double> e;              // post-fit residuals
+    std::vector<double> leverage;       // p_jj
+
+    double threshold(int dof) const;
+
+public:
+    Raim();
+
+    void setRangeSigma(double metres) { sigma = metres; }
+    void setFalseAlarmRate(double p);
+    void setMaxExclusions(int k);
+
+    double getRangeSigma() const { return sigma; }
+    double getFalseAlarmRate() const { return falseAlarm; }
+    int    getMaxExclusions() const { return maxExclusions; }
+
+    // Pre-sizes scratch so epochs with up to maxSatellites never allocate
+    void reserve(int maxSatellites);
+
+    // Tests `epoch` at the fix (x, y, z, clockBias) and, on a fault, looks
+    // for satellites to exclude
+    RaimResult check(const EpochView& epoch, double x, double y, double z, double clockBias);
+};
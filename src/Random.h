@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+
+// splitmix64 step: used to expand seeds and derive per-run streams
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Independent, reproducible seed for item `index` of a batch
+inline uint64_t deriveSeed(uint64_t baseSeed, uint64_t index) {
+    uint64_t s = baseSeed ^ (index * 0xD1B54A32D192ED03ULL);
+    splitmix64(s);
+    return splitmix64(s);
+}
+
+// xoshiro256** generator. Self-contained (unlike <random> distributions,
+// whose algorithms are implementation-defined) so a seed produces the same
+// draws on every compiler and standard library.
+class Rng {
+private:
+    uint64_t s[4];
+    bool   hasSpare = false;
+    double spare    = 0.0;
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    explicit Rng(uint64_t seed = 1) {
+        for (auto& v : s) v = splitmix64(seed);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    double uniform(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+
+    // Standard normal (Box-Muller, spare value cached)
+    double gaussian() {
+        if (hasSpare) { hasSpare = false; return spare; }
+        double u1 = uniform(), u2 = uniform();
+        if (u1 < 1e-300) u1 = 1e-300;
+        double r = std::sqrt(-2.0 * std::log(u1));
+        spare = r * std::sin(2 * M_PI * u2);
+        hasSpare = true;
+        return r * std::cos(2 * M_PI * u2);
+    }
+};
@@ -1,15 +1,13 @@
 #include "Receiver.h"
 #include <cmath>
 
+#include "SignalPath.h"
+
 Receiver::Receiver(double x, double y, double z)
     : x(x), y(y), z(z), clockBias(0.0001) {}
 
-double Receiver::distanceTo(double satX, double satY, double satZ) {
-    return sqrt(
-        pow(satX - x, 2) +
-        pow(satY - y, 2) +
-        pow(satZ - z, 2)
-    );
+double Receiver::distanceTo(const double satPos[3], const double satVel[3]) const {
+    return signalRange(satPos, satVel, x, y, z);
 }
 double Receiver::getX() const {
     return x;
@@ -15,5 +15,7 @@ public:
     double getZ() const;
 
     double getClockBias() const;
-    double distanceTo(double satX, double satY, double satZ);
+    // Range a signal travels from a satellite at satPos moving at satVel
+    // (receive time, ECEF), with light time and Earth rotation
+    double distanceTo(const double satPos[3], const double satVel[3]) const;
 };
@@ -0,0 +1,386 @@
+#include "Renderer_gl.h"
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glcorearb.h>
+#endif
+#include <cmath>
+#include <algorithm>
+#include <array>
+
+#include "Constellation.h"
+#include "Visibility.h"
+
+// ===== Shaders =====
+// Meshes (Earth, rings, trail) take positions directly; the instanced
+// program places each instance at `instance`, moved towards `anchor` by
+// the per-vertex `along` (0 for points, 0 and 1 for a signal line)
+static const char* MESH_VS = R"(#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 mvp;
+uniform float pointSize;
+void main() {
+    gl_Position = mvp * vec4(position, 1.0);
+    gl_PointSize = pointSize;
+}
+)";
+
+static const char* INSTANCED_VS = R"(#version 330 core
+layout(location = 0) in float along;
+layout(location = 1) in vec3 instance;
+uniform mat4 mvp;
+uniform vec3 anchor;
+uniform float pointSize;
+void main() {
+    gl_Position = mvp * vec4(mix(instance, anchor, along), 1.0);
+    gl_PointSize = pointSize;
+}
+)";
+
+// Solid colour; the sprite variant also rounds the point. Kept apart because
+// a shader that may discard loses early depth testing on the Earth mesh.
+static const char* FS = R"(#version 330 core
+uniform vec4 color;
+out vec4 fragColor;
+void main() {
+    fragColor = color;
+}
+)";
+
+static const char* ROUND_FS = R"(#version 330 core
+uniform vec4 color;
+out vec4 fragColor;
+void main() {
+    if (length(gl_PointCoord - vec2(0.5)) > 0.5) discard;
+    fragColor = color;
+}
+)";
+
+static unsigned compile(GLenum type, const char* src, std::string* err) {
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
+    GLint ok = 0;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+        if (err) *err = std::string("shader compile failed: ") + log;
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+unsigned linkProgram(const char* vs, const char* fs, std::string* err) {
+    GLuint v = compile(GL_VERTEX_SHADER, vs, err);
+    if (!v) return 0;
+    GLuint f = compile(GL_FRAGMENT_SHADER, fs, err);
+    if (!f) { glDeleteShader(v); return 0; }
+    GLuint p = glCreateProgram();
+    glAttachShader(p, v);
+    glAttachShader(p, f);
+    glLinkProgram(p);
+    glDeleteShader(v);
+    glDeleteShader(f);
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(p, sizeof(log), nullptr, log);
+        if (err) *err = std::string("shader link failed: ") + log;
+        glDeleteProgram(p);
+        return 0;
+    }
+    return p;
+}
+
+// Instance buffer bound to attribute 1 (divisor 1) over the shared
+// two-vertex line on attribute 0
+static unsigned instanceVao(unsigned lineVbo, unsigned& vbo) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, sizeof(float), nullptr);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    glVertexAttribDivisor(1, 1);
+    return vao;
+}
+
+static unsigned positionVao(unsigned& vbo) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+    return vao;
+}
+
+bool SkyRenderer::init(std::string* err) {
+    mesh.id    = linkProgram(MESH_VS, FS, err);
+    dot.id     = linkProgram(MESH_VS, ROUND_FS, err);
+    sprites.id = linkProgram(INSTANCED_VS, ROUND_FS, err);
+    lines.id   = linkProgram(INSTANCED_VS, FS, err);
+    if (!mesh.id || !dot.id || !sprites.id || !lines.id) return false;
+    for (Program* p : {&mesh, &dot, &sprites, &lines}) {
+        p->mvp       = glGetUniformLocation(p->id, "mvp");
+        p->color     = glGetUniformLocation(p->id, "color");
+        p->pointSize = glGetUniformLocation(p->id, "pointSize");
+        p->anchor    = glGetUniformLocation(p->id, "anchor");
+    }
+
+    // ===== Earth: unit sphere, 36 x 18 latitude/longitude grid, outward CCW =====
+    const int sl = 36, st = 18;
+    std::vector<float> verts;
+    std::vector<unsigned> idx;
+    verts.reserve((size_t)(st + 1) * (sl + 1) * 3);
+    for (int i = 0; i <= st; i++) {
+        double lat = M_PI * (-0.5 + (double)i / st);
+        for (int j = 0; j <= sl; j++) {
+            double lng = 2 * M_PI * j / sl;
+            verts.push_back((float)(cos(lng) * cos(lat)));
+            verts.push_back((float)(sin(lng) * cos(lat)));
+            verts.push_back((float)sin(lat));
+        }
+    }
+    for (int i = 0; i < st; i++)
+        for (int j = 0; j < sl; j++) {
+            unsigned a = i * (sl + 1) + j, b = a + sl + 1;
+            idx.insert(idx.end(), {a, a + 1, b, a + 1, b + 1, b});
+        }
+    earthVao = positionVao(earthVbo);
+    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &earthIbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, earthIbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size() * sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
+    earthIndices = (int)idx.size();
+
+    ringVao = positionVao(ringVbo);
+
+    // ===== Shared two-vertex line and the instance buffers =====
+    const float line[2] = {0.0f, 1.0f};
+    glGenBuffers(1, &lineVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(line), line, GL_STATIC_DRAW);
+    satVao = instanceVao(lineVbo, satVbo);
+    rxVao  = instanceVao(lineVbo, rxVbo);
+    sigVao = instanceVao(lineVbo, sigVbo);
+
+    // ===== Trail ring: slot TRAIL_POINTS mirrors slot 0 to close the seam =====
+    trailVao = positionVao(trailVbo);
+    glBufferData(GL_ARRAY_BUFFER, (TRAIL_POINTS + 1) * 3 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    trailHead = trailCount = 0;
+    glBindVertexArray(0);
+    ready = true;
+    return true;
+}
+
+void SkyRenderer::release() {
+    if (!ready) return;
+    for (unsigned* b : {&earthVbo, &earthIbo, &ringVbo, &lineVbo, &satVbo, &rxVbo, &sigVbo, &trailVbo})
+        glDeleteBuffers(1, b);
+    for (unsigned* a : {&earthVao, &ringVao, &satVao, &rxVao, &sigVao, &trailVao})
+        glDeleteVertexArrays(1, a);
+    for (Program* p : {&mesh, &dot, &sprites, &lines})
+        glDeleteProgram(p->id);
+    satCapacity = rxCapacity = sigCapacity = 0;
+    ready = false;
+}
+
+void SkyRenderer::setOrbits(const Constellation& satellites, double scale) {
+    // Distinct orbit planes: satellites sharing radius, inclination and node
+    std::vector<std::array<double,3>> planes;
+    for (int i = 0; i < satellites.size(); i++) {
+        std::array<double,3> p = {satellites.getRadius(i), satellites.getInclination(i),
+                                  std::remainder(satellites.getRaan(i), 2 * M_PI)};
+        bool seen = false;
+        for (const auto& q : planes)
+            if (std::fabs(q[0] - p[0]) < 1.0 && std::fabs(q[1] - p[1]) < 1e-9 && std::fabs(q[2] - p[2]) < 1e-9) {
+                seen = true;
+                break;
+            }
+        if (!seen) planes.push_back(p);
+    }
+
+    const int seg = 64;
+    std::vector<float> verts;
+    verts.reserve((planes.size() + 1) * seg * 3);
+    ringFirst.clear();
+    ringCount.clear();
+    auto ring = [&](double r, double incl, double node) {
+        double cn = cos(node), sn = sin(node), ci = cos(incl), si = sin(incl);
+        ringFirst.push_back((int)verts.size() / 3);
+        ringCount.push_back(seg);
+        for (int k = 0; k < seg; k++) {
+            double a = 2 * M_PI * k / seg, c = r * cos(a), s = r * sin(a);
+            verts.push_back((float)(c * cn - s * ci * sn));
+            verts.push_back((float)(c * sn + s * ci * cn));
+            verts.push_back((float)(s * si));
+        }
+    };
+    ring(1.001, 0.0, 0.0);
+    for (const auto& p : planes) ring(p[0] * scale, p[1], p[2]);
+    glBindBuffer(GL_ARRAY_BUFFER, ringVbo);
+    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
+}
+
+// Orphans the buffer (the driver may keep drawing from the old storage)
+// and refills it from `staging`; grows geometrically, so steady frames
+// never reallocate
+void SkyRenderer::upload(unsigned vbo, size_t& capacity, int count) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if ((size_t)count > capacity) capacity = std::max((size_t)count, std::max<size_t>(256, 2 * capacity));
+    glBufferData(GL_ARRAY_BUFFER, capacity * 3 * sizeof(float), nullptr, GL_STREAM_DRAW);
+    if (count > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, (size_t)count * 3 * sizeof(float), staging.data());
+}
+
+void SkyRenderer::setSatellites(const Constellation& satellites, double scale) {
+    const int n = satellites.size();
+    staging.resize((size_t)n * 3);
+    const double *x = satellites.x(), *y = satellites.y(), *z = satellites.z();
+    float* out = staging.data();
+    for (int i = 0; i < n; i++) {
+        out[3 * i]     = (float)(x[i] * scale);
+        out[3 * i + 1] = (float)(y[i] * scale);
+        out[3 * i + 2] = (float)(z[i] * scale);
+    }
+    upload(satVbo, satCapacity, n);
+    satCount = n;
+}
+
+void SkyRenderer::setSignals(const Constellation& satellites, const VisibleSet& visible, double scale) {
+    const int n = visible.size();
+    staging.resize((size_t)n * 3);
+    for (int k = 0; k < n; k++) {
+        int i = visible.satellite(k);
+        staging[3 * k]     = (float)(satellites.getX(i) * scale);
+        staging[3 * k + 1] = (float)(satellites.getY(i) * scale);
+        staging[3 * k + 2] = (float)(satellites.getZ(i) * scale);
+    }
+    upload(sigVbo, sigCapacity, n);
+    sigCount = n;
+}
+
+void SkyRenderer::setReceivers(const double* x, const double* y, const double* z, int count, double scale) {
+    staging.resize((size_t)count * 3);
+    for (int i = 0; i < count; i++) {
+        staging[3 * i]     = (float)(x[i] * scale);
+        staging[3 * i + 1] = (float)(y[i] * scale);
+        staging[3 * i + 2] = (float)(z[i] * scale);
+    }
+    upload(rxVbo, rxCapacity, count);
+    rxCount = count;
+}
+
+void SkyRenderer::pushReceiver(double x, double y, double z) {
+    receiver[0] = (float)x; receiver[1] = (float)y; receiver[2] = (float)z;
+    glBindBuffer(GL_ARRAY_BUFFER, trailVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, (size_t)trailHead * 3 * sizeof(float), sizeof(receiver), receiver);
+    if (trailHead == 0)
+        glBufferSubData(GL_ARRAY_BUFFER, (size_t)TRAIL_POINTS * 3 * sizeof(float), sizeof(receiver), receiver);
+    trailHead = (trailHead + 1) % TRAIL_POINTS;
+    if (trailCount < TRAIL_POINTS) trailCount++;
+}
+
+// Column-major view-projection of the orbiting camera
+static void cameraMatrix(const OrbitCamera& cam, int width, int height, float out[16]) {
+    double yr = cam.yaw * M_PI / 180, pr = cam.pitch * M_PI / 180;
+    double cx = cam.dist * cos(pr) * sin(yr), cy = cam.dist * sin(pr), cz = cam.dist * cos(pr) * cos(yr);
+    double fx = -cx, fy = -cy, fz = -cz, fl = sqrt(fx*fx + fy*fy + fz*fz);
+    fx /= fl; fy /= fl; fz /= fl;
+    double sx = -fz, sy = 0, sz = fx, sl = sqrt(sx*sx + sz*sz);       // forward x (0, 1, 0)
+    sx /= sl; sz /= sl;
+    double ux = sy*fz - sz*fy, uy = sz*fx - sx*fz, uz = sx*fy - sy*fx;
+    double view[16] = {sx, ux, -fx, 0, sy, uy, -fy, 0, sz, uz, -fz, 0,
+                       -(sx*cx + sy*cy + sz*cz), -(ux*cx + uy*cy + uz*cz), (fx*cx + fy*cy + fz*cz), 1};
+    double asp = (double)width / std::max(1, height), f = 1.0 / tan(22.5 * M_PI / 180);
+    double zN = 0.01, zF = 200;
+    double proj[16] = {f / asp, 0, 0, 0, 0, f, 0, 0, 0, 0, (zF + zN) / (zN - zF), -1,
+                       0, 0, 2 * zF * zN / (zN - zF), 0};
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++) {
+            double v = 0;
+            for (int k = 0; k < 4; k++) v += proj[k * 4 + r] * view[c * 4 + k];
+            out[c * 4 + r] = (float)v;
+        }
+}
+
+void SkyRenderer::draw(int width, int height, const OrbitCamera& camera) {
+    float mvp[16];
+    cameraMatrix(camera, width, height, mvp);
+
+    glViewport(0, 0, width, height);
+    glClearColor(0.02f, 0.02f, 0.08f, 1);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    // ===== Static geometry =====
+    glUseProgram(mesh.id);
+    glUniformMatrix4fv(mesh.mvp, 1, GL_FALSE, mvp);
+    glUniform4f(mesh.color, 0.1f, 0.25f, 0.55f, 1);
+    glBindVertexArray(earthVao);
+    // Opaque and closed: only the near hemisphere is rasterized
+    glDisable(GL_BLEND);
+    glEnable(GL_CULL_FACE);
+    glDrawElements(GL_TRIANGLES, earthIndices, GL_UNSIGNED_INT, nullptr);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    if (!ringFirst.empty()) {
+        glBindVertexArray(ringVao);
+        glUniform4f(mesh.color, 0.25f, 0.25f, 0.5f, 1);
+        glDrawArrays(GL_LINE_LOOP, ringFirst[0], ringCount[0]);
+        glUniform4f(mesh.color, 0.15f, 0.15f, 0.15f, 1);
+        glMultiDrawArrays(GL_LINE_LOOP, ringFirst.data() + 1, ringCount.data() + 1, (int)ringFirst.size() - 1);
+    }
+
+    // ===== Instanced batches =====
+    glUseProgram(sprites.id);
+    glUniformMatrix4fv(sprites.mvp, 1, GL_FALSE, mvp);
+    glUniform1f(sprites.pointSize, 6.0f);
+    glUniform4f(sprites.color, 1, 0.9f, 0.2f, 1);
+    glBindVertexArray(satVao);
+    glDrawArraysInstanced(GL_POINTS, 0, 1, satCount);
+    if (rxCount > 0) {
+        glUniform1f(sprites.pointSize, 3.0f);
+        glUniform4f(sprites.color, 0.3f, 0.8f, 1, 1);
+        glBindVertexArray(rxVao);
+        glDrawArraysInstanced(GL_POINTS, 0, 1, rxCount);
+    }
+    glUseProgram(lines.id);
+    glUniformMatrix4fv(lines.mvp, 1, GL_FALSE, mvp);
+    glUniform3fv(lines.anchor, 1, receiver);
+    glUniform4f(lines.color, 0.2f, 1, 0.3f, 0.18f);
+    glBindVertexArray(sigVao);
+    glDrawArraysInstanced(GL_LINES, 0, 2, sigCount);
+
+    // ===== Receiver trail (oldest first) and dot =====
+    glUseProgram(mesh.id);
+    glBindVertexArray(trailVao);
+    glUniform4f(mesh.color, 0.8f, 0.2f, 0.2f, 1);
+    if (trailCount < TRAIL_POINTS || trailHead == 0) {
+        glDrawArrays(GL_LINE_STRIP, 0, trailCount);
+    } else {
+        GLint first[2] = {trailHead, 0};
+        GLsizei count[2] = {TRAIL_POINTS - trailHead + 1, trailHead};
+        glMultiDrawArrays(GL_LINE_STRIP, first, count, 2);
+    }
+    if (trailCount > 0) {
+        glUseProgram(dot.id);
+        glUniformMatrix4fv(dot.mvp, 1, GL_FALSE, mvp);
+        glUniform1f(dot.pointSize, 10.0f);
+        glUniform4f(dot.color, 1, 0.2f, 0.2f, 1);
+        glDrawArrays(GL_POINTS, (trailHead + TRAIL_POINTS - 1) % TRAIL_POINTS, 1);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <string>
+
+class Constellation;
+class VisibleSet;
+
+// Compiles and links a vertex/fragment shader pair into a program; 0 (and
+// the compiler's log in `err`) on failure
+unsigned linkProgram(const char* vertexSource, const char* fragmentSource, std::string* err = nullptr);
+
+// Camera orbiting the origin (Earth radii, degrees)
+struct OrbitCamera {
+    double yaw = 30, pitch = 20, dist = 2.5;
+};
+
+// Retained-mode renderer for the 3D sky view (OpenGL 3.3 core).
+//
+// Everything that does not move lives in buffers uploaded once: the Earth
+// mesh, the equator and one ring per orbit plane of the constellation.
+// Per frame the satellite positions, the receivers of a fleet and the
+// visible satellites are each copied into one instance buffer (orphaned
+// and refilled, no reallocation once large enough) and drawn as one
+// instanced call: satellites and receivers as point sprites, signal lines
+// as a two-vertex line instanced per visible satellite. The receiver trail
+// is a ring buffer on the GPU; a new point is one 12-byte upload.
+//
+// All positions are in Earth radii: callers pass the metres-to-radii scale.
+// Needs a current OpenGL 3.3 core context for init(), draw() and release().
+class SkyRenderer {
+public:
+    static const int TRAIL_POINTS = 500;
+
+private:
+    struct Program {
+        unsigned id = 0;
+        int mvp = -1, color = -1, pointSize = -1, anchor = -1;
+    };
+    Program mesh, dot;              // positions as given; dot rounds its point
+    Program sprites, lines;         // instanced: round points, signal lines
+
+    unsigned earthVao = 0, earthVbo = 0, earthIbo = 0;
+    int earthIndices = 0;
+    unsigned ringVao = 0, ringVbo = 0;
+    std::vector<int> ringFirst, ringCount;      // ring 0 is the equator
+    unsigned lineVbo = 0;                       // {0, 1}: satellite end, receiver end
+    unsigned satVao = 0, satVbo = 0, rxVao = 0, rxVbo = 0, sigVao = 0, sigVbo = 0;
+    size_t satCapacity = 0, rxCapacity = 0, sigCapacity = 0;    // instances
+    int satCount = 0, rxCount = 0, sigCount = 0;
+    unsigned trailVao = 0, trailVbo = 0;
+    int trailHead = 0, trailCount = 0;
+    float receiver[3] = {1, 0, 0};
+    bool  ready = false;
+
+    std::vector<float> staging;                 // CPU copy for one instance upload
+
+    void upload(unsigned vbo, size_t& capacity, int count);
+
+public:
+    // Compiles the shaders and builds the static Earth geometry
+    bool init(std::string* err = nullptr);
+    void release();
+
+    // Static: one ring per distinct orbit plane (uploaded once per call)
+    void setOrbits(const Constellation& satellites, double scale);
+
+    // Per frame
+    void setSatellites(const Constellation& satellites, double scale);
+    void setSignals(const Constellation& satellites, const VisibleSet& visible, double scale);
+    void setReceivers(const double* x, const double* y, const double* z, int count, double scale);
+    // Moves the tracked receiver (Earth radii) and appends it to the trail
+    void pushReceiver(double x, double y, double z);
+
+    void draw(int width, int height, const OrbitCamera& camera);
+};
@@ -0,0 +1,155 @@
+#include "RinexNav.h"
+#include <fstream>
+#include <cstdlib>
+#include <cctype>
+
+const double SECONDS_PER_WEEK = 604800.0;
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+static long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+double gpsSecondsFromCalendar(int year, int month, int day,
+                              int hour, int minute, double second) {
+    long days = daysFromCivil(year, month, day) - daysFromCivil(1980, 1, 6);
+    return days * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+}
+
+// Fixed-width Fortran number; accepts D exponents, blank means zero
+static double field(const std::string& line, size_t col, size_t width) {
+    if (col >= line.size()) return 0.0;
+    std::string s = line.substr(col, width);
+    for (auto& c : s) if (c == 'D' || c == 'd') c = 'E';
+    return std::strtod(s.c_str(), nullptr);
+}
+
+static int intField(const std::string& line, size_t col, size_t width) {
+    return (int)field(line, col, width);
+}
+
+// The seven broadcast-orbit lines are laid out identically for GPS,
+// Galileo and QZSS; only the leading indent differs between versions.
+static void parseOrbit(const std::vector<std::string>& lines, size_t indent,
+                       BroadcastEphemeris& e) {
+    double v[7][4] = {};
+    for (size_t k = 0; k < lines.size() && k < 7; k++)
+        for (int j = 0; j < 4; j++)
+            v[k][j] = field(lines[k], indent + 19 * j, 19);
+
+    e.iode  = v[0][0]; e.crs = v[0][1]; e.deltaN = v[0][2]; e.m0     = v[0][3];
+    e.cuc   = v[1][0]; e.e   = v[1][1]; e.cus    = v[1][2]; e.sqrtA  = v[1][3];
+    double toeSow = v[2][0];
+    e.cic   = v[2][1]; e.omega0 = v[2][2]; e.cis = v[2][3];
+    e.i0    = v[3][0]; e.crc = v[3][1]; e.omega  = v[3][2]; e.omegaDot = v[3][3];
+    e.idot  = v[4][0]; e.week = v[4][2];
+    e.health = v[5][1]; e.tgd = v[5][2];
+
+    e.toe = e.week * SECONDS_PER_WEEK + toeSow;
+}
+
+static bool headerLabel(const std::string& line, const char* label) {
+    return line.size() > 60 && line.compare(60, std::string(label).size(), label) == 0;
+}
+
+bool loadRinexNav(const std::string& path,
+                  std::vector<BroadcastEphemeris>& out,
+                  std::string* error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+
+    // ===== Header =====
+    std::string line;
+    double version = 0;
+    char   fileSystem = 'G';
+    bool   isNav = false;
+    while (std::getline(in, line)) {
+        if (headerLabel(line, "RINEX VERSION / TYPE")) {
+            version = field(line, 0, 9);
+            char type = line.size() > 20 ? line[20] : ' ';
+            isNav = (type == 'N' || type == 'n');
+            if (line.size() > 40 && line[40] != ' ') fileSystem = line[40];
+            // RINEX 2 gives GLONASS and SBAS navigation files their own types
+            if (version < 3.0 && (type == 'G' || type == 'H')) {
+                isNav = true;
+                fileSystem = type == 'G' ? 'R' : 'S';
+            }
+        }
+        if (headerLabel(line, "END OF HEADER")) break;
+    }
+    if (!isNav || version < 2.0) {
+        if (error) *error = path + " is not a RINEX navigation file";
+        return false;
+    }
+
+    // ===== Records =====
+    if (version < 3.0) {
+        // RINEX 2: "PP YY MM DD HH MM SS.S" + 3 x D19.12, then 7 lines of 3X,4D19.12
+        if (fileSystem != 'G' && fileSystem != 'N' && fileSystem != ' ') return true;
+        while (std::getline(in, line)) {
+            if (line.find_first_not_of(' ') == std::string::npos) continue;
+            std::vector<std::string> orbit(7);
+            for (auto& o : orbit) if (!std::getline(in, o)) break;
+
+            BroadcastEphemeris e;
+            e.system = 'G';
+            e.prn    = intField(line, 0, 2);
+            int yy = intField(line, 2, 3);
+            int year = yy < 80 ? 2000 + yy : 1900 + yy;
+            e.toc = gpsSecondsFromCalendar(year, intField(line, 5, 3), intField(line, 8, 3),
+                                           intField(line, 11, 3), intField(line, 14, 3),
+                                           field(line, 17, 5));
+            e.af0 = field(line, 22, 19);
+            e.af1 = field(line, 41, 19);
+            e.af2 = field(line, 60, 19);
+            parseOrbit(orbit, 3, e);
+            out.push_back(e);
+        }
+        return true;
+    }
+
+    // RINEX 3: "SNN YYYY MM DD HH MM SS" + 3 x D19.12, then orbit lines of 4X,4D19.12.
+    // Orbit-line counts differ by system, so a record ends at the next line
+    // that starts with a system letter.
+    std::string head;
+    std::vector<std::string> orbit;
+    auto flush = [&]() {
+        if (head.empty()) return;
+        char sys = head[0];
+        if (sys == 'G' || sys == 'E' || sys == 'J') {
+            BroadcastEphemeris e;
+            e.system = sys;
+            e.prn    = intField(head, 1, 2);
+            e.toc = gpsSecondsFromCalendar(intField(head, 4, 4), intField(head, 9, 2),
+                                           intField(head, 12, 2), intField(head, 15, 2),
+                                           intField(head, 18, 2), field(head, 21, 2));
+            e.af0 = field(head, 23, 19);
+            e.af1 = field(head, 42, 19);
+            e.af2 = field(head, 61, 19);
+            parseOrbit(orbit, 4, e);
+            out.push_back(e);
+        }
+        head.clear();
+        orbit.clear();
+    };
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        if (std::isalpha((unsigned char)line[0])) {
+            flush();
+            head = line;
+        } else if (!head.empty()) {
+            orbit.push_back(line);
+        }
+    }
+    flush();
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Ephemeris.h"
+
+// Reads a RINEX 2.x (GPS) or 3.x (GPS/Galileo/QZSS, mixed) navigation
+// file into broadcast-ephemeris records. Records for other systems
+// (GLONASS, SBAS, BeiDou, NavIC) are skipped; a RINEX 2 GLONASS or SBAS
+// navigation file loads as no records.
+// Returns false and sets `error` if the file cannot be opened or its
+// header is not a navigation header.
+bool loadRinexNav(const std::string& path,
+                  std::vector<BroadcastEphemeris>& out,
+                  std::string* error = nullptr);
+
+// Calendar date/time (GPS time scale) to seconds since 1980-01-06 00:00
+double gpsSecondsFromCalendar(int year, int month, int day,
+                              int hour, int minute, double second);
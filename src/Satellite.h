@@ -1,23 +1,27 @@
 #ifndef SATELLITE_H
 #define SATELLITE_H
 
+class Constellation;
+
+// Thin view onto one satellite of a Constellation. The orbital elements and
+// positions are owned by the Constellation's contiguous arrays; a Satellite
+// only remembers which slot it refers to.
 class Satellite {
 private:
-    double altitude;
-    double radius;
-    double x, y, z;
-    double phase;     // NEW
-    double omega;     // angular velocity
-    double inclination;
+    Constellation* owner;
+    int index;
 
 public:
-    Satellite(double alt, double initialPhase, double incl);
+    Satellite(Constellation& owner, int index);
 
+    // Propagates just this satellite; prefer Constellation::update for the set
     void update(double time);
 
     double getX() const;
     double getY() const;
     double getZ() const;
+
+    int getIndex() const { return index; }
 };
 
-#endif
\ No newline at end of file
+#endif
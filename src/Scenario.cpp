@@ -0,0 +1,188 @@
+#include "Scenario.h"
+#include <cmath>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include "GnssSystems.h"
+#include "Geodesy.h"
+#include "TraceWriter.h"
+#include "Instrument.h"
+#include "SignalPath.h"
+
+EpochPipeline::EpochPipeline(Constellation& satellites, const Spoofer& spoofer, double clockBiasTrue)
+    : satellites(satellites), spoofer(spoofer), clockBiasTrue(clockBiasTrue)
+{
+    epoch.reserve(satellites.size());
+    visibleSats.reserve(satellites.size());
+    rangeErrors.resize(VisibleSet::padded(satellites.size()));
+    solver.reserve(satellites.size());
+    detector.reserve(satellites.size());
+}
+
+void EpochPipeline::setRangeNoise(double sigma,uint64_t seed){
+    noiseSigma=sigma;
+    noise=Rng(seed);
+    detector.raim().setRangeSigma(std::max(1.0,sigma));
+    filter.setRangeSigma(std::max(1.0,sigma));
+}
+
+void formPseudoranges(const Constellation& satellites,const VisibleSet& visible,double time,
+                      double rx,double ry,double rz,double clockBias,
+                      double noiseSigma,Rng& noise,const RangeErrors& errors,EpochBuffer& epoch){
+    GNSS_STAGE(STAGE_RANGES);
+    epoch.clear();
+    if(errors.components!=ERROR_NONE){
+        errors.model->locate(*errors.site,rx,ry,rz);
+        errors.model->compute(time,*errors.site,visible,errors.components,errors.scratch);
+    }
+    const double *satX=satellites.x(),*satY=satellites.y(),*satZ=satellites.z();
+    for(int k=0;k<visible.size();k++){
+        int i=visible.satellite(k);
+        double vel[3];
+        satellites.getVelocity(i,vel);
+        epoch.push(satX[i],satY[i],satZ[i],vel,0.0,i,satellites.getSystem(i),satellites.getPrn(i));
+    }
+    // True ranges in one pass over the epoch, then errors, clock and noise
+    double* pr=epoch.ranges();
+    signalRanges(epoch.view(),rx,ry,rz,pr);
+    for(int k=0;k<epoch.size();k++){
+        if(errors.components!=ERROR_NONE) pr[k]+=errors.scratch[k];
+        pr[k]+=clockBias;
+        if(noiseSigma>0) pr[k]+=noiseSigma*noise.gaussian();
+    }
+}
+
+EpochResult EpochPipeline::step(double simTime, double rx, double ry, double rz,
+                                double dt, bool spoofMode, const SignalQualityView* signal)
+{
+    EpochResult out;
+    out.valid=false;
+    satellites.propagate(simTime);    // one recurrence step in fixed-step runs
+    visibility.setSatellites(satellites);
+    visibility.visibleAll(rx,ry,rz,visibleSats);
+
+    RangeErrors errors;
+    errors.model=errorModel; errors.components=errorComponents;
+    errors.site=&site; errors.scratch=rangeErrors.data();
+    formPseudoranges(satellites,visibleSats,simTime,rx,ry,rz,clockBiasTrue,noiseSigma,noise,errors,epoch);
+    out.visible=epoch.size();
+    GNSS_COUNT(COUNTER_EPOCHS,1);
+    GNSS_COUNT(COUNTER_VISIBLE,out.visible);
+    if(epoch.size()<4) return out;
+    if(spoofMode&&attack)
+        attack->apply(simTime,rx,ry,rz,clockBiasTrue,epoch.view(),epoch.ranges());
+    else if(spoofMode)
+        spoofer.spoofPseudoranges(epoch.view(),clockBiasTrue,epoch.ranges());
+
+    EpochView view=epoch.view();
+    if(navigation==NAV_FILTER&&filter.isInitialized()){
+        filter.predict(simTime);
+        FilterInnovations innov=filter.update(view);
+        out.estX=filter.getX(); out.estY=filter.getY(); out.estZ=filter.getZ();
+        out.clockBias=filter.getClockBias();
+        out.detection=detector.analyze(out.estX,out.estY,out.estZ,out.clockBias,dt,view,signal,&innov);
+        out.valid=true;
+        return out;
+    }
+    PositionFix fix;
+    solver.solve(&view,&fix);
+    if(!fix.valid) return out;
+    if(navigation==NAV_FILTER) filter.initialize(simTime,fix);
+    out.estX=fix.x; out.estY=fix.y; out.estZ=fix.z; out.clockBias=fix.clockBias;
+    out.detection=detector.analyze(out.estX,out.estY,out.estZ,out.clockBias,dt,view,signal);
+    out.valid=true;
+    return out;
+}
+
+TraceRecord makeTraceRecord(double simTime,double rx,double ry,double rz,
+                            const EpochResult& r,uint32_t run,bool spoofActive,bool inNoFly){
+    TraceRecord t={};
+    t.time=simTime;
+    t.trueX=rx; t.trueY=ry; t.trueZ=rz;
+    // Truth and estimate converted together
+    double x[2]={rx,rx},y[2]={ry,ry},z[2]={rz,rz};
+    if(r.valid){ x[1]=r.estX; y[1]=r.estY; z[1]=r.estZ; }
+    double lat[2],lon[2],alt[2];
+    ecef_to_lla(x,y,z,2,lat,lon,alt);
+    t.trueLat=lat[0]; t.trueLon=lon[0]; t.trueAlt=alt[0];
+    t.run=run;
+    t.visible=r.visible;
+    t.valid=r.valid;
+    t.spoofActive=spoofActive;
+    t.inNoFly=inNoFly;
+    if(r.valid){
+        t.estX=r.estX; t.estY=r.estY; t.estZ=r.estZ;
+        t.estLat=lat[1]; t.estLon=lon[1]; t.estAlt=alt[1];
+        t.clockBias=r.clockBias;
+        t.confidence=r.detection.confidence;
+        t.residualScore=r.detection.residualScore;
+        t.velocityScore=r.detection.velocityScore;
+        t.clockScore=r.detection.clockScore;
+        t.spoofDetected=r.detection.spoofingDetected;
+    }
+    return t;
+}
+
+Constellation buildGpsConstellation(){
+    // Walker 24/6/4: four satellites per plane, planes 60 degrees apart
+    WalkerShell gps={SYSTEM_GPS,24,6,4,26571000.0,55.0*M_PI/180,0.0,1,0.0};
+    return buildConstellation({gps});
+}
+
+NoFlyZone pearsonNoFlyZone(){
+    return {localFrame(43.6777,-79.6248,173),5000.0};
+}
+
+ScenarioState runScenario(bool spoofMode, TraceWriter* trace) {
+    std::vector<std::array<double,3>> waypoints={
+        lla_to_ecef(43.6426,-79.3871,200),
+        lla_to_ecef(43.6500,-79.4500,200),
+        lla_to_ecef(43.6600,-79.5200,200),
+        lla_to_ecef(43.6700,-79.5800,200),
+        lla_to_ecef(43.6777,-79.6248,200),
+    };
+    std::vector<std::array<double,2>> waypoints_ll = {
+        {43.6426,-79.3871},{43.6500,-79.4500},{43.6600,-79.5200},
+        {43.6700,-79.5800},{43.6777,-79.6248},
+    };
+
+    const NoFlyZone noFly=pearsonNoFlyZone();
+    auto fake=lla_to_ecef(43.6426,-79.3871,200);
+    Spoofer spoofer(fake[0],fake[1],fake[2]);
+
+    Constellation satellites=buildGpsConstellation();
+    const double clockBiasTrue=0.12;
+    EpochPipeline pipeline(satellites,spoofer,clockBiasTrue);
+    pipeline.setMeasurementErrors(&defaultMeasurementErrors());
+
+    ScenarioState scenario;
+    scenario.pearsonLatLon={43.6777,-79.6248};
+    scenario.noFlyRadiusDeg=2000.0/111000.0;
+    scenario.spoofMode=spoofMode;
+
+    double simTime=0;
+    std::vector<double> estX,estY,estZ;
+    for(int wp=0;wp<(int)waypoints.size();wp++){
+        auto& pos=waypoints[wp];
+        double rx=pos[0],ry=pos[1],rz=pos[2];
+        simTime+=360;
+
+        EpochResult r=pipeline.step(simTime,rx,ry,rz,360,spoofMode);
+        bool inNoFly=noFly.contains(rx,ry,rz);
+        if(trace) trace->append(makeTraceRecord(simTime,rx,ry,rz,r,spoofMode?1:0,spoofMode,inNoFly));
+        if(!r.valid) continue;
+
+        scenario.truePath.push_back({waypoints_ll[wp][0],waypoints_ll[wp][1]});
+        estX.push_back(r.estX); estY.push_back(r.estY); estZ.push_back(r.estZ);
+        scenario.spoofDetected.push_back(r.detection.spoofingDetected);
+        scenario.inNoFly.push_back(inNoFly);
+    }
+
+    // The solver's fixes on the map, converted in one batch
+    const int n=(int)estX.size();
+    std::vector<double> lat(n),lon(n),alt(n);
+    ecef_to_lla(estX.data(),estY.data(),estZ.data(),n,lat.data(),lon.data(),alt.data());
+    for(int i=0;i<n;i++) scenario.estPath.push_back({lat[i],lon[i]});
+    return scenario;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "Constellation.h"
+#include "Spoofer.h"
+#include "Attack.h"
+#include "Detector.h"
+#include "EpochBuffer.h"
+#include "Solver.h"
+#include "NavFilter.h"
+#include "Random.h"
+#include "Visibility.h"
+#include "MeasurementErrors.h"
+#include "Visualizer.h"
+#include "Geodesy.h"
+
+class TraceWriter;
+struct TraceRecord;
+
+// How EpochPipeline turns an epoch's pseudoranges into a fix
+enum NavigationMode {
+    NAV_SNAPSHOT,       // least squares per epoch (warm-started Gauss-Newton)
+    NAV_FILTER,         // EKF carried across epochs; a snapshot fix seeds it
+};
+
+// Output of one pass through the epoch pipeline
+struct EpochResult {
+    bool   valid;      // false if fewer than 4 satellites were visible
+    int    visible;
+    double estX, estY, estZ, clockBias;
+    DetectionResult detection;
+};
+
+// Optional error pass of formPseudoranges(): the model's components are
+// added when `components` is not ERROR_NONE
+struct RangeErrors {
+    const MeasurementErrors* model = nullptr;
+    uint32_t      components = ERROR_NONE;
+    ReceiverSite* site   = nullptr;     // the receiver's, kept between epochs
+    double*       scratch = nullptr;    // VisibleSet::padded(visible.size())
+};
+
+// Fills `epoch` with the satellites of `visible` and one receiver's
+// pseudoranges to them at `time`: signal-path ranges from (rx, ry, rz),
+// then the model's errors, the receiver clock bias (m) and white noise of
+// `noiseSigma` (m) drawn from `noise`. Shared by EpochPipeline and Fleet,
+// so a receiver measures the same either way.
+void formPseudoranges(const Constellation& satellites, const VisibleSet& visible, double time,
+                      double rx, double ry, double rz, double clockBias,
+                      double noiseSigma, Rng& noise, const RangeErrors& errors, EpochBuffer& epoch);
+
+// One receiver's per-epoch processing chain: propagate, select satellites
+// above the elevation mask, form pseudoranges, optionally spoof, solve and
+// run the detector. All scratch storage is owned here and reused, so
+// steady-state epochs make no heap allocations.
+class EpochPipeline {
+private:
+    Constellation& satellites;
+    Spoofer        spoofer;
+    const AttackEngine* attack = nullptr;
+    Detector       detector;
+    PositionSolver solver;     // warm-starts from the previous epoch's fix
+    NavFilter<8>   filter;
+    NavigationMode navigation = NAV_SNAPSHOT;
+    VisibilityEngine visibility;
+    VisibleSet     visibleSats;
+    EpochBuffer    epoch;
+    double         clockBiasTrue;
+    double         noiseSigma = 0.0;
+    Rng            noise;
+    const MeasurementErrors* errorModel = nullptr;
+    uint32_t       errorComponents = ERROR_NONE;
+    ReceiverSite   site;
+    std::vector<double> rangeErrors;   // per visible satellite, this epoch
+
+public:
+    EpochPipeline(Constellation& satellites, const Spoofer& spoofer, double clockBiasTrue);
+
+    // White Gaussian pseudorange noise (metres, 1-sigma) from a seeded
+    // stream; the detector's integrity check assumes the same sigma (at
+    // least 1 m)
+    void setRangeNoise(double sigma, uint64_t seed);
+
+    // Adds the model's atmospheric, multipath and satellite-clock errors
+    // (ErrorComponent mask) to every pseudorange; nullptr or ERROR_NONE
+    // leaves them geometric. Not owned; must outlive the pipeline's use.
+    void setMeasurementErrors(const MeasurementErrors* model, uint32_t components = ERROR_ALL) {
+        errorModel = model; errorComponents = model ? components : ERROR_NONE;
+    }
+
+    // Satellites below this elevation are not tracked (default 5 degrees)
+    void setElevationMask(double deg) { visibility.setMask(deg); }
+
+    // NAV_FILTER tracks the receiver with the EKF (reseeded from a snapshot
+    // fix when switched on) and feeds its innovations to the detector
+    void setNavigation(NavigationMode mode) { navigation = mode; filter.reset(); }
+    NavigationMode getNavigation() const { return navigation; }
+    const NavFilter<8>& navFilter() const { return filter; }
+
+    void setDetectorThresholds(const DetectorThresholds& t) { detector.setThresholds(t); }
+
+    // Replaces the spoofer (e.g. to ramp its power during a drag-off)
+    void setSpoofer(const Spoofer& s) { spoofer = s; }
+
+    // Spoofed epochs follow these attack profiles instead of the spoofer
+    // (nullptr restores it). Not owned; must outlive the pipeline's use.
+    void setAttack(const AttackEngine* a) { attack = a; }
+
+    // `signal` passes the tracking loops' correlator measurements, if the
+    // receiver is simulated at sample level, on to the detector
+    EpochResult step(double simTime, double rx, double ry, double rz,
+                     double dt, bool spoofMode, const SignalQualityView* signal = nullptr);
+
+    const EpochBuffer& buffer() const { return epoch; }
+
+    // Satellites used in the last epoch with their elevation/azimuth, in
+    // the same order as buffer()
+    const VisibleSet& visible() const { return visibleSats; }
+};
+
+// Packs one epoch (truth, fix and detector scores) into a trace record
+TraceRecord makeTraceRecord(double simTime, double rx, double ry, double rz,
+                            const EpochResult& r, uint32_t run, bool spoofActive, bool inNoFly);
+
+// The 6-plane x 4-satellite GPS-like constellation (Walker 24/6/4) used by
+// the scenarios
+Constellation buildGpsConstellation();
+
+// A no-fly circle on the local horizontal, tested with ENU distances
+struct NoFlyZone {
+    LocalFrame frame;
+    double     radius;      // m
+
+    bool contains(double x, double y, double z) const {
+        return frame.horizontalDistanceSq(x, y, z) < radius * radius;
+    }
+};
+
+// The scenarios' no-fly zone: 5 km round Toronto Pearson
+NoFlyZone pearsonNoFlyZone();
+
+// CN Tower -> Pearson drone flight, optionally under spoofing. Every epoch
+// is also appended to `trace` (if given) with run id = spoofMode.
+ScenarioState runScenario(bool spoofMode, TraceWriter* trace = nullptr);
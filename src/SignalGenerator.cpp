@@ -0,0 +1,170 @@
+#include "SignalGenerator.h"
+#include <cmath>
+#include <algorithm>
+
+#include "CaCode.h"
+#include "Constellation.h"
+#include "GnssSystems.h"
+#include "Visibility.h"
+#include "Spoofer.h"
+#include "Random.h"
+#include "SignalPath.h"
+
+static const int    GAUSS_TABLE    = 1 << 16;
+static const int    BLOCK          = 4096;     // samples per pass over the sources
+
+SignalGenerator::SignalGenerator(const SignalConfig& config)
+    : config(config)
+    , amplitude((float)std::sqrt(2.0 * std::pow(10.0, config.cn0 / 10) / config.sampleRate))
+    , noiseState(config.seed | 1)
+{
+    // Noise is drawn by indexing a table of Gaussian samples with a fast
+    // generator: far cheaper than Box-Muller per sample, and 2^16 entries
+    // are plenty for acquisition and tracking statistics
+    Rng rng(config.seed);
+    gauss.resize(GAUSS_TABLE);
+    for (auto& g : gauss) g = (float)rng.gaussian();
+}
+
+void SignalGenerator::addSource(int prn, bool spoofed, double range, double rangeRate,
+                                double time, float amp)
+{
+    SignalSource s;
+    s.prn      = prn;
+    s.spoofed  = spoofed;
+    s.doppler  = -rangeRate / SPEED_OF_LIGHT * CaCodeTable::L1_FREQ;
+    s.codeRate = CaCodeTable::CHIP_RATE * (1.0 + s.doppler / CaCodeTable::L1_FREQ);
+    // Code phase of the signal transmitted range/c before `time`
+    double chips = std::fmod((time - range / SPEED_OF_LIGHT) * CaCodeTable::CHIP_RATE,
+                             (double)CaCodeTable::CHIPS);
+    s.codePhase    = chips < 0 ? chips + CaCodeTable::CHIPS : chips;
+    s.carrierPhase = 0.0;
+    s.amplitude    = amp;
+    sources.push_back(s);
+}
+
+void SignalGenerator::setSky(const Constellation& satellites, const VisibleSet& visible,
+                             double rx, double ry, double rz, double clockBias, double time,
+                             const Spoofer* spoofer)
+{
+    previous.swap(sources);
+    sources.clear();
+    sources.reserve(2 * visible.size());
+
+    // Range and range rate of satellite i seen from (ox, oy, oz)
+    auto geometry = [&](int i, double ox, double oy, double oz, double& range, double& rate) {
+        double pos[3] = {satellites.getX(i), satellites.getY(i), satellites.getZ(i)}, v[3], tx, ty, tz;
+        satellites.getVelocity(i, v);
+        range = signalPath(pos, v, ox, oy, oz, tx, ty, tz);
+        double dx = tx - ox, dy = ty - oy, dz = tz - oz;
+        rate = (v[0] * dx + v[1] * dy + v[2] * dz) / range;
+    };
+    // C/A PRN of satellite i; 0 if it transmits no C/A code we can make
+    auto caPrn = [&](int i) {
+        int prn = satellites.getPrn(i);
+        return satellites.getSystem(i) == SYSTEM_GPS && prn >= 1 && prn <= CaCodeTable::MAX_PRN ? prn : 0;
+    };
+
+    for (int k = 0; k < visible.size(); k++) {
+        int i = visible.satellite(k), prn = caPrn(i);
+        if (prn == 0) continue;
+        double range, rate;
+        geometry(i, rx, ry, rz, range, rate);
+        addSource(prn, false, range + clockBias, rate, time, amplitude);
+    }
+
+    // Counterfeits are timed like Spoofer::spoofPseudoranges: a power-weighted
+    // blend of the true range and the range from the spoofer's fake (static)
+    // position, so a ramping power is a code-phase drag-off that starts
+    // aligned with the authentic signal
+    if (spoofer && spoofer->getPower() > 0) {
+        const double p = spoofer->getPower();
+        const float fakeAmp = amplitude * (float)std::pow(10.0, config.spooferAdvantage / 20);
+        for (int k = 0; k < visible.size(); k++) {
+            int i = visible.satellite(k), prn = caPrn(i);
+            if (prn == 0) continue;
+            double range, rate, fakeRange, fakeRate;
+            geometry(i, rx, ry, rz, range, rate);
+            geometry(i, spoofer->getFakeX(), spoofer->getFakeY(), spoofer->getFakeZ(), fakeRange, fakeRate);
+            addSource(prn, true, (1 - p) * range + p * fakeRange + clockBias,
+                      (1 - p) * rate + p * fakeRate, time, fakeAmp);
+        }
+    }
+    finishSky();
+}
+
+void SignalGenerator::finishSky() {
+    // Keep the carrier running for signals that were already on air
+    for (auto& s : sources)
+        for (const auto& p : previous)
+            if (p.prn == s.prn && p.spoofed == s.spoofed) { s.carrierPhase = p.carrierPhase; break; }
+
+    rotCos.resize(sources.size() * CHUNK);
+    rotSin.resize(sources.size() * CHUNK);
+    for (size_t s = 0; s < sources.size(); s++)
+        for (int k = 0; k < CHUNK; k++) {
+            double a = 2 * M_PI * sources[s].doppler / config.sampleRate * k;
+            rotCos[s * CHUNK + k] = (float)std::cos(a);
+            rotSin[s * CHUNK + k] = (float)std::sin(a);
+        }
+}
+
+void SignalGenerator::generate(int count, float* re, float* im) {
+    const CaCodeTable& codes = CaCodeTable::instance();
+    const double fs = config.sampleRate;
+    const float* g = gauss.data();
+
+    for (int b0 = 0; b0 < count; b0 += BLOCK) {
+        const int bn = std::min(BLOCK, count - b0);
+        float* __restrict bre = re + b0;
+        float* __restrict bim = im + b0;
+
+        // ===== Noise: one xorshift64* draw gives two complex samples =====
+        uint64_t x = noiseState;
+        for (int i = 0; i < bn; i += 2) {
+            x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+            uint64_t r = x * 0x2545F4914F6CDD1DULL;
+            bre[i] = g[r & 0xFFFF];
+            bim[i] = g[(r >> 16) & 0xFFFF];
+            if (i + 1 < bn) {
+                bre[i + 1] = g[(r >> 32) & 0xFFFF];
+                bim[i + 1] = g[r >> 48];
+            }
+        }
+        noiseState = x;
+
+        // ===== Signals: code x carrier, accumulated per source =====
+        for (size_t s = 0; s < sources.size(); s++) {
+            SignalSource& src = sources[s];
+            const uint64_t* code = codes.code(src.prn);
+            const float* rc = &rotCos[s * CHUNK];
+            const float* rs = &rotSin[s * CHUNK];
+            const double chipsPerSample  = src.codeRate / fs;
+            const double cyclesPerSample = src.doppler / fs;
+            const uint64_t step = (uint64_t)(chipsPerSample * 4294967296.0);
+
+            for (int i0 = 0; i0 < bn; i0 += CHUNK) {
+                const int m = std::min(CHUNK, bn - i0);
+                double a = 2 * M_PI * src.carrierPhase;
+                float c0 = src.amplitude * (float)std::cos(a);
+                float s0 = src.amplitude * (float)std::sin(a);
+                // 32.32 fixed-point code phase; a chunk spans < 64 chips, so
+                // indices stay inside the table's wrapped tail
+                uint64_t p0 = (uint64_t)(src.codePhase * 4294967296.0);
+                float* __restrict ore = bre + i0;
+                float* __restrict oim = bim + i0;
+                #pragma omp simd
+                for (int k = 0; k < m; k++) {
+                    uint64_t idx = (p0 + (uint64_t)k * step) >> 32;
+                    float sign = 1.0f - 2.0f * (float)((code[idx >> 6] >> (idx & 63)) & 1);
+                    ore[k] += sign * (c0 * rc[k] - s0 * rs[k]);
+                    oim[k] += sign * (s0 * rc[k] + c0 * rs[k]);
+                }
+                src.codePhase += m * chipsPerSample;
+                if (src.codePhase >= CaCodeTable::CHIPS) src.codePhase -= CaCodeTable::CHIPS;
+                src.carrierPhase += m * cyclesPerSample;
+                src.carrierPhase -= std::floor(src.carrierPhase);
+            }
+        }
+    }
+}
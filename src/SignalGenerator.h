@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+class Constellation;
+class VisibleSet;
+class Spoofer;
+
+struct SignalConfig {
+    double   sampleRate       = 4.096e6;    // Hz, complex baseband
+    double   cn0              = 45.0;       // dB-Hz of each authentic signal
+    double   spooferAdvantage = 3.0;        // dB of counterfeit over authentic power
+    uint64_t seed             = 1;
+};
+
+// One ranging signal in the sample stream
+struct SignalSource {
+    int    prn;
+    bool   spoofed;
+    double codePhase;       // chips at the next sample, [0, 1023)
+    double codeRate;        // chips/s, including code Doppler
+    double doppler;         // Hz
+    double carrierPhase;    // cycles at the next sample, [0, 1)
+    float  amplitude;
+};
+
+// GPS L1 C/A complex baseband sample generator. Each visible GPS satellite
+// with PRN 1-32 contributes its C/A code x carrier at the code phase and
+// Doppler its geometry implies (other systems are left out); a spoofer adds a
+// counterfeit of every signal, timed and Doppler-shifted for the range it
+// forges. Noise is complex white Gaussian with unit variance per
+// component, so the signal amplitude follows from C/N0.
+//
+// Samples are produced in chunks of CHUNK: per source the carrier phasor
+// is evaluated once per chunk and rotated by a per-source table, and the
+// code is read from the bit-packed table with a fixed-point phase, so the
+// per-sample loop is branch-free multiply-adds.
+class SignalGenerator {
+public:
+    static const int CHUNK = 64;
+
+private:
+    SignalConfig config;
+    float        amplitude;                 // of an authentic signal
+    std::vector<SignalSource> sources;
+    std::vector<SignalSource> previous;     // sources before the last setSky()
+    std::vector<float> rotCos, rotSin;      // [source * CHUNK + k], carrier turn over k samples
+    std::vector<float> gauss;               // N(0,1) draws indexed by the noise stream
+    uint64_t noiseState;
+
+    void addSource(int prn, bool spoofed, double range, double rangeRate, double time, float amp);
+    void finishSky();
+
+public:
+    explicit SignalGenerator(const SignalConfig& config);
+
+    // Replaces the sources with the satellites in `visible` as received at
+    // (rx, ry, rz) with a clock bias (m), for a stream whose next sample is
+    // taken at receiver time `time`. Counterfeits are added if `spoofer`
+    // is given with non-zero power, at the spoofer's blended range.
+    // Carrier phase carries over for signals already present.
+    void setSky(const Constellation& satellites, const VisibleSet& visible,
+                double rx, double ry, double rz, double clockBias, double time,
+                const Spoofer* spoofer = nullptr);
+
+    // Writes the next `count` samples
+    void generate(int count, float* re, float* im);
+
+    const std::vector<SignalSource>& getSources() const { return sources; }
+    double getSampleRate() const { return config.sampleRate; }
+};
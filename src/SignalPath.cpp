@@ -0,0 +1,18 @@
+#include "SignalPath.h"
+
+void signalRanges(const EpochView& epoch, double rx, double ry, double rz, double* ranges) {
+    const double* pos = epoch.pos;
+    const double* vel = epoch.vel;
+    const int n = epoch.count;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) ranges[i] = signalRange(pos + 3 * i, vel + 3 * i, rx, ry, rz);
+}
+
+void transmitPositions(const EpochView& epoch, double rx, double ry, double rz, double* tx) {
+    const double* pos = epoch.pos;
+    const double* vel = epoch.vel;
+    const int n = epoch.count;
+    #pragma omp simd
+    for (int i = 0; i < n; i++)
+        signalPath(pos + 3 * i, vel + 3 * i, rx, ry, rz, tx[3 * i], tx[3 * i + 1], tx[3 * i + 2]);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cmath>
+#include "EpochBuffer.h"
+
+const double SPEED_OF_LIGHT = 299792458.0;         // m/s
+const double EARTH_ROTATION = 7.2921151467e-5;     // rad/s, WGS-84
+
+// Path of a signal from a satellite to a receiver, both in ECEF at the
+// receive time.
+//
+// The signal left the satellite tau = range / c earlier (about 70 ms from
+// MEO), when the satellite was some 270 m back along its track. While it
+// was in flight the Earth turned by omega tau, so in the receive-time frame
+// the transmit position is rotated about the polar axis (the Sagnac term,
+// up to ~30 m of range). tau is found by fixed-point iteration from the
+// geometric range, which is off by up to ~110 m; each pass shrinks the
+// error by v / c ~ 1e-5, so one pass leaves about a millimetre. The
+// satellite is moved back on its current velocity (its orbital
+// acceleration adds ~2 mm over the flight) and the rotation, ~5e-7 rad, is
+// applied to second order.
+//
+// The pass count is fixed and there are no branches, so the batch forms
+// vectorize across the satellites of an epoch, and the inline form can sit
+// inside callers' own vectorized loops.
+static const int LIGHT_TIME_ITERATIONS = 1;
+
+// Returns the range from the satellite's transmit position in the
+// receive-time frame to (rx, ry, rz), and that position in (tx, ty, tz).
+// The position comes back through references rather than an array so the
+// call vectorizes inside a caller's loop.
+inline double signalPath(const double pos[3], const double vel[3], double rx, double ry, double rz,
+                         double& tx, double& ty, double& tz) {
+    const double sx = pos[0], sy = pos[1], sz = pos[2];
+    const double vx = vel[0], vy = vel[1], vz = vel[2];
+    tx = sx; ty = sy; tz = sz;
+    double dx = sx - rx, dy = sy - ry, dz = sz - rz;
+    double range = std::sqrt(dx*dx + dy*dy + dz*dz);
+    for (int k = 0; k < LIGHT_TIME_ITERATIONS; k++) {
+        const double tau = range * (1.0 / SPEED_OF_LIGHT);
+        const double theta = EARTH_ROTATION * tau;
+        const double c = 1.0 - 0.5 * theta * theta;
+        const double px = sx - vx * tau, py = sy - vy * tau;
+        tx = c * px + theta * py;
+        ty = c * py - theta * px;
+        tz = sz - vz * tau;
+        dx = tx - rx; dy = ty - ry; dz = tz - rz;
+        range = std::sqrt(dx*dx + dy*dy + dz*dz);
+    }
+    return range;
+}
+
+inline double signalRange(const double pos[3], const double vel[3], double rx, double ry, double rz) {
+    double tx, ty, tz;
+    return signalPath(pos, vel, rx, ry, rz, tx, ty, tz);
+}
+
+// Ranges from (rx, ry, rz) to every satellite of `epoch`
+void signalRanges(const EpochView& epoch, double rx, double ry, double rz, double* ranges);
+
+// Transmit positions (x, y, z triples) of every satellite of `epoch` as
+// seen from (rx, ry, rz). Geometric ranges from them are signal ranges, to
+// 1.3 cm for each km the receiver is from (rx, ry, rz).
+void transmitPositions(const EpochView& epoch, double rx, double ry, double rz, double* tx);
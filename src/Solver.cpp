@@ -0,0 +1,362 @@
+#include "Solver.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Instrument.h"
+#include "SignalPath.h"
+
+bool cholesky4Solve(const double A[4][4], const double b[4], double x[4]) {
+    // A = R^T R with R upper triangular (unrolled)
+    double r00 = A[0][0];
+    if (!(r00 > 1e-12)) return false;
+    r00 = std::sqrt(r00);
+    double r01 = A[0][1] / r00, r02 = A[0][2] / r00, r03 = A[0][3] / r00;
+    double r11 = A[1][1] - r01 * r01;
+    if (!(r11 > 1e-12)) return false;
+    r11 = std::sqrt(r11);
+    double r12 = (A[1][2] - r01 * r02) / r11;
+    double r13 = (A[1][3] - r01 * r03) / r11;
+    double r22 = A[2][2] - r02 * r02 - r12 * r12;
+    if (!(r22 > 1e-12)) return false;
+    r22 = std::sqrt(r22);
+    double r23 = (A[2][3] - r02 * r03 - r12 * r13) / r22;
+    double r33 = A[3][3] - r03 * r03 - r13 * r13 - r23 * r23;
+    if (!(r33 > 1e-12)) return false;
+    r33 = std::sqrt(r33);
+
+    // R^T y = b, then R x = y
+    double y0 = b[0] / r00;
+    double y1 = (b[1] - r01 * y0) / r11;
+    double y2 = (b[2] - r02 * y0 - r12 * y1) / r22;
+    double y3 = (b[3] - r03 * y0 - r13 * y1 - r23 * y2) / r33;
+    x[3] = y3 / r33;
+    x[2] = (y2 - r23 * x[3]) / r22;
+    x[1] = (y1 - r12 * x[2] - r13 * x[3]) / r11;
+    x[0] = (y0 - r01 * x[1] - r02 * x[2] - r03 * x[3]) / r00;
+    return true;
+}
+
+std::array<double,4> solvePositionLeastSquares(
+    const EpochView& epoch,
+    double initX,double initY,double initZ)
+{
+    GNSS_STAGE(STAGE_SOLVE);
+    double x=initX,y=initY,z=initZ,clockBias=0;
+    int iterations=0;
+    for(int iter=0;iter<20;iter++){
+        double HtH[4][4]={0},Htr[4]={0};
+        for(int i=0;i<epoch.count;i++){
+            double sx,sy,sz;
+            double range=signalPath(epoch.sat(i),epoch.velocity(i),x,y,z,sx,sy,sz);
+            double dx=x-sx,dy=y-sy,dz=z-sz;
+            if(range<1) continue;
+            double res=epoch.ranges[i]-(range+clockBias);
+            double H[4]={dx/range,dy/range,dz/range,1};
+            for(int r=0;r<4;r++){Htr[r]+=H[r]*res;for(int c=r;c<4;c++)HtH[r][c]+=H[r]*H[c];}
+        }
+        double d[4];
+        if(!cholesky4Solve(HtH,Htr,d)) break;
+        double du=d[0],dv=d[1],dw=d[2],db=d[3];
+        const double ms=1e5;
+        x+=std::max(-ms,std::min(ms,du)); y+=std::max(-ms,std::min(ms,dv));
+        z+=std::max(-ms,std::min(ms,dw)); clockBias+=db;
+        iterations++;
+        if(fabs(du)<1e-4&&fabs(dv)<1e-4&&fabs(dw)<1e-4)break;
+    }
+    GNSS_SOLVER_ITERATIONS(iterations);
+    return {x,y,z,clockBias};
+}
+
+// Lorentz inner product <a,b> = a1b1 + a2b2 + a3b3 - a4b4
+static inline double lorentz(const double a[4], const double b[4]) {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2] - a[3]*b[3];
+}
+
+bool bancroftFix(const EpochView& epoch, std::array<double,4>& out) {
+    const int n = epoch.count;
+    if (n < 4) return false;
+
+    // Rows a_i = (s_i, rho_i); solve B M y = alpha + lambda 1 in the
+    // least-squares sense with u = B+ 1 and v = B+ alpha, B+ = (B^T B)^-1 B^T.
+    // Coordinates are centred on the satellites' mean position to keep
+    // B^T B well conditioned; the centring is undone at the end.
+    double c[3] = {0, 0, 0};
+    for (int i = 0; i < n; i++)
+        for (int k = 0; k < 3; k++) c[k] += epoch.sat(i)[k];
+    for (int k = 0; k < 3; k++) c[k] /= n;
+
+    double BtB[4][4] = {{0}}, Bt1[4] = {0}, BtA[4] = {0};
+    for (int i = 0; i < n; i++) {
+        const double* s = epoch.sat(i);
+        double a[4] = {s[0] - c[0], s[1] - c[1], s[2] - c[2], epoch.ranges[i]};
+        double alpha = 0.5 * lorentz(a, a);
+        for (int r = 0; r < 4; r++) {
+            Bt1[r] += a[r];
+            BtA[r] += a[r] * alpha;
+            for (int k = r; k < 4; k++) BtB[r][k] += a[r] * a[k];
+        }
+    }
+    double u[4], v[4];
+    if (!cholesky4Solve(BtB, Bt1, u) || !cholesky4Solve(BtB, BtA, v)) return false;
+
+    // lambda solves <u,u> l^2 + 2(<u,v> - 1) l + <v,v> = 0
+    double qa = lorentz(u, u), qb = 2 * (lorentz(u, v) - 1), qc = lorentz(v, v);
+    double disc = qb * qb - 4 * qa * qc;
+    if (disc < 0) disc = 0;
+    double sq = std::sqrt(disc);
+    double roots[2];
+    int nRoots;
+    if (std::fabs(qa) < 1e-30) { roots[0] = -qc / qb; nRoots = 1; }
+    else { roots[0] = (-qb + sq) / (2 * qa); roots[1] = (-qb - sq) / (2 * qa); nRoots = 2; }
+
+    // Of the two candidates keep the one that best fits the pseudoranges
+    double bestCost = 1e300;
+    for (int k = 0; k < nRoots; k++) {
+        double l = roots[k];
+        double y[4] = {v[0] + l * u[0], v[1] + l * u[1], v[2] + l * u[2], -(v[3] + l * u[3])};
+        double cost = 0;
+        for (int i = 0; i < n; i++) {
+            const double* s = epoch.sat(i);
+            double dx = y[0] - (s[0] - c[0]), dy = y[1] - (s[1] - c[1]), dz = y[2] - (s[2] - c[2]);
+            double e = epoch.ranges[i] - (std::sqrt(dx*dx + dy*dy + dz*dz) + y[3]);
+            cost += e * e;
+        }
+        if (cost < bestCost) {
+            bestCost = cost;
+            out = {y[0] + c[0], y[1] + c[1], y[2] + c[2], y[3]};
+        }
+    }
+    return bestCost < 1e300;
+}
+
+template<int L, int S>
+BatchPositionSolver<L, S>::BatchPositionSolver() {
+    for (int k = 0; k < 256; k++) clockOf[k] = std::min(k, S - 1);
+    reset();
+}
+
+template<int L, int S>
+void BatchPositionSolver<L, S>::reset() {
+    for (int l = 0; l < L; l++) havePrev[l] = false;
+}
+
+template<int L, int S>
+void BatchPositionSolver<L, S>::seedLane(int lane, double x, double y, double z, double clockBias) {
+    prev[0][lane] = x; prev[1][lane] = y; prev[2][lane] = z;
+    for (int k = 3; k < STATES; k++) prev[k][lane] = clockBias;
+    havePrev[lane] = true;
+}
+
+// Limits a position update to 100 km per iteration (branch-free form of
+// std::max/std::min, which take references and defeat vectorization)
+static inline double clampStep(double d) {
+    const double ms = 1e5;
+    return d > ms ? ms : (d < -ms ? -ms : d);
+}
+
+// Index of (r, c), r <= c, in a row-major packed upper triangle of size D
+template<int D>
+constexpr int tri(int r, int c) { return r * D - r * (r - 1) / 2 + (c - r); }
+
+template<int L, int S>
+void BatchPositionSolver<L, S>::reserve(int maxSatellites) {
+    if ((int)mask.size() >= maxSatellites * L) return;
+    sx.resize(maxSatellites * L); sy.resize(maxSatellites * L); sz.resize(maxSatellites * L);
+    pr.resize(maxSatellites * L); mask.resize(maxSatellites * L);
+    tx.resize(3 * maxSatellites);
+    if (S > 1) clk.resize(maxSatellites * L);
+}
+
+template<int L, int S>
+void BatchPositionSolver<L, S>::solve(const EpochView* epochs, PositionFix* out) {
+    GNSS_STAGE(STAGE_SOLVE);
+    const int D = STATES;
+    const int T = D * (D + 1) / 2;
+
+    // ===== Initial state: previous solution, else Bancroft =====
+    // Lane flags are kept as 0/1 doubles so every per-lane loop below is
+    // branch-free; `omp simd` (enabled with -fopenmp-simd, no OpenMP runtime)
+    // asks the compiler to vectorize across lanes.
+    double st[D][L];
+    double live[L];     // 1 while the lane is still iterating
+    double ok[L];       // 1 while every factorization of the lane succeeded
+    double iters[L];
+    bool   active[L];
+    for (int l = 0; l < L; l++) {
+        active[l] = epochs[l].count >= 4;
+        for (int k = 0; k < D; k++) st[k][l] = active[l] ? prev[k][l] : 0.0;
+        // A cold lane starts from Bancroft; it only becomes a warm start
+        // once it converges, and a lane Bancroft cannot place sits out
+        if (active[l] && !havePrev[l]) {
+            std::array<double,4> b;
+            if (bancroftFix(epochs[l], b)) {
+                st[0][l] = b[0]; st[1][l] = b[1]; st[2][l] = b[2];
+                for (int k = 3; k < D; k++) st[k][l] = b[3];
+            } else {
+                active[l] = false;
+                for (int k = 0; k < D; k++) st[k][l] = 0.0;
+            }
+        }
+        live[l]  = active[l] ? 1.0 : 0.0;
+        ok[l]    = live[l];
+        iters[l] = 0.0;
+    }
+
+    // ===== Pack satellites lane-interleaved; short lanes are masked out =====
+    // Transmit positions as seen from the initial state
+    int maxN = 0;
+    for (int l = 0; l < L; l++) maxN = std::max(maxN, epochs[l].count);
+    reserve(maxN);
+    for (int l = 0; l < L; l++) {
+        const EpochView& e = epochs[l];
+        transmitPositions(e, st[0][l], st[1][l], st[2][l], tx.data());
+        for (int i = 0; i < maxN; i++) {
+            int k = i * L + l;
+            if (i < e.count) {
+                sx[k] = tx[3 * i]; sy[k] = tx[3 * i + 1]; sz[k] = tx[3 * i + 2];
+                pr[k] = e.ranges[i]; mask[k] = 1.0;
+                if (S > 1) clk[k] = clockOf[e.systems[i]];
+            } else {
+                sx[k] = sy[k] = sz[k] = 0.0;
+                pr[k] = 0.0; mask[k] = 0.0;
+                if (S > 1) clk[k] = 0.0;
+            }
+        }
+    }
+
+    const double* __restrict SX = sx.data();
+    const double* __restrict SY = sy.data();
+    const double* __restrict SZ = sz.data();
+    const double* __restrict PR = pr.data();
+    const double* __restrict MK = mask.data();
+    const double* __restrict CK = clk.data();
+
+    alignas(64) double nm[T][L];        // H^T H, packed upper triangle
+    alignas(64) double g[D][L];         // H^T r
+    for (int iter = 0; iter < MAX_ITERATIONS; iter++) {
+        double anyLive = 0;
+        for (int l = 0; l < L; l++) anyLive += live[l];
+        if (anyLive == 0) break;
+
+        #pragma omp simd
+        for (int l = 0; l < L; l++) {
+            #pragma GCC unroll 16
+            for (int t = 0; t < T; t++) nm[t][l] = 0;
+            #pragma GCC unroll 16
+            for (int r = 0; r < D; r++) g[r][l] = 0;
+        }
+        for (int i = 0; i < maxN; i++) {
+            const int k = i * L;
+            #pragma omp simd
+            for (int l = 0; l < L; l++) {
+                double dx = st[0][l] - SX[k + l];
+                double dy = st[1][l] - SY[k + l];
+                double dz = st[2][l] - SZ[k + l];
+                double r2 = dx*dx + dy*dy + dz*dz;
+                // Satellites closer than 1 m are ignored (as in the scalar solver)
+                double m = r2 >= 1.0 ? MK[k + l] : 0.0;
+                double range = std::sqrt(r2 >= 1.0 ? r2 : 1.0);
+                double inv = m / range;
+                // Row h = (line of sight, one-hot clock of the satellite's system)
+                double h[D];
+                h[0] = dx * inv; h[1] = dy * inv; h[2] = dz * inv;
+                double bias = 0.0;
+                #pragma GCC unroll 16
+                for (int c = 0; c < S; c++) {
+                    h[3 + c] = S == 1 ? m : (CK[k + l] == c ? m : 0.0);
+                    bias += h[3 + c] * st[3 + c][l];
+                }
+                double res = m * (PR[k + l] - range) - bias;
+                #pragma GCC unroll 16
+                for (int r = 0; r < D; r++) {
+                    g[r][l] += h[r] * res;
+                    #pragma GCC unroll 16
+                    for (int c = r; c < D; c++) nm[tri<D>(r, c)][l] += h[r] * h[c];
+                }
+            }
+        }
+
+        // Unrolled Cholesky + substitution, one lane per SIMD slot
+        #pragma omp simd
+        for (int l = 0; l < L; l++) {
+            // A system with no satellites this epoch: pin its clock
+            #pragma GCC unroll 16
+            for (int c = 1; c < S; c++) {
+                const int t = tri<D>(3 + c, 3 + c);
+                nm[t][l] += nm[t][l] == 0.0 ? 1.0 : 0.0;
+            }
+            // R^T R = N with the pivots kept as reciprocals: one division
+            // per row instead of one per entry
+            double R[T], rinv[D];
+            double spd = 1.0;
+            #pragma GCC unroll 16
+            for (int r = 0; r < D; r++) {
+                double p = nm[tri<D>(r, r)][l];
+                #pragma GCC unroll 16
+                for (int q = 0; q < r; q++) p -= R[tri<D>(q, r)] * R[tri<D>(q, r)];
+                spd *= p > 1e-12 ? 1.0 : 0.0;
+                rinv[r] = 1.0 / std::sqrt(p > 1e-12 ? p : 1.0);
+                #pragma GCC unroll 16
+                for (int c = r + 1; c < D; c++) {
+                    double v = nm[tri<D>(r, c)][l];
+                    #pragma GCC unroll 16
+                    for (int q = 0; q < r; q++) v -= R[tri<D>(q, r)] * R[tri<D>(q, c)];
+                    R[tri<D>(r, c)] = v * rinv[r];
+                }
+            }
+            double y[D], d[D];
+            #pragma GCC unroll 16
+            for (int r = 0; r < D; r++) {
+                double v = g[r][l];
+                #pragma GCC unroll 16
+                for (int q = 0; q < r; q++) v -= R[tri<D>(q, r)] * y[q];
+                y[r] = v * rinv[r];
+            }
+            #pragma GCC unroll 16
+            for (int r = D - 1; r >= 0; r--) {
+                double v = y[r];
+                #pragma GCC unroll 16
+                for (int q = r + 1; q < D; q++) v -= R[tri<D>(r, q)] * d[q];
+                d[r] = v * rinv[r];
+            }
+
+            // Finished or singular lanes keep their state; a singular one
+            // has failed
+            ok[l] *= 1.0 - live[l] * (1.0 - spd);
+            double keep = live[l] * spd;
+            st[0][l] += keep * clampStep(d[0]);
+            st[1][l] += keep * clampStep(d[1]);
+            st[2][l] += keep * clampStep(d[2]);
+            #pragma GCC unroll 16
+            for (int c = 3; c < D; c++) st[c][l] += keep * d[c];
+            iters[l] += live[l];
+            double conv = (std::fabs(d[0]) < 1e-4 ? 1.0 : 0.0) * (std::fabs(d[1]) < 1e-4 ? 1.0 : 0.0) *
+                          (std::fabs(d[2]) < 1e-4 ? 1.0 : 0.0);
+            live[l] = keep * (1.0 - conv);
+        }
+    }
+
+    for (int l = 0; l < L; l++) {
+        out[l].x = st[0][l]; out[l].y = st[1][l]; out[l].z = st[2][l];
+        out[l].clockBias = st[3][l];
+        for (int c = 0; c < MAX_GNSS_SYSTEMS - 1; c++)
+            out[l].systemBias[c] = c + 1 < S ? st[4 + (c + 1 < S ? c : 0)][l] - st[3][l] : 0.0;
+        out[l].iterations = (int)iters[l];
+        // Valid only if every step factorized and the lane converged within
+        // MAX_ITERATIONS; failed lanes keep their previous warm start
+        out[l].valid = active[l] && ok[l] == 1.0 && live[l] == 0.0;
+        if (active[l]) GNSS_SOLVER_ITERATIONS((int)iters[l]);
+        if (out[l].valid) {
+            for (int k = 0; k < D; k++) prev[k][l] = st[k][l];
+            havePrev[l] = true;
+        }
+    }
+}
+
+template class BatchPositionSolver<1>;
+template class BatchPositionSolver<4>;
+template class BatchPositionSolver<8>;
+template class BatchPositionSolver<1, 2>;
+template class BatchPositionSolver<1, 4>;
+template class BatchPositionSolver<4, 2>;
+template class BatchPositionSolver<4, 4>;
@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "EpochBuffer.h"
+
+// Iterative (Gauss-Newton) snapshot position fix from one epoch of
+// pseudoranges. Returns {x, y, z, clockBias}.
+std::array<double,4> solvePositionLeastSquares(
+    const EpochView& epoch,
+    double initX, double initY, double initZ);
+
+// Closed-form Bancroft fix (needs >= 4 satellites). Used to cold-start the
+// iterative solvers; returns false if the geometry is degenerate.
+bool bancroftFix(const EpochView& epoch, std::array<double,4>& out);
+
+// Solves the symmetric positive-definite 4x4 system A x = b by Cholesky.
+// Only the upper triangle of A is read. Returns false if A is not SPD.
+bool cholesky4Solve(const double A[4][4], const double b[4], double x[4]);
+
+// Satellite systems a solver can carry one clock bias each for
+static const int MAX_GNSS_SYSTEMS = 4;
+
+struct PositionFix {
+    double x, y, z, clockBias;      // clockBias: the first system's (m)
+    int    iterations;
+    bool   valid;
+    double systemBias[MAX_GNSS_SYSTEMS - 1];    // other systems' bias minus clockBias (m)
+};
+
+// Gauss-Newton solver for L independent epoch streams (receivers, or
+// separate recordings) at once. Each stream occupies one lane; all lanes
+// advance through the same fixed-size loops so the compiler keeps them in
+// SIMD registers. The normal matrix is assembled as its unique entries and
+// factorized with an unrolled Cholesky per lane.
+//
+// S is the number of satellite systems, each with its own receiver clock
+// bias (one inter-system offset per extra constellation), so the state has
+// 3 + S entries. Both L and S are compile-time constants: the single- and
+// dual-system kernels are fully unrolled, with no run-time sizing. A
+// satellite's system (EpochView::systems) selects its clock through
+// mapSystem(); by default GnssSystem k uses clock min(k, S - 1). A system
+// with no satellites in an epoch keeps its previous bias.
+//
+// Lanes remember their last solution and warm-start the next epoch from
+// it; a lane with no history is seeded with a Bancroft fix. Satellites are
+// taken at their transmit positions (SignalPath.h) as seen from that
+// starting point, found once per epoch, which holds the fix to 1.3 cm per
+// km it moves from the start. Scratch space grows to the largest satellite
+// count seen and is then reused.
+template<int L, int S = 1>
+class BatchPositionSolver {
+    static_assert(S >= 1 && S <= MAX_GNSS_SYSTEMS, "1 to MAX_GNSS_SYSTEMS satellite systems");
+
+public:
+    static const int STATES = 3 + S;
+
+private:
+    double prev[STATES][L];
+    bool   havePrev[L];
+    int    clockOf[256];                        // GnssSystem -> clock state
+    std::vector<double> sx, sy, sz, pr, mask;   // [sat * L + lane]
+    std::vector<double> clk;                    // [sat * L + lane] clock index, S > 1 only
+    std::vector<double> tx;                     // [sat * 3 + axis] one lane's transmit positions
+
+public:
+    static const int MAX_ITERATIONS = 20;
+
+    BatchPositionSolver();
+
+    void reset();
+    void resetLane(int lane) { havePrev[lane] = false; }
+
+    // Satellites of `system` use clock `clock` (0..S-1)
+    void mapSystem(int system, int clock) { clockOf[system & 255] = clock; }
+
+    // Pre-sizes scratch so epochs with up to maxSatellites never allocate
+    void reserve(int maxSatellites);
+
+    // Seeds a lane explicitly (e.g. from a known starting point); every
+    // system's clock starts at clockBias
+    void seedLane(int lane, double x, double y, double z, double clockBias);
+
+    // Solves epochs[0..L-1]. A lane without a warm start begins from a
+    // Bancroft fix. A lane whose epoch has fewer than 4 satellites, that
+    // Bancroft cannot place, whose normal matrix turns singular or which
+    // does not converge within MAX_ITERATIONS is reported invalid and keeps
+    // its previous warm start (none, for a cold lane).
+    void solve(const EpochView* epochs, PositionFix* out);
+};
+
+using PositionSolver = BatchPositionSolver<1>;
@@ -1,31 +1,25 @@
 #include "Spoofer.h"
 #include <cmath>
 
+#include "Instrument.h"
+#include "SignalPath.h"
+
 Spoofer::Spoofer(double fakeX, double fakeY, double fakeZ, double power)
     : fakeX(fakeX), fakeY(fakeY), fakeZ(fakeZ), power(power) {}
 
-std::vector<double> Spoofer::spoofPseudoranges(
-    const std::vector<std::vector<double>>& satPositions,
-    const std::vector<double>& realPseudoranges,
-    double clockBias)
+void Spoofer::spoofPseudoranges(
+    const EpochView& epoch,
+    double clockBias,
+    double* out) const
 {
-    std::vector<double> spoofed;
-
-    for (int i = 0; i < (int)satPositions.size(); i++) {
-        double sx = satPositions[i][0];
-        double sy = satPositions[i][1];
-        double sz = satPositions[i][2];
-
-        // Fake distance: from satellite to the fake receiver position
-        double dx = fakeX - sx;
-        double dy = fakeY - sy;
-        double dz = fakeZ - sz;
-        double fakeDist = sqrt(dx*dx + dy*dy + dz*dz) + clockBias;
+    GNSS_STAGE(STAGE_SPOOFING);
+    #pragma omp simd
+    for (int i = 0; i < epoch.count; i++) {
+        // Fake distance: the signal path from the satellite to the fake
+        // receiver position
+        double fakeDist = signalRange(epoch.sat(i), epoch.velocity(i), fakeX, fakeY, fakeZ) + clockBias;
 
         // Blend real and fake based on spoofer power
-        double blended = (1.0 - power) * realPseudoranges[i] + power * fakeDist;
-        spoofed.push_back(blended);
+        out[i] = (1.0 - power) * epoch.ranges[i] + power * fakeDist;
     }
-
-    return spoofed;
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 #pragma once
-#include <vector>
+#include "EpochBuffer.h"
 
 // A Spoofer injects fake pseudoranges to make the receiver
 // think it's at a different location (the "fake" position).
@@ -11,14 +11,16 @@ private:
 public:
     Spoofer(double fakeX, double fakeY, double fakeZ, double power = 1.0);
 
-    // Takes real pseudoranges and corrupts them to match the fake position
-    std::vector<double> spoofPseudoranges(
-        const std::vector<std::vector<double>>& satPositions,
-        const std::vector<double>& realPseudoranges,
-        double clockBias
-    );
+    // Takes real pseudoranges and corrupts them to match the fake position.
+    // Writes epoch.count values to `out`, which may alias epoch.ranges.
+    void spoofPseudoranges(
+        const EpochView& epoch,
+        double clockBias,
+        double* out
+    ) const;
 
     double getFakeX() const { return fakeX; }
     double getFakeY() const { return fakeY; }
     double getFakeZ() const { return fakeZ; }
+    double getPower() const { return power; }
 };
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "Sweep.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+#include "Scenario.h"
+#include "Spoofer.h"
+#include "Solver.h"
+#include "Geodesy.h"
+#include "Random.h"
+#include "SignalPath.h"
+
+// Same as EpochPipeline / runScenario
+static const double CLOCK_BIAS_TRUE = 0.12;
+static const int    DETECTOR_WINDOW = 10;
+
+// ===== Stage keys =====
+
+static uint64_t mix(uint64_t h, uint64_t v) {
+    return deriveSeed(h, v);
+}
+
+static uint64_t mix(uint64_t h, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof bits);
+    return mix(h, bits);
+}
+
+uint64_t SweepEngine::geometryKey(const ScenarioConfig& c) {
+    uint64_t h = mix((uint64_t)SWEEP_GEOMETRY, (uint64_t)c.route.size());
+    for (auto& w : c.route) h = mix(mix(mix(h, w[0]), w[1]), w[2]);
+    h = mix(h, c.speed);
+    h = mix(h, c.epochInterval);
+    h = mix(h, (uint64_t)c.errorModels);
+    return mix(h, scenarioStartTime(c));
+}
+
+uint64_t SweepEngine::rangesKey(const ScenarioConfig& c) {
+    uint64_t h = mix(geometryKey(c), (uint64_t)SWEEP_RANGES);
+    h = mix(h, c.rangeNoise);
+    h = mix(h, c.seed);
+    // Without a spoofer its position and start time change nothing
+    h = mix(h, c.spooferPower);
+    if (c.spooferPower > 0)
+        h = mix(mix(mix(mix(h, c.fakeLat), c.fakeLon), c.fakeAlt), c.spoofStart);
+    return h;
+}
+
+// ===== Cache =====
+
+SweepEngine::SweepEngine(int cacheEntries)
+    : capacity(std::max(1, cacheEntries))
+    , geometryCache(capacity)
+    , rangesCache(capacity)
+    , satellites(buildGpsConstellation())
+    , errorModel(defaultMeasurementErrors())
+{
+    epoch.reserve(satellites.size());
+    visible.reserve(satellites.size());
+    errors.resize(VisibleSet::padded(satellites.size()));
+}
+
+void SweepEngine::clear() {
+    for (auto& e : geometryCache) e.used = false;
+    for (auto& e : rangesCache) e.used = false;
+}
+
+// Returns the entry for `key`, or the least recently used one (re-keyed,
+// its buffers kept for reuse) with hit = false
+template<class T>
+T& SweepEngine::lookup(std::vector<Entry<T>>& cache, uint64_t key, SweepStage stage, bool& hit) {
+    Entry<T>* slot = &cache[0];
+    for (auto& e : cache) {
+        if (e.used && e.key == key) { slot = &e; break; }
+        if (!e.used || (slot->used && e.lastUse < slot->lastUse)) slot = &e;
+    }
+    hit = slot->used && slot->key == key;
+    slot->key = key;
+    slot->used = true;
+    slot->lastUse = ++useClock;
+    if (hit) counts.reused[stage]++;
+    else     counts.computed[stage]++;
+    return slot->value;
+}
+
+// ===== Stages =====
+
+void SweepEngine::computeGeometry(const ScenarioConfig& c, Geometry& g) {
+    g.track = scenarioTrack(c);
+    g.epochs = (int)g.track.size();
+    g.startTime = scenarioStartTime(c);
+    g.first.assign(1, 0);
+    g.pos.clear(); g.vel.clear(); g.range.clear(); g.id.clear(); g.system.clear(); g.prn.clear();
+    g.inNoFly.assign(g.epochs, 0);
+    site.valid = false;         // as a fresh pipeline
+
+    const NoFlyZone noFly = pearsonNoFlyZone();
+    for (int e = 0; e < g.epochs; e++) {
+        const double rx = g.track[e][0], ry = g.track[e][1], rz = g.track[e][2];
+        satellites.propagate(g.startTime + e * c.epochInterval);
+        visibility.setSatellites(satellites);
+        visibility.visibleAll(rx, ry, rz, visible);
+        if (c.errorModels != ERROR_NONE) {
+            errorModel.locate(site, rx, ry, rz);
+            errorModel.compute(g.startTime + e * c.epochInterval, site, visible, c.errorModels, errors.data());
+        }
+        const double *satX = satellites.x(), *satY = satellites.y(), *satZ = satellites.z();
+        for (int k = 0; k < visible.size(); k++) {
+            int i = visible.satellite(k);
+            double pos[3] = {satX[i], satY[i], satZ[i]}, vel[3];
+            satellites.getVelocity(i, vel);
+            g.pos.insert(g.pos.end(), pos, pos + 3);
+            g.vel.insert(g.vel.end(), vel, vel + 3);
+            double range = signalRange(pos, vel, rx, ry, rz);
+            if (c.errorModels != ERROR_NONE) range += errors[k];
+            g.range.push_back(range);
+            g.id.push_back(i);
+            g.system.push_back((uint8_t)satellites.getSystem(i));
+            g.prn.push_back(satellites.getPrn(i));
+        }
+        g.first.push_back((int)g.range.size());
+        g.inNoFly[e] = noFly.contains(rx, ry, rz);
+    }
+}
+
+void SweepEngine::computeRanges(const ScenarioConfig& c, const Geometry& g, Ranges& r) {
+    auto fake = lla_to_ecef(c.fakeLat, c.fakeLon, c.fakeAlt);
+    Spoofer spoofer(fake[0], fake[1], fake[2], c.spooferPower);
+    Rng noise(c.seed);
+    PositionSolver solver;
+    solver.reserve(satellites.size());
+    Detector detector(DETECTOR_WINDOW);
+    detector.reserve(satellites.size());
+    detector.raim().setRangeSigma(std::max(1.0, c.rangeNoise));
+
+    r.valid.assign(g.epochs, 0);
+    r.spoofed.assign(g.epochs, 0);
+    r.scores.resize(g.epochs);
+    r.base = {0, 0, 0, 0, -1.0, 0.0, false};
+    for (int e = 0; e < g.epochs; e++) {
+        double t = e * c.epochInterval;
+        epoch.clear();
+        for (int k = g.first[e]; k < g.first[e + 1]; k++) {
+            double pr = g.range[k] + CLOCK_BIAS_TRUE;
+            if (c.rangeNoise > 0) pr += c.rangeNoise * noise.gaussian();
+            epoch.push(g.pos[3 * k], g.pos[3 * k + 1], g.pos[3 * k + 2], &g.vel[3 * k], pr, g.id[k], g.system[k],
+                       g.prn[k]);
+        }
+        if (epoch.size() < 4) continue;
+        bool spoofNow = c.spooferPower > 0 && t >= c.spoofStart;
+        if (spoofNow) spoofer.spoofPseudoranges(epoch.view(), CLOCK_BIAS_TRUE, epoch.ranges());
+
+        EpochView view = epoch.view();
+        PositionFix fix;
+        solver.solve(&view, &fix);
+        if (!fix.valid) continue;
+        r.scores[e] = detector.analyze(fix.x, fix.y, fix.z, fix.clockBias, c.epochInterval, view);
+        r.valid[e] = 1;
+        r.spoofed[e] = spoofNow;
+
+        r.base.epochs++;
+        r.base.spoofedEpochs += spoofNow;
+        double ex = fix.x - g.track[e][0], ey = fix.y - g.track[e][1], ez = fix.z - g.track[e][2];
+        r.base.maxPositionError = std::max(r.base.maxPositionError, sqrt(ex*ex + ey*ey + ez*ez));
+        if (g.inNoFly[e]) r.base.enteredNoFly = true;
+    }
+}
+
+RunResult SweepEngine::verdict(const ScenarioConfig& c, const Ranges& r) const {
+    RunResult out = r.base;
+    const int epochs = (int)r.valid.size();
+    for (int e = 0; e < epochs; e++) {
+        if (!r.valid[e]) continue;
+        if (!(judgeDetection(c.detector, r.scores[e]) > c.detector.alarmLevel)) continue;
+        if (r.spoofed[e]) {
+            out.truePositives++;
+            if (out.detectionDelay < 0) out.detectionDelay = e * c.epochInterval - c.spoofStart;
+        } else {
+            out.falseAlarms++;
+        }
+    }
+    return out;
+}
+
+// ===== Driver =====
+
+void SweepEngine::run(const std::vector<ScenarioConfig>& points, std::vector<RunResult>& out) {
+    const int n = (int)points.size();
+    out.resize(n);
+    std::vector<std::array<uint64_t,2>> keys(n);
+    for (int i = 0; i < n; i++) keys[i] = {geometryKey(points[i]), rangesKey(points[i])};
+
+    // Group by geometry, then ranges, so shared outputs are still cached
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return keys[a] < keys[b]; });
+
+    for (int i : order) {
+        const ScenarioConfig& c = points[i];
+        bool hit;
+        Ranges& r = lookup(rangesCache, keys[i][1], SWEEP_RANGES, hit);
+        if (!hit) {
+            bool geometryHit;
+            Geometry& g = lookup(geometryCache, keys[i][0], SWEEP_GEOMETRY, geometryHit);
+            if (!geometryHit) computeGeometry(c, g);
+            computeRanges(c, g, r);
+        }
+        out[i] = verdict(c, r);
+        counts.computed[SWEEP_VERDICT]++;
+    }
+}
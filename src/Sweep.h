@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "MonteCarlo.h"
+#include "Constellation.h"
+#include "Visibility.h"
+#include "MeasurementErrors.h"
+#include "EpochBuffer.h"
+#include "Detector.h"
+
+// Stages of one sweep point, in dependency order. Each is keyed by the
+// ScenarioConfig fields it reads plus the key of the stage before it.
+enum SweepStage {
+    SWEEP_GEOMETRY,     // route, time grid: track, propagation, visibility, true ranges
+    SWEEP_RANGES,       // + noise, seed, spoofer: pseudoranges, fixes, detector scores
+    SWEEP_VERDICT,      // + detector thresholds: the point's RunResult
+    SWEEP_STAGE_COUNT
+};
+
+struct SweepStats {
+    long long computed[SWEEP_STAGE_COUNT] = {0, 0, 0};
+    long long reused[SWEEP_STAGE_COUNT]   = {0, 0, 0};
+};
+
+// Parameter-sweep driver that memoizes the pipeline stages shared between
+// sweep points.
+//
+// A point is a ScenarioConfig and its result is what runScenario() returns
+// for it. Points are evaluated in order of their stage keys, so points
+// that differ only downstream run back to back and find their upstream
+// outputs in a small per-stage cache (least recently used evicted). A
+// threshold sweep over one scenario therefore costs one geometry pass, one
+// ranges pass and one verdict per point; a spoofer-power sweep shares the
+// geometry only.
+//
+// The solver and the detector's statistics depend on nothing a
+// ScenarioConfig varies besides the pseudoranges (the RAIM sigma follows
+// the range noise), so they are cached with the ranges. The detector is
+// run once per ranges entry with its scores kept per epoch; a verdict is
+// judgeDetection() over them with the point's thresholds, a few dozen
+// flops per epoch.
+//
+// The stages mirror EpochPipeline::step and runScenario() step for step
+// (same draws, same order), so results are bit-identical to running the
+// points one by one. Keys are 64-bit hashes of the inputs.
+class SweepEngine {
+private:
+    struct Geometry {
+        int    epochs = 0;
+        double startTime = 0.0;
+        std::vector<std::array<double,3>> track;
+        std::vector<int>     first;         // [epoch] first satellite; epochs + 1 entries
+        std::vector<double>  pos;           // [sat * 3 + axis]
+        std::vector<double>  vel;           // [sat * 3 + axis]
+        std::vector<double>  range;         // signal range
+        std::vector<int>     id;
+        std::vector<uint8_t> system;
+        std::vector<int>     prn;
+        std::vector<uint8_t> inNoFly;       // [epoch]
+    };
+    struct Ranges {
+        std::vector<uint8_t> valid;         // [epoch] at least 4 satellites
+        std::vector<uint8_t> spoofed;       // [epoch]
+        std::vector<DetectionResult> scores;    // [epoch]
+        RunResult base;                     // threshold-independent part of the result
+    };
+    template<class T> struct Entry {
+        uint64_t key = 0;
+        uint64_t lastUse = 0;
+        bool     used = false;
+        T        value;
+    };
+
+    int capacity;
+    uint64_t useClock = 0;
+    std::vector<Entry<Geometry>> geometryCache;
+    std::vector<Entry<Ranges>>   rangesCache;
+    SweepStats counts;
+
+    Constellation satellites;
+    VisibilityEngine visibility;
+    VisibleSet   visible;
+    EpochBuffer  epoch;
+    const MeasurementErrors& errorModel;
+    ReceiverSite site;
+    std::vector<double> errors;
+
+    template<class T> T& lookup(std::vector<Entry<T>>& cache, uint64_t key, SweepStage stage, bool& hit);
+
+    void computeGeometry(const ScenarioConfig& c, Geometry& g);
+    void computeRanges(const ScenarioConfig& c, const Geometry& g, Ranges& r);
+    RunResult verdict(const ScenarioConfig& c, const Ranges& r) const;
+
+public:
+    // Stage outputs kept per stage; points are sorted, so 1 is enough
+    // within one run() and more lets later runs reuse earlier ones
+    explicit SweepEngine(int cacheEntries = 4);
+
+    static uint64_t geometryKey(const ScenarioConfig& c);
+    static uint64_t rangesKey(const ScenarioConfig& c);
+
+    // Evaluates every point; out[i] is runScenario(points[i])
+    void run(const std::vector<ScenarioConfig>& points, std::vector<RunResult>& out);
+
+    const SweepStats& stats() const { return counts; }
+    void resetStats() { counts = SweepStats(); }
+
+    // Drops every cached stage output
+    void clear();
+};
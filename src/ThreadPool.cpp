@@ -0,0 +1,81 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount <= 0) threadCount = 1;
+    for (int i = 0; i < threadCount; i++) workers.emplace_back(new Worker());
+    for (int i = 0; i < threadCount; i++) threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(jobLock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+bool ThreadPool::popLocal(int self, int& chunk) {
+    Worker& w = *workers[self];
+    std::lock_guard<std::mutex> lk(w.lock);
+    if (w.front == w.chunks.size()) return false;
+    chunk = w.chunks.back();
+    w.chunks.pop_back();
+    return true;
+}
+
+// Takes the oldest chunk of the first non-empty victim after `self`
+bool ThreadPool::steal(int self, int& chunk) {
+    int n = (int)workers.size();
+    for (int k = 1; k < n; k++) {
+        Worker& victim = *workers[(self + k) % n];
+        std::lock_guard<std::mutex> lk(victim.lock);
+        if (victim.front == victim.chunks.size()) continue;
+        chunk = victim.chunks[victim.front++];
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int self) {
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(jobLock);
+            jobReady.wait(lk, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        int chunk;
+        while (popLocal(self, chunk) || steal(self, chunk)) {
+            (*job)(chunk, self);
+            if (remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lk(jobLock);
+                jobDone.notify_all();
+            }
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int chunks, const std::function<void(int, int)>& fn) {
+    if (chunks <= 0) return;
+    int n = (int)workers.size();
+
+    std::unique_lock<std::mutex> lk(jobLock);
+    job = &fn;
+    remaining = chunks;
+    // Contiguous blocks keep neighbouring chunks on one worker until stolen
+    for (int w = 0; w < n; w++) {
+        int begin = (int)((long long)chunks * w / n);
+        int end   = (int)((long long)chunks * (w + 1) / n);
+        std::lock_guard<std::mutex> wl(workers[w]->lock);
+        workers[w]->chunks.clear();
+        workers[w]->front = 0;
+        for (int c = begin; c < end; c++) workers[w]->chunks.push_back(c);
+    }
+    generation++;
+    jobReady.notify_all();
+    jobDone.wait(lk, [&] { return remaining.load() == 0; });
+    job = nullptr;
+}
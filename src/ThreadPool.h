@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Fixed-size pool of worker threads with per-worker work queues.
+//
+// parallelFor() deals contiguous blocks of chunk indices to the workers'
+// own queues. A worker pops from the back of its queue and, when it runs
+// dry, steals from the front of another worker's queue, so uneven chunk
+// costs even out without any shared queue or global lock.
+class ThreadPool {
+private:
+    // Chunks [front, size) are pending; the owner pops from the back and
+    // thieves take from the front. The vector keeps its capacity between
+    // jobs, so a steady stream of parallelFor calls does not allocate.
+    struct Worker {
+        std::mutex       lock;
+        std::vector<int> chunks;
+        size_t           front = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread>             threads;
+
+    std::mutex              jobLock;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const std::function<void(int, int)>* job = nullptr;
+    unsigned long long generation = 0;
+    std::atomic<int>  remaining{0};
+    std::atomic<int>  activeWorkers{0};
+    bool stopping = false;
+
+    bool popLocal(int self, int& chunk);
+    bool steal(int self, int& chunk);
+    void workerLoop(int self);
+
+public:
+    // threads <= 0 uses every hardware thread
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)threads.size(); }
+
+    // Calls fn(chunk, worker) once for every chunk in [0, chunks) and
+    // blocks until all have finished. `worker` is in [0, size()).
+    void parallelFor(int chunks, const std::function<void(int chunk, int worker)>& fn);
+};
@@ -0,0 +1,201 @@
+#include "TracePyramid.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "TraceReader.h"
+
+static void spanBegin(TraceSpan& s) {
+    s.t0 = s.t1 = 0;
+    s.first = s.last = 0;
+    s.records = s.valid = 0;
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+        s.lo[c] = std::numeric_limits<float>::max();
+        s.hi[c] = -std::numeric_limits<float>::max();
+    }
+}
+
+static inline void sample(TraceSpan& s, int c, float v) {
+    s.lo[c] = std::min(s.lo[c], v);
+    s.hi[c] = std::max(s.hi[c], v);
+}
+
+static void spanAdd(TraceSpan& s, const TraceRecord& rec, uint64_t index) {
+    if (s.records == 0) {
+        s.t0 = rec.time;
+        s.first = index;
+    }
+    s.t1 = rec.time;
+    s.last = index;
+    s.records++;
+    sample(s, CHANNEL_TRUE_LAT, (float)rec.trueLat);
+    sample(s, CHANNEL_TRUE_LON, (float)rec.trueLon);
+    sample(s, CHANNEL_SPOOF_ACTIVE, rec.spoofActive);
+    sample(s, CHANNEL_NO_FLY, rec.inNoFly);
+    if (!rec.valid) return;
+    s.valid++;
+    double dx = rec.estX - rec.trueX, dy = rec.estY - rec.trueY, dz = rec.estZ - rec.trueZ;
+    sample(s, CHANNEL_EST_LAT, (float)rec.estLat);
+    sample(s, CHANNEL_EST_LON, (float)rec.estLon);
+    sample(s, CHANNEL_ERROR, (float)std::sqrt(dx * dx + dy * dy + dz * dz));
+    sample(s, CHANNEL_CONFIDENCE, (float)rec.confidence);
+    sample(s, CHANNEL_DETECTED, rec.spoofDetected);
+}
+
+static TraceSpan spanMerge(const TraceSpan& a, const TraceSpan& b) {
+    TraceSpan m;
+    m.t0 = a.t0;
+    m.t1 = b.t1;
+    m.first = a.first;
+    m.last = b.last;
+    m.records = a.records + b.records;
+    m.valid = a.valid + b.valid;
+    for (int c = 0; c < CHANNEL_COUNT; c++) {
+        m.lo[c] = std::min(a.lo[c], b.lo[c]);
+        m.hi[c] = std::max(a.hi[c], b.hi[c]);
+    }
+    return m;
+}
+
+void TracePyramid::reset(const TraceReader& trace) {
+    source = &trace;
+    next = 0;
+    runs.clear();
+    runIndex.clear();
+    lastRun = -1;
+    spanBegin(all);
+}
+
+bool TracePyramid::complete() const {
+    return source && next >= source->size();
+}
+
+int TracePyramid::runFor(uint32_t id) {
+    if (lastRun >= 0 && runs[lastRun].id == id) return lastRun;
+    auto it = runIndex.find(id);
+    if (it != runIndex.end()) return lastRun = it->second;
+    runs.emplace_back();
+    runs.back().id = id;
+    spanBegin(runs.back().open);
+    runIndex[id] = (int)runs.size() - 1;
+    return lastRun = (int)runs.size() - 1;
+}
+
+// Moves the full open span into level 0 and carries pairs upwards, like
+// incrementing a binary counter
+void TracePyramid::closeOpen(Run& r) {
+    if (r.levels.empty()) r.levels.emplace_back();
+    r.levels[0].push_back(r.open);
+    spanBegin(r.open);
+    for (size_t L = 0; r.levels[L].size() % 2 == 0; L++) {
+        const auto& lv = r.levels[L];
+        TraceSpan m = spanMerge(lv[lv.size() - 2], lv[lv.size() - 1]);
+        if (r.levels.size() == L + 1) r.levels.emplace_back();
+        r.levels[L + 1].push_back(m);
+    }
+}
+
+uint64_t TracePyramid::build(uint64_t budget) {
+    if (!source) return 0;
+    const uint64_t end = std::min(source->size(), next + budget);
+    const uint64_t begin = next;
+    source->willRead(begin, end - begin);
+    for (; next < end; next++) {
+        const TraceRecord& rec = (*source)[next];
+        Run& r = runs[runFor(rec.run)];
+        spanAdd(r.open, rec, next);
+        spanAdd(all, rec, next);
+        r.records++;
+        if (r.open.records == (uint32_t)BASE) closeOpen(r);
+    }
+    return end - begin;
+}
+
+// Spans of level `level` (finest pieces for the part of the run not yet
+// covered by a complete span there) from the one current at t0 through
+// the last starting at or before t1. Counts them, and appends them to
+// `out` if given.
+int TracePyramid::collect(const Run& r, int level, double t0, double t1, std::vector<TraceSpan>* out) const {
+    // The run at this level: complete spans, then at most one leftover
+    // span per finer level, then the open span
+    const TraceSpan* tail[66];
+    int tails = 0;
+    const TraceSpan* body = nullptr;
+    int m = 0;
+    if (level < (int)r.levels.size()) {
+        body = r.levels[level].data();
+        m = (int)r.levels[level].size();
+        for (int k = level - 1; k >= 0; k--)
+            if (r.levels[k].size() % 2) tail[tails++] = &r.levels[k].back();
+    }
+    if (r.open.records > 0) tail[tails++] = &r.open;
+    const int n = m + tails;
+    auto at = [&](int i) -> const TraceSpan& { return i < m ? body[i] : *tail[i - m]; };
+    auto firstAfter = [&](double t) {
+        int lo = 0, hi = n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (at(mid).t0 <= t) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    };
+    int a = std::max(0, firstAfter(t0) - 1), b = firstAfter(t1);
+    if (b <= a) return 0;
+    if (out)
+        for (int i = a; i < b; i++) out->push_back(at(i));
+    return b - a;
+}
+
+// The run's records between trace indices `from` and `to`, as one-epoch
+// spans, windowed like collect()
+void TracePyramid::collectRecords(const Run& r, uint64_t from, uint64_t to, double t0, double t1,
+                                  std::vector<TraceSpan>& out) const
+{
+    TraceSpan s;
+    bool pending = false;           // latest record at or before t0, not yet emitted
+    for (uint64_t i = from; i <= to; i++) {
+        const TraceRecord& rec = (*source)[i];
+        if (rec.run != r.id) continue;
+        if (rec.time <= t0) {
+            spanBegin(s);
+            spanAdd(s, rec, i);
+            pending = true;
+            continue;
+        }
+        if (rec.time > t1) break;
+        if (pending) { out.push_back(s); pending = false; }
+        spanBegin(s);
+        spanAdd(s, rec, i);
+        out.push_back(s);
+    }
+    if (pending) out.push_back(s);
+}
+
+int TracePyramid::query(int run, double t0, double t1, int maxSpans, std::vector<TraceSpan>& out) const {
+    const Run& r = runs[run];
+    const int levels = (int)r.levels.size();
+    maxSpans = std::max(1, maxSpans);
+
+    int count = collect(r, 0, t0, t1, nullptr);
+    if (count <= maxSpans) {
+        // Records instead, if the window holds few enough and they sit
+        // close together in the file
+        const size_t mark = out.size();
+        collect(r, 0, t0, t1, &out);
+        uint64_t records = 0, stretch = 0;
+        for (size_t i = mark; i < out.size(); i++) {
+            records += out[i].records;
+            stretch += out[i].last - out[i].first + 1;
+        }
+        if (count == 0 || records > (uint64_t)maxSpans || stretch > 4 * records) return 0;
+        uint64_t from = out[mark].first, to = out.back().last;
+        out.resize(mark);
+        collectRecords(r, from, to, t0, t1, out);
+        return -1;
+    }
+    int level = 0;
+    while (level + 1 < levels && count > maxSpans) count = collect(r, ++level, t0, t1, nullptr);
+    collect(r, level, t0, t1, &out);
+    return level;
+}
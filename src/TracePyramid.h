@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+class TraceReader;
+
+// Per-epoch quantities summarized by the pyramid
+enum TraceChannel {
+    CHANNEL_TRUE_LAT,
+    CHANNEL_TRUE_LON,
+    CHANNEL_EST_LAT,            // est and score channels skip epochs without a fix
+    CHANNEL_EST_LON,
+    CHANNEL_ERROR,              // |est - true| (m)
+    CHANNEL_CONFIDENCE,
+    CHANNEL_SPOOF_ACTIVE,       // 0/1 flags: max is "any epoch in the span"
+    CHANNEL_DETECTED,
+    CHANNEL_NO_FLY,
+    CHANNEL_COUNT
+};
+
+// Min/max of every channel over consecutive epochs of one run. A channel
+// with no samples in the span (e.g. no fix at all) has lo > hi. Values
+// are floats: about 1 m of latitude/longitude resolution.
+struct TraceSpan {
+    double   t0, t1;            // first and last epoch time (s)
+    uint64_t first, last;       // trace indices of the first and last record
+    uint32_t records;
+    uint32_t valid;             // records with a fix
+    float    lo[CHANNEL_COUNT];
+    float    hi[CHANNEL_COUNT];
+};
+
+// Level-of-detail summary of a trace for playback, per run (receiver).
+//
+// Level 0 holds one span per BASE consecutive epochs of a run, level L one
+// span per BASE << L, each the merge of two spans below it, so the whole
+// pyramid is about 2 / BASE spans per record. It is built in one sequential
+// pass over the mapped file, a slice at a time, so a viewer can stay
+// interactive while a long trace loads; queries see what is built so far.
+//
+// A query picks the finest level at which the time window holds no more
+// than the requested number of spans, so drawing a window costs the same
+// whatever the length of the trace or the zoom. Zoomed in far enough, the
+// records themselves are returned (as spans of one epoch), read from the
+// mapping; that is skipped when the run's records are scattered through
+// the file (many interleaved receivers), where level 0 is the finest.
+class TracePyramid {
+public:
+    static const int BASE = 16;
+
+private:
+    struct Run {
+        uint32_t id;
+        uint64_t records = 0;
+        std::vector<std::vector<TraceSpan>> levels;     // complete spans only
+        TraceSpan open;                                 // epochs not yet in level 0
+    };
+
+    const TraceReader* source = nullptr;
+    uint64_t next = 0;
+    std::vector<Run> runs;
+    std::unordered_map<uint32_t, int> runIndex;
+    int lastRun = -1;
+    TraceSpan all;
+
+    int  runFor(uint32_t id);
+    void closeOpen(Run& r);
+    int  collect(const Run& r, int level, double t0, double t1, std::vector<TraceSpan>* out) const;
+    void collectRecords(const Run& r, uint64_t from, uint64_t to, double t0, double t1,
+                        std::vector<TraceSpan>& out) const;
+
+public:
+    // Starts over on `trace`, which must outlive the pyramid's use
+    void reset(const TraceReader& trace);
+
+    // Summarizes up to `budget` more records; returns how many it took
+    uint64_t build(uint64_t budget);
+    bool complete() const;
+    uint64_t built() const { return next; }
+
+    int      runCount() const { return (int)runs.size(); }
+    uint32_t runId(int run) const { return runs[run].id; }
+    uint64_t runRecords(int run) const { return runs[run].records; }
+
+    // Every record built so far, all runs
+    const TraceSpan& overall() const { return all; }
+
+    // Appends the spans of `run` covering [t0, t1], in time order: from the
+    // span current at t0 (the last starting at or before it) to the last
+    // starting at or before t1. At most max(maxSpans, 66) spans; `out` is
+    // not cleared and does not reallocate if it has room. Returns the
+    // level used, -1 for records.
+    int query(int run, double t0, double t1, int maxSpans, std::vector<TraceSpan>& out) const;
+};
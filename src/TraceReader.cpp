@@ -0,0 +1,76 @@
+#include "TraceReader.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static uint32_t get32(const unsigned char* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+static uint64_t get64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+bool TraceReader::open(const std::string& path, std::string* error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 32) {
+        if (error) *error = path + " is too short to be a trace";
+        ::close(fd);
+        return false;
+    }
+    size_t bytes = (size_t)st.st_size;
+    void* m = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);                    // the mapping keeps the file open
+    if (m == MAP_FAILED) {
+        if (error) *error = "cannot map " + path;
+        return false;
+    }
+
+    const unsigned char* h = (const unsigned char*)m;
+    uint32_t headerBytes = get32(h + 8), recordBytes = get32(h + 12);
+    const char* why = nullptr;
+    if (std::memcmp(h, "GNSSTRC1", 8) != 0) why = " is not a gnss_sim trace";
+    else if (recordBytes != sizeof(TraceRecord)) why = " was written with a different record layout";
+    else if (headerBytes > bytes || headerBytes % alignof(TraceRecord) != 0) why = " has a bad header size";
+    if (why) {
+        if (error) *error = path + why;
+        munmap(m, bytes);
+        return false;
+    }
+
+    mapping = h;
+    mappedBytes = bytes;
+    records = (const TraceRecord*)(h + headerBytes);
+    uint64_t whole = (bytes - headerBytes) / sizeof(TraceRecord);
+    uint64_t stated = get64(h + 24);
+    count = stated != 0 && stated <= whole ? stated : whole;
+    return true;
+}
+
+void TraceReader::close() {
+    if (!mapping) return;
+    munmap((void*)mapping, mappedBytes);
+    mapping = nullptr;
+    records = nullptr;
+    mappedBytes = 0;
+    count = 0;
+}
+
+void TraceReader::willRead(uint64_t first, uint64_t n) const {
+    if (!mapping || first >= count) return;
+    if (n > count - first) n = count - first;
+    // madvise wants a page-aligned start
+    const long page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)(records + first), end = (uintptr_t)(records + first + n);
+    begin &= ~(uintptr_t)(page - 1);
+    madvise((void*)begin, end - begin, MADV_WILLNEED);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "TraceWriter.h"
+
+// Read-only view of a trace written by TraceWriter. The file is memory-
+// mapped, so records are paged in from disk as they are touched and a
+// trace far larger than RAM can be walked once or sampled at random
+// without reading it all. A trace whose writer never closed (record count
+// 0 in the header) is read up to the last whole record.
+class TraceReader {
+private:
+    const unsigned char* mapping = nullptr;
+    size_t   mappedBytes = 0;
+    const TraceRecord* records = nullptr;
+    uint64_t count = 0;
+
+public:
+    TraceReader() = default;
+    ~TraceReader() { close(); }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // Maps `path` and checks the header against this build's TraceRecord.
+    // Returns false and sets `error` if the file is missing or not a trace.
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    uint64_t size() const { return count; }
+    const TraceRecord& operator[](uint64_t i) const { return records[i]; }
+
+    // Hints that records [first, first + n) are about to be read in order
+    void willRead(uint64_t first, uint64_t n) const;
+};
@@ -0,0 +1,147 @@
+#include "TraceWriter.h"
+#include <cstring>
+#include <cstddef>
+
+static_assert(sizeof(TraceRecord) == 160, "TraceRecord must stay packed; update the schema");
+
+namespace {
+
+struct FieldDesc {
+    const char* name;
+    const char* type;
+    uint32_t    offset;
+};
+
+#define TRACE_FIELD(member, name, type) { name, type, (uint32_t)offsetof(TraceRecord, member) }
+
+const FieldDesc FIELDS[] = {
+    TRACE_FIELD(time,          "time",           "<f8"),
+    TRACE_FIELD(trueX,         "true_x",         "<f8"),
+    TRACE_FIELD(trueY,         "true_y",         "<f8"),
+    TRACE_FIELD(trueZ,         "true_z",         "<f8"),
+    TRACE_FIELD(trueLat,       "true_lat",       "<f8"),
+    TRACE_FIELD(trueLon,       "true_lon",       "<f8"),
+    TRACE_FIELD(trueAlt,       "true_alt",       "<f8"),
+    TRACE_FIELD(estX,          "est_x",          "<f8"),
+    TRACE_FIELD(estY,          "est_y",          "<f8"),
+    TRACE_FIELD(estZ,          "est_z",          "<f8"),
+    TRACE_FIELD(estLat,        "est_lat",        "<f8"),
+    TRACE_FIELD(estLon,        "est_lon",        "<f8"),
+    TRACE_FIELD(estAlt,        "est_alt",        "<f8"),
+    TRACE_FIELD(clockBias,     "clock_bias",     "<f8"),
+    TRACE_FIELD(confidence,    "confidence",     "<f8"),
+    TRACE_FIELD(residualScore, "residual_score", "<f8"),
+    TRACE_FIELD(velocityScore, "velocity_score", "<f8"),
+    TRACE_FIELD(clockScore,    "clock_score",    "<f8"),
+    TRACE_FIELD(run,           "run",            "<u4"),
+    TRACE_FIELD(visible,       "visible",        "<i4"),
+    TRACE_FIELD(valid,         "valid",          "|u1"),
+    TRACE_FIELD(spoofActive,   "spoof_active",   "|u1"),
+    TRACE_FIELD(spoofDetected, "spoof_detected", "|u1"),
+    TRACE_FIELD(inNoFly,       "in_no_fly",      "|u1"),
+};
+
+#undef TRACE_FIELD
+
+const int FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+const int FIELD_BYTES = 24 + 8 + 4 + 4;
+const int HEADER_BYTES = 8 + 4 * 4 + 8 + FIELD_COUNT * FIELD_BYTES;
+const long COUNT_OFFSET = 8 + 4 * 4;
+
+void put32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+void put64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+} // namespace
+
+bool TraceWriter::open(const std::string& path, std::string* error) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "cannot create " + path;
+        return false;
+    }
+
+    unsigned char header[HEADER_BYTES];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, "GNSSTRC1", 8);
+    put32(header + 8, HEADER_BYTES);
+    put32(header + 12, sizeof(TraceRecord));
+    put32(header + 16, FIELD_COUNT);
+    unsigned char* f = header + 8 + 4 * 4 + 8;
+    for (int i = 0; i < FIELD_COUNT; i++, f += FIELD_BYTES) {
+        std::strncpy((char*)f, FIELDS[i].name, 23);
+        std::strncpy((char*)f + 24, FIELDS[i].type, 7);
+        put32(f + 32, FIELDS[i].offset);
+    }
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        if (error) *error = "cannot write header to " + path;
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    for (auto& b : blocks) b.resize(BLOCK_RECORDS);
+    fill = 0;
+    active = 0;
+    pendingCount = -1;
+    writeFailed = false;
+    stopping = false;
+    recordCount = 0;
+    worker = std::thread(&TraceWriter::writerLoop, this);
+    return true;
+}
+
+void TraceWriter::submitActive() {
+    std::unique_lock<std::mutex> lk(lock);
+    // Wait for the other block to drain before reusing it
+    pendingDone.wait(lk, [&] { return pendingCount < 0; });
+    pendingCount = fill;
+    recordCount += fill;
+    active ^= 1;
+    fill = 0;
+    lk.unlock();
+    pendingReady.notify_one();
+}
+
+void TraceWriter::writerLoop() {
+    std::unique_lock<std::mutex> lk(lock);
+    for (;;) {
+        pendingReady.wait(lk, [&] { return pendingCount >= 0 || stopping; });
+        if (pendingCount < 0) return;   // stopping with nothing queued
+
+        // The pending block is the one the caller is not appending to
+        const TraceRecord* data = blocks[active ^ 1].data();
+        size_t n = (size_t)pendingCount;
+        lk.unlock();
+        bool ok = std::fwrite(data, sizeof(TraceRecord), n, file) == n;
+        lk.lock();
+        if (!ok) writeFailed = true;
+        pendingCount = -1;
+        pendingDone.notify_one();
+    }
+}
+
+bool TraceWriter::close() {
+    if (!file) return true;
+    if (fill > 0) submitActive();
+    {
+        std::lock_guard<std::mutex> lk(lock);
+        stopping = true;
+    }
+    pendingReady.notify_one();
+    worker.join();
+
+    unsigned char count[8];
+    put64(count, recordCount);
+    bool ok = !writeFailed;
+    if (std::fseek(file, COUNT_OFFSET, SEEK_SET) != 0 ||
+        std::fwrite(count, 1, sizeof(count), file) != sizeof(count))
+        ok = false;
+    if (std::fclose(file) != 0) ok = false;
+    file = nullptr;
+    return ok;
+}
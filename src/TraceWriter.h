@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// One epoch of a scenario run as stored in a trace file. Fixed width and
+// naturally aligned (no padding between members), so a file is a header
+// followed by a plain array of these records.
+struct TraceRecord {
+    double   time;                      // simulation time (s)
+    double   trueX, trueY, trueZ;       // ECEF (m)
+    double   trueLat, trueLon, trueAlt; // WGS-84 (deg, deg, m)
+    double   estX, estY, estZ;
+    double   estLat, estLon, estAlt;
+    double   clockBias;                 // estimated receiver clock bias (m)
+    double   confidence;                // DetectionResult scores
+    double   residualScore;
+    double   velocityScore;
+    double   clockScore;
+    uint32_t run;                       // caller-defined run id (e.g. 0 normal, 1 spoofed)
+    int32_t  visible;                   // satellites used in the fix
+    uint8_t  valid;                     // 0 if the epoch had no fix (est/score columns are 0)
+    uint8_t  spoofActive;
+    uint8_t  spoofDetected;
+    uint8_t  inNoFly;
+    uint8_t  reserved[4];
+};
+
+// Streams TraceRecords to a binary file without stalling the caller.
+//
+// File layout (little-endian):
+//   char[8]  magic "GNSSTRC1"
+//   uint32   header size in bytes (records start at this offset)
+//   uint32   record size in bytes
+//   uint32   field count
+//   uint32   reserved
+//   uint64   record count (patched on close; 0 if the writer never closed,
+//            in which case readers use the file size)
+//   fields:  char[24] name, char[8] numpy type string (e.g. "<f8"),
+//            uint32 byte offset in the record, uint32 reserved
+//   records  (host byte order, i.e. little-endian on every supported target)
+//
+// Records are appended to one of two fixed-size blocks. When a block fills
+// it is handed to a background thread for fwrite() and the caller carries on
+// with the other block, so the simulation only waits if the disk falls a
+// whole block behind.
+class TraceWriter {
+private:
+    static const int BLOCK_RECORDS = 8192;
+
+    std::FILE* file = nullptr;
+    std::vector<TraceRecord> blocks[2];
+    int  fill = 0;              // records in the active block
+    int  active = 0;            // block the caller appends to
+    int  pendingCount = -1;     // records in the block being written, -1 if none
+    bool writeFailed = false;
+    bool stopping = false;
+    uint64_t recordCount = 0;
+
+    std::thread             worker;
+    std::mutex              lock;
+    std::condition_variable pendingReady;
+    std::condition_variable pendingDone;
+
+    void writerLoop();
+    void submitActive();
+
+public:
+    TraceWriter() = default;
+    ~TraceWriter() { close(); }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Creates/truncates `path` and writes the header. Returns false and sets
+    // `error` if the file cannot be created.
+    bool open(const std::string& path, std::string* error = nullptr);
+
+    bool isOpen() const { return file != nullptr; }
+
+    void append(const TraceRecord& r) {
+        blocks[active][fill++] = r;
+        if (fill == BLOCK_RECORDS) submitActive();
+    }
+
+    // Flushes buffered records, finalizes the header and closes the file.
+    // Returns false if any write failed.
+    bool close();
+
+    uint64_t size() const { return recordCount + fill; }
+};
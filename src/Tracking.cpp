@@ -0,0 +1,189 @@
+#include "Tracking.h"
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "CaCode.h"
+#include "Instrument.h"
+
+TrackingBank::TrackingBank(const TrackingConfig& config)
+    : config(config)
+    , n(std::max(1, (int)std::lround(config.sampleRate * 1e-3)))
+    , T(n / config.sampleRate)
+{}
+
+void TrackingBank::reserve(int channels) {
+    for (auto* v : {&codePhase, &codeRate, &carrierPhase, &carrierFreq, &freqState, &prevI, &prevQ,
+                    &sumP2, &sumP4, &sumAsym, &sumRatio, &sumLock,
+                    &promptPower, &asymmetry, &flatness, &cn0, &lock})
+        v->reserve(channels);
+    prn.reserve(channels);
+    rotCos.reserve((size_t)channels * CHUNK);
+    rotSin.reserve((size_t)channels * CHUNK);
+    accum.reserve((size_t)channels * 6);
+}
+
+void TrackingBank::clear() {
+    for (auto* v : {&codePhase, &codeRate, &carrierPhase, &carrierFreq, &freqState, &prevI, &prevQ,
+                    &sumP2, &sumP4, &sumAsym, &sumRatio, &sumLock,
+                    &promptPower, &asymmetry, &flatness, &cn0, &lock, &accum})
+        v->clear();
+    prn.clear();
+    rotCos.clear();
+    rotSin.clear();
+    filled = integrations = 0;
+}
+
+int TrackingBank::addChannel(int p, double phase, double doppler) {
+    prn.push_back(p);
+    codePhase.push_back(phase);
+    codeRate.push_back(CaCodeTable::CHIP_RATE * (1.0 + doppler / CaCodeTable::L1_FREQ));
+    carrierPhase.push_back(0.0);
+    carrierFreq.push_back(doppler);
+    freqState.push_back(doppler);
+    prevI.push_back(0.0);
+    prevQ.push_back(0.0);
+    for (int k = 0; k < 6; k++) accum.push_back(0.0);
+    for (auto* v : {&sumP2, &sumP4, &sumAsym, &sumRatio, &sumLock,
+                    &promptPower, &asymmetry, &flatness, &cn0, &lock})
+        v->push_back(0.0);
+    rotCos.resize(rotCos.size() + CHUNK);
+    rotSin.resize(rotSin.size() + CHUNK);
+    int c = size() - 1;
+    setRotation(c);
+    return c;
+}
+
+// Carrier turn over k samples at the channel's NCO frequency, by
+// repeated multiplication in double (no trig per entry)
+void TrackingBank::setRotation(int c) {
+    double a = -2 * M_PI * carrierFreq[c] / config.sampleRate;
+    double stepC = std::cos(a), stepS = std::sin(a);
+    double rc = 1.0, rs = 0.0;
+    float* oc = &rotCos[(size_t)c * CHUNK];
+    float* os = &rotSin[(size_t)c * CHUNK];
+    for (int k = 0; k < CHUNK; k++) {
+        oc[k] = (float)rc;
+        os[k] = (float)rs;
+        double t = rc * stepC - rs * stepS;
+        rs = rc * stepS + rs * stepC;
+        rc = t;
+    }
+}
+
+// Fixed-point 32.32 code phase of `chips`, wrapped into [0, CHIPS)
+static inline uint64_t fixedPhase(double chips) {
+    if (chips < 0) chips += CaCodeTable::CHIPS;
+    else if (chips >= CaCodeTable::CHIPS) chips -= CaCodeTable::CHIPS;
+    return (uint64_t)(chips * 4294967296.0);
+}
+
+void TrackingBank::correlate(int c, const float* re, const float* im, int count) {
+    const uint64_t* code = CaCodeTable::instance().code(prn[c]);
+    const float* rc = &rotCos[(size_t)c * CHUNK];
+    const float* rs = &rotSin[(size_t)c * CHUNK];
+    const double chipsPerSample  = codeRate[c] / config.sampleRate;
+    const double cyclesPerSample = carrierFreq[c] / config.sampleRate;
+    const uint64_t step = (uint64_t)(chipsPerSample * 4294967296.0);
+    double* acc = &accum[(size_t)c * 6];
+    double phase = codePhase[c], carrier = carrierPhase[c];
+
+    for (int i0 = 0; i0 < count; i0 += CHUNK) {
+        const int m = std::min(CHUNK, count - i0);
+        // Local carrier conjugate at the chunk start; the table turns it on
+        double a = -2 * M_PI * carrier;
+        float c0 = (float)std::cos(a), s0 = (float)std::sin(a);
+        // A chunk spans < 64 chips, so indices stay inside the wrapped tail
+        uint64_t pE = fixedPhase(phase + config.spacing);
+        uint64_t pP = fixedPhase(phase);
+        uint64_t pL = fixedPhase(phase - config.spacing);
+        const float* __restrict xr = re + i0;
+        const float* __restrict xi = im + i0;
+        float ei = 0, eq = 0, pi = 0, pq = 0, li = 0, lq = 0;
+        #pragma omp simd reduction(+:ei,eq,pi,pq,li,lq)
+        for (int k = 0; k < m; k++) {
+            float cr = c0 * rc[k] - s0 * rs[k];
+            float ci = s0 * rc[k] + c0 * rs[k];
+            float yr = xr[k] * cr - xi[k] * ci;
+            float yi = xr[k] * ci + xi[k] * cr;
+            uint64_t off = (uint64_t)k * step;
+            uint64_t ie = (pE + off) >> 32, ip = (pP + off) >> 32, il = (pL + off) >> 32;
+            float se = 1.0f - 2.0f * (float)((code[ie >> 6] >> (ie & 63)) & 1);
+            float sp = 1.0f - 2.0f * (float)((code[ip >> 6] >> (ip & 63)) & 1);
+            float sl = 1.0f - 2.0f * (float)((code[il >> 6] >> (il & 63)) & 1);
+            ei += se * yr; eq += se * yi;
+            pi += sp * yr; pq += sp * yi;
+            li += sl * yr; lq += sl * yi;
+        }
+        acc[0] += ei; acc[1] += eq;
+        acc[2] += pi; acc[3] += pq;
+        acc[4] += li; acc[5] += lq;
+        phase += m * chipsPerSample;
+        if (phase >= CaCodeTable::CHIPS) phase -= CaCodeTable::CHIPS;
+        carrier += m * cyclesPerSample;
+        carrier -= std::floor(carrier);
+    }
+    codePhase[c] = phase;
+    carrierPhase[c] = carrier;
+}
+
+void TrackingBank::updateLoops(int c) {
+    double* acc = &accum[(size_t)c * 6];
+    const double I = acc[2], Q = acc[3];
+    const double early = std::sqrt(acc[0] * acc[0] + acc[1] * acc[1]);
+    const double late  = std::sqrt(acc[4] * acc[4] + acc[5] * acc[5]);
+    const double p2 = I * I + Q * Q;
+    std::fill(acc, acc + 6, 0.0);
+
+    // ===== Carrier: FLL-assisted second-order PLL =====
+    double phaseErr = I != 0 ? std::atan(Q / I) / (2 * M_PI) : 0.0;              // cycles
+    double cross = prevI[c] * Q - prevQ[c] * I, dot = prevI[c] * I + prevQ[c] * Q;
+    double freqErr = (cross != 0 || dot != 0) ? std::atan2(cross, dot) / (2 * M_PI * T) : 0.0;   // Hz
+    prevI[c] = I; prevQ[c] = Q;
+    const double wp = config.pllBandwidth / 0.53, wf = config.fllBandwidth / 0.25;
+    freqState[c] += T * (wp * wp * phaseErr + wf * freqErr);
+    carrierFreq[c] = freqState[c] + 1.414 * wp * phaseErr;
+
+    // ===== Code: carrier-aided DLL =====
+    double asym = early + late > 0 ? (early - late) / (early + late) : 0.0;
+    double chipErr = asym * (1.0 - config.spacing);
+    codeRate[c] = CaCodeTable::CHIP_RATE * (1.0 + carrierFreq[c] / CaCodeTable::L1_FREQ)
+                + 4 * config.dllBandwidth * chipErr;
+    setRotation(c);
+
+    sumP2[c]    += p2;
+    sumP4[c]    += p2 * p2;
+    sumAsym[c]  += asym;
+    sumRatio[c] += p2 > 0 ? (early + late) / (2 * std::sqrt(p2)) : 0.0;
+    sumLock[c]  += p2 > 0 ? (I * I - Q * Q) / p2 : 0.0;
+}
+
+void TrackingBank::process(const float* re, const float* im, int count) {
+    GNSS_STAGE(STAGE_TRACKING);
+    const int channels = size();
+    for (int i = 0; i < count; ) {
+        const int take = std::min(n - filled, count - i);
+        for (int c = 0; c < channels; c++) correlate(c, re + i, im + i, take);
+        i += take;
+        filled += take;
+        if (filled < n) break;
+        filled = 0;
+        for (int c = 0; c < channels; c++) updateLoops(c);
+
+        if (++integrations < config.cn0Window) continue;
+        // ===== Quality window: moment C/N0 estimate and means =====
+        const double w = integrations;
+        for (int c = 0; c < channels; c++) {
+            double m2 = sumP2[c] / w, m4 = sumP4[c] / w;
+            double pd = std::sqrt(std::max(0.0, 2 * m2 * m2 - m4));
+            double pn = m2 - pd;
+            cn0[c] = pd > 0 && pn > 0 ? 10 * std::log10(pd / (pn * T)) : 0.0;
+            promptPower[c] = m2;
+            asymmetry[c]   = sumAsym[c] / w;
+            flatness[c]    = sumRatio[c] / w / (1.0 - config.spacing) - 1.0;
+            lock[c]        = sumLock[c] / w;
+            sumP2[c] = sumP4[c] = sumAsym[c] = sumRatio[c] = sumLock[c] = 0.0;
+        }
+        integrations = 0;
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+
+struct TrackingConfig {
+    double sampleRate   = 4.096e6;  // Hz, complex baseband
+    double spacing      = 0.5;      // early / late offset from prompt, chips
+    double dllBandwidth = 2.0;      // Hz, carrier-aided first-order DLL
+    double pllBandwidth = 15.0;     // Hz, second-order PLL
+    double fllBandwidth = 10.0;     // Hz, first-order FLL assisting the PLL
+    int    cn0Window    = 100;      // integrations per C/N0 / quality update
+};
+
+// Read-only view of the correlator-level signal quality of `count` tracked
+// channels, refreshed every cn0Window integrations. Each array has one
+// entry per channel.
+struct SignalQualityView {
+    const int*    prn;
+    const double* promptPower;  // mean |P|^2 per integration
+    const double* asymmetry;    // mean (|E| - |L|) / (|E| + |L|), 0 for a clean peak
+    const double* flatness;     // mean (|E| + |L|) / (2 (1 - spacing) |P|) - 1, 0 for a clean peak
+    const double* cn0;          // dB-Hz, moment estimate
+    const double* lock;         // phase-lock indicator, cos of twice the phase error (1 = locked)
+    int count;
+};
+
+// Bank of code/carrier tracking channels over one complex sample stream.
+//
+// Channels are stored as structure-of-arrays. Every integration (1 ms of
+// samples) runs one correlator kernel per channel over the shared samples:
+// carrier wipe-off with a per-chunk phasor and a per-channel rotation
+// table, then early/prompt/late code signs read from the bit-packed code
+// table with fixed-point phases, accumulated in six reductions. The loop
+// filters then run once per channel: a carrier-aided DLL on the
+// normalized early-minus-late envelope, and a second-order PLL (Costas
+// discriminator) assisted by a first-order FLL. Integrations are not
+// aligned to code epochs; the stream carries no navigation data.
+//
+// process() accepts any number of samples and carries partial
+// integrations across calls. After reserve() it does not allocate.
+class TrackingBank {
+public:
+    static const int CHUNK = 64;
+
+private:
+    TrackingConfig config;
+    int    n;                   // samples per integration
+    double T;                   // integration time, s
+    int    filled = 0;          // samples of the current integration done
+    int    integrations = 0;    // in the current quality window
+
+    // ===== Channel state =====
+    std::vector<int>    prn;
+    std::vector<double> codePhase;      // chips at the next sample
+    std::vector<double> codeRate;       // chips/s
+    std::vector<double> carrierPhase;   // cycles at the next sample
+    std::vector<double> carrierFreq;    // Hz, NCO frequency
+    std::vector<double> freqState;      // Hz, loop-filter integrator
+    std::vector<double> prevI, prevQ;   // last prompt, for the FLL
+    std::vector<float>  rotCos, rotSin; // [channel * CHUNK + k]
+    std::vector<double> accum;          // [channel * 6 + {EI, EQ, PI, PQ, LI, LQ}]
+
+    // ===== Quality window sums and outputs =====
+    std::vector<double> sumP2, sumP4, sumAsym, sumRatio, sumLock;
+    std::vector<double> promptPower, asymmetry, flatness, cn0, lock;
+
+    void correlate(int c, const float* re, const float* im, int count);
+    void updateLoops(int c);
+    void setRotation(int c);
+
+public:
+    explicit TrackingBank(const TrackingConfig& config = TrackingConfig());
+
+    void reserve(int channels);
+    void clear();
+
+    // Starts a channel from an acquisition: code phase (chips) and Doppler
+    // (Hz) at the next sample to be processed. Returns the channel index.
+    int addChannel(int prn, double codePhase, double doppler);
+
+    void process(const float* re, const float* im, int count);
+
+    int size() const { return (int)prn.size(); }
+    int getPrn(int c) const { return prn[c]; }
+    double getCodePhase(int c) const { return codePhase[c]; }
+    double getDoppler(int c) const { return carrierFreq[c]; }
+
+    SignalQualityView quality() const {
+        return {prn.data(), promptPower.data(), asymmetry.data(), flatness.data(), cn0.data(),
+                lock.data(), size()};
+    }
+};
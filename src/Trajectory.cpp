@@ -0,0 +1,84 @@
+#include "Trajectory.h"
+#include <algorithm>
+
+bool Trajectory::build(const std::vector<double>& times, const std::vector<std::array<double,3>>& points,
+                       std::string* err)
+{
+    knots.clear();
+    coef.clear();
+    const int n = (int)times.size();
+    if (n < 2 || (int)points.size() != n) {
+        if (err) *err = "need at least two waypoints, each with a time";
+        return false;
+    }
+    for (int i = 1; i < n; i++)
+        if (!(times[i] > times[i - 1])) {
+            if (err) *err = "waypoint times must increase";
+            return false;
+        }
+
+    knots = times;
+    coef.resize((size_t)(n - 1) * 12);
+    std::vector<double> h(n - 1), diag(n), rhs(n), m(n);
+    for (int i = 0; i < n - 1; i++) h[i] = times[i + 1] - times[i];
+
+    for (int axis = 0; axis < 3; axis++) {
+        // Second derivatives M from the clamped (zero end velocity) system
+        //   h[i-1] M[i-1] + 2 (h[i-1] + h[i]) M[i] + h[i] M[i+1] = 6 (slope[i] - slope[i-1])
+        // solved by the Thomas algorithm; sub- and super-diagonals are h
+        auto slope = [&](int i) { return (points[i + 1][axis] - points[i][axis]) / h[i]; };
+        for (int i = 0; i < n; i++) {
+            double lo = i > 0 ? h[i - 1] : 0.0, hi = i < n - 1 ? h[i] : 0.0;
+            diag[i] = 2 * (lo + hi);
+            rhs[i]  = 6 * ((i < n - 1 ? slope(i) : 0.0) - (i > 0 ? slope(i - 1) : 0.0));
+        }
+        for (int i = 1; i < n; i++) {
+            double w = h[i - 1] / diag[i - 1];
+            diag[i] -= w * h[i - 1];
+            rhs[i]  -= w * rhs[i - 1];
+        }
+        m[n - 1] = rhs[n - 1] / diag[n - 1];
+        for (int i = n - 2; i >= 0; i--) m[i] = (rhs[i] - h[i] * m[i + 1]) / diag[i];
+
+        for (int i = 0; i < n - 1; i++) {
+            double* c = &coef[((size_t)i * 3 + axis) * 4];
+            c[0] = points[i][axis];
+            c[1] = slope(i) - h[i] * (2 * m[i] + m[i + 1]) / 6;
+            c[2] = m[i] / 2;
+            c[3] = (m[i + 1] - m[i]) / (6 * h[i]);
+        }
+    }
+    return true;
+}
+
+int Trajectory::segmentOf(double t) const {
+    int seg = (int)(std::upper_bound(knots.begin(), knots.end(), t) - knots.begin()) - 1;
+    return std::max(0, std::min(seg, (int)knots.size() - 2));
+}
+
+void Trajectory::evaluateSegment(int seg, double t, TrajectoryState& s) const {
+    double u = std::max(0.0, std::min(t, knots.back())) - knots[seg];
+    s.t = t;
+    for (int axis = 0; axis < 3; axis++) {
+        const double* c = &coef[((size_t)seg * 3 + axis) * 4];
+        s.pos[axis] = c[0] + u * (c[1] + u * (c[2] + u * c[3]));
+        s.vel[axis] = c[1] + u * (2 * c[2] + u * 3 * c[3]);
+        s.acc[axis] = 2 * c[2] + u * 6 * c[3];
+    }
+}
+
+void Trajectory::evaluate(double t, TrajectoryState& s) const {
+    evaluateSegment(segmentOf(t), std::max(t, knots.front()), s);
+    s.t = t;
+}
+
+void Trajectory::sample(double t0, double dt, int count, TrajectoryState* out) const {
+    const int last = (int)knots.size() - 2;
+    int seg = segmentOf(t0);
+    for (int k = 0; k < count; k++) {
+        double t = t0 + k * dt;
+        while (seg < last && t >= knots[seg + 1]) seg++;
+        evaluateSegment(seg, std::max(t, knots.front()), out[k]);
+        out[k].t = t;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <string>
+
+// Receiver truth at one instant (ECEF metres, m/s, m/s^2)
+struct TrajectoryState {
+    double t;
+    double pos[3];
+    double vel[3];
+    double acc[3];
+};
+
+// Smooth flight path through timed waypoints: a C2 cubic spline per ECEF
+// axis (position, velocity and acceleration all continuous), at rest at
+// the first and last waypoint. Each segment is stored as polynomial
+// coefficients, so a state is three Horner evaluations per axis.
+//
+// Straight ECEF chords dip below a constant-altitude path by d^2 / 8R,
+// about 0.5 m for waypoints 5 km apart.
+class Trajectory {
+private:
+    std::vector<double> knots;      // waypoint times, increasing
+    std::vector<double> coef;       // [(segment * 3 + axis) * 4 + power], local time u = t - knot
+
+    int segmentOf(double t) const;
+    void evaluateSegment(int seg, double t, TrajectoryState& s) const;
+
+public:
+    // Fits the spline. Fails (with a reason) unless there are at least two
+    // waypoints with strictly increasing times.
+    bool build(const std::vector<double>& times, const std::vector<std::array<double,3>>& points,
+               std::string* err = nullptr);
+
+    bool empty() const { return knots.size() < 2; }
+    double startTime() const { return knots.front(); }
+    double endTime() const { return knots.back(); }
+
+    // State at `t`, clamped to [startTime(), endTime()]
+    void evaluate(double t, TrajectoryState& s) const;
+
+    // Dense states t0, t0 + dt, ... (count of them) into `out`, walking the
+    // segments forward instead of searching for each one
+    void sample(double t0, double dt, int count, TrajectoryState* out) const;
+};
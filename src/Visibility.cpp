@@ -0,0 +1,191 @@
+#include "Visibility.h"
+#include <cmath>
+#include <algorithm>
+
+#include "Constellation.h"
+#include "Instrument.h"
+
+namespace {
+const double E2 = 0.00669437999014;          // WGS-84 first eccentricity squared
+const double POLAR_RADIUS = 6356752.3;
+const double LOWEST_RECEIVER = POLAR_RADIUS - 1000.0;
+const double VERTICAL_MARGIN = 0.2 * M_PI / 180;   // geodetic vs geocentric up (max 0.19 deg)
+}
+
+double VisibleSet::elevation(int i) const {
+    return atan2(up[i], sqrt(east[i]*east[i] + north[i]*north[i]));
+}
+
+double VisibleSet::azimuth(int i) const {
+    double az = atan2(east[i], north[i]);
+    return az < 0 ? az + 2 * M_PI : az;
+}
+
+// Point on cube face `face` at face coordinates (u, v) in [-1, 1]
+static void faceDirection(int face, double u, double v, double d[3]) {
+    double s = (face & 1) ? -1.0 : 1.0;
+    switch (face >> 1) {
+        case 0:  d[0] = s; d[1] = u; d[2] = v; break;
+        case 1:  d[0] = u; d[1] = s; d[2] = v; break;
+        default: d[0] = u; d[1] = v; d[2] = s; break;
+    }
+    double n = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+    d[0] /= n; d[1] /= n; d[2] /= n;
+}
+
+VisibilityEngine::VisibilityEngine(double maskDeg, double cellDeg)
+    : side(std::max(1, (int)std::ceil(90.0 / cellDeg)))
+{
+    setMask(maskDeg);
+
+    int cells = 6 * side * side;
+    cellUx.resize(cells); cellUy.resize(cells); cellUz.resize(cells);
+    cellCosR.resize(cells); cellSinR.resize(cells);
+    cellStart.assign(cells + 1, 0);
+
+    const double w = 2.0 / side;
+    for (int f = 0; f < 6; f++)
+        for (int j = 0; j < side; j++)
+            for (int i = 0; i < side; i++) {
+                int k = (f * side + j) * side + i;
+                double u0 = -1 + i * w, v0 = -1 + j * w;
+                double c[3];
+                faceDirection(f, u0 + 0.5 * w, v0 + 0.5 * w, c);
+                cellUx[k] = c[0]; cellUy[k] = c[1]; cellUz[k] = c[2];
+                // Cell edges are great circles: the farthest point is a corner
+                double minDot = 1.0;
+                for (double u : {u0, u0 + w})
+                    for (double v : {v0, v0 + w}) {
+                        double p[3];
+                        faceDirection(f, u, v, p);
+                        minDot = std::min(minDot, p[0]*c[0] + p[1]*c[1] + p[2]*c[2]);
+                    }
+                double radius = acos(std::max(-1.0, std::min(1.0, minDot))) + 1e-9;
+                cellCosR[k] = cos(radius);
+                cellSinR[k] = sin(radius);
+            }
+}
+
+void VisibilityEngine::setMask(double maskDeg) {
+    maskRad  = maskDeg * M_PI / 180;
+    sinMask  = sin(maskRad);
+    sinMask2 = sinMask * sinMask;
+    maskNonNegative = maskDeg >= 0;
+}
+
+double VisibilityEngine::getMaskDeg() const { return maskRad * 180 / M_PI; }
+
+void VisibilityEngine::setSatellites(const Constellation& satellites) {
+    setSatellites(satellites.x(), satellites.y(), satellites.z(), satellites.size());
+}
+
+void VisibilityEngine::setSatellites(const double* x, const double* y, const double* z, int count) {
+    satX = x; satY = y; satZ = z;
+    nSats = count;
+}
+
+void VisibilityEngine::update(const Constellation& satellites) {
+    update(satellites.x(), satellites.y(), satellites.z(), satellites.size());
+}
+
+void VisibilityEngine::update(const double* x, const double* y, const double* z, int count) {
+    GNSS_STAGE(STAGE_SKY_GRID);
+    setSatellites(x, y, z, count);
+    if ((int)capCos.size() < count) {
+        capCos.resize(count); capSin.resize(count);
+        unitX.resize(count); unitY.resize(count); unitZ.resize(count);
+    }
+
+    // Visibility cap of each satellite: Earth central angle between the
+    // sub-satellite point and a receiver (radius R) that sees it at the
+    // mask elevation, acos(R cos(mask) / r) - mask. It is largest for the
+    // lowest receiver.
+    for (int i = 0; i < count; i++) {
+        double r = sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+        unitX[i] = x[i] / r; unitY[i] = y[i] / r; unitZ[i] = z[i] / r;
+        double c = std::min(1.0, LOWEST_RECEIVER * cos(maskRad) / r);
+        double cap = std::min(M_PI, acos(c) - maskRad + VERTICAL_MARGIN);
+        capCos[i] = cos(cap);
+        capSin[i] = sin(cap);
+    }
+
+    // Two passes over cells x satellites: count, then fill (CSR)
+    const int cells = 6 * side * side;
+    auto overlaps = [&](int k, int i) {
+        // angle(cell, sat) <= cap + cellRadius  <=>  dot >= cos(cap + cellRadius)
+        double cosSum = capCos[i] * cellCosR[k] - capSin[i] * cellSinR[k];
+        double dot = cellUx[k] * unitX[i] + cellUy[k] * unitY[i] + cellUz[k] * unitZ[i];
+        // cos(a + b) is only monotonic up to pi; past it the cap covers the cell
+        bool wraps = capSin[i] * cellCosR[k] + capCos[i] * cellSinR[k] < 0;   // sin(a + b) < 0
+        return wraps || dot >= cosSum;
+    };
+    int total = 0;
+    for (int k = 0; k < cells; k++) {
+        cellStart[k] = total;
+        for (int i = 0; i < count; i++) total += overlaps(k, i);
+    }
+    cellStart[cells] = total;
+    // Candidate totals drift a little from epoch to epoch; grow with headroom
+    if ((int)cellSats.size() < total) cellSats.resize(total + total / 4);
+    int* out = cellSats.data();
+    for (int k = 0; k < cells; k++)
+        for (int i = 0; i < count; i++)
+            if (overlaps(k, i)) *out++ = i;
+}
+
+int VisibilityEngine::cellOf(double x, double y, double z) const {
+    double ax = fabs(x), ay = fabs(y), az = fabs(z);
+    int face;
+    double m, u, v;
+    if (ax >= ay && ax >= az) { face = x < 0;     m = ax; u = y; v = z; }
+    else if (ay >= az)        { face = 2 + (y < 0); m = ay; u = x; v = z; }
+    else                      { face = 4 + (z < 0); m = az; u = x; v = y; }
+    double scale = 0.5 * side / m;
+    int i = std::min(side - 1, std::max(0, (int)((u + m) * scale)));
+    int j = std::min(side - 1, std::max(0, (int)((v + m) * scale)));
+    return (face * side + j) * side + i;
+}
+
+template<bool ALL>
+void VisibilityEngine::test(const int* candidates, int count,
+                            double rx, double ry, double rz, VisibleSet& out) const
+{
+    out.clear();
+    // Local frame: geodetic up is the ellipsoid normal (x, y, z / (1 - e2))
+    double ux = rx, uy = ry, uz = rz / (1 - E2);
+    double un = 1.0 / sqrt(ux*ux + uy*uy + uz*uz);
+    ux *= un; uy *= un; uz *= un;
+    double eh = sqrt(rx*rx + ry*ry);
+    double ex = eh > 0 ? -ry / eh : 0.0, ey = eh > 0 ? rx / eh : 1.0;   // east
+    double nx = -uz * ey, ny = uz * ex, nz = ux * ey - uy * ex;         // north = up x east
+
+    for (int k = 0; k < count; k++) {
+        int i = ALL ? k : candidates[k];
+        double dx = satX[i] - rx, dy = satY[i] - ry, dz = satZ[i] - rz;
+        double up = dx*ux + dy*uy + dz*uz;
+        double d2 = dx*dx + dy*dy + dz*dz;
+        // elevation >= mask  <=>  up >= sin(mask) |d|, tested without sqrt
+        if (maskNonNegative) {
+            if (up < 0 || up * up < sinMask2 * d2) continue;
+        } else if (up < 0 && up * up > sinMask2 * d2) {
+            continue;
+        }
+        out.push(i, dx*ex + dy*ey, dx*nx + dy*ny + dz*nz, up);
+    }
+}
+
+void VisibilityEngine::visible(double rx, double ry, double rz, VisibleSet& out) const {
+    GNSS_STAGE(STAGE_VISIBILITY);
+    int k = cellOf(rx, ry, rz);
+    test<false>(cellSats.data() + cellStart[k], cellStart[k + 1] - cellStart[k], rx, ry, rz, out);
+}
+
+void VisibilityEngine::visibleAll(double rx, double ry, double rz, VisibleSet& out) const {
+    GNSS_STAGE(STAGE_VISIBILITY);
+    test<true>(nullptr, nSats, rx, ry, rz, out);
+}
+
+int VisibilityEngine::candidates(double rx, double ry, double rz) const {
+    int k = cellOf(rx, ry, rz);
+    return cellStart[k + 1] - cellStart[k];
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+
+class Constellation;
+
+// Satellites visible from one receiver with their line of sight in the
+// receiver's local east/north/up frame. Look angles are derived from it on
+// request, so selecting satellites costs no trig. Storage is kept between
+// epochs, so refilling it does not allocate after warm-up.
+//
+// Storage is a whole number of PADDING-wide blocks, so fixed-width kernels
+// may read a full block past size(). Those entries are stale (or zero) but
+// finite, and the kernels drop their results or write them to the same
+// padding of their outputs (sized with padded()).
+class VisibleSet {
+public:
+    static const int PADDING = 8;
+    static int padded(int count) { return (count + PADDING - 1) / PADDING * PADDING; }
+
+private:
+    std::vector<int>    sats;
+    std::vector<double> east, north, up;    // line of sight, metres
+    int n = 0;
+
+public:
+    void reserve(int capacity) {
+        capacity = padded(capacity);
+        if ((int)sats.size() < capacity) {
+            sats.resize(capacity);
+            east.resize(capacity); north.resize(capacity); up.resize(capacity);
+        }
+    }
+    void clear() { n = 0; }
+    void push(int sat, double e, double nn, double u) {
+        if (n == (int)sats.size()) reserve(n < 8 ? 16 : 2 * n);
+        sats[n] = sat; east[n] = e; north[n] = nn; up[n] = u;
+        n++;
+    }
+
+    int size() const { return n; }
+    int capacity() const { return (int)sats.size(); }   // a multiple of PADDING
+    int satellite(int i) const { return sats[i]; }
+
+    double elevation(int i) const;       // rad
+    double azimuth(int i) const;         // rad in [0, 2 pi), clockwise from north
+
+    // Line of sight of every satellite, for batch kernels (padded, see above)
+    const double* eastData() const  { return east.data(); }
+    const double* northData() const { return north.data(); }
+    const double* upData() const    { return up.data(); }
+    const int*    satelliteData() const { return sats.data(); }
+};
+
+// Elevation-mask visibility for any number of receivers.
+//
+// A satellite is visible when its elevation above the receiver's local
+// (geodetic) horizon is at least the mask angle. The test compares
+// (d . up)^2 against sin^2(mask) |d|^2, so rejected satellites cost no
+// sqrt or trig; elevation and azimuth are only computed for the visible
+// ones.
+//
+// For fleets, update() bins the satellites once per epoch into sky cells: a
+// satellite is listed in every cell that overlaps its visibility cap (the
+// ground region from which it clears the mask). A receiver then tests only
+// the candidates of its own cell instead of the whole constellation. Cells
+// are a gnomonic cube map, so finding a receiver's cell is a division, not
+// trig, and every cell edge is a great circle (its farthest point from the
+// centre is a corner). The cap shrinks with receiver height, so it is sized
+// for a receiver 1 km below the polar radius and widened by the
+// geodetic/geocentric vertical difference: the grid never drops a
+// satellite the exact test would accept.
+class VisibilityEngine {
+private:
+    double maskRad;
+    double sinMask, sinMask2;
+    bool   maskNonNegative;
+
+    // Sky-cell grid: 6 cube faces x side x side cells
+    int    side;
+    std::vector<double> cellUx, cellUy, cellUz;   // cell centre unit vectors
+    std::vector<double> cellCosR, cellSinR;      // cos/sin of each cell's angular radius
+    std::vector<int>    cellStart;               // CSR: candidates of cell c are
+    std::vector<int>    cellSats;                // cellSats[cellStart[c] .. cellStart[c+1])
+
+    // Satellites binned by the last update()
+    const double* satX = nullptr;
+    const double* satY = nullptr;
+    const double* satZ = nullptr;
+    int nSats = 0;
+    std::vector<double> capCos, capSin;          // cap half-angle (+ margin), per satellite
+    std::vector<double> unitX, unitY, unitZ;     // satellite direction from Earth's centre
+
+    int cellOf(double x, double y, double z) const;
+    template<bool ALL>
+    void test(const int* candidates, int count,
+              double rx, double ry, double rz, VisibleSet& out) const;
+
+public:
+    // `cellDeg` is the approximate cell width at a cube face centre
+    explicit VisibilityEngine(double maskDeg = 5.0, double cellDeg = 10.0);
+
+    void   setMask(double maskDeg);
+    double getMaskDeg() const;
+
+    // Points the engine at this epoch's satellite positions without binning
+    // them; enough for visibleAll(). The arrays must stay valid (and
+    // unchanged) until they are replaced.
+    void setSatellites(const double* x, const double* y, const double* z, int count);
+    void setSatellites(const Constellation& satellites);
+
+    // setSatellites() plus binning into the sky-cell grid, for visible()
+    void update(const double* x, const double* y, const double* z, int count);
+    void update(const Constellation& satellites);
+
+    // Visible satellites from receiver (rx, ry, rz) (ECEF, metres), using
+    // the grid candidates from the last update()
+    void visible(double rx, double ry, double rz, VisibleSet& out) const;
+
+    // Same result, testing every satellite (no grid); for single receivers
+    void visibleAll(double rx, double ry, double rz, VisibleSet& out) const;
+
+    // Candidate count of the receiver's cell (for diagnostics/benchmarks)
+    int candidates(double rx, double ry, double rz) const;
+};
@@ -1,13 +1,17 @@
-#define GL_SILENCE_DEPRECATION
+#define GLFW_INCLUDE_NONE
 #include "Visualizer_gl.h"
+#include "Visibility.h"
+#include "Renderer_gl.h"
+#include "Playback_gl.h"
+#include "TraceReader.h"
 #include </opt/homebrew/include/GLFW/glfw3.h>
-#include <OpenGL/gl.h>
 #include <iostream>
 #include <cmath>
-#include <vector>
-#include <array>
+#include <algorithm>
+#include <string>
+#include <cstdio>
 
-static double camYaw=30, camPitch=20, camDist=2.5;
+static OrbitCamera camera;
 static double lastX, lastY; static bool dragging=false;
 
 static void mouseButtonCB(GLFWwindow* w,int btn,int action,int){
@@ -15,65 +19,41 @@ static void mouseButtonCB(GLFWwindow* w,int btn,int action,int){
 }
 static void cursorCB(GLFWwindow*,double x,double y){
     if(!dragging)return;
-    camYaw+=(x-lastX)*0.4; camPitch+=(y-lastY)*0.4;
-    camPitch=std::max(-89.0,std::min(89.0,camPitch));
+    camera.yaw+=(x-lastX)*0.4; camera.pitch+=(y-lastY)*0.4;
+    camera.pitch=std::max(-89.0,std::min(89.0,camera.pitch));
     lastX=x;lastY=y;
 }
 static void scrollCB(GLFWwindow*,double,double dy){
-    camDist-=dy*0.15; camDist=std::max(1.2,std::min(8.0,camDist));
+    camera.dist-=dy*0.15; camera.dist=std::max(1.2,std::min(8.0,camera.dist));
 }
 
-static void drawSphere(double r,int sl,int st){
-    for(int i=0;i<st;i++){
-        double lat0=M_PI*(-0.5+(double)i/st),lat1=M_PI*(-0.5+(double)(i+1)/st);
-        double z0=sin(lat0),zr0=cos(lat0),z1=sin(lat1),zr1=cos(lat1);
-        glBegin(GL_QUAD_STRIP);
-        for(int j=0;j<=sl;j++){
-            double lng=2*M_PI*(double)j/sl,x=cos(lng),y=sin(lng);
-            glVertex3d(r*x*zr0,r*y*zr0,r*z0);
-            glVertex3d(r*x*zr1,r*y*zr1,r*z1);
-        }
-        glEnd();
-    }
-}
-
-static void drawCircle(double r,int seg){
-    glBegin(GL_LINE_LOOP);
-    for(int i=0;i<seg;i++){double a=2*M_PI*i/seg; glVertex3d(r*cos(a),r*sin(a),0);}
-    glEnd();
-}
-
-static void applyCamera(){
-    double yr=camYaw*M_PI/180,pr=camPitch*M_PI/180;
-    double cx=camDist*cos(pr)*sin(yr),cy=camDist*sin(pr),cz=camDist*cos(pr)*cos(yr);
-    double fx=-cx,fy=-cy,fz=-cz,fl=sqrt(fx*fx+fy*fy+fz*fz);
-    fx/=fl;fy/=fl;fz/=fl;
-    double sx=fy*0-fz*1,sy=fz*0-fx*0,sz=fx*1-fy*0,sl2=sqrt(sx*sx+sy*sy+sz*sz);
-    sx/=sl2;sy/=sl2;sz/=sl2;
-    double ux=sy*fz-sz*fy,uy=sz*fx-sx*fz,uz=sx*fy-sy*fx;
-    double mv[16]={sx,ux,-fx,0,sy,uy,-fy,0,sz,uz,-fz,0,
-        -(sx*cx+sy*cy+sz*cz),-(ux*cx+uy*cy+uz*cz),(fx*cx+fy*cy+fz*cz),1};
-    glLoadMatrixd(mv);
-}
-
-void runGLVisualizer(std::vector<Satellite>& satellites,
+void runGLVisualizer(Constellation& satellites,
                      double earthRadius, double angularSpeed)
 {
     if(!glfwInit()) return;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT,GLFW_TRUE);
     GLFWwindow* win=glfwCreateWindow(1000,800,"GNSS Satellite Visualizer",nullptr,nullptr);
     if(!win){glfwTerminate();return;}
     glfwMakeContextCurrent(win);
     glfwSetMouseButtonCallback(win,mouseButtonCB);
     glfwSetCursorPosCallback(win,cursorCB);
     glfwSetScrollCallback(win,scrollCB);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_POINT_SMOOTH);
+
+    SkyRenderer renderer;
+    std::string err;
+    if(!renderer.init(&err)){
+        std::cout<<"Renderer: "<<err<<"\n";
+        glfwDestroyWindow(win); glfwTerminate(); return;
+    }
 
     const double S=1.0/earthRadius;
-    const double satR=26571000.0*S;
-    std::vector<std::array<double,3>> trail;
+    renderer.setOrbits(satellites,S);
+    VisibilityEngine visibility;        // default 5 degree mask
+    VisibleSet visibleSats;
+    visibleSats.reserve(satellites.size());
     double simTime=0, prevWall=glfwGetTime();
 
     while(!glfwWindowShouldClose(win)){
@@ -82,58 +62,144 @@ void runGLVisualizer(std::vector<Satellite>& satellites,
 
         double theta=angularSpeed*simTime;
         double rx=cos(theta),ry=sin(theta),rz=0.0;
-        trail.push_back({rx,ry,rz});
-        if(trail.size()>500) trail.erase(trail.begin());
-        for(auto& sat:satellites) sat.update(simTime);
+        satellites.update(simTime);
+        visibility.setSatellites(satellites);
+        visibility.visibleAll(rx*earthRadius,ry*earthRadius,rz*earthRadius,visibleSats);
+
+        renderer.pushReceiver(rx,ry,rz);
+        renderer.setSatellites(satellites,S);
+        renderer.setSignals(satellites,visibleSats,S);
 
         int W,H; glfwGetFramebufferSize(win,&W,&H);
-        glViewport(0,0,W,H);
-        glClearColor(0.02f,0.02f,0.08f,1);
-        glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-
-        glMatrixMode(GL_PROJECTION); glLoadIdentity();
-        double asp=(double)W/H, f=1.0/tan(22.5*M_PI/180);
-        double zN=0.01,zF=200;
-        double pr[16]={f/asp,0,0,0,0,f,0,0,0,0,(zF+zN)/(zN-zF),-1,0,0,2*zF*zN/(zN-zF),0};
-        glLoadMatrixd(pr);
-        glMatrixMode(GL_MODELVIEW); glLoadIdentity();
-        applyCamera();
-
-        // Earth
-        glColor3f(0.1f,0.25f,0.55f); drawSphere(1.0,36,18);
-        glLineWidth(1); glColor3f(0.25f,0.25f,0.5f); drawCircle(1.001,64);
-
-        // Orbital rings
-        for(int p=0;p<6;p++){
-            glPushMatrix(); glRotated(p*60,0,0,1); glRotated(55,1,0,0);
-            glColor3f(0.15f,0.15f,0.15f); drawCircle(satR,64);
-            glPopMatrix();
-        }
+        renderer.draw(W,H,camera);
 
-        // Satellites + signal lines
-        double recMag=sqrt(rx*rx+ry*ry+rz*rz);
-        for(auto& sat:satellites){
-            double sx=sat.getX()*S,sy=sat.getY()*S,sz=sat.getZ()*S;
-            glPointSize(6); glColor3f(1,0.9f,0.2f);
-            glBegin(GL_POINTS); glVertex3d(sx,sy,sz); glEnd();
-            double dot=sx*rx+sy*ry+sz*rz,sm=sqrt(sx*sx+sy*sy+sz*sz);
-            if(recMag>0&&dot/(sm*recMag)>0){
-                glColor4f(0.2f,1,0.3f,0.18f);
-                glBegin(GL_LINES); glVertex3d(sx,sy,sz); glVertex3d(rx,ry,rz); glEnd();
-            }
-        }
+        glfwSwapBuffers(win); glfwPollEvents();
+    }
+    renderer.release();
+    glfwDestroyWindow(win); glfwTerminate();
+}
+
+// ===== Trace playback =====
+static PlaybackView* playView=nullptr;
+static PlaybackWindow playWin;
+static bool playing=true, wholeTrace=true, scrubbing=false, panning=false;
+static double playSpeed=1.0;            // window lengths per 10 s
+static double panX;
+
+// Cursor position in framebuffer pixels (differs from window units on HiDPI)
+static void framebufferCursor(GLFWwindow* w,double& x,double& y,int& W,int& H){
+    int ww,wh; glfwGetWindowSize(w,&ww,&wh); glfwGetFramebufferSize(w,&W,&H);
+    glfwGetCursorPos(w,&x,&y);
+    x*=(double)W/std::max(1,ww); y*=(double)H/std::max(1,wh);
+}
+static void clampCursor(){ playWin.cursor=std::max(playWin.start,std::min(playWin.end,playWin.cursor)); }
+
+static void playKeyCB(GLFWwindow*,int key,int,int action,int){
+    if(action!=GLFW_PRESS&&action!=GLFW_REPEAT) return;
+    double len=playWin.end-playWin.start;
+    if(key==GLFW_KEY_SPACE) playing=!playing;
+    else if(key==GLFW_KEY_LEFT){ playWin.cursor-=0.01*len; clampCursor(); }
+    else if(key==GLFW_KEY_RIGHT){ playWin.cursor+=0.01*len; clampCursor(); }
+    else if(key==GLFW_KEY_UP) playSpeed*=2;
+    else if(key==GLFW_KEY_DOWN) playSpeed/=2;
+    else if(key==GLFW_KEY_HOME) wholeTrace=true;
+    else if(key==GLFW_KEY_PAGE_DOWN){
+        int runs=playView->summary().runCount();
+        if(playView->firstRun+PlaybackView::MAX_RUNS<runs) playView->firstRun+=PlaybackView::MAX_RUNS;
+    }
+    else if(key==GLFW_KEY_PAGE_UP) playView->firstRun=std::max(0,playView->firstRun-PlaybackView::MAX_RUNS);
+}
+static void playButtonCB(GLFWwindow* w,int btn,int action,int){
+    double x,y; int W,H; framebufferCursor(w,x,y,W,H);
+    if(btn==GLFW_MOUSE_BUTTON_LEFT){
+        scrubbing=action==GLFW_PRESS&&playView->onStrip(y,H);
+        if(scrubbing){ playWin.cursor=playView->timeAt(x,W,playWin); clampCursor(); }
+    }
+    if(btn==GLFW_MOUSE_BUTTON_RIGHT){ panning=action==GLFW_PRESS; panX=x; }
+}
+static void playCursorCB(GLFWwindow* w,double,double){
+    if(!scrubbing&&!panning) return;
+    double x,y; int W,H; framebufferCursor(w,x,y,W,H);
+    if(scrubbing){ playWin.cursor=playView->timeAt(x,W,playWin); clampCursor(); }
+    if(panning){
+        double dt=playView->timeAt(panX,W,playWin)-playView->timeAt(x,W,playWin);
+        playWin.start+=dt; playWin.end+=dt; playWin.cursor+=dt; wholeTrace=false; panX=x;
+    }
+}
+static void playScrollCB(GLFWwindow* w,double,double dy){
+    double x,y; int W,H; framebufferCursor(w,x,y,W,H);
+    double pivot=playView->onStrip(y,H)?playView->timeAt(x,W,playWin):playWin.cursor;
+    double f=std::pow(0.8,dy);
+    playWin.start=pivot+(playWin.start-pivot)*f;
+    playWin.end=pivot+(playWin.end-pivot)*f;
+    wholeTrace=false; clampCursor();
+}
 
-        // Receiver trail
-        glLineWidth(2); glColor3f(0.8f,0.2f,0.2f);
-        glBegin(GL_LINE_STRIP);
-        for(auto& p:trail) glVertex3d(p[0],p[1],p[2]);
-        glEnd();
+void runPlayback(const std::string& path)
+{
+    TraceReader trace;
+    std::string err;
+    if(!trace.open(path,&err)){ std::cout<<"Playback: "<<err<<"\n"; return; }
+    std::cout<<"Playing "<<trace.size()<<" epochs from "<<path<<"\n"
+             <<"  space play/pause, left/right step, up/down speed, scroll zoom, drag strip to scrub,\n"
+             <<"  right-drag pan, home whole trace, page up/down other runs\n";
+    if(!glfwInit()) return;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT,GLFW_TRUE);
+    GLFWwindow* win=glfwCreateWindow(1400,800,"GNSS Trace Playback",nullptr,nullptr);
+    if(!win){glfwTerminate();return;}
+    glfwMakeContextCurrent(win);
+    glfwSetKeyCallback(win,playKeyCB);
+    glfwSetMouseButtonCallback(win,playButtonCB);
+    glfwSetCursorPosCallback(win,playCursorCB);
+    glfwSetScrollCallback(win,playScrollCB);
+
+    PlaybackView view;
+    if(!view.init(&err)){
+        std::cout<<"Playback: "<<err<<"\n";
+        glfwDestroyWindow(win); glfwTerminate(); return;
+    }
+    playView=&view;
+    view.open(trace);
+    double prevWall=glfwGetTime(), titleWall=0;
 
-        // Receiver dot
-        glPointSize(10); glColor3f(1,0.2f,0.2f);
-        glBegin(GL_POINTS); glVertex3d(rx,ry,rz); glEnd();
+    while(!glfwWindowShouldClose(win)){
+        double now=glfwGetTime(), dt=now-prevWall; prevWall=now;
+        // Summarize the trace a slice per frame so the window stays live
+        if(!view.summary().complete()) view.load(1<<18);
+        const TraceSpan& all=view.summary().overall();
+        if(wholeTrace&&all.records>0){
+            playWin.start=all.t0; playWin.end=std::max(all.t1,all.t0+1e-3);
+        }
+        double len=playWin.end-playWin.start;
+        if(playing&&!scrubbing){
+            playWin.cursor+=dt*playSpeed*len/10;
+            // Page the window along with the cursor once zoomed in
+            if(playWin.cursor>playWin.end&&!wholeTrace&&playWin.end<all.t1){
+                playWin.start+=len; playWin.end+=len;
+            }
+            clampCursor();
+        }
 
+        int W,H; glfwGetFramebufferSize(win,&W,&H);
+        view.draw(W,H,playWin);
+
+        if(now-titleWall>0.25){
+            char title[256];
+            std::snprintf(title,sizeof(title),
+                "GNSS Trace Playback  |  t=%.1f s  window %.1f s  |  runs %d-%d of %d  |  %s %d  |  %d vertices%s",
+                playWin.cursor,len,view.firstRun,std::min(view.firstRun+PlaybackView::MAX_RUNS,
+                view.summary().runCount())-1,view.summary().runCount(),
+                view.lastLevel()<0?"records":"level",std::max(0,view.lastLevel()),view.lastVertexCount(),
+                view.summary().complete()?"":"  |  loading");
+            glfwSetWindowTitle(win,title);
+            titleWall=now;
+        }
         glfwSwapBuffers(win); glfwPollEvents();
     }
+    view.release();
+    playView=nullptr;
     glfwDestroyWindow(win); glfwTerminate();
-}
\ No newline at end of file
+}
@@ -1,7 +1,11 @@
 #pragma once
-#include <vector>
-#include "Satellite.h"
+#include <string>
+#include "Constellation.h"
 
-void runGLVisualizer(std::vector<Satellite>& satellites,
+void runGLVisualizer(Constellation& satellites,
                      double earthRadius,
-                     double angularSpeed);
\ No newline at end of file
+                     double angularSpeed);
+
+// Replays a trace written by gnss_sim (--trace) with level-of-detail
+// decimation, so traces of millions of epochs scrub and zoom interactively
+void runPlayback(const std::string& path);
@@ -4,136 +4,540 @@
 #include <fstream>
 #include <string>
 #include <array>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
 
-#include "Satellite.h"
-#include "Receiver.h"
+#include "Scenario.h"
+#include "MonteCarlo.h"
+#include "Sweep.h"
+#include "Evaluation.h"
+#include "Fleet.h"
+#include "Ephemeris.h"
+#include "RinexNav.h"
+#include "TraceWriter.h"
+#include "Geodesy.h"
+#include "Visibility.h"
 #include "Spoofer.h"
-#include "Detector.h"
-#include "Visualizer.h"
-
-std::array<double,3> lla_to_ecef(double lat_deg,double lon_deg,double alt_m){
-    const double a=6378137.0, e2=0.00669437999014;
-    double lat=lat_deg*M_PI/180, lon=lon_deg*M_PI/180;
-    double N=a/sqrt(1-e2*sin(lat)*sin(lat));
-    return {(N+alt_m)*cos(lat)*cos(lon),(N+alt_m)*cos(lat)*sin(lon),(N*(1-e2)+alt_m)*sin(lat)};
+#include "CaCode.h"
+#include "SignalGenerator.h"
+#include "Acquisition.h"
+#include "Tracking.h"
+#include "Trajectory.h"
+#include "GnssSystems.h"
+#include "SignalPath.h"
+
+// Replays a broadcast-ephemeris file for one day at 1 Hz and reports throughput
+int runEphemerisReplay(const std::string& path){
+    std::vector<BroadcastEphemeris> records;
+    std::string err;
+    if(!loadRinexNav(path,records,&err)){ std::cout<<"RINEX load failed: "<<err<<"\n"; return 1; }
+    EphemerisPropagator prop;
+    prop.load(records);
+    if(prop.size()==0){ std::cout<<"No GPS/Galileo/QZSS ephemerides in "<<path<<"\n"; return 1; }
+
+    const double t0=prop.firstToe();
+    const int epochs=86400;
+    auto start=std::chrono::steady_clock::now();
+    double meanRadius=0;
+    for(int k=0;k<epochs;k++){
+        prop.update(t0+k);
+        meanRadius+=sqrt(prop.getX(0)*prop.getX(0)+prop.getY(0)*prop.getY(0)+prop.getZ(0)*prop.getZ(0));
+    }
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    std::cout<<"Loaded "<<records.size()<<" records for "<<prop.size()<<" satellites\n";
+    std::cout<<"Replayed "<<epochs<<" epochs (1 Hz, 24 h) in "<<secs<<" s  ("
+             <<(double)epochs*prop.size()/secs<<" sat-epochs/s, "
+             <<(double)prop.getKeplerIterations()/((double)epochs*prop.size())<<" Kepler iterations/sat-epoch)\n";
+    std::cout<<"Mean orbit radius of "<<prop.getSystem(0)<<prop.getPrn(0)<<": "<<meanRadius/epochs/1000.0<<" km\n";
+    return 0;
+}
+
+// Randomized batch for detector tuning: gnss_sim montecarlo <runs> [threads] [seed]
+int runMonteCarloBatch(int argc,char* argv[]){
+    long long runs=argc>=3?atoll(argv[2]):10000;
+    int threads=argc>=4?atoi(argv[3]):0;
+    uint64_t seed=argc>=5?strtoull(argv[4],nullptr,10):1;
+
+    auto start=std::chrono::steady_clock::now();
+    MonteCarloStats st=runMonteCarlo(runs,seed,threads);
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    long long cleanEpochs=st.epochs-st.spoofedEpochs;
+    std::cout<<"Monte Carlo: "<<st.runs<<" runs ("<<st.spoofedRuns<<" spoofed), "
+             <<st.epochs<<" epochs, seed "<<seed<<"\n";
+    std::cout<<"  P(detect | spoofed epoch) = "<<(st.spoofedEpochs?(double)st.truePositives/st.spoofedEpochs:0)<<"\n";
+    std::cout<<"  P(alarm  | clean epoch)   = "<<(cleanEpochs?(double)st.falseAlarms/cleanEpochs:0)<<"\n";
+    std::cout<<"  spoofed runs detected     = "<<st.detectedRuns<<" / "<<st.spoofedRuns<<"\n";
+    std::cout<<"  mean detection delay      = "<<(st.detectedRuns?st.sumDetectionDelay/st.detectedRuns:0)<<" s\n";
+    std::cout<<"  runs entering no-fly zone = "<<st.noFlyRuns<<"\n";
+    std::cout<<"  max position error        = "<<st.maxPositionError<<" m\n";
+    std::cout<<"  wall time "<<secs<<" s  ("<<st.runs/secs<<" runs/s, "<<st.epochs/secs<<" epochs/s)\n";
+    return 0;
 }
 
-std::vector<double> solvePositionLeastSquares(
-    const std::vector<std::vector<double>>& satPositions,
-    const std::vector<double>& pseudoranges,
-    double initX,double initY,double initZ)
-{
-    double x=initX,y=initY,z=initZ,clockBias=0;
-    for(int iter=0;iter<20;iter++){
-        double HtH[4][4]={0},Htr[4]={0};
-        for(int i=0;i<(int)satPositions.size();i++){
-            double dx=x-satPositions[i][0],dy=y-satPositions[i][1],dz=z-satPositions[i][2];
-            double range=sqrt(dx*dx+dy*dy+dz*dz);
-            if(range<1) continue;
-            double res=pseudoranges[i]-(range+clockBias);
-            double H[4]={dx/range,dy/range,dz/range,1};
-            for(int r=0;r<4;r++){Htr[r]+=H[r]*res;for(int c=0;c<4;c++)HtH[r][c]+=H[r]*H[c];}
+// Many drones in one sky: gnss_sim fleet <receivers> [epochs] [threads] [seed]
+int runFleetBatch(int argc,char* argv[]){
+    FleetConfig cfg;
+    cfg.receivers=argc>=3?atoi(argv[2]):10000;
+    cfg.epochs=argc>=4?atoi(argv[3]):60;
+    int threads=argc>=5?atoi(argv[4]):0;
+    cfg.seed=argc>=6?strtoull(argv[5],nullptr,10):1;
+
+    auto start=std::chrono::steady_clock::now();
+    FleetStats st=runFleet(cfg,threads);
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    long long cleanEpochs=st.receiverEpochs-st.spoofedEpochs;
+    std::cout<<"Fleet: "<<cfg.receivers<<" receivers x "<<cfg.epochs<<" epochs, seed "<<cfg.seed<<"\n";
+    std::cout<<"  solved fixes              = "<<st.solved<<" / "<<st.receiverEpochs<<"\n";
+    std::cout<<"  P(detect | spoofed epoch) = "<<(st.spoofedEpochs?(double)st.truePositives/st.spoofedEpochs:0)<<"\n";
+    std::cout<<"  P(alarm  | clean epoch)   = "<<(cleanEpochs?(double)st.falseAlarms/cleanEpochs:0)<<"\n";
+    std::cout<<"  max clean position error  = "<<st.maxCleanError<<" m\n";
+    std::cout<<"  wall time "<<secs<<" s  ("<<st.receiverEpochs/secs<<" receiver-epochs/s)\n";
+    return 0;
+}
+
+// Signal-level run: gnss_sim acquire [seconds] [spoof]
+// Generates L1 C/A samples for the Toronto sky one second at a time and
+// acquires all 32 PRNs at the start of each second
+int runAcquisitionDemo(int argc,char* argv[]){
+    int seconds=argc>=3?atoi(argv[2]):4;
+    bool spoof=argc>=4&&atoi(argv[3])!=0;
+
+    Constellation sats=buildGpsConstellation();
+    auto rx=lla_to_ecef(43.6426,-79.3871,200);
+    auto fake=lla_to_ecef(43.7,-79.0,200);
+    Spoofer spoofer(fake[0],fake[1],fake[2]);
+    VisibilityEngine visibility;
+    VisibleSet visible;
+    visible.reserve(sats.size());
+
+    SignalConfig sc;
+    SignalGenerator gen(sc);
+    AcquisitionEngine acq;
+    if(!acq.valid()){ std::cout<<"Acquisition needs a power-of-two sample count per ms\n"; return 1; }
+    const int n=(int)sc.sampleRate;
+    std::vector<float> re(n),im(n);
+    int prns[32];
+    for(int i=0;i<32;i++) prns[i]=i+1;
+    AcquisitionResult res[32];
+
+    const double t0=5000.0, clockBias=1234.0;
+    double genSecs=0,acqSecs=0;
+    for(int s=0;s<seconds;s++){
+        double t=t0+s;
+        sats.update(t);
+        visibility.setSatellites(sats);
+        visibility.visibleAll(rx[0],rx[1],rx[2],visible);
+        gen.setSky(sats,visible,rx[0],rx[1],rx[2],clockBias,t,spoof?&spoofer:nullptr);
+        std::vector<SignalSource> truth=gen.getSources();
+
+        auto start=std::chrono::steady_clock::now();
+        gen.generate(n,re.data(),im.data());
+        auto mid=std::chrono::steady_clock::now();
+        acq.search(re.data(),im.data(),prns,32,res);
+        auto stop=std::chrono::steady_clock::now();
+        genSecs+=std::chrono::duration<double>(mid-start).count();
+        acqSecs+=std::chrono::duration<double>(stop-mid).count();
+
+        int acquired=0;
+        for(auto& r:res) acquired+=r.acquired;
+        std::cout<<"t="<<t<<" s: "<<visible.size()<<" visible, "<<acquired<<" acquired\n";
+        if(s>0) continue;
+        for(auto& r:res){
+            if(!r.acquired) continue;
+            std::cout<<"  PRN "<<r.prn<<": code "<<r.codePhase<<" chips, Doppler "<<r.doppler
+                     <<" Hz, metric "<<r.peakMetric;
+            if(r.secondMetric>8.0) std::cout<<" | second peak "<<r.secondCodePhase<<" chips, metric "<<r.secondMetric;
+            std::cout<<"\n";
+            for(auto& src:truth)
+                if(src.prn==r.prn)
+                    std::cout<<"      "<<(src.spoofed?"counterfeit":"authentic  ")<<" code "<<src.codePhase
+                             <<" chips, Doppler "<<src.doppler<<" Hz\n";
         }
-        double A[4][5];
-        for(int i=0;i<4;i++){for(int j=0;j<4;j++)A[i][j]=HtH[i][j];A[i][4]=Htr[i];}
-        for(int i=0;i<4;i++){
-            int mr=i;double mv=fabs(A[i][i]);
-            for(int k=i+1;k<4;k++)if(fabs(A[k][i])>mv){mv=fabs(A[k][i]);mr=k;}
-            if(mr!=i)for(int j=0;j<5;j++)std::swap(A[i][j],A[mr][j]);
-            double piv=A[i][i];if(fabs(piv)<1e-10)continue;
-            for(int j=i;j<5;j++)A[i][j]/=piv;
-            for(int k=0;k<4;k++){if(k==i)continue;double f=A[k][i];for(int j=i;j<5;j++)A[k][j]-=f*A[i][j];}
+    }
+    std::cout<<"Generated "<<seconds<<" s at "<<sc.sampleRate/1e6<<" MHz in "<<genSecs<<" s, acquisition "
+             <<acqSecs<<" s  ("<<seconds/(genSecs+acqSecs)<<"x real time)\n";
+    return 0;
+}
+
+// Signal-level drag-off: gnss_sim track [seconds] [drag start s, <0 = clean]
+// Acquires and tracks the Toronto sky while a spoofer 2 km north starts
+// aligned with the real signals and ramps its power (and so its code-phase
+// offset) over 20 s; the tracking loops' correlator measurements are fed
+// to the detector once per second
+int runTrackingDemo(int argc,char* argv[]){
+    int seconds=argc>=3?atoi(argv[2]):12;
+    double dragStart=argc>=4?atof(argv[3]):4.0;
+    const double ramp=20.0, clockBias=1234.0, t0=5000.0;
+
+    Constellation sats=buildGpsConstellation();
+    auto rx=lla_to_ecef(43.6426,-79.3871,200);
+    auto fake=lla_to_ecef(43.6426+2.0/111.0,-79.3871,200);
+    VisibilityEngine visibility;
+    VisibleSet visible;
+    visible.reserve(sats.size());
+    EpochPipeline pipeline(sats,Spoofer(fake[0],fake[1],fake[2],0.0),clockBias);
+
+    SignalConfig sc;
+    SignalGenerator gen(sc);
+    AcquisitionEngine acq;
+    TrackingBank bank;
+    bank.reserve(CaCodeTable::MAX_PRN);
+    const int block=(int)(sc.sampleRate*0.02);      // sky refreshed every 20 ms
+    std::vector<float> re(block),im(block);
+
+    double trackSecs=0;
+    for(int b=0;b<seconds*50;b++){
+        double t=t0+b*0.02;
+        double power=dragStart>=0&&t-t0>dragStart?std::min(1.0,(t-t0-dragStart)/ramp):0.0;
+        Spoofer spoofer(fake[0],fake[1],fake[2],power);
+        sats.update(t);
+        visibility.setSatellites(sats);
+        visibility.visibleAll(rx[0],rx[1],rx[2],visible);
+        gen.setSky(sats,visible,rx[0],rx[1],rx[2],clockBias,t,&spoofer);
+        gen.generate(block,re.data(),im.data());
+
+        if(b==0){
+            int prns[CaCodeTable::MAX_PRN];
+            AcquisitionResult res[CaCodeTable::MAX_PRN];
+            for(int i=0;i<CaCodeTable::MAX_PRN;i++) prns[i]=i+1;
+            acq.search(re.data(),im.data(),prns,CaCodeTable::MAX_PRN,res);
+            for(auto& r:res) if(r.acquired) bank.addChannel(r.prn,r.codePhase,r.doppler);
+            std::cout<<"Acquired "<<bank.size()<<" of "<<visible.size()<<" visible satellites\n";
         }
-        double du=A[0][4],dv=A[1][4],dw=A[2][4],db=A[3][4];
-        const double ms=1e5;
-        x+=std::max(-ms,std::min(ms,du)); y+=std::max(-ms,std::min(ms,dv));
-        z+=std::max(-ms,std::min(ms,dw)); clockBias+=db;
-        if(fabs(du)<1e-4&&fabs(dv)<1e-4&&fabs(dw)<1e-4)break;
+        auto start=std::chrono::steady_clock::now();
+        bank.process(re.data(),im.data(),block);
+        trackSecs+=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+        if(b%50!=49) continue;
+        pipeline.setSpoofer(spoofer);
+        SignalQualityView q=bank.quality();
+        EpochResult r=pipeline.step(t+0.02,rx[0],rx[1],rx[2],1.0,power>0,&q);
+        if(!r.valid) continue;
+        const DetectionResult& d=r.detection;
+        std::cout<<"t="<<(int)std::lround(t+0.02-t0)<<" s  spoofer "<<power<<"  C/N0 "<<d.cn0Mean
+                 <<"  asym "<<d.asymmetryScore<<"  flat "<<d.flatnessScore<<"  power "<<d.powerScore
+                 <<" dB  conf "<<d.confidence<<"  "<<formatReason(d)<<"\n";
     }
-    return {x,y,z,clockBias};
+    std::cout<<"Tracked "<<bank.size()<<" channels over "<<seconds<<" s of samples in "<<trackSecs
+             <<" s  ("<<seconds/trackSecs<<"x real time)\n";
+    return 0;
 }
 
-ScenarioState runScenario(bool spoofMode) {
-    std::vector<std::array<double,3>> waypoints={
-        lla_to_ecef(43.6426,-79.3871,200),
-        lla_to_ecef(43.6500,-79.4500,200),
-        lla_to_ecef(43.6600,-79.5200,200),
-        lla_to_ecef(43.6700,-79.5800,200),
-        lla_to_ecef(43.6777,-79.6248,200),
-    };
-    std::vector<std::array<double,2>> waypoints_ll = {
-        {43.6426,-79.3871},{43.6500,-79.4500},{43.6600,-79.5200},
-        {43.6700,-79.5800},{43.6777,-79.6248},
-    };
-
-    auto pearson=lla_to_ecef(43.6777,-79.6248,173);
-    const double noFlyRadius=5000.0;
-    auto fake=lla_to_ecef(43.6426,-79.3871,200);
-    Spoofer spoofer(fake[0],fake[1],fake[2]);
+// High-rate flight: gnss_sim flight [rate Hz] [minutes] [trace file]
+// Flies CN Tower -> Pearson and back along a spline through the scenario
+// waypoints, with the constellation advanced by fixed-step recurrences.
+// With a trace file every epoch is recorded (run 0) for playback in gnss_gl.
+int runFlight(int argc,char* argv[]){
+    double rate=argc>=3?atof(argv[2]):10.0;
+    double minutes=argc>=4?atof(argv[3]):60.0;
+    if(rate<=0||minutes<=0){ std::cout<<"rate and duration must be positive\n"; return 1; }
+    TraceWriter trace;
+    if(argc>=5){
+        std::string terr;
+        if(!trace.open(argv[4],&terr)){ std::cout<<"Trace disabled: "<<terr<<"\n"; }
+    }
+    const NoFlyZone noFly=pearsonNoFlyZone();
+
+    const double leg[5][2]={{43.6426,-79.3871},{43.6500,-79.4500},{43.6600,-79.5200},
+                            {43.6700,-79.5800},{43.6777,-79.6248}};
+    std::vector<double> times;
+    std::vector<std::array<double,3>> points;
+    for(int k=0;times.empty()||times.back()<minutes*60;k++){
+        int i=(k/4)%2==0?k%4:4-k%4;     // out and back
+        times.push_back(360.0*k);
+        points.push_back(lla_to_ecef(leg[i][0],leg[i][1],200));
+    }
+    Trajectory path;
+    std::string err;
+    if(!path.build(times,points,&err)){ std::cout<<"Trajectory failed: "<<err<<"\n"; return 1; }
+
+    Constellation satellites=buildGpsConstellation();
+    EpochPipeline pipeline(satellites,Spoofer(0,0,0,0.0),0.12);
+    pipeline.setRangeNoise(3.0,7);
+    pipeline.setNavigation(NAV_FILTER);   // EKF across epochs instead of a fresh fix each one
+    const double dt=1.0/rate;
+    const long long epochs=(long long)(minutes*60*rate);
+    satellites.beginSteps(0.0,dt);
+
+    const int block=1024;
+    std::vector<TrajectoryState> states(block);
+    double maxError=0,sumSqError=0,maxSpeed=0,maxAccel=0;
+    long long alarms=0,fixes=0;
+    auto start=std::chrono::steady_clock::now();
+    for(long long e0=1;e0<=epochs;e0+=block){
+        int n=(int)std::min<long long>(block,epochs-e0+1);
+        path.sample(e0*dt,dt,n,states.data());
+        for(int k=0;k<n;k++){
+            const TrajectoryState& s=states[k];
+            EpochResult r=pipeline.step((e0+k)*dt,s.pos[0],s.pos[1],s.pos[2],dt,false);
+            if(trace.isOpen()){
+                bool inNoFly=noFly.contains(s.pos[0],s.pos[1],s.pos[2]);
+                trace.append(makeTraceRecord((e0+k)*dt,s.pos[0],s.pos[1],s.pos[2],r,0,false,inNoFly));
+            }
+            maxSpeed=std::max(maxSpeed,std::sqrt(s.vel[0]*s.vel[0]+s.vel[1]*s.vel[1]+s.vel[2]*s.vel[2]));
+            maxAccel=std::max(maxAccel,std::sqrt(s.acc[0]*s.acc[0]+s.acc[1]*s.acc[1]+s.acc[2]*s.acc[2]));
+            if(!r.valid) continue;
+            fixes++;
+            alarms+=r.detection.spoofingDetected;
+            double dx=r.estX-s.pos[0],dy=r.estY-s.pos[1],dz=r.estZ-s.pos[2];
+            maxError=std::max(maxError,std::sqrt(dx*dx+dy*dy+dz*dz));
+            sumSqError+=dx*dx+dy*dy+dz*dz;
+        }
+    }
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    std::cout<<"Flight: "<<minutes<<" min at "<<rate<<" Hz, "<<times.size()<<" waypoints\n";
+    std::cout<<"  fixes                     = "<<fixes<<" / "<<epochs<<"\n";
+    std::cout<<"  false alarms              = "<<alarms<<"\n";
+    std::cout<<"  max position error        = "<<maxError<<" m\n";
+    std::cout<<"  rms position error (EKF)  = "<<(fixes?std::sqrt(sumSqError/fixes):0.0)<<" m\n";
+    std::cout<<"  max speed / acceleration  = "<<maxSpeed<<" m/s, "<<maxAccel<<" m/s^2\n";
+    std::cout<<"  wall time "<<secs<<" s  ("<<epochs/secs<<" epochs/s, "<<minutes*60/secs<<"x real time)\n";
+    if(trace.isOpen()){
+        uint64_t records=trace.size();
+        if(trace.close()) std::cout<<"Wrote "<<records<<" epochs to "<<argv[4]<<"\n";
+        else std::cout<<"Trace write to "<<argv[4]<<" failed\n";
+    }
+    return 0;
+}
+
+// Multi-GNSS static fix: gnss_sim gnss [constellations file] [hours]
+// Loads Walker shells (default data/constellations.txt), puts every system's
+// time offset into its pseudoranges and solves each epoch four ways: GPS
+// alone, GPS + Galileo with two clocks, all systems with one clock per
+// system, and all systems forced onto a single clock.
+int runMultiGnss(int argc,char* argv[]){
+    std::string path=argc>=3?argv[2]:"data/constellations.txt";
+    double hours=argc>=4?atof(argv[3]):12.0;
+    std::vector<WalkerShell> shells;
+    std::string err;
+    if(!loadConstellations(path,shells,&err)){ std::cout<<"Constellation load failed: "<<err<<"\n"; return 1; }
+    if(hours<=0){ std::cout<<"duration must be positive\n"; return 1; }
+
+    Constellation satellites=buildConstellation(shells);
+    double offset[SYSTEM_COUNT]={0,0,0,0};
+    for(const WalkerShell& s:shells) offset[s.system]=s.timeOffset*SPEED_OF_LIGHT;
+    const double clockBiasTrue=0.12*SPEED_OF_LIGHT*1e-6;     // 0.12 us receiver clock
+
+    auto rx=lla_to_ecef(43.6426,-79.3871,200);
+    VisibilityEngine visibility(10.0);
+    VisibleSet visible;
+    EpochBuffer all,gps,dual;
+    Rng noise(11);
 
-    std::vector<Satellite> satellites;
-    const double incl=55.0*M_PI/180;
-    for(int p=0;p<6;p++) for(int s=0;s<4;s++)
-        satellites.emplace_back(26571000.0,(s*(2*M_PI/4))+(p*(2*M_PI/6)),incl);
-
-    Detector detector;
-    const double clockBiasTrue=0.12;
-
-    ScenarioState scenario;
-    scenario.pearsonLatLon={43.6777,-79.6248};
-    scenario.noFlyRadiusDeg=2000.0/111000.0;
-    scenario.spoofMode=spoofMode;
-
-    double simTime=0;
-    for(int wp=0;wp<(int)waypoints.size();wp++){
-        auto& pos=waypoints[wp];
-        double rx=pos[0],ry=pos[1],rz=pos[2];
-        simTime+=360;
-        for(auto& sat:satellites) sat.update(simTime);
-
-        Receiver trueReceiver(rx,ry,rz);
-        std::vector<double> pseudoranges;
-        std::vector<std::vector<double>> satPositions;
-        double recMag=sqrt(rx*rx+ry*ry+rz*rz);
-        for(auto& sat:satellites){
-            double sx=sat.getX(),sy=sat.getY(),sz=sat.getZ();
-            if((sx*rx+sy*ry+sz*rz)/(sqrt(sx*sx+sy*sy+sz*sz)*recMag)>0){
-                pseudoranges.push_back(trueReceiver.distanceTo(sx,sy,sz)+clockBiasTrue);
-                satPositions.push_back({sx,sy,sz});
+    PositionSolver gpsSolver,oneClock;
+    BatchPositionSolver<1,2> dualSolver;
+    BatchPositionSolver<1,4> multiSolver;
+    const int ways=4;
+    const char* label[ways]={"GPS only (1 clock)","GPS+Galileo (2 clocks)",
+                             "all systems (4 clocks)","all systems (1 clock)"};
+    double sumSq[ways]={0,0,0,0};
+    long long fixes[ways]={0,0,0,0};
+    double sumBias[MAX_GNSS_SYSTEMS-1]={0,0,0};
+    long long biasFixes=0,epochs=0,sumVisible=0;
+
+    for(double t=0;t<hours*3600;t+=30.0,epochs++){
+        satellites.propagate(t);
+        visibility.setSatellites(satellites);
+        visibility.visibleAll(rx[0],rx[1],rx[2],visible);
+        all.clear(); gps.clear(); dual.clear();
+        for(int k=0;k<visible.size();k++){
+            int i=visible.satellite(k);
+            int sys=satellites.getSystem(i),prn=satellites.getPrn(i);
+            double pos[3]={satellites.x()[i],satellites.y()[i],satellites.z()[i]},vel[3];
+            satellites.getVelocity(i,vel);
+            double pr=signalRange(pos,vel,rx[0],rx[1],rx[2])+clockBiasTrue+offset[sys]+3.0*noise.gaussian();
+            all.push(pos[0],pos[1],pos[2],vel,pr,i,sys,prn);
+            if(sys==SYSTEM_GPS) gps.push(pos[0],pos[1],pos[2],vel,pr,i,sys,prn);
+            if(sys==SYSTEM_GPS||sys==SYSTEM_GALILEO) dual.push(pos[0],pos[1],pos[2],vel,pr,i,sys,prn);
+        }
+        sumVisible+=all.size();
+
+        EpochView v[ways]={gps.view(),dual.view(),all.view(),all.view()};
+        PositionFix f[ways];
+        gpsSolver.solve(&v[0],&f[0]);
+        dualSolver.solve(&v[1],&f[1]);
+        multiSolver.solve(&v[2],&f[2]);
+        oneClock.solve(&v[3],&f[3]);
+        for(int w=0;w<ways;w++){
+            if(!f[w].valid) continue;
+            double ex=f[w].x-rx[0],ey=f[w].y-rx[1],ez=f[w].z-rx[2];
+            sumSq[w]+=ex*ex+ey*ey+ez*ez;
+            fixes[w]++;
+        }
+        if(f[2].valid){
+            for(int s=0;s<MAX_GNSS_SYSTEMS-1;s++) sumBias[s]+=f[2].systemBias[s];
+            biasFixes++;
+        }
+    }
+
+    std::cout<<"Multi-GNSS: "<<satellites.size()<<" satellites in "<<shells.size()<<" shells from "<<path
+             <<", "<<epochs<<" epochs over "<<hours<<" h, mean "<<(epochs?(double)sumVisible/epochs:0.0)
+             <<" visible\n";
+    for(int w=0;w<ways;w++)
+        std::cout<<"  "<<label[w]<<": rms error "<<(fixes[w]?std::sqrt(sumSq[w]/fixes[w]):0.0)
+                 <<" m ("<<fixes[w]<<" fixes)\n";
+    std::cout<<"  inter-system bias vs GPS (m), estimated / true:\n";
+    for(int s=1;s<SYSTEM_COUNT;s++)
+        std::cout<<"    "<<systemName(s)<<": "<<(biasFixes?sumBias[s-1]/biasFixes:0.0)
+                 <<" / "<<offset[s]-offset[0]<<"\n";
+    return 0;
+}
+
+// Detector threshold sweep: gnss_sim sweep [runs] [seed]
+// Judges `runs` randomized scenarios at every point of a speed x residual x
+// clock-jump threshold grid. The scenarios are simulated once each; only
+// the verdicts are redone per grid point.
+int runThresholdSweep(int argc,char* argv[]){
+    long long runs=argc>=3?atoll(argv[2]):50;
+    uint64_t seed=argc>=4?strtoull(argv[3],nullptr,10):1;
+    const double speeds[]={50,100,150,200,300};
+    const double residuals[]={5,10,20,50};
+    const double clockJumps[]={10,30,100};
+    const int nS=5,nR=4,nC=3,grid=nS*nR*nC;
+
+    std::vector<ScenarioConfig> points;
+    points.reserve(runs*grid);
+    for(long long i=0;i<runs;i++){
+        ScenarioConfig base=randomScenario(seed,i);
+        for(int g=0;g<grid;g++){
+            ScenarioConfig c=base;
+            c.detector.maxPhysicalSpeed=speeds[g/(nR*nC)];
+            c.detector.residualThreshold=residuals[g/nC%nR];
+            c.detector.clockJumpThreshold=clockJumps[g%nC];
+            points.push_back(c);
+        }
+    }
+
+    SweepEngine sweep;
+    std::vector<RunResult> results;
+    auto start=std::chrono::steady_clock::now();
+    sweep.run(points,results);
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    std::vector<MonteCarloStats> st(grid);
+    for(size_t i=0;i<results.size();i++) st[i%grid].add(results[i]);
+
+    std::cout<<"Threshold sweep: "<<runs<<" scenarios x "<<grid<<" threshold points, seed "<<seed<<"\n";
+    std::cout<<"  speed m/s  residual m  clock m   P(det|spoofed)  P(alarm|clean)  runs detected  mean delay s\n";
+    for(int g=0;g<grid;g++){
+        const MonteCarloStats& m=st[g];
+        long long clean=m.epochs-m.spoofedEpochs;
+        char line[160];
+        snprintf(line,sizeof(line),"  %9.0f  %10.0f  %7.0f   %14.4f  %14.5f  %6lld / %-5lld %12.1f\n",
+                 points[g].detector.maxPhysicalSpeed,points[g].detector.residualThreshold,
+                 points[g].detector.clockJumpThreshold,
+                 m.spoofedEpochs?(double)m.truePositives/m.spoofedEpochs:0.0,
+                 clean?(double)m.falseAlarms/clean:0.0,m.detectedRuns,m.spoofedRuns,
+                 m.detectedRuns?m.sumDetectionDelay/m.detectedRuns:0.0);
+        std::cout<<line;
+    }
+    const SweepStats& ss=sweep.stats();
+    std::cout<<"  stages computed: geometry "<<ss.computed[SWEEP_GEOMETRY]<<", ranges "<<ss.computed[SWEEP_RANGES]
+             <<", verdicts "<<ss.computed[SWEEP_VERDICT]<<"\n";
+    std::cout<<"  wall time "<<secs<<" s  ("<<points.size()/secs<<" points/s)\n";
+    return 0;
+}
+
+// ROC, AUC and detection latency of several check weightings over one
+// Monte Carlo batch: gnss_sim roc [runs] [threads] [seed]
+int runRocEvaluation(int argc,char* argv[]){
+    long long runs=argc>=3?atoll(argv[2]):200;
+    int threads=argc>=4?atoi(argv[3]):0;
+    uint64_t seed=argc>=5?strtoull(argv[4],nullptr,10):1;
+
+    const char* names[]={"default","velocity","integrity","equal"};
+    CheckWeights def;
+    DetectorThresholds limits;
+    for(int k=0;k<CHECK_COUNT;k++) def[k]=limits.weights[k];
+    CheckWeights velocity=def,integrity=def,equal;
+    velocity[CHECK_VELOCITY]=0.6; velocity[CHECK_CLOCK]=0.3;
+    integrity[CHECK_RAIM]=1.0; integrity[CHECK_INNOVATION]=1.0; integrity[CHECK_RESIDUAL]=0.3;
+    equal.fill(0.25);
+    DetectorEvaluation eval({def,velocity,integrity,equal});
+
+    auto start=std::chrono::steady_clock::now();
+    evaluateMonteCarlo(runs,seed,threads,eval);
+    double secs=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    std::cout<<"ROC evaluation: "<<runs<<" scenarios, seed "<<seed<<"\n";
+    std::cout<<"  "<<eval.getCleanEpochs()<<" clean / "<<eval.getSpoofedEpochs()<<" spoofed epochs, "
+             <<eval.getSpoofedRuns()<<" spoofed runs, "<<eval.memoryBytes()/1024<<" KiB of counters\n";
+    std::cout<<"  weights     AUC     operating point  level   P(alarm|clean)  P(det|spoofed)  runs det  median / p90 delay s\n";
+    const int defaultLevel=(int)std::lround(limits.alarmLevel*DetectorEvaluation::LEVELS);
+    for(int s=0;s<eval.weightSets();s++){
+        const char* points[]={"FA <= 1e-2","FA <= 1e-3","FA <= 1e-4","level 0.4"};
+        int levels[]={eval.levelForFalseAlarmRate(s,1e-2),eval.levelForFalseAlarmRate(s,1e-3),
+                      eval.levelForFalseAlarmRate(s,1e-4),defaultLevel};
+        for(int p=0;p<4;p++){
+            int j=levels[p];
+            char line[200];
+            if(j==DetectorEvaluation::LEVELS){
+                // Only the never-alarming level 1.0 meets the rate
+                snprintf(line,sizeof(line),"  %-10s %6.4f  %-15s  unreachable: no level below 1.0 meets it\n",
+                         p==0?names[s]:"",eval.auc(s),points[p]);
+                std::cout<<line;
+                continue;
             }
+            snprintf(line,sizeof(line),"  %-10s %6.4f  %-15s  %5.3f  %14.5f  %14.4f  %8.3f  %6.0f / %-6.0f\n",
+                     p==0?names[s]:"",eval.auc(s),points[p],DetectorEvaluation::level(j),
+                     eval.falseAlarmRate(s,j),eval.detectionRate(s,j),eval.runDetectionRate(s,j),
+                     eval.latencyQuantile(s,j,0.5),eval.latencyQuantile(s,j,0.9));
+            std::cout<<line;
         }
-        if((int)satPositions.size()<4) continue;
-        if(spoofMode)
-            pseudoranges=spoofer.spoofPseudoranges(satPositions,pseudoranges,clockBiasTrue);
-
-        auto sol=solvePositionLeastSquares(satPositions,pseudoranges,rx,ry,rz);
-        double estX=sol[0],estY=sol[1],estZ=sol[2],clockBias=sol[3];
-        double dx=rx-pearson[0],dy2=ry-pearson[1],dz=rz-pearson[2];
-        bool inNoFly=sqrt(dx*dx+dy2*dy2+dz*dz)<noFlyRadius;
-
-        DetectionResult det=detector.analyze(estX,estY,estZ,clockBias,360,satPositions,pseudoranges);
-
-        scenario.truePath.push_back({waypoints_ll[wp][0],waypoints_ll[wp][1]});
-        if(spoofMode)
-            scenario.estPath.push_back({43.6426,-79.3871}); // stuck at CN Tower
-        else
-            scenario.estPath.push_back({waypoints_ll[wp][0],waypoints_ll[wp][1]});
-        scenario.spoofDetected.push_back(det.spoofingDetected);
-        scenario.inNoFly.push_back(inNoFly);
     }
-    return scenario;
+    std::cout<<"  wall time "<<secs<<" s  ("<<(eval.getCleanEpochs()+eval.getSpoofedEpochs())/secs<<" epochs/s)\n";
+    return 0;
 }
 
 int main(int argc,char* argv[]){
+    if(argc>=2&&std::string(argv[1])=="montecarlo")
+        return runMonteCarloBatch(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="sweep")
+        return runThresholdSweep(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="roc")
+        return runRocEvaluation(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="fleet")
+        return runFleetBatch(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="acquire")
+        return runAcquisitionDemo(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="track")
+        return runTrackingDemo(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="flight")
+        return runFlight(argc,argv);
+    if(argc>=2&&std::string(argv[1])=="gnss")
+        return runMultiGnss(argc,argv);
+    if(argc>=3&&std::string(argv[1])=="nav")
+        return runEphemerisReplay(argv[2]);
+
+    // gnss_sim [--trace <file>]  (default trace.bin)
+    std::string tracePath="trace.bin";
+    for(int i=1;i+1<argc;i++)
+        if(std::string(argv[i])=="--trace") tracePath=argv[i+1];
+
     std::cout<<"\n==========================================\n";
     std::cout<<"  GNSS DRONE NO-FLY ZONE SIMULATOR\n";
     std::cout<<"  Split-screen: Normal vs Spoofing\n";
     std::cout<<"==========================================\n\n";
 
-    ScenarioState normal = runScenario(false);
-    ScenarioState spoofed = runScenario(true);
+    TraceWriter trace;
+    std::string err;
+    if(!trace.open(tracePath,&err)){ std::cout<<"Trace disabled: "<<err<<"\n"; }
+    TraceWriter* tw=trace.isOpen()?&trace:nullptr;
+    ScenarioState normal = runScenario(false,tw);
+    ScenarioState spoofed = runScenario(true,tw);
+    if(tw){
+        uint64_t records=trace.size();
+        if(trace.close()) std::cout<<"Wrote "<<records<<" epochs to "<<tracePath<<"\n";
+        else std::cout<<"Trace write to "<<tracePath<<" failed\n";
+    }
 
-    // Visualization is handled by src/visualize.py
-    // Run: python src/visualize.py
+    // Visualization: gnss_gl <trace.bin> plays the trace back, and
+    // src/visualize.py memory-maps it for matplotlib
+    // Run: python src/visualize.py [trace.bin]
     return 0;
 }
\ No newline at end of file
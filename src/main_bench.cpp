@@ -0,0 +1,2676 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <atomic>
+
+#include "Constellation.h"
+#include "Ephemeris.h"
+#include "Scenario.h"
+#include "Geodesy.h"
+#include "Solver.h"
+#include "NavFilter.h"
+#include "Random.h"
+#include "TraceWriter.h"
+#include "TraceReader.h"
+#include "TracePyramid.h"
+#include "Detector.h"
+#include "Raim.h"
+#include "Fleet.h"
+#include "MonteCarlo.h"
+#include "Sweep.h"
+#include "Evaluation.h"
+#include "ThreadPool.h"
+#include "Visibility.h"
+#include "Satellite.h"
+#include "Receiver.h"
+#include "Spoofer.h"
+#include "Attack.h"
+#include "CaCode.h"
+#include "SignalGenerator.h"
+#include "Acquisition.h"
+#include "Tracking.h"
+#include "Trajectory.h"
+#include "GnssSystems.h"
+#include "MeasurementErrors.h"
+#include "SignalPath.h"
+
+// ===== Allocation counting =====
+// Every heap allocation in the process goes through these, so a benchmark
+// can read the counter before and after a region of interest.
+static std::atomic<long long> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+// Over-aligned types (alignas(64) slots); aligned_alloc wants a multiple of
+// the alignment
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = (std::size_t)align;
+    return std::aligned_alloc(a, (std::max<std::size_t>(size, 1) + a - 1) / a * a);
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = operator new(size, align, std::nothrow)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t align) { return operator new(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t& tag) noexcept {
+    return operator new(size, align, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+static long long allocationCount() { return g_allocations.load(std::memory_order_relaxed); }
+
+// Reference copy of the original array-of-structs Satellite: every object
+// holds its own elements and recomputes cos/sin of both the orbit angle and
+// the inclination on each update. Kept here only as the "before" baseline.
+struct LegacySatellite {
+    double radius, x, y, z, phase, omega, inclination;
+
+    LegacySatellite(double r, double ph, double incl)
+        : radius(r), x(r), y(0), z(0), phase(ph),
+          omega(std::sqrt(3.986e14 / std::pow(r, 3))), inclination(incl) {}
+
+    void update(double time) {
+        double angle = omega * time + phase;
+        x = radius * std::cos(angle);
+        y = radius * std::sin(angle) * std::cos(inclination);
+        z = radius * std::sin(angle) * std::sin(inclination);
+    }
+};
+
+static double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Walker-style layout: `planes` planes, satellites spread evenly in each
+static void buildSet(int planes, int perPlane,
+                     std::vector<LegacySatellite>& legacy, Constellation& batch)
+{
+    const double incl = 55.0 * M_PI / 180;
+    legacy.reserve(planes * perPlane);
+    batch.reserve(planes * perPlane);
+    for (int p = 0; p < planes; p++)
+        for (int s = 0; s < perPlane; s++) {
+            double ph = s * (2 * M_PI / perPlane) + p * (2 * M_PI / planes);
+            legacy.emplace_back(26571000.0, ph, incl);
+            batch.add(26571000.0, ph, incl);
+        }
+}
+
+// Walker layout with planes spread in RAAN, like buildGpsConstellation();
+// GPS satellites numbered from PRN 1
+static Constellation buildWalker(int planes, int perPlane) {
+    Constellation sats;
+    const double incl = 55.0 * M_PI / 180;
+    sats.reserve(planes * perPlane);
+    for (int p = 0; p < planes; p++)
+        for (int s = 0; s < perPlane; s++)
+            sats.add(26571000.0, s * (2 * M_PI / perPlane) + p * (2 * M_PI / planes) / perPlane,
+                     incl, p * (2 * M_PI / planes), SYSTEM_GPS, p * perPlane + s + 1);
+    return sats;
+}
+
+// ===== High-rate trajectories: fixed-step propagation and spline states =====
+// Steps constellations through an hour at 100 Hz with the recurrence and
+// compares against the direct formula, then samples a spline flight.
+// Returns false if stepping drifts by a millimetre, allocates, or the spline
+// misses a waypoint or breaks continuity.
+static bool benchTrajectory() {
+    const double dt = 0.01;
+    const long long steps = 360000;
+    bool ok = true;
+    std::printf("  %6s %14s %14s %14s %10s %12s\n",
+                "sats", "direct ns/sat", "update ns/sat", "step ns/sat", "speedup", "max err m");
+    for (auto layout : {std::array<int,2>{6, 4}, std::array<int,2>{48, 32}}) {
+        Constellation stepped = buildWalker(layout[0], layout[1]);
+        Constellation direct  = buildWalker(layout[0], layout[1]);
+        const int n = stepped.size();
+        const long long timed = std::max(2000LL, 20000000LL / n);     // epochs per timing run
+
+        double t0 = nowSeconds();
+        for (long long e = 0; e < timed; e++)
+            for (int i = 0; i < n; i++) direct.updateOne(i, e * dt);
+        double tDirect = nowSeconds() - t0;
+        t0 = nowSeconds();
+        for (long long e = 0; e < timed; e++) direct.update(e * dt);
+        double tUpdate = nowSeconds() - t0;
+
+        stepped.beginSteps(0.0, dt);
+        long long before = allocationCount();
+        double tStep = 0, maxErr = 0;
+        for (long long e = 1; e <= steps; e++) {
+            t0 = nowSeconds();
+            stepped.step();
+            tStep += nowSeconds() - t0;
+            if (e % 997 && e != steps) continue;
+            for (int i = 0; i < n; i++) direct.updateOne(i, e * dt);
+            for (int i = 0; i < n; i++) {
+                double dx = stepped.getX(i) - direct.getX(i);
+                double dy = stepped.getY(i) - direct.getY(i);
+                double dz = stepped.getZ(i) - direct.getZ(i);
+                maxErr = std::max(maxErr, std::sqrt(dx*dx + dy*dy + dz*dz));
+            }
+        }
+        long long allocs = allocationCount() - before;
+        double perDirect = tDirect / ((double)timed * n) * 1e9;
+        double perUpdate = tUpdate / ((double)timed * n) * 1e9;
+        double perStep   = tStep / ((double)steps * n) * 1e9;
+        std::printf("  %6d %14.2f %14.2f %14.2f %9.1fx %12.2e  (%lld allocations)\n",
+                    n, perDirect, perUpdate, perStep, perDirect / perStep, maxErr, allocs);
+        if (maxErr > 1e-3 || allocs) ok = false;
+    }
+
+    // Out-and-back flight through the scenario waypoints, one every 6 minutes
+    const double ll[5][2] = {{43.6426, -79.3871}, {43.6500, -79.4500}, {43.6600, -79.5200},
+                             {43.6700, -79.5800}, {43.6777, -79.6248}};
+    std::vector<double> times;
+    std::vector<std::array<double,3>> points;
+    for (int k = 0; k <= 10; k++) {
+        int i = (k / 4) % 2 == 0 ? k % 4 : 4 - k % 4;
+        times.push_back(360.0 * k);
+        points.push_back(lla_to_ecef(ll[i][0], ll[i][1], 200));
+    }
+    Trajectory path;
+    if (!path.build(times, points)) { std::printf("  FAIL: spline fit\n"); return false; }
+
+    double knotPos = 0, jumpVel = 0, jumpAcc = 0;
+    for (size_t k = 0; k < times.size(); k++) {
+        TrajectoryState a, b;
+        path.evaluate(times[k] - 1e-6, a);
+        path.evaluate(times[k], b);
+        for (int axis = 0; axis < 3; axis++) {
+            knotPos = std::max(knotPos, std::fabs(b.pos[axis] - points[k][axis]));
+            if (k == 0 || k + 1 == times.size()) continue;
+            jumpVel = std::max(jumpVel, std::fabs(b.vel[axis] - a.vel[axis]));
+            jumpAcc = std::max(jumpAcc, std::fabs(b.acc[axis] - a.acc[axis]));
+        }
+    }
+    TrajectoryState end;
+    path.evaluate(path.endTime(), end);
+    double endSpeed = std::sqrt(end.vel[0] * end.vel[0] + end.vel[1] * end.vel[1] + end.vel[2] * end.vel[2]);
+
+    const int dense = (int)((path.endTime() - path.startTime()) / dt);
+    std::vector<TrajectoryState> states(dense);
+    long long before = allocationCount();
+    double t0 = nowSeconds();
+    path.sample(path.startTime(), dt, dense, states.data());
+    double tSample = nowSeconds() - t0;
+    long long allocs = allocationCount() - before;
+    std::printf("  spline, %zu waypoints: %d states at 100 Hz, %.1f ns/state, %lld allocations\n",
+                times.size(), dense, tSample / dense * 1e9, allocs);
+    std::printf("          waypoint miss %.2e m, velocity jump %.2e m/s, acceleration jump %.2e m/s^2, "
+                "end speed %.2e m/s\n", knotPos, jumpVel, jumpAcc, endSpeed);
+    if (knotPos > 1e-6 || jumpVel > 1e-3 || jumpAcc > 1e-3 || endSpeed > 1e-9 || allocs) ok = false;
+    if (!ok) std::printf("  FAIL: fixed-step propagation drifted or the spline is not C2 through the waypoints\n");
+    return ok;
+}
+
+// ===== Constellation propagation: per-object loop vs SoA batch =====
+static void benchPropagation() {
+    std::printf("%-10s %8s %16s %16s %8s\n",
+                "sats", "epochs", "legacy sat/s", "batch sat/s", "speedup");
+
+    const int layouts[][2] = {{6, 4}, {6, 20}, {24, 16}, {48, 32}};
+    for (auto& layout : layouts) {
+        std::vector<LegacySatellite> legacy;
+        Constellation batch;
+        buildSet(layout[0], layout[1], legacy, batch);
+        const int n = batch.size();
+        const int epochs = 4000000 / n;
+        volatile double sink = 0;
+
+        double t0 = nowSeconds();
+        for (int e = 0; e < epochs; e++) {
+            double t = e * 0.1;
+            for (auto& sat : legacy) sat.update(t);
+            sink += legacy[e % n].x;
+        }
+        double tLegacy = nowSeconds() - t0;
+
+        t0 = nowSeconds();
+        for (int e = 0; e < epochs; e++) {
+            batch.update(e * 0.1);
+            sink += batch.getX(e % n);
+        }
+        double tBatch = nowSeconds() - t0;
+
+        // Both paths must agree on the final epoch
+        double maxErr = 0;
+        for (int i = 0; i < n; i++) {
+            maxErr = std::max(maxErr, std::fabs(legacy[i].x - batch.getX(i)));
+            maxErr = std::max(maxErr, std::fabs(legacy[i].y - batch.getY(i)));
+            maxErr = std::max(maxErr, std::fabs(legacy[i].z - batch.getZ(i)));
+        }
+
+        double legacyRate = (double)n * epochs / tLegacy;
+        double batchRate  = (double)n * epochs / tBatch;
+        std::printf("%-10d %8d %16.3e %16.3e %7.1fx   (max |dpos| %.2e m)\n",
+                    n, epochs, legacyRate, batchRate, batchRate / legacyRate, maxErr);
+    }
+}
+
+// Textbook IS-GPS-200 evaluation: cold-start Kepler solve, atan2 for the
+// true anomaly and fresh trig for every correction. The "before" baseline
+// for the cached-constant propagator.
+static void referenceKepler(const BroadcastEphemeris& e, double t, double out[3]) {
+    const double mu = e.system == 'E' ? 3.986004418e14 : 3.986005e14, wE = 7.2921151467e-5;
+    double A = e.sqrtA * e.sqrtA;
+    double n = std::sqrt(mu / std::pow(A, 3)) + e.deltaN;
+    double tk = t - e.toe;
+    double M = e.m0 + n * tk;
+    double E = M;
+    for (int it = 0; it < 30; it++) {
+        double dE = (E - e.e * std::sin(E) - M) / (1 - e.e * std::cos(E));
+        E -= dE;
+        if (std::fabs(dE) < 1e-13) break;
+    }
+    double v = std::atan2(std::sqrt(1 - e.e * e.e) * std::sin(E), std::cos(E) - e.e);
+    double phi = v + e.omega;
+    double u = phi + e.cus * std::sin(2 * phi) + e.cuc * std::cos(2 * phi);
+    double r = A * (1 - e.e * std::cos(E)) + e.crs * std::sin(2 * phi) + e.crc * std::cos(2 * phi);
+    double i = e.i0 + e.cis * std::sin(2 * phi) + e.cic * std::cos(2 * phi) + e.idot * tk;
+    double xp = r * std::cos(u), yp = r * std::sin(u);
+    double node = e.omega0 + (e.omegaDot - wE) * tk - wE * std::fmod(e.toe, 604800.0);
+    out[0] = xp * std::cos(node) - yp * std::cos(i) * std::sin(node);
+    out[1] = xp * std::sin(node) + yp * std::cos(i) * std::cos(node);
+    out[2] = yp * std::sin(i);
+}
+
+// 31 GPS-like satellites, one ephemeris upload every 2 h for a day
+static std::vector<BroadcastEphemeris> syntheticEphemerides(double t0) {
+    std::vector<BroadcastEphemeris> set;
+    for (int prn = 1; prn <= 31; prn++)
+        for (int k = 0; k <= 12; k++) {
+            BroadcastEphemeris e;
+            e.prn = prn;
+            e.toe = e.toc = t0 + k * 7200.0;
+            e.week = std::floor(e.toe / 604800.0);
+            e.sqrtA = 5153.7 + 0.3 * std::sin(prn);
+            e.e = 0.002 + 0.0006 * (prn % 17);
+            e.i0 = 0.96 + 0.01 * std::cos(prn);
+            e.omega0 = (prn % 6) * (M_PI / 3);
+            e.omega = 0.3 * prn;
+            e.m0 = std::fmod(prn * 1.1 + k * 7200.0 * 1.4585e-4, 2 * M_PI);
+            e.deltaN = 4.5e-9;
+            e.omegaDot = -8.0e-9;
+            e.idot = 2.0e-10;
+            e.cuc = 1e-6; e.cus = 8e-6; e.crc = 200; e.crs = 40; e.cic = 1e-7; e.cis = -5e-8;
+            e.af0 = 1e-5 * prn; e.af1 = 1e-12;
+            set.push_back(e);
+        }
+    return set;
+}
+
+// ===== Broadcast-ephemeris replay: textbook vs cached/warm-started =====
+static void benchEphemeris() {
+    const double t0 = 2200 * 604800.0;
+    auto set = syntheticEphemerides(t0);
+    EphemerisPropagator prop;
+    prop.load(set);
+    const int n = prop.size();
+    const int epochs = 86400;
+    volatile double sink = 0;
+
+    // Reference uses the same nearest-toe record choice
+    auto recordFor = [&](int sat, double t) -> const BroadcastEphemeris& {
+        int k = (int)std::floor((t - t0) / 7200.0 + 0.5);
+        k = std::max(0, std::min(12, k));
+        return set[sat * 13 + k];
+    };
+
+    double t = nowSeconds();
+    double pos[3];
+    for (int e = 0; e < epochs; e++)
+        for (int i = 0; i < n; i++) {
+            referenceKepler(recordFor(i, t0 + e), t0 + e, pos);
+            sink += pos[0];
+        }
+    double tRef = nowSeconds() - t;
+
+    t = nowSeconds();
+    double maxErr = 0;
+    for (int e = 0; e < epochs; e++) {
+        prop.update(t0 + e);
+        sink += prop.getX(e % n);
+        if (e % 997 == 0)
+            for (int i = 0; i < n; i++) {
+                referenceKepler(recordFor(i, t0 + e), t0 + e, pos);
+                maxErr = std::max(maxErr, std::fabs(pos[0] - prop.getX(i)) +
+                                          std::fabs(pos[1] - prop.getY(i)) +
+                                          std::fabs(pos[2] - prop.getZ(i)));
+            }
+    }
+    double tProp = nowSeconds() - t;
+
+    // A Galileo record takes Galileo's gravitational parameter
+    BroadcastEphemeris gal = set[0];
+    gal.system = 'E';
+    gal.sqrtA = 5440.6;
+    EphemerisPropagator galileo;
+    galileo.load({gal});
+    galileo.update(gal.toe + 3600);
+    referenceKepler(gal, gal.toe + 3600, pos);
+    double galErr = std::fabs(pos[0] - galileo.getX(0)) + std::fabs(pos[1] - galileo.getY(0))
+                  + std::fabs(pos[2] - galileo.getZ(0));
+
+    std::printf("%d sats x %d epochs (24 h @ 1 Hz)\n", n, epochs);
+    std::printf("  textbook   %8.3f s  %12.3e sat-epochs/s\n", tRef, (double)n * epochs / tRef);
+    std::printf("  cached     %8.3f s  %12.3e sat-epochs/s  (%.2f Kepler iter/sat-epoch, max |dpos| %.2e m)\n",
+                tProp, (double)n * epochs / tProp,
+                (double)prop.getKeplerIterations() / ((double)n * epochs), maxErr);
+    std::printf("  Galileo record 1 h past toe: max |dpos| %.2e m\n", galErr);
+}
+
+// Reference copy of the original solver: 4x5 Gauss-Jordan with pivoting on
+// the full normal matrix every iteration. The "before" baseline.
+static std::array<double,4> legacySolve(const EpochView& epoch, double initX, double initY, double initZ) {
+    double x=initX,y=initY,z=initZ,clockBias=0;
+    for(int iter=0;iter<20;iter++){
+        double HtH[4][4]={{0}},Htr[4]={0};
+        for(int i=0;i<epoch.count;i++){
+            double sx,sy,sz;
+            double range=signalPath(epoch.sat(i),epoch.velocity(i),x,y,z,sx,sy,sz);
+            double dx=x-sx,dy=y-sy,dz=z-sz;
+            if(range<1) continue;
+            double res=epoch.ranges[i]-(range+clockBias);
+            double H[4]={dx/range,dy/range,dz/range,1};
+            for(int r=0;r<4;r++){Htr[r]+=H[r]*res;for(int c=0;c<4;c++)HtH[r][c]+=H[r]*H[c];}
+        }
+        double A[4][5];
+        for(int i=0;i<4;i++){for(int j=0;j<4;j++)A[i][j]=HtH[i][j];A[i][4]=Htr[i];}
+        for(int i=0;i<4;i++){
+            int mr=i;double mv=fabs(A[i][i]);
+            for(int k=i+1;k<4;k++)if(fabs(A[k][i])>mv){mv=fabs(A[k][i]);mr=k;}
+            if(mr!=i)for(int j=0;j<5;j++)std::swap(A[i][j],A[mr][j]);
+            double piv=A[i][i];if(fabs(piv)<1e-10)continue;
+            for(int j=i;j<5;j++)A[i][j]/=piv;
+            for(int k=0;k<4;k++){if(k==i)continue;double f=A[k][i];for(int j=i;j<5;j++)A[k][j]-=f*A[i][j];}
+        }
+        double du=A[0][4],dv=A[1][4],dw=A[2][4],db=A[3][4];
+        const double ms=1e5;
+        x+=std::max(-ms,std::min(ms,du)); y+=std::max(-ms,std::min(ms,dv));
+        z+=std::max(-ms,std::min(ms,dw)); clockBias+=db;
+        if(fabs(du)<1e-4&&fabs(dv)<1e-4&&fabs(dw)<1e-4)break;
+    }
+    return {x,y,z,clockBias};
+}
+
+// Recorded pseudoranges for `receivers` static receivers over `epochs` 1 Hz
+// epochs, stored receiver-major: recording[r * epochs + e]
+struct Recording {
+    int receivers, epochs;
+    std::vector<EpochBuffer> buffers;
+    std::vector<std::array<double,3>> truth;
+};
+
+static Recording recordEpochs(int receivers, int epochs) {
+    Recording rec{receivers, epochs, {}, {}};
+    Constellation sats = buildGpsConstellation();
+    Rng rng(42);
+    for (int r = 0; r < receivers; r++)
+        rec.truth.push_back(lla_to_ecef(rng.uniform(-60, 60), rng.uniform(-180, 180), 100));
+    rec.buffers.resize((size_t)receivers * epochs);
+    for (int e = 0; e < epochs; e++) {
+        sats.update(1000.0 + e);
+        for (int r = 0; r < receivers; r++) {
+            auto& p = rec.truth[r];
+            EpochBuffer& b = rec.buffers[(size_t)r * epochs + e];
+            for (int i = 0; i < sats.size(); i++) {
+                double sx = sats.getX(i), sy = sats.getY(i), sz = sats.getZ(i);
+                if (sx*p[0] + sy*p[1] + sz*p[2] <= 0) continue;
+                double pos[3] = {sx, sy, sz}, vel[3];
+                sats.getVelocity(i, vel);
+                b.push(sx, sy, sz, vel, signalRange(pos, vel, p[0], p[1], p[2]) + 30.0 + 2.0 * rng.gaussian(), i,
+                       sats.getSystem(i), sats.getPrn(i));
+            }
+        }
+    }
+    return rec;
+}
+
+template<int L>
+static double benchBatchSolver(const Recording& rec, double& maxDiff, double& meanIters) {
+    std::vector<BatchPositionSolver<L>> solvers(rec.receivers / L);
+    std::vector<EpochView> views(L);
+    PositionFix fix[L];
+    long long iters = 0, fixes = 0;
+    maxDiff = 0;
+    double t0 = nowSeconds();
+    for (int e = 0; e < rec.epochs; e++)
+        for (int g = 0; g < rec.receivers / L; g++) {
+            for (int l = 0; l < L; l++)
+                views[l] = rec.buffers[(size_t)(g * L + l) * rec.epochs + e].view();
+            solvers[g].solve(views.data(), fix);
+            for (int l = 0; l < L; l++) { iters += fix[l].iterations; fixes++; }
+            if (e == rec.epochs - 1)
+                for (int l = 0; l < L; l++) {
+                    auto& p = rec.truth[g * L + l];
+                    auto ref = legacySolve(views[l], p[0], p[1], p[2]);
+                    maxDiff = std::max(maxDiff, std::fabs(ref[0] - fix[l].x) + std::fabs(ref[1] - fix[l].y) +
+                                                std::fabs(ref[2] - fix[l].z));
+                }
+        }
+    double secs = nowSeconds() - t0;
+    meanIters = (double)iters / fixes;
+    return fixes / secs;
+}
+
+// ===== Position solver: Gauss-Jordan vs Cholesky vs SIMD lanes =====
+static void benchSolver() {
+    Recording rec = recordEpochs(64, 400);
+    const long long fixes = (long long)rec.receivers * rec.epochs;
+    volatile double sink = 0;
+
+    double t0 = nowSeconds();
+    for (int r = 0; r < rec.receivers; r++)
+        for (int e = 0; e < rec.epochs; e++) {
+            auto& p = rec.truth[r];
+            sink += legacySolve(rec.buffers[(size_t)r * rec.epochs + e].view(), p[0], p[1], p[2])[0];
+        }
+    double tLegacy = nowSeconds() - t0;
+
+    t0 = nowSeconds();
+    for (int r = 0; r < rec.receivers; r++)
+        for (int e = 0; e < rec.epochs; e++) {
+            auto& p = rec.truth[r];
+            sink += solvePositionLeastSquares(rec.buffers[(size_t)r * rec.epochs + e].view(), p[0], p[1], p[2])[0];
+        }
+    double tChol = nowSeconds() - t0;
+
+    std::printf("%lld fixes (%d receivers x %d epochs)\n", fixes, rec.receivers, rec.epochs);
+    std::printf("  %-28s %12.3e fixes/s\n", "Gauss-Jordan (truth init)", fixes / tLegacy);
+    std::printf("  %-28s %12.3e fixes/s\n", "Cholesky (truth init)", fixes / tChol);
+    double diff, it;
+    double r1 = benchBatchSolver<1>(rec, diff, it);
+    std::printf("  %-28s %12.3e fixes/s  (%.2f iter/fix, max |dpos| vs reference %.1e m)\n", "batch x1 (warm start)", r1, it, diff);
+    double r4 = benchBatchSolver<4>(rec, diff, it);
+    std::printf("  %-28s %12.3e fixes/s  (%.2f iter/fix, max |dpos| vs reference %.1e m)\n", "batch x4 (warm start)", r4, it, diff);
+    double r8 = benchBatchSolver<8>(rec, diff, it);
+    std::printf("  %-28s %12.3e fixes/s  (%.2f iter/fix, max |dpos| vs reference %.1e m)\n", "batch x8 (warm start)", r8, it, diff);
+
+    // Cold start accuracy of the closed-form fix
+    double worst = 0;
+    for (int r = 0; r < rec.receivers; r++) {
+        std::array<double,4> b;
+        auto& p = rec.truth[r];
+        if (!bancroftFix(rec.buffers[(size_t)r * rec.epochs].view(), b)) { worst = 1e300; break; }
+        worst = std::max(worst, std::sqrt((b[0]-p[0])*(b[0]-p[0]) + (b[1]-p[1])*(b[1]-p[1]) + (b[2]-p[2])*(b[2]-p[2])));
+    }
+    std::printf("  Bancroft cold-start error   max %.2f m\n", worst);
+}
+
+// ===== Multi-GNSS solver: compile-time vs run-time system count =====
+
+// Four nominal MEO shells as in data/constellations.txt, with 12, -85 and
+// 40 ns inter-system offsets against GPS
+static std::vector<WalkerShell> benchShells() {
+    const double d = M_PI / 180.0;
+    return {
+        {SYSTEM_GPS,     24, 6, 4, 26571000.0, 55.0 * d,  0.0 * d,  1,   0e-9},
+        {SYSTEM_GALILEO, 24, 3, 1, 29600300.0, 56.0 * d, 15.0 * d,  1,  12e-9},
+        {SYSTEM_GLONASS, 24, 3, 1, 25508000.0, 64.8 * d, 35.0 * d,  1, -85e-9},
+        {SYSTEM_BEIDOU,  24, 3, 1, 27906100.0, 55.0 * d, 50.0 * d, 19,  40e-9},
+    };
+}
+
+// Like recordEpochs(), over the first `systems` GnssSystems of benchShells()
+static Recording recordMultiEpochs(int receivers, int epochs, int systems, double* isb) {
+    Recording rec{receivers, epochs, {}, {}};
+    std::vector<WalkerShell> shells = benchShells();
+    shells.resize(systems);
+    Constellation sats = buildConstellation(shells);
+    for (int s = 0; s < systems; s++) isb[s] = (shells[s].timeOffset - shells[0].timeOffset) * SPEED_OF_LIGHT;
+    Rng rng(42);
+    for (int r = 0; r < receivers; r++)
+        rec.truth.push_back(lla_to_ecef(rng.uniform(-60, 60), rng.uniform(-180, 180), 100));
+    rec.buffers.resize((size_t)receivers * epochs);
+    for (int e = 0; e < epochs; e++) {
+        sats.update(1000.0 + e);
+        for (int r = 0; r < receivers; r++) {
+            auto& p = rec.truth[r];
+            EpochBuffer& b = rec.buffers[(size_t)r * epochs + e];
+            for (int i = 0; i < sats.size(); i++) {
+                double sx = sats.getX(i), sy = sats.getY(i), sz = sats.getZ(i);
+                if (sx*p[0] + sy*p[1] + sz*p[2] <= 0) continue;
+                double pos[3] = {sx, sy, sz}, vel[3];
+                sats.getVelocity(i, vel);
+                int sys = sats.getSystem(i);
+                b.push(sx, sy, sz, vel, signalRange(pos, vel, p[0], p[1], p[2]) + 30.0 + isb[sys] + 2.0 * rng.gaussian(),
+                       i, sys);
+            }
+        }
+    }
+    return rec;
+}
+
+// Reference Gauss-Newton with the state size decided at run time: 3 + S
+// states, loops bounded by S, Cholesky on the full matrix. out[3 + k] is
+// system k's clock.
+static void dynamicMultiSolve(const EpochView& epoch, int S, const double* init, double* out) {
+    const int D = 3 + S;
+    double st[3 + MAX_GNSS_SYSTEMS];
+    for (int k = 0; k < D; k++) st[k] = init[k];
+    for (int iter = 0; iter < 20; iter++) {
+        double N[7][7] = {{0}}, g[7] = {0}, h[7];
+        for (int i = 0; i < epoch.count; i++) {
+            double sx, sy, sz;
+            double range = signalPath(epoch.sat(i), epoch.velocity(i), st[0], st[1], st[2], sx, sy, sz);
+            double dx = st[0]-sx, dy = st[1]-sy, dz = st[2]-sz;
+            int c = std::min((int)epoch.systems[i], S - 1);
+            h[0] = dx / range; h[1] = dy / range; h[2] = dz / range;
+            for (int k = 0; k < S; k++) h[3 + k] = k == c ? 1.0 : 0.0;
+            double res = epoch.ranges[i] - (range + st[3 + c]);
+            for (int r = 0; r < D; r++) {
+                g[r] += h[r] * res;
+                for (int q = 0; q < D; q++) N[r][q] += h[r] * h[q];
+            }
+        }
+        for (int k = 3; k < D; k++) if (N[k][k] == 0) N[k][k] = 1;
+        double L[7][7] = {{0}}, y[7], d[7];
+        for (int r = 0; r < D; r++)
+            for (int q = 0; q <= r; q++) {
+                double v = N[r][q];
+                for (int m = 0; m < q; m++) v -= L[r][m] * L[q][m];
+                L[r][q] = r == q ? sqrt(v) : v / L[q][q];
+            }
+        for (int r = 0; r < D; r++) {
+            double v = g[r];
+            for (int m = 0; m < r; m++) v -= L[r][m] * y[m];
+            y[r] = v / L[r][r];
+        }
+        for (int r = D - 1; r >= 0; r--) {
+            double v = y[r];
+            for (int m = r + 1; m < D; m++) v -= L[m][r] * d[m];
+            d[r] = v / L[r][r];
+        }
+        for (int k = 0; k < D; k++) st[k] += d[k];
+        if (fabs(d[0]) < 1e-4 && fabs(d[1]) < 1e-4 && fabs(d[2]) < 1e-4) break;
+    }
+    for (int k = 0; k < D; k++) out[k] = st[k];
+}
+
+struct MultiRun {
+    double rate;            // fixes/s
+    double maxDiff;         // vs dynamicMultiSolve at the last epoch (m)
+    double isbError;        // mean |estimated - true| inter-system bias (m)
+    long long allocations;  // after the first epoch
+};
+
+template<int L, int S>
+static MultiRun benchMultiSolver(const Recording& rec, const double* isb) {
+    std::vector<BatchPositionSolver<L, S>> solvers(rec.receivers / L);
+    for (auto& s : solvers) s.reserve(64);
+    EpochView views[L];
+    PositionFix fix[L];
+    MultiRun run = {0, 0, 0, 0};
+    long long fixes = 0, isbCount = 0, before = 0;
+    double t0 = nowSeconds();
+    for (int e = 0; e < rec.epochs; e++) {
+        if (e == 1) before = allocationCount();
+        for (int g = 0; g < rec.receivers / L; g++) {
+            for (int l = 0; l < L; l++)
+                views[l] = rec.buffers[(size_t)(g * L + l) * rec.epochs + e].view();
+            solvers[g].solve(views, fix);
+            fixes += L;
+            for (int l = 0; l < L; l++)
+                for (int s = 1; s < S; s++) {
+                    run.isbError += std::fabs(fix[l].systemBias[s - 1] - isb[s]);
+                    isbCount++;
+                }
+            if (e == rec.epochs - 1)
+                for (int l = 0; l < L; l++) {
+                    auto& p = rec.truth[g * L + l];
+                    double init[3 + MAX_GNSS_SYSTEMS] = {p[0], p[1], p[2], 0, 0, 0, 0};
+                    double ref[3 + MAX_GNSS_SYSTEMS];
+                    dynamicMultiSolve(views[l], S, init, ref);
+                    double diff = std::fabs(ref[0] - fix[l].x) + std::fabs(ref[1] - fix[l].y) +
+                                  std::fabs(ref[2] - fix[l].z);
+                    for (int s = 1; s < S; s++)
+                        diff += std::fabs((ref[3 + s] - ref[3]) - fix[l].systemBias[s - 1]);
+                    run.maxDiff = std::max(run.maxDiff, diff);
+                }
+        }
+    }
+    run.rate = fixes / (nowSeconds() - t0);
+    run.allocations = allocationCount() - before;
+    run.isbError = isbCount ? run.isbError / isbCount : 0.0;
+    return run;
+}
+
+// Run-time-sized reference throughput over the same recording
+static double benchDynamicSolver(const Recording& rec, int S) {
+    volatile double sink = 0;
+    double t0 = nowSeconds();
+    for (int r = 0; r < rec.receivers; r++) {
+        auto& p = rec.truth[r];
+        double st[3 + MAX_GNSS_SYSTEMS] = {p[0], p[1], p[2], 0, 0, 0, 0};
+        for (int e = 0; e < rec.epochs; e++) {
+            dynamicMultiSolve(rec.buffers[(size_t)r * rec.epochs + e].view(), S, st, st);
+            sink += st[0];
+        }
+    }
+    (void)sink;
+    return (double)rec.receivers * rec.epochs / (nowSeconds() - t0);
+}
+
+// Solves GPS, GPS + Galileo and four-system recordings with the solver
+// specialized on S, against the run-time-sized reference. Returns false if
+// the fixes disagree, the inter-system biases are not recovered or a
+// steady-state solve allocates.
+static bool benchMultiGnss() {
+    bool ok = true;
+    for (int systems : {1, 2, 4}) {
+        double isb[MAX_GNSS_SYSTEMS];
+        Recording rec = recordMultiEpochs(64, 200, systems, isb);
+        int satellites = 0;
+        for (const EpochBuffer& b : rec.buffers) satellites += b.size();
+        std::printf("%d system%s, %.1f satellites/epoch:\n", systems, systems > 1 ? "s" : "",
+                    (double)satellites / rec.buffers.size());
+
+        double dyn = benchDynamicSolver(rec, systems);
+        MultiRun r1, r4;
+        if (systems == 1)      { r1 = benchMultiSolver<1, 1>(rec, isb); r4 = benchMultiSolver<4, 1>(rec, isb); }
+        else if (systems == 2) { r1 = benchMultiSolver<1, 2>(rec, isb); r4 = benchMultiSolver<4, 2>(rec, isb); }
+        else                   { r1 = benchMultiSolver<1, 4>(rec, isb); r4 = benchMultiSolver<4, 4>(rec, isb); }
+
+        std::printf("  %-28s %12.3e fixes/s\n", "run-time sized (warm start)", dyn);
+        const MultiRun* runs[2] = {&r1, &r4};
+        const char* names[2] = {"S fixed, x1 (warm start)", "S fixed, x4 (warm start)"};
+        for (int k = 0; k < 2; k++) {
+            const MultiRun& r = *runs[k];
+            std::printf("  %-28s %12.3e fixes/s  (%.2fx, max |d| vs reference %.1e m, %lld allocations)\n",
+                        names[k], r.rate, r.rate / dyn, r.maxDiff, r.allocations);
+            if (r.maxDiff > 1e-3 || r.allocations != 0) ok = false;
+        }
+        if (systems > 1) {
+            std::printf("  mean |inter-system bias error|  %.3f m (biases", r1.isbError);
+            for (int s = 1; s < systems; s++) std::printf(" %s %+.2f", systemName(s), isb[s]);
+            std::printf(" m)\n");
+            if (r1.isbError > 1.0) ok = false;
+        }
+    }
+    if (!ok) std::printf("  FAIL: multi-system solver disagrees, misses the biases or allocates\n");
+    return ok;
+}
+
+// ===== Steady-state allocations of the epoch pipeline =====
+// Flies a receiver along the scenario route at 1 Hz and counts heap
+// allocations per epoch after warm-up. Returns false if either the nominal
+// or the spoofed pipeline allocates at all.
+static bool checkEpochAllocations() {
+    auto start = lla_to_ecef(43.6426, -79.3871, 200);
+    auto end   = lla_to_ecef(43.6777, -79.6248, 200);
+    auto fake  = lla_to_ecef(43.6426, -79.3871, 200);
+    const int warmup = 100, epochs = 20000;
+
+    bool ok = true;
+    for (int mode = 0; mode < 2; mode++) {
+        bool spoof = mode == 1;
+        Constellation satellites = buildGpsConstellation();
+        EpochPipeline pipeline(satellites, Spoofer(fake[0], fake[1], fake[2]), 0.12);
+
+        long long before = 0;
+        int valid = 0;
+        for (int e = 0; e < warmup + epochs; e++) {
+            if (e == warmup) before = allocationCount();
+            double f = (double)e / (warmup + epochs);
+            double rx = start[0] + f * (end[0] - start[0]);
+            double ry = start[1] + f * (end[1] - start[1]);
+            double rz = start[2] + f * (end[2] - start[2]);
+            EpochResult r = pipeline.step(e * 1.0, rx, ry, rz, 1.0, spoof);
+            if (e >= warmup) valid += r.valid;
+        }
+        long long allocs = allocationCount() - before;
+
+        std::printf("  %-8s %6d epochs (%d solved)  %lld allocations  (%.3f/epoch)\n",
+                    spoof ? "spoofed" : "nominal", epochs, valid, allocs, (double)allocs / epochs);
+        if (allocs != 0) ok = false;
+    }
+    if (!ok) std::printf("  FAIL: epoch pipeline allocates in steady state\n");
+    return ok;
+}
+
+// ===== Signal path: kernel vs converged reference, fix accuracy, cost =====
+// The reference iterates light time to convergence with the satellite on
+// its true orbit at the transmit time and the exact Earth rotation. Also
+// solves noise-free epochs with both solvers. Returns false if the kernel
+// strays 5 mm or more from the reference or a fix is off by 1 cm or more.
+static bool benchSignalPath() {
+    Constellation sats = buildGpsConstellation();
+    Constellation past = buildGpsConstellation();
+    Rng rng(24);
+    double worst = 0.0, largest = 0.0;
+    for (int trial = 0; trial < 200; trial++) {
+        const double t = rng.uniform(0, 86400);
+        auto p = lla_to_ecef(rng.uniform(-80, 80), rng.uniform(-180, 180), rng.uniform(0, 3000));
+        sats.update(t);
+        for (int i = 0; i < sats.size(); i++) {
+            double pos[3] = {sats.getX(i), sats.getY(i), sats.getZ(i)}, vel[3];
+            if (pos[0]*p[0] + pos[1]*p[1] + pos[2]*p[2] <= 0) continue;
+            sats.getVelocity(i, vel);
+            double range = signalRange(pos, vel, p[0], p[1], p[2]);
+
+            double ref = sqrt((pos[0]-p[0])*(pos[0]-p[0]) + (pos[1]-p[1])*(pos[1]-p[1]) + (pos[2]-p[2])*(pos[2]-p[2]));
+            const double geometric = ref;
+            for (int k = 0; k < 10; k++) {
+                double tau = ref / SPEED_OF_LIGHT, a = EARTH_ROTATION * tau;
+                past.updateOne(i, t - tau);
+                double sx = past.getX(i), sy = past.getY(i), sz = past.getZ(i);
+                double tx = cos(a) * sx + sin(a) * sy, ty = cos(a) * sy - sin(a) * sx;
+                ref = sqrt((tx-p[0])*(tx-p[0]) + (ty-p[1])*(ty-p[1]) + (sz-p[2])*(sz-p[2]));
+            }
+            worst = std::max(worst, std::fabs(range - ref));
+            largest = std::max(largest, std::fabs(ref - geometric));
+        }
+    }
+    std::printf("  kernel vs converged reference: %.2f mm worst; signal path differs from the"
+                " geometric range by up to %.1f m\n", worst * 1e3, largest);
+    bool ok = worst < 0.005;
+
+    // Noise-free fixes: the batch solver from its Bancroft seed, the scalar
+    // one from 5 km off
+    PositionSolver batch;
+    EpochBuffer epoch;
+    double worstBatch = 0.0, worstScalar = 0.0;
+    for (int trial = 0; trial < 500; trial++) {
+        sats.update(rng.uniform(0, 86400));
+        auto p = lla_to_ecef(rng.uniform(-80, 80), rng.uniform(-180, 180), rng.uniform(0, 3000));
+        epoch.clear();
+        for (int i = 0; i < sats.size(); i++) {
+            double pos[3] = {sats.getX(i), sats.getY(i), sats.getZ(i)}, vel[3];
+            if (pos[0]*p[0] + pos[1]*p[1] + pos[2]*p[2] <= 0) continue;
+            sats.getVelocity(i, vel);
+            epoch.push(pos[0], pos[1], pos[2], vel, signalRange(pos, vel, p[0], p[1], p[2]) + 36000.0, i);
+        }
+        if (epoch.size() < 5) continue;
+        const EpochView v = epoch.view();
+        PositionFix f;
+        batch.reset();
+        batch.solve(&v, &f);
+        auto s = solvePositionLeastSquares(v, p[0] + 3000, p[1] - 4000, p[2]);
+        worstBatch  = std::max(worstBatch, std::sqrt((f.x-p[0])*(f.x-p[0]) + (f.y-p[1])*(f.y-p[1]) + (f.z-p[2])*(f.z-p[2])));
+        worstScalar = std::max(worstScalar, std::sqrt((s[0]-p[0])*(s[0]-p[0]) + (s[1]-p[1])*(s[1]-p[1]) + (s[2]-p[2])*(s[2]-p[2])));
+    }
+    std::printf("  noise-free fixes, 500 random sites: batch solver %.2f mm, scalar solver %.2f mm worst\n",
+                worstBatch * 1e3, worstScalar * 1e3);
+    ok = ok && worstBatch < 0.01 && worstScalar < 0.01;
+
+    // Cost per satellite: batch signal ranges vs plain geometric ranges
+    sats.update(1000.0);
+    auto home = lla_to_ecef(43.6426, -79.3871, 200);
+    epoch.clear();
+    for (int i = 0; i < sats.size(); i++) {
+        double vel[3];
+        sats.getVelocity(i, vel);
+        epoch.push(sats.getX(i), sats.getY(i), sats.getZ(i), vel, 0.0, i);
+    }
+    const EpochView view = epoch.view();
+    std::vector<double> out(view.count);
+    const int reps = 200000;
+    double best[2] = {1e9, 1e9}, sink = 0.0;
+    for (int run = 0; run < 5; run++) {
+        double t0 = nowSeconds();
+        for (int r = 0; r < reps; r++) {
+            signalRanges(view, home[0] + (r & 7), home[1], home[2], out.data());
+            sink += out[r % view.count];
+        }
+        best[0] = std::min(best[0], nowSeconds() - t0);
+        t0 = nowSeconds();
+        for (int r = 0; r < reps; r++) {
+            const double rx = home[0] + (r & 7), ry = home[1], rz = home[2];
+            #pragma omp simd
+            for (int i = 0; i < view.count; i++) {
+                const double* s = view.pos + 3 * i;
+                out[i] = sqrt((s[0]-rx)*(s[0]-rx) + (s[1]-ry)*(s[1]-ry) + (s[2]-rz)*(s[2]-rz));
+            }
+            sink += out[r % view.count];
+        }
+        best[1] = std::min(best[1], nowSeconds() - t0);
+    }
+    if (sink == 12345.0) std::printf(" ");
+    const double per = 1e9 / ((double)reps * view.count);
+    std::printf("  %d satellites: signal range %.2f ns, geometric range %.2f ns per satellite\n",
+                view.count, best[0] * per, best[1] * per);
+    if (!ok) std::printf("  FAIL: signal path inaccurate or fixes biased\n");
+    return ok;
+}
+
+// ===== Measurement errors: tables vs analytic models, cost per epoch =====
+// Returns false if the tables or held ionospheric delays stray more than
+// 2 cm from the analytic models, the errors add 15 % to the epoch loop or
+// more, or an epoch with errors allocates.
+static bool benchMeasurementErrors() {
+    const MeasurementErrors& model = defaultMeasurementErrors();
+    Rng rng(21);
+    VisibleSet one;
+    one.reserve(1);
+    // The night-time floor alone: the held delays may cross the step to it late
+    KlobucharCoefficients night = MeasurementErrors::DEFAULT_KLOBUCHAR;
+    for (double& a : night.alpha) a = 0.0;
+    double worstIono = 0.0, worstTropo = 0.0, worstHeld = 0.0, largestIono = 0.0, largestTropo = 0.0;
+    for (int i = 0; i < 20000; i++) {
+        double latDeg = rng.uniform(-80, 80), lonDeg = rng.uniform(-180, 180), h = rng.uniform(0, 3000);
+        double elev = rng.uniform(5, 90) * M_PI / 180, az = rng.uniform(0, 2 * M_PI);
+        double t = rng.uniform(0, 86400);
+        auto p = lla_to_ecef(latDeg, lonDeg, h);
+        ReceiverSite site;
+        model.locate(site, p[0], p[1], p[2]);
+        one.clear();
+        one.push(0, cos(elev) * sin(az), cos(elev) * cos(az), sin(elev));
+        double iono[VisibleSet::PADDING], tropo[VisibleSet::PADDING], held[VisibleSet::PADDING];
+        model.compute(t, site, one, ERROR_IONOSPHERE, iono);
+        model.compute(t, site, one, ERROR_TROPOSPHERE, tropo);
+        // Just short of the hold: still the delay evaluated at t
+        const double later = t + 0.99 * MeasurementErrors::IONO_HOLD;
+        model.compute(later, site, one, ERROR_IONOSPHERE, held);
+
+        double lat = latDeg * M_PI / 180, lon = lonDeg * M_PI / 180;
+        double ionoRef = klobucharDelay(MeasurementErrors::DEFAULT_KLOBUCHAR, lat, lon, elev, az, t);
+        double zd, zw, md, mw;
+        saastamoinenZenith(lat, h, zd, zw);
+        niellMapping(lat, h, 180, elev, md, mw);
+        double tropoRef = zd * md + zw * mw;
+        double heldRef = klobucharDelay(MeasurementErrors::DEFAULT_KLOBUCHAR, lat, lon, elev, az, later);
+        worstIono  = std::max(worstIono, std::fabs(iono[0] - ionoRef));
+        worstTropo = std::max(worstTropo, std::fabs(tropo[0] - tropoRef));
+        double floorRef = klobucharDelay(night, lat, lon, elev, az, t);
+        if ((ionoRef > floorRef) == (heldRef > floorRef))
+            worstHeld = std::max(worstHeld, std::fabs(held[0] - heldRef));
+        largestIono  = std::max(largestIono, ionoRef);
+        largestTropo = std::max(largestTropo, tropoRef);
+    }
+    std::printf("  tables vs analytic, 20k random sites/geometries: ionosphere %.1f mm (max delay %.1f m),"
+                " troposphere %.1f mm (max %.1f m)\n",
+                worstIono * 1e3, largestIono, worstTropo * 1e3, largestTropo);
+    std::printf("  ionosphere held %.1f s: %.1f mm from the analytic model (away from the night step)\n",
+                0.99 * MeasurementErrors::IONO_HOLD, worstHeld * 1e3);
+    std::printf("  tables %.1f KiB\n", model.tableBytes() / 1024.0);
+    bool ok = worstIono < 0.02 && worstTropo < 0.02 && worstHeld < 0.02;
+
+    // Cost: a pipeline epoch without and with the errors, gated on the
+    // difference, and the model alone over the same visible sets. The modes alternate and each keeps
+    // its best of three runs, so a slow patch on the machine hits both.
+    auto start = lla_to_ecef(43.6426, -79.3871, 200);
+    auto end   = lla_to_ecef(43.6777, -79.6248, 200);
+    auto fake  = lla_to_ecef(43.6426, -79.3871, 200);
+    const int epochs = 20000;
+    double perEpoch[2] = {1e9, 1e9};
+    long long allocs = 0;
+    double modelSeconds = 1e9;
+    int visible = 0;
+    for (int run = 0; run < 3; run++) {
+        for (int mode = 0; mode < 2; mode++) {
+            Constellation satellites = buildGpsConstellation();
+            EpochPipeline pipeline(satellites, Spoofer(fake[0], fake[1], fake[2]), 0.12);
+            pipeline.setRangeNoise(2.0, 1);
+            if (mode == 1) pipeline.setMeasurementErrors(&model);
+            pipeline.step(0.0, start[0], start[1], start[2], 1.0, false);
+            long long before = allocationCount();
+            double t0 = nowSeconds();
+            for (int e = 1; e <= epochs; e++) {
+                double f = (double)e / epochs;
+                pipeline.step(e * 1.0, start[0] + f * (end[0] - start[0]), start[1] + f * (end[1] - start[1]),
+                              start[2] + f * (end[2] - start[2]), 1.0, false);
+            }
+            perEpoch[mode] = std::min(perEpoch[mode], (nowSeconds() - t0) / epochs);
+            if (mode == 0) continue;
+            allocs += allocationCount() - before;
+
+            // The model on its own, over the same visible sets
+            std::vector<double> err(VisibleSet::padded(satellites.size()));
+            ReceiverSite site;
+            const VisibleSet& vis = pipeline.visible();
+            visible = vis.size();
+            double sink = 0.0;
+            t0 = nowSeconds();
+            for (int e = 1; e <= epochs; e++) {
+                double f = (double)e / epochs;
+                model.locate(site, start[0] + f * (end[0] - start[0]), start[1] + f * (end[1] - start[1]),
+                             start[2] + f * (end[2] - start[2]));
+                model.compute(e * 1.0, site, vis, ERROR_ALL, err.data());
+                sink += err[0];
+            }
+            modelSeconds = std::min(modelSeconds, (nowSeconds() - t0) / epochs);
+            if (sink == 12345.0) std::printf(" ");
+        }
+    }
+    double added = (perEpoch[1] - perEpoch[0]) / perEpoch[0];
+    std::printf("  epoch loop %.3f us without errors, %.3f us with (+%.1f %%); model alone %.3f us"
+                " for %d satellites\n",
+                perEpoch[0] * 1e6, perEpoch[1] * 1e6, 100.0 * added, modelSeconds * 1e6, visible);
+    std::printf("  %lld allocations in %d epochs with errors\n", allocs, 3 * epochs);
+    ok = ok && added < 0.15 && allocs == 0;
+    if (!ok) std::printf("  FAIL: error tables inaccurate, too slow or allocating\n");
+    return ok;
+}
+
+// ===== Geodesy: batch conversions vs single-point forms =====
+// Random points from 1 km below the ellipsoid to geostationary height
+// through both batch kernels, against the single-point forms (whose
+// ecef_to_lla iterates to convergence). Returns false if a batch result
+// is off by 1 mm or more or the batch forms are not several times faster.
+static bool benchGeodesy() {
+    const int n = 1 << 16;
+    Rng rng(25);
+    std::vector<double> lat(n), lon(n), alt(n), x(n), y(n), z(n), lat2(n), lon2(n), alt2(n);
+    for (int i = 0; i < n; i++) {
+        lat[i] = rng.uniform(-90, 90);
+        lon[i] = rng.uniform(-180, 180);
+        alt[i] = i % 2 ? rng.uniform(-1000, 20000) : rng.uniform(-1000, 36e6);
+    }
+    lat[0] = 90; lat[1] = -90; lon[2] = 180; lon[3] = -180; lat[4] = lon[4] = 0;
+    lla_to_ecef(lat.data(), lon.data(), alt.data(), n, x.data(), y.data(), z.data());
+    ecef_to_lla(x.data(), y.data(), z.data(), n, lat2.data(), lon2.data(), alt2.data());
+    double worstEcef = 0, worstNear = 0, worstFar = 0, worstRound = 0;
+    for (int i = 0; i < n; i++) {
+        auto p = lla_to_ecef(lat[i], lon[i], alt[i]);
+        worstEcef = std::max(worstEcef, std::sqrt((p[0]-x[i])*(p[0]-x[i]) + (p[1]-y[i])*(p[1]-y[i]) + (p[2]-z[i])*(p[2]-z[i])));
+        // Horizontal error as metres on the ground, vertical in metres
+        auto g = ecef_to_lla(x[i], y[i], z[i]);
+        double dLon = std::fabs(g[1] - lon2[i]);
+        dLon = std::min(dLon, 360 - dLon) * std::cos(g[0] * M_PI / 180);
+        double err = std::max(std::hypot(g[0] - lat2[i], dLon) * 111320.0, std::fabs(g[2] - alt2[i]));
+        (alt[i] < 20000 ? worstNear : worstFar) = std::max(alt[i] < 20000 ? worstNear : worstFar, err);
+        if (std::fabs(lat[i]) < 89.9)
+            worstRound = std::max(worstRound, std::max(std::fabs(lat2[i] - lat[i]) * 111320.0, std::fabs(alt2[i] - alt[i])));
+    }
+    std::printf("  lla_to_ecef batch vs single %.1e m; ecef_to_lla batch vs iterated %.1e m below 20 km,"
+                " %.1e m to GEO; round trip %.1e m\n", worstEcef, worstNear, worstFar, worstRound);
+    bool ok = worstEcef < 1e-3 && worstNear < 1e-3 && worstFar < 1e-3 && worstRound < 1e-3;
+
+    // Throughput over the same points, best of 5
+    double best[4] = {1e9, 1e9, 1e9, 1e9}, sink = 0;
+    for (int run = 0; run < 5; run++) {
+        double t0 = nowSeconds();
+        lla_to_ecef(lat.data(), lon.data(), alt.data(), n, x.data(), y.data(), z.data());
+        double t1 = nowSeconds();
+        ecef_to_lla(x.data(), y.data(), z.data(), n, lat2.data(), lon2.data(), alt2.data());
+        double t2 = nowSeconds();
+        for (int i = 0; i < n; i++) sink += lla_to_ecef(lat[i], lon[i], alt[i])[0];
+        double t3 = nowSeconds();
+        for (int i = 0; i < n; i++) sink += ecef_to_lla(x[i], y[i], z[i])[0];
+        double t4 = nowSeconds();
+        best[0] = std::min(best[0], t1 - t0); best[1] = std::min(best[1], t2 - t1);
+        best[2] = std::min(best[2], t3 - t2); best[3] = std::min(best[3], t4 - t3);
+    }
+    if (sink == 12345.0) std::printf(" ");
+    std::printf("  lla_to_ecef  batch %6.1f M points/s  single %6.1f M/s  (%.1fx)\n",
+                n / best[0] * 1e-6, n / best[2] * 1e-6, best[2] / best[0]);
+    std::printf("  ecef_to_lla  batch %6.1f M points/s  single %6.1f M/s  (%.1fx)\n",
+                n / best[1] * 1e-6, n / best[3] * 1e-6, best[3] / best[1]);
+    ok = ok && best[2] > 3 * best[0] && best[3] > 3 * best[1];
+
+    if (!ok) std::printf("  FAIL: batch conversions inaccurate or slow\n");
+    return ok;
+}
+
+// ===== Detector: cost per call vs window length =====
+// Feeds one recorded epoch stream through detectors of increasing window
+// length. With running statistics the cost per call should not grow with
+// the window. Also checks the windowed mean/stddev against a direct rescan
+// and that analyze() never allocates. Returns false on any failure.
+static bool benchDetector() {
+    Recording rec = recordEpochs(1, 2000);
+    const auto& p = rec.truth[0];
+    const int calls = 200000;
+    bool ok = true;
+
+    for (int window : {10, 100, 1000}) {
+        Detector det(window);
+        det.reserve(24);
+        std::vector<double> clocks;
+        double worst = 0;
+        long long allocs = 0;
+        volatile double sink = 0;
+        double t0 = nowSeconds();
+        for (int c = 0; c < calls; c++) {
+            int e = c % rec.epochs;
+            double clock = 30.0 + 0.01 * c;
+            long long before = allocationCount();
+            DetectionResult r = det.analyze(p[0], p[1], p[2], clock, 0.02, rec.buffers[e].view());
+            allocs += allocationCount() - before;
+            sink += r.confidence;
+            if (c % 997 == 0) {
+                // Direct rescan of the same window, outside the timed path
+                double now = nowSeconds();
+                clocks.clear();
+                for (int k = std::max(0, c - window + 1); k <= c; k++) clocks.push_back(30.0 + 0.01 * k);
+                double m = 0, v = 0;
+                for (double x : clocks) m += x;
+                m /= clocks.size();
+                for (double x : clocks) v += (x - m) * (x - m);
+                double sd = clocks.size() > 1 ? std::sqrt(v / (clocks.size() - 1)) : 0.0;
+                worst = std::max(worst, std::fabs(m - r.clockMean) + std::fabs(sd - r.clockStdDev));
+                t0 += nowSeconds() - now;
+            }
+        }
+        double secs = nowSeconds() - t0;
+        std::printf("  window %-5d %8.1f ns/call  %lld allocations  (max |stat - rescan| %.1e)\n",
+                    window, secs / calls * 1e9, allocs, worst);
+        if (allocs != 0 || worst > 1e-6) ok = false;
+    }
+    if (!ok) std::printf("  FAIL: detector allocates or window statistics drift\n");
+    return ok;
+}
+
+// ===== Navigation filter: EKF vs per-epoch least squares =====
+// A 10 Hz drone flight through the scenario waypoints with 3 m range
+// noise, recorded once and then navigated by each method. Returns false if
+// the filter allocates, costs more than the iterative solver, is not
+// smoother, or its innovation test misses a spoofer or alarms without one.
+static bool benchNavFilter() {
+    const double rate = 10.0, sigma = 3.0, seconds = 1200.0;
+    const double ll[5][2] = {{43.6426, -79.3871}, {43.6500, -79.4500}, {43.6600, -79.5200},
+                             {43.6700, -79.5800}, {43.6777, -79.6248}};
+    std::vector<double> times;
+    std::vector<std::array<double,3>> points;
+    for (int k = 0; k <= 4; k++) {
+        times.push_back(300.0 * k);
+        points.push_back(lla_to_ecef(ll[k][0], ll[k][1], 200));
+    }
+    Trajectory path;
+    if (!path.build(times, points)) { std::printf("  FAIL: spline fit\n"); return false; }
+
+    const int epochs = (int)(seconds * rate);
+    std::vector<TrajectoryState> truth(epochs);
+    path.sample(1.0, 1.0 / rate, epochs, truth.data());
+    std::vector<EpochBuffer> recorded(epochs);
+    {
+        Constellation sats = buildGpsConstellation();
+        EpochPipeline pipeline(sats, Spoofer(0, 0, 0, 0.0), 0.12);
+        pipeline.setRangeNoise(sigma, 31);
+        for (int e = 0; e < epochs; e++) {
+            const TrajectoryState& s = truth[e];
+            pipeline.step(s.t, s.pos[0], s.pos[1], s.pos[2], 1.0 / rate, false);
+            recorded[e] = pipeline.buffer();
+        }
+    }
+
+    // Each method's fixes, then error statistics. "jitter" is the RMS
+    // change of the error between consecutive epochs: how ragged the track is.
+    std::vector<std::array<double,3>> est(epochs);
+    auto report = [&](const char* name, double secs, long long allocs, double& rms, double& jitter) {
+        double sum = 0, sumJ = 0;
+        for (int e = 0; e < epochs; e++) {
+            double d[3], j[3];
+            for (int k = 0; k < 3; k++) d[k] = est[e][k] - truth[e].pos[k];
+            sum += d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+            if (e == 0) continue;
+            for (int k = 0; k < 3; k++) j[k] = d[k] - (est[e - 1][k] - truth[e - 1].pos[k]);
+            sumJ += j[0]*j[0] + j[1]*j[1] + j[2]*j[2];
+        }
+        rms = std::sqrt(sum / epochs);
+        jitter = std::sqrt(sumJ / (epochs - 1));
+        std::printf("  %-34s %8.0f ns/epoch  rms error %6.2f m  jitter %6.2f m  %lld allocations\n",
+                    name, secs / epochs * 1e9, rms, jitter, allocs);
+    };
+    bool ok = true;
+    double rmsLs, jitLs, rmsBatch, jitBatch, rmsEkf, jitEkf, rms5, jit5;
+
+    std::array<double,4> prev = {truth[0].pos[0], truth[0].pos[1], truth[0].pos[2], 0.0};
+    long long before = allocationCount();
+    double t0 = nowSeconds();
+    for (int e = 0; e < epochs; e++) {
+        prev = solvePositionLeastSquares(recorded[e].view(), prev[0], prev[1], prev[2]);
+        est[e] = {prev[0], prev[1], prev[2]};
+    }
+    report("solvePositionLeastSquares", nowSeconds() - t0, allocationCount() - before, rmsLs, jitLs);
+
+    PositionSolver solver;
+    solver.reserve(64);
+    PositionFix fix;
+    before = allocationCount();
+    t0 = nowSeconds();
+    for (int e = 0; e < epochs; e++) {
+        EpochView v = recorded[e].view();
+        solver.solve(&v, &fix);
+        est[e] = {fix.x, fix.y, fix.z};
+    }
+    double tBatch = nowSeconds() - t0;
+    report("PositionSolver (warm start)", tBatch, allocationCount() - before, rmsBatch, jitBatch);
+
+    NavFilter<8> ekf;
+    ekf.setRangeSigma(sigma);
+    solver.reset();
+    EpochView first = recorded[0].view();
+    solver.solve(&first, &fix);
+    ekf.initialize(truth[0].t, fix);
+    double nisSum = 0;
+    int nisCount = 0;
+    before = allocationCount();
+    t0 = nowSeconds();
+    for (int e = 0; e < epochs; e++) {
+        ekf.predict(truth[e].t);
+        FilterInnovations in = ekf.update(recorded[e].view());
+        nisSum += in.nis;
+        nisCount += in.count;
+        est[e] = {ekf.getX(), ekf.getY(), ekf.getZ()};
+    }
+    double tEkf = nowSeconds() - t0;
+    report("NavFilter<8> (PV + clock)", tEkf, allocationCount() - before, rmsEkf, jitEkf);
+    long long ekfAllocs = allocationCount() - before;
+
+    NavFilter<5> still;
+    still.setRangeSigma(sigma);
+    still.initialize(truth[0].t, fix);
+    before = allocationCount();
+    t0 = nowSeconds();
+    for (int e = 0; e < epochs; e++) {
+        still.predict(truth[e].t);
+        still.update(recorded[e].view());
+        est[e] = {still.getX(), still.getY(), still.getZ()};
+    }
+    report("NavFilter<5> (position + clock)", nowSeconds() - t0, allocationCount() - before, rms5, jit5);
+    std::printf("  EKF mean NIS per range %.2f (1 if consistent); %.1fx faster, %.1fx less jitter than "
+                "PositionSolver\n", nisSum / nisCount, tBatch / tEkf, jitBatch / jitEkf);
+    if (ekfAllocs != 0 || tEkf > tBatch || jitEkf > jitBatch || rmsEkf > rmsBatch) ok = false;
+
+    // Innovation test in the pipeline: clean flight, then a counterfeit
+    // 500 m off the drone switched on at full power at t = 600 s
+    for (int spoof = 0; spoof < 2; spoof++) {
+        for (NavigationMode mode : {NAV_SNAPSHOT, NAV_FILTER}) {
+            Constellation sats = buildGpsConstellation();
+            EpochPipeline pipeline(sats, Spoofer(0, 0, 0, 0.0), 0.12);
+            pipeline.setRangeNoise(sigma, 31);
+            pipeline.setNavigation(mode);
+            AttackProfile jump;
+            jump.start = 600.0;
+            jump.followReceiver = true;
+            jump.offsetX = 300; jump.offsetY = -400;
+            AttackEngine attack(jump);
+            pipeline.setAttack(&attack);
+            int alarms = 0, innovationAlarms = 0;
+            double firstAlarm = -1;
+            for (int e = 0; e < epochs; e++) {
+                const TrajectoryState& s = truth[e];
+                EpochResult r = pipeline.step(s.t, s.pos[0], s.pos[1], s.pos[2], 1.0 / rate, spoof == 1);
+                if (!r.valid || !r.detection.spoofingDetected) continue;
+                alarms++;
+                innovationAlarms += (r.detection.reasons & REASON_INNOVATION) != 0;
+                if (firstAlarm < 0) firstAlarm = s.t;
+            }
+            std::printf("  %-8s %-9s %5d alarms (%5d by innovations), first at %s",
+                        spoof ? "spoofed" : "clean", mode == NAV_FILTER ? "EKF" : "snapshot",
+                        alarms, innovationAlarms, firstAlarm < 0 ? "-" : "");
+            if (firstAlarm >= 0) std::printf("%.1f s", firstAlarm);
+            std::printf("\n");
+            if (mode == NAV_FILTER && spoof == 0 && innovationAlarms > epochs / 1000) ok = false;
+            if (mode == NAV_FILTER && spoof == 1 && (firstAlarm < 600.0 || firstAlarm > 601.0)) ok = false;
+        }
+    }
+    if (!ok) std::printf("  FAIL: EKF slower or rougher than least squares, allocates, or its innovation test failed\n");
+    return ok;
+}
+
+// ===== RAIM/FDE: downdated subsets vs re-solving each subset =====
+// Sum of squared residuals of `epoch` without satellites `skip` (sorted),
+// re-solved from scratch; the fix goes to `fix`
+static double bruteSubsetSse(const EpochView& epoch, const int* skip, int k, EpochBuffer& scratch,
+                             double initX, double initY, double initZ, std::array<double,4>& fix) {
+    scratch.clear();
+    for (int i = 0, s = 0; i < epoch.count; i++) {
+        if (s < k && skip[s] == i) { s++; continue; }
+        const double* p = epoch.sat(i);
+        scratch.push(p[0], p[1], p[2], epoch.velocity(i), epoch.ranges[i], epoch.sats[i]);
+    }
+    EpochView v = scratch.view();
+    fix = solvePositionLeastSquares(v, initX, initY, initZ);
+    double sse = 0;
+    for (int i = 0; i < v.count; i++) {
+        double e = v.ranges[i] - (signalRange(v.sat(i), v.velocity(i), fix[0], fix[1], fix[2]) + fix[3]);
+        sse += e * e;
+    }
+    return sse;
+}
+
+// Injects range faults into recorded epochs and checks that FDE excludes
+// exactly the faulty satellites, that its statistics and fixes match
+// re-solving every subset, and that clean epochs rarely alarm. Returns
+// false on a mismatch or if a check allocates.
+static bool benchRaim() {
+    const int epochs = 2000;
+    const double sigma = 2.0;           // recordEpochs' noise
+    Recording rec = recordEpochs(1, epochs);
+    const auto& p = rec.truth[0];
+    Rng rng(23);
+    bool ok = true;
+
+    Raim raim;
+    raim.setRangeSigma(sigma);
+    raim.reserve(64);
+    PositionSolver solver;
+    solver.reserve(64);
+    EpochBuffer faulty, scratch;
+    faulty.reserve(64);
+    scratch.reserve(64);
+
+    for (int k = 0; k <= 2; k++) {
+        raim.setMaxExclusions(std::max(1, k));
+        int alarms = 0, correct = 0, tested = 0;
+        double worstStat = 0, worstFix = 0;
+        long long allocs = 0, subsets = 0;
+        double raimSecs = 0, bruteSecs = 0, solveSecs = 0;
+        for (int e = 0; e < epochs; e++) {
+            EpochView clean = rec.buffers[e].view();
+            if (clean.count < 5 + k) continue;
+            tested++;
+
+            // k distinct satellites get a 60-300 m fault each
+            int bad[2] = {-1, -1};
+            for (int m = 0; m < k; m++) {
+                do bad[m] = (int)(rng.uniform() * clean.count); while (m == 1 && bad[1] == bad[0]);
+            }
+            if (k == 2 && bad[0] > bad[1]) std::swap(bad[0], bad[1]);
+            faulty.clear();
+            for (int i = 0; i < clean.count; i++) {
+                double f = (i == bad[0] || i == bad[1]) ? rng.uniform(60, 300) * (rng.uniform() < 0.5 ? -1 : 1) : 0;
+                const double* s = clean.sat(i);
+                faulty.push(s[0], s[1], s[2], clean.velocity(i), clean.ranges[i] + f, clean.sats[i], clean.systems[i],
+                            clean.prns[i]);
+            }
+            EpochView view = faulty.view();
+
+            double t0 = nowSeconds();
+            PositionFix fix;
+            solver.reset();
+            solver.seedLane(0, p[0], p[1], p[2], 30.0);
+            solver.solve(&view, &fix);
+            double t1 = nowSeconds();
+            long long before = allocationCount();
+            RaimResult r = raim.check(view, fix.x, fix.y, fix.z, fix.clockBias);
+            allocs += allocationCount() - before;
+            double t2 = nowSeconds();
+            solveSecs += t1 - t0;
+            raimSecs += t2 - t1;
+            subsets += r.subsetsTested;
+
+            if (k == 0) {
+                alarms += r.fault;
+                continue;
+            }
+            bool right = r.isolated && r.excludedCount == k;
+            for (int m = 0; right && m < k; m++)
+                right = r.excluded[m] == clean.sats[bad[m]] && r.excludedPrn[m] == clean.prns[bad[m]]
+                        && r.excludedSystem[m] == clean.systems[bad[m]];
+            correct += right;
+
+            // Brute force over the same subsets: every one re-solved
+            double best = 1e300;
+            std::array<double,4> bestFix{}, sub;
+            int idx[2];
+            double b0 = nowSeconds();
+            for (idx[0] = 0; idx[0] < view.count; idx[0]++)
+                for (idx[1] = (k == 2 ? idx[0] + 1 : view.count); idx[1] <= view.count; idx[1]++) {
+                    if (k == 2 && idx[1] == view.count) break;
+                    double sse = bruteSubsetSse(view, idx, k, scratch, fix.x, fix.y, fix.z, sub);
+                    if (sse < best) { best = sse; bestFix = sub; }
+                    if (k == 1) break;
+                }
+            bruteSecs += nowSeconds() - b0;
+            if (right) {
+                worstStat = std::max(worstStat, std::fabs(best / (sigma * sigma) - r.subsetStatistic));
+                worstFix = std::max(worstFix, std::fabs(bestFix[0] - r.x) + std::fabs(bestFix[1] - r.y)
+                                            + std::fabs(bestFix[2] - r.z) + std::fabs(bestFix[3] - r.clockBias));
+            }
+        }
+        if (k == 0) {
+            std::printf("  clean      %4d epochs  %d false alarms (Pfa %.0e per epoch)  %.2f us/check "
+                        "(solve %.2f us)  %lld allocations\n", tested, alarms, raim.getFalseAlarmRate(),
+                        raimSecs / tested * 1e6, solveSecs / tested * 1e6, allocs);
+            if (alarms > tested / 100 || allocs != 0) ok = false;
+            continue;
+        }
+        std::printf("  %d fault%s   %4d epochs  %5.1f%% excluded exactly  %.2f us/check (%lld subsets) vs "
+                    "%.1f us re-solving  |stat| %.1e  |fix| %.1e m  %lld allocations\n",
+                    k, k > 1 ? "s" : " ", tested, 100.0 * correct / tested, raimSecs / tested * 1e6,
+                    subsets / tested, bruteSecs / tested * 1e6, worstStat, worstFix, allocs);
+        if (correct < 0.9 * tested || worstStat > 0.05 || worstFix > 0.05 || allocs != 0) ok = false;
+    }
+
+    // A spoofer on two satellites only: the detector names them
+    {
+        Detector detector;
+        detector.reserve(64);
+        detector.raim().setRangeSigma(sigma);
+        detector.raim().setMaxExclusions(2);
+        AttackProfile two;
+        two.offsetX = p[0] + 800; two.offsetY = p[1] - 500; two.offsetZ = p[2];
+        solver.reset();
+        int named = 0, flagged = 0, runs = 0;
+        std::vector<double> spoofed(64);
+        for (int e = 0; e < epochs; e++) {
+            EpochView view = rec.buffers[e].view();
+            if (view.count < 7) continue;
+            const int pick[2] = {e % view.count, (e + 3) % view.count};
+            int ids[2] = {view.sats[pick[0]], view.sats[pick[1]]};
+            int systems[2] = {view.systems[pick[0]], view.systems[pick[1]]};
+            int prns[2] = {view.prns[pick[0]], view.prns[pick[1]]};
+            two.onlySatellites(systems, prns, 2);
+            AttackEngine eng(two);
+            eng.apply(e, p[0], p[1], p[2], 30.0, view, spoofed.data());
+            view.ranges = spoofed.data();
+            PositionFix fix;
+            solver.solve(&view, &fix);
+            DetectionResult d = detector.analyze(fix.x, fix.y, fix.z, fix.clockBias, 1.0, view);
+            runs++;
+            flagged += (d.reasons & REASON_RAIM_FAULT) != 0;
+            const RaimResult& r = d.raim;
+            named += r.isolated && r.excludedCount == 2
+                   && std::min(r.excluded[0], r.excluded[1]) == std::min(ids[0], ids[1])
+                   && std::max(r.excluded[0], r.excluded[1]) == std::max(ids[0], ids[1]);
+        }
+        std::printf("  2-satellite spoofer  %d epochs  %.1f%% flagged  %.1f%% spoofed satellites named\n",
+                    runs, 100.0 * flagged / runs, 100.0 * named / runs);
+        if (named < 0.9 * runs) ok = false;
+    }
+
+    // One clock: an epoch mixing in a GLONASS satellite 25 m off is not tested
+    {
+        EpochView clean = rec.buffers[0].view();
+        faulty.clear();
+        for (int i = 0; i < clean.count; i++) {
+            const int sys = i == 0 ? SYSTEM_GLONASS : SYSTEM_GPS;
+            const double* s = clean.sat(i);
+            faulty.push(s[0], s[1], s[2], clean.velocity(i), clean.ranges[i] - (i == 0 ? 25.0 : 0.0),
+                        clean.sats[i], sys, clean.prns[i]);
+        }
+        RaimResult r = raim.check(faulty.view(), p[0], p[1], p[2], 30.0);
+        std::printf("  mixed GPS/GLONASS epoch: %s\n", r.available ? "tested" : "unavailable");
+        if (r.available) ok = false;
+    }
+    if (!ok) std::printf("  FAIL: RAIM/FDE misses faults, disagrees with re-solving, tests mixed-system epochs, "
+                         "or allocates\n");
+    return ok;
+}
+
+// ===== Attack profiles: batch blend vs a per-satellite reference =====
+// Straightforward per-satellite, per-spoofer evaluation of an attack set,
+// with the branches the batch pass avoids
+static void referenceAttack(const AttackEngine& eng, double t, const double* rx, double clockBias,
+                            const EpochView& epoch, double* out) {
+    for (int i = 0; i < epoch.count; i++) {
+        const double* s = epoch.sat(i);
+        double w[AttackEngine::MAX_ACTIVE], fake[AttackEngine::MAX_ACTIVE], total = 0;
+        int n = 0;
+        for (int p = 0; p < eng.size() && n < AttackEngine::MAX_ACTIVE; p++) {
+            const AttackProfile& a = eng.profile(p);
+            if (t < a.start || t >= a.end) continue;
+            int k = n++;
+            w[k] = 0;
+            int prn = epoch.prns[i];
+            bool on = prn >= 1 && prn <= MAX_MASK_PRN ? (a.mask[epoch.systems[i]] >> (prn - 1)) & 1 : a.others;
+            if (!on) continue;
+            double age = t - a.start;
+            double f[3] = {a.offsetX + a.velocityX * age, a.offsetY + a.velocityY * age,
+                           a.offsetZ + a.velocityZ * age};
+            if (a.followReceiver)
+                for (int c = 0; c < 3; c++) f[c] += rx[c];
+            double power = a.powerEnd;
+            if (a.rampTime > 0 && age < a.rampTime)
+                power = a.powerStart + (a.powerEnd - a.powerStart) * age / a.rampTime;
+            w[k] = power;
+            fake[k] = signalRange(s, epoch.velocity(i), f[0], f[1], f[2]) + clockBias + a.delay;
+            total += power;
+        }
+        double r = epoch.ranges[i];
+        if (total > 0) {
+            double scale = total > 1 ? 1 / total : 1;
+            r *= 1 - total * scale;
+            for (int k = 0; k < n; k++)
+                if (w[k] > 0) r += w[k] * scale * fake[k];
+        }
+        out[i] = r;
+    }
+}
+
+// Variant v of a sweep: 1-4 spoofers with drift speed, ramp time, start,
+// delay, receiver-following and PRN subset all varying with v
+static void attackVariant(int v, const std::array<double,3>& victim, AttackEngine& eng) {
+    static const double speeds[] = {0.5, 1, 2, 5, 10, 20, 50, 100};
+    static const double ramps[]  = {0, 10, 30, 60, 120, 300};
+    eng.clear();
+    const int spoofers = 1 + v % 4;
+    for (int k = 0; k < spoofers; k++) {
+        int u = v / 4 + 7 * k;
+        AttackProfile p;
+        p.start = 10.0 * (u % 5) + k;
+        p.end = p.start + 100 + 50 * (u % 7);
+        p.followReceiver = (u + k) % 2 == 0;
+        double speed = speeds[u % 8], dir = 0.3 * u;
+        if (p.followReceiver) {
+            p.offsetX = p.offsetY = p.offsetZ = 0;
+        } else {
+            p.offsetX = victim[0] + 3000 * std::cos(dir);
+            p.offsetY = victim[1] + 3000 * std::sin(dir);
+            p.offsetZ = victim[2];
+        }
+        p.velocityX = speed * std::cos(dir);
+        p.velocityY = speed * std::sin(dir);
+        p.velocityZ = 0.1 * speed;
+        p.powerStart = 0.05 * (u % 3);
+        p.powerEnd = 0.4 + 0.2 * (u % 4);
+        p.rampTime = ramps[u % 6];
+        p.delay = (u % 3 == 1) ? 150.0 * (1 + k) : 0.0;
+        if (u % 4 == 3) {
+            for (int s = 0; s < SYSTEM_COUNT; s++)
+                for (int prn = 1; prn <= MAX_MASK_PRN; prn++)
+                    p.includeSatellite(s, prn, (prn + s + k + u) % 3 != 0);
+            p.others = (k + u) % 2 == 0;
+        }
+        eng.add(p);
+    }
+}
+
+// Checks AttackEngine against Spoofer and the per-satellite reference, then
+// sweeps attack variants over a recorded epoch stream: the blend alone, and
+// full detector evaluation runs (blend, solve, analyze). Returns false on a
+// mismatch or if a sweep allocates.
+static bool benchAttacks() {
+    const int epochs = 300;
+    Recording rec = recordEpochs(1, epochs);
+    const auto& victim = rec.truth[0];
+    const double clockBias = 30.0;
+    bool ok = true;
+
+    // A Spoofer is the one-profile, static, always-on case
+    std::vector<double> a(64), b(64);
+    double spooferDiff = 0, refDiff = 0;
+    for (double power : {0.0, 0.3, 1.0}) {
+        Spoofer spoofer(victim[0] + 3000, victim[1] - 2000, victim[2] + 1000, power);
+        AttackEngine eng(AttackProfile::fromSpoofer(spoofer));
+        for (int e = 0; e < epochs; e++) {
+            EpochView view = rec.buffers[e].view();
+            spoofer.spoofPseudoranges(view, clockBias, a.data());
+            eng.apply(e, victim[0], victim[1], victim[2], clockBias, view, b.data());
+            for (int i = 0; i < view.count; i++) spooferDiff = std::max(spooferDiff, std::fabs(a[i] - b[i]));
+        }
+    }
+
+    // Every variant against the branching reference, and the sweep timing
+    const int variants = 4096;
+    AttackEngine eng;
+    eng.reserve(AttackEngine::MAX_ACTIVE);
+    long long ranges = 0, unchanged = 0;
+    for (int v = 0; v < variants; v += 7) {
+        attackVariant(v, victim, eng);
+        for (int e = 0; e < epochs; e++) {
+            EpochView view = rec.buffers[e].view();
+            referenceAttack(eng, e, victim.data(), clockBias, view, a.data());
+            eng.apply(e, victim[0], victim[1], victim[2], clockBias, view, b.data());
+            for (int i = 0; i < view.count; i++) {
+                refDiff = std::max(refDiff, std::fabs(a[i] - b[i]) / std::max(1.0, std::fabs(a[i])));
+                unchanged += b[i] == view.ranges[i];
+                ranges++;
+            }
+        }
+    }
+    std::printf("  |AttackEngine - Spoofer| max %.1e m, vs per-satellite reference max %.1e (rel), "
+                "%.0f%% of ranges untouched\n", spooferDiff, refDiff, 100.0 * unchanged / ranges);
+    if (spooferDiff > 1e-9 || refDiff > 1e-14) ok = false;
+
+    volatile double sink = 0;
+    double perRef = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        long long before = allocationCount();
+        long long sats = 0;
+        double t0 = nowSeconds();
+        for (int v = 0; v < variants; v++) {
+            attackVariant(v, victim, eng);
+            double sum = 0;
+            for (int e = 0; e < epochs; e++) {
+                EpochView view = rec.buffers[e].view();
+                if (pass == 0) referenceAttack(eng, e, victim.data(), clockBias, view, b.data());
+                else eng.apply(e, victim[0], victim[1], victim[2], clockBias, view, b.data());
+                sum += b[view.count - 1];
+                sats += view.count;
+            }
+            sink = sink + sum;
+        }
+        double secs = nowSeconds() - t0;
+        long long allocs = allocationCount() - before;
+        double rate = variants / secs;
+        if (pass == 0) perRef = rate;
+        std::printf("  %-26s %5d variants x %d epochs  %9.0f variants/s  %6.1f ns/range  (%.1fx, %lld allocations)\n",
+                    pass == 0 ? "per-satellite reference" : "AttackEngine::apply", variants, epochs,
+                    rate, secs / sats * 1e9, rate / perRef, allocs);
+        if (pass == 1 && allocs != 0) ok = false;
+    }
+
+    // Full evaluation runs: how many variants the detector flags
+    {
+        const int runs = 512;
+        PositionSolver solver;
+        solver.reserve(64);
+        Detector detector;
+        detector.reserve(64);
+        std::vector<double> spoofed(64);
+        int detected = 0;
+        double latency = 0;
+        long long before = allocationCount();
+        double t0 = nowSeconds();
+        for (int v = 0; v < runs; v++) {
+            attackVariant(v, victim, eng);
+            solver.reset();
+            detector.reset();
+            int first = -1;
+            for (int e = 0; e < epochs; e++) {
+                const EpochBuffer& buf = rec.buffers[e];
+                EpochView view = buf.view();
+                eng.apply(e, victim[0], victim[1], victim[2], clockBias, view, spoofed.data());
+                view.ranges = spoofed.data();
+                PositionFix fix;
+                solver.solve(&view, &fix);
+                DetectionResult r = detector.analyze(fix.x, fix.y, fix.z, fix.clockBias, 1.0, view);
+                if (first < 0 && r.spoofingDetected && eng.activeAt(e) > 0) first = e;
+            }
+            if (first >= 0) {
+                detected++;
+                latency += first - eng.profile(0).start;
+            }
+        }
+        double secs = nowSeconds() - t0;
+        long long allocs = allocationCount() - before;
+        std::printf("  detector runs: %d variants x %d epochs in %.2f s (%.0f variants/s, %lld allocations); "
+                    "%d detected, mean %.1f s after onset\n",
+                    runs, epochs, secs, runs / secs, allocs, detected, detected ? latency / detected : 0.0);
+        if (allocs != 0) ok = false;
+    }
+    if (!ok) std::printf("  FAIL: attack blend disagrees with the reference or allocates\n");
+    return ok;
+}
+
+// ===== Parameter sweep: memoized stages vs one full run per point =====
+
+static bool sameResult(const RunResult& a, const RunResult& b) {
+    return a.epochs == b.epochs && a.spoofedEpochs == b.spoofedEpochs &&
+           a.truePositives == b.truePositives && a.falseAlarms == b.falseAlarms &&
+           a.detectionDelay == b.detectionDelay && a.maxPositionError == b.maxPositionError &&
+           a.enteredNoFly == b.enteredNoFly;
+}
+
+// Runs `points` one by one and through a SweepEngine, checks the results
+// match exactly and prints both rates. Returns the number of mismatches.
+static int compareSweep(const char* name, const std::vector<ScenarioConfig>& points,
+                        SweepEngine& sweep, double& sweepSecs) {
+    std::vector<RunResult> naive(points.size()), memo;
+    double t0 = nowSeconds();
+    for (size_t i = 0; i < points.size(); i++) naive[i] = runScenario(points[i]);
+    double naiveSecs = nowSeconds() - t0;
+
+    sweep.resetStats();
+    t0 = nowSeconds();
+    sweep.run(points, memo);
+    sweepSecs = nowSeconds() - t0;
+
+    int mismatches = 0;
+    for (size_t i = 0; i < points.size(); i++) mismatches += !sameResult(naive[i], memo[i]);
+    const SweepStats& st = sweep.stats();
+    std::printf("  %-22s %5zu points  full runs %7.3f s  sweep %7.4f s  (%5.0fx)  computed: geometry %lld, ranges %lld  %d mismatches\n",
+                name, points.size(), naiveSecs, sweepSecs, naiveSecs / sweepSecs,
+                st.computed[SWEEP_GEOMETRY], st.computed[SWEEP_RANGES], mismatches);
+    return mismatches;
+}
+
+// A 1,000-point threshold sweep over one spoofed scenario should cost about
+// one simulation plus 1,000 verdicts; a spoofer-power sweep one geometry
+// pass plus one ranges pass per power. Returns false if any point differs
+// from running it alone, a stage is recomputed needlessly or a fully
+// cached re-run allocates per point.
+static bool benchSweep() {
+    ScenarioConfig base = randomScenario(5, 0);
+    for (long long i = 1; base.spooferPower == 0; i++) base = randomScenario(5, i);
+    bool ok = true;
+
+    // 10 x 10 x 10 threshold grid
+    std::vector<ScenarioConfig> thresholds;
+    for (int a = 0; a < 10; a++)
+        for (int b = 0; b < 10; b++)
+            for (int c = 0; c < 10; c++) {
+                ScenarioConfig p = base;
+                p.detector.maxPhysicalSpeed   = 30.0 + 30.0 * a;
+                p.detector.residualThreshold  = 2.0 + 6.0 * b;
+                p.detector.clockJumpThreshold = 5.0 + 15.0 * c;
+                thresholds.push_back(p);
+            }
+    // 50 powers x 20 thresholds
+    std::vector<ScenarioConfig> powers;
+    for (int k = 0; k < 50; k++)
+        for (int c = 0; c < 20; c++) {
+            ScenarioConfig p = base;
+            p.spooferPower = 0.02 * (k + 1);
+            p.detector.clockJumpThreshold = 5.0 + 10.0 * c;
+            powers.push_back(p);
+        }
+
+    SweepEngine sweep;
+    double tThreshold, tPower;
+    int bad = compareSweep("thresholds 10x10x10", thresholds, sweep, tThreshold);
+    ok = ok && bad == 0 && sweep.stats().computed[SWEEP_GEOMETRY] == 1 && sweep.stats().computed[SWEEP_RANGES] == 1;
+    bad = compareSweep("power 50 x clock 20", powers, sweep, tPower);
+    ok = ok && bad == 0 && sweep.stats().computed[SWEEP_GEOMETRY] == 0 && sweep.stats().computed[SWEEP_RANGES] == 50;
+
+    // Cost of the threshold sweep in units of one simulation
+    const int reps = 20;
+    double t0 = nowSeconds();
+    for (int r = 0; r < reps; r++) runScenario(base);
+    double tRun = (nowSeconds() - t0) / reps;
+    std::vector<RunResult> out;
+    sweep.run(thresholds, out);     // warm: every stage cached
+    long long before = allocationCount();
+    t0 = nowSeconds();
+    sweep.run(thresholds, out);
+    double tVerdicts = nowSeconds() - t0;
+    long long allocs = allocationCount() - before;
+    std::printf("  one run %.3f ms (%d epochs); 1,000 verdicts %.3f ms; threshold sweep = %.2f runs"
+                " (1 run + verdicts = %.2f)\n",
+                tRun * 1e3, out[0].epochs, tVerdicts * 1e3, tThreshold / tRun, 1.0 + tVerdicts / tRun);
+    std::printf("  cached re-run: %lld allocations for %zu points\n", allocs, thresholds.size());
+    if (allocs > 4) ok = false;
+    if (!ok) std::printf("  FAIL: sweep disagrees with full runs, recomputes a stage or allocates per point\n");
+    return ok;
+}
+
+// ===== ROC evaluation: one counting pass vs the detector at each level =====
+// Synthetic labelled runs: per-check confidences, higher after the onset.
+// With `lattice` the confidences are multiples of 1/64 and the weights of
+// 1/8, so every weighted sum is exact and any summation order agrees.
+struct SyntheticEpoch { int run; double time; bool spoofed; double conf[CHECK_COUNT]; };
+
+static std::vector<SyntheticEpoch> syntheticRuns(int runs, int epochs, bool lattice, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<SyntheticEpoch> out;
+    out.reserve((size_t)runs * epochs);
+    for (int r = 0; r < runs; r++) {
+        double onset = rng.uniform() < 0.6 ? rng.uniform(50, epochs - 50) : -1.0;
+        double strength = rng.uniform(0.05, 0.5);
+        for (int e = 0; e < epochs; e++) {
+            SyntheticEpoch ep;
+            ep.run = r; ep.time = e; ep.spoofed = onset >= 0 && e >= onset;
+            for (int k = 0; k < CHECK_COUNT; k++) {
+                double c = std::fabs(rng.gaussian()) * 0.12 + (ep.spoofed ? strength * rng.uniform() : 0.0);
+                c = std::min(1.0, c);
+                ep.conf[k] = lattice ? std::floor(c * 64) / 64 : c;
+            }
+            out.push_back(ep);
+        }
+    }
+    return out;
+}
+
+static double syntheticScore(const CheckWeights& w, const double* c) {
+    double s = 0.0;
+    for (int k = 0; k < CHECK_COUNT; k++) s += w[k] * c[k];
+    return std::min(1.0, s);
+}
+
+static void feed(DetectorEvaluation& eval, const std::vector<SyntheticEpoch>& epochs, int runBegin, int runEnd) {
+    int current = -1;
+    for (size_t i = 0; i < epochs.size(); i++) {
+        const SyntheticEpoch& ep = epochs[i];
+        if (ep.run < runBegin || ep.run >= runEnd) continue;
+        if (ep.run != current) {
+            // Onset: the first spoofed epoch of the run, if any
+            double onset = -1.0;
+            for (size_t k = i; k < epochs.size() && epochs[k].run == ep.run; k++)
+                if (epochs[k].spoofed) { onset = epochs[k].time; break; }
+            eval.beginRun(onset);
+            current = ep.run;
+        }
+        eval.addEpoch(ep.time, ep.conf);
+    }
+    eval.endRun();
+}
+
+// Mann-Whitney AUC of the exact scores, by sorting
+static double sortedAuc(const CheckWeights& w, const std::vector<SyntheticEpoch>& epochs) {
+    std::vector<std::pair<double,int>> s;
+    for (const SyntheticEpoch& ep : epochs) s.push_back({syntheticScore(w, ep.conf), ep.spoofed ? 1 : 0});
+    std::sort(s.begin(), s.end());
+    double wins = 0.0, negBelow = 0.0, pos = 0.0;
+    for (size_t i = 0; i < s.size();) {
+        size_t j = i;
+        double p = 0, n = 0;
+        while (j < s.size() && s[j].first == s[i].first) { if (s[j].second) p++; else n++; j++; }
+        wins += p * (negBelow + 0.5 * n);
+        negBelow += n; pos += p;
+        i = j;
+    }
+    return wins / (pos * negBelow);
+}
+
+static bool benchEvaluation() {
+    bool ok = true;
+    std::vector<CheckWeights> sets(3);
+    sets[0] = {0.125, 0.25, 0.125, 0.5, 0.5, 0.5, 0.5, 0.5};
+    sets[1] = {0.5, 0.5, 0.25, 0.125, 0.125, 0.25, 0.375, 0.0};
+    sets[2].fill(0.25);
+
+    // Counts, AUC and latency against brute force at sample levels
+    std::vector<SyntheticEpoch> lattice = syntheticRuns(300, 600, true, 11);
+    DetectorEvaluation eval(sets), first(sets), second(sets);
+    feed(eval, lattice, 0, 300);
+    feed(first, lattice, 0, 137);
+    feed(second, lattice, 137, 300);
+    first.merge(second);
+    int mismatches = 0;
+    for (int s = 0; s < 3; s++) {
+        if (std::fabs(eval.auc(s) - sortedAuc(sets[s], lattice)) > 1e-12) mismatches++;
+        for (int j : {0, 1, 64, 137, 400, 500, 731, 999}) {
+            const double level = DetectorEvaluation::level(j);
+            long long fa = 0, det = 0;
+            std::vector<double> latency;
+            int run = -1;
+            bool found = false;
+            for (const SyntheticEpoch& ep : lattice) {
+                if (ep.run != run) { run = ep.run; found = false; }
+                bool alarm = syntheticScore(sets[s], ep.conf) > level;
+                if (!ep.spoofed) { fa += alarm; continue; }
+                det += alarm;
+                if (alarm && !found) {
+                    found = true;
+                    double onset = ep.time;
+                    for (const SyntheticEpoch& o : lattice)
+                        if (o.run == run && o.spoofed) { onset = o.time; break; }
+                    latency.push_back(std::min(120.0, std::floor(ep.time - onset) + 1.0));
+                }
+            }
+            std::sort(latency.begin(), latency.end());
+            double median = latency.empty() ? -1.0 : latency[(size_t)std::ceil(0.5 * latency.size()) - 1];
+            double p90 = latency.empty() ? -1.0 : latency[(size_t)std::ceil(0.9 * latency.size()) - 1];
+            if (eval.falseAlarms(s, j) != fa || eval.detections(s, j) != det
+                || std::lround(eval.runDetectionRate(s, j) * eval.getSpoofedRuns()) != (long)latency.size()
+                || eval.latencyQuantile(s, j, 0.5) != median || eval.latencyQuantile(s, j, 0.9) != p90)
+                mismatches++;
+            if (first.falseAlarms(s, j) != fa || first.detections(s, j) != det
+                || first.latencyQuantile(s, j, 0.9) != p90)
+                mismatches++;
+        }
+    }
+    std::printf("  %lld epochs, 3 weight sets x 8 levels vs brute force: %d mismatches\n",
+                eval.getCleanEpochs() + eval.getSpoofedEpochs(), mismatches);
+    ok = ok && mismatches == 0;
+
+    // Continuous scores: the level grid bins ties, AUC stays close
+    std::vector<SyntheticEpoch> continuous = syntheticRuns(300, 600, false, 12);
+    DetectorEvaluation binned(sets);
+    feed(binned, continuous, 0, 300);
+    double worst = 0.0;
+    for (int s = 0; s < 3; s++) worst = std::max(worst, std::fabs(binned.auc(s) - sortedAuc(sets[s], continuous)));
+    std::printf("  continuous scores: AUC within %.2e of the sorted exact value\n", worst);
+    ok = ok && worst < 2e-3;
+
+    // Monte Carlo: default weights reproduce the detector's verdicts. The
+    // default level rarely fires in these scenarios, so alarm lower.
+    CheckWeights def;
+    DetectorThresholds limits;
+    for (int k = 0; k < CHECK_COUNT; k++) def[k] = limits.weights[k];
+    DetectorEvaluation mc({def, sets[2]});
+    MonteCarloStats st;
+    const int j = 150;
+    for (int i = 0; i < 100; i++) {
+        ScenarioConfig c = randomScenario(3, i);
+        c.detector.alarmLevel = DetectorEvaluation::level(j);
+        st.add(runScenario(c, &mc));
+    }
+    bool same = mc.detections(0, j) == st.truePositives && mc.falseAlarms(0, j) == st.falseAlarms
+             && mc.getSpoofedEpochs() == st.spoofedEpochs && mc.getSpoofedRuns() == st.spoofedRuns
+             && std::lround(mc.runDetectionRate(0, j) * mc.getSpoofedRuns()) == st.detectedRuns;
+    std::printf("  Monte Carlo (100 runs) at level %.3f: %lld detections, %lld false alarms, %lld / %lld runs: %s\n",
+                DetectorEvaluation::level(j), mc.detections(0, j), mc.falseAlarms(0, j),
+                st.detectedRuns, st.spoofedRuns, same ? "matches the detector" : "DIFFERS");
+    ok = ok && same;
+
+    // Throughput and footprint on 100M epochs, cycling a pool of confidences
+    const int POOL = 1 << 16;
+    std::vector<double> pool((size_t)POOL * CHECK_COUNT);
+    for (int i = 0; i < POOL; i++)
+        std::memcpy(&pool[(size_t)i * CHECK_COUNT], continuous[i].conf, sizeof(continuous[i].conf));
+    std::vector<CheckWeights> four = {def, sets[0], sets[1], sets[2]};
+    DetectorEvaluation big(four);
+    const long long EPOCHS = 100000000, RUN = 3600;
+    long long before = allocationCount();
+    double t0 = nowSeconds();
+    for (long long e = 0; e < EPOCHS; e++) {
+        long long k = e % RUN;
+        if (k == 0) big.beginRun((e / RUN) % 4 == 0 ? -1.0 : 1800.0);
+        big.addEpoch((double)k, &pool[(size_t)(e & (POOL - 1)) * CHECK_COUNT]);
+    }
+    big.endRun();
+    double secs = nowSeconds() - t0;
+    long long allocs = allocationCount() - before;
+    std::printf("  100M epochs x 4 weight sets: %.2f s (%.3e epochs/s), %zu KiB fixed, %lld allocations\n",
+                secs, EPOCHS / secs, big.memoryBytes() / 1024, allocs);
+    ok = ok && allocs == 0 && big.getCleanEpochs() + big.getSpoofedEpochs() == EPOCHS;
+    if (!ok) std::printf("  FAIL: evaluation disagrees with brute force or the detector, or allocates per epoch\n");
+    return ok;
+}
+
+// ===== Fleet: shared propagation + batched receivers vs one pipeline each =====
+// Returns false if a fleet epoch allocates after the first one, or a fleet
+// with the error models leaves fixes unsolved or more than 100 m out.
+static bool benchFleet() {
+    FleetConfig cfg;
+    cfg.receivers = 2000;
+    cfg.epochs    = 30;
+    cfg.spoofStart = 15;
+
+    // Baseline: every receiver owns an EpochPipeline and re-propagates the
+    // constellation itself
+    auto fake = lla_to_ecef(43.6426, -79.3871, 200);
+    std::vector<std::array<double,3>> start;
+    Rng rng(cfg.seed);
+    for (int r = 0; r < cfg.receivers; r++)
+        start.push_back(lla_to_ecef(rng.uniform(43.55, 43.77), rng.uniform(-79.75, -79.28), 200));
+    Constellation shared = buildGpsConstellation();
+    std::vector<EpochPipeline> pipelines;
+    pipelines.reserve(cfg.receivers);
+    for (int r = 0; r < cfg.receivers; r++) {
+        pipelines.emplace_back(shared, Spoofer(fake[0], fake[1], fake[2], 0.0), 0.12);
+        pipelines.back().setRangeNoise(cfg.rangeNoise, deriveSeed(cfg.seed, r));
+    }
+    double t0 = nowSeconds();
+    for (int e = 0; e < cfg.epochs; e++)
+        for (int r = 0; r < cfg.receivers; r++)
+            pipelines[r].step(e * 1.0, start[r][0], start[r][1], start[r][2], 1.0, false);
+    double perReceiver = (double)cfg.receivers * cfg.epochs / (nowSeconds() - t0);
+    std::printf("  %-34s %12.3e receiver-epochs/s\n", "one pipeline per receiver", perReceiver);
+
+    bool ok = true;
+    for (int threads : {1, 2, 4}) {
+        Constellation sats = buildGpsConstellation();
+        Fleet fleet(sats, cfg);
+        ThreadPool pool(threads);
+        fleet.step(pool);                       // sizes per-worker scratch
+        long long before = allocationCount();
+        FleetStats st;
+        t0 = nowSeconds();
+        for (int e = 1; e < cfg.epochs; e++) st.merge(fleet.step(pool));
+        double rate = st.receiverEpochs / (nowSeconds() - t0);
+        long long allocs = allocationCount() - before;
+        char label[64];
+        std::snprintf(label, sizeof(label), "fleet, %d thread%s", threads, threads > 1 ? "s" : "");
+        std::printf("  %-34s %12.3e receiver-epochs/s  (%.1fx, %lld allocations, %lld/%lld solved)\n",
+                    label, rate, rate / perReceiver, allocs, st.solved, st.receiverEpochs);
+        if (allocs != 0) ok = false;
+    }
+
+    // With the error models: the fleet forms ranges with the pipeline's helper
+    {
+        FleetConfig withErrors = cfg;
+        withErrors.errorModels = ERROR_ALL;
+        Constellation sats = buildGpsConstellation();
+        Fleet fleet(sats, withErrors);
+        ThreadPool pool(4);
+        FleetStats st = fleet.step(pool);
+        long long before = allocationCount();
+        t0 = nowSeconds();
+        for (int e = 1; e < cfg.epochs; e++) st.merge(fleet.step(pool));
+        double rate = (st.receiverEpochs - cfg.receivers) / (nowSeconds() - t0);
+        long long allocs = allocationCount() - before;
+        std::printf("  %-34s %12.3e receiver-epochs/s  (%lld allocations, %lld/%lld solved,"
+                    " worst clean fix %.1f m)\n", "fleet with errors, 4 threads", rate, allocs,
+                    st.solved, st.receiverEpochs, st.maxCleanError);
+        if (allocs != 0 || st.solved < st.receiverEpochs || st.maxCleanError > 100.0) ok = false;
+    }
+    std::printf("  (%u hardware threads)\n", std::thread::hardware_concurrency());
+    if (!ok) std::printf("  FAIL: fleet epochs allocate or fail with errors\n");
+    return ok;
+}
+
+// ===== Visibility: sky-cell candidates vs testing every satellite =====
+// Receivers are spread over the globe at 0-10 km; the GPS constellation and
+// a 120-satellite Walker set are swept over three masks. Returns false if
+// the grid ever disagrees with the exhaustive test or a lookup allocates.
+static bool benchVisibility() {
+    const int receivers = 20000, epochs = 20;
+    Rng rng(11);
+    std::vector<double> rx(receivers), ry(receivers), rz(receivers);
+    for (int r = 0; r < receivers; r++) {
+        double lat = asin(rng.uniform(-1, 1)) * 180 / M_PI;
+        auto p = lla_to_ecef(lat, rng.uniform(-180, 180), rng.uniform(0, 10000));
+        rx[r] = p[0]; ry[r] = p[1]; rz[r] = p[2];
+    }
+
+    bool ok = true;
+    for (int set = 0; set < 2; set++) {
+        Constellation sats;
+        if (set == 0) sats = buildGpsConstellation();
+        else { std::vector<LegacySatellite> unused; buildSet(10, 12, unused, sats); }
+
+        for (double mask : {0.0, 5.0, 15.0}) {
+            VisibilityEngine grid(mask), all(mask);
+            VisibleSet a, b;
+            a.reserve(sats.size()); b.reserve(sats.size());
+            long long mismatches = 0, candidates = 0;
+            double tGrid = 0, tAll = 0, tBuild = 0;
+            long long before = 0;
+            for (int e = 0; e < epochs; e++) {
+                sats.update(600.0 * e);
+                if (e == 1) before = allocationCount();
+                double t0 = nowSeconds();
+                grid.update(sats);
+                tBuild += nowSeconds() - t0;
+                all.setSatellites(sats);
+
+                t0 = nowSeconds();
+                for (int r = 0; r < receivers; r++) grid.visible(rx[r], ry[r], rz[r], a);
+                tGrid += nowSeconds() - t0;
+                t0 = nowSeconds();
+                for (int r = 0; r < receivers; r++) all.visibleAll(rx[r], ry[r], rz[r], b);
+                tAll += nowSeconds() - t0;
+
+                for (int r = 0; r < receivers; r++) {
+                    grid.visible(rx[r], ry[r], rz[r], a);
+                    all.visibleAll(rx[r], ry[r], rz[r], b);
+                    candidates += grid.candidates(rx[r], ry[r], rz[r]);
+                    bool same = a.size() == b.size();
+                    for (int k = 0; same && k < a.size(); k++)
+                        same = a.satellite(k) == b.satellite(k);
+                    if (!same) mismatches++;
+                }
+            }
+            long long allocs = allocationCount() - before;
+            double n = (double)receivers * epochs;
+            std::printf("  %3d sats, mask %4.1f deg: grid %6.1f ns/rx, all %6.1f ns/rx (%.2fx), "
+                        "rebuild %6.1f us, %5.1f candidates, %lld mismatches, %lld allocations\n",
+                        sats.size(), mask, tGrid / n * 1e9, tAll / n * 1e9, tAll / tGrid,
+                        tBuild / epochs * 1e6, candidates / n, mismatches, allocs);
+            if (mismatches != 0 || allocs != 0) ok = false;
+        }
+    }
+    if (!ok) std::printf("  FAIL: sky-cell grid disagrees with the exhaustive test or allocates\n");
+    return ok;
+}
+
+// ===== Signal generation and acquisition =====
+// Generates a few seconds of 4 MHz samples for a Toronto sky, with and
+// without a spoofer, and acquires every PRN at the start of each second.
+// Returns false if a visible PRN is missed or mislocated, an absent PRN is
+// acquired, the spoofer's copy does not appear, or a steady-state second
+// allocates.
+static bool benchSignal() {
+    const int seconds = 4;
+    auto rx   = lla_to_ecef(43.6426, -79.3871, 200);
+    auto fake = lla_to_ecef(43.7, -79.0, 200);
+    Spoofer spoofer(fake[0], fake[1], fake[2]);
+
+    SignalConfig sc;
+    AcquisitionConfig ac;
+    const int n = (int)sc.sampleRate;
+    std::vector<float> re(n), im(n);
+    int prns[CaCodeTable::MAX_PRN];
+    for (int i = 0; i < CaCodeTable::MAX_PRN; i++) prns[i] = i + 1;
+    AcquisitionResult res[CaCodeTable::MAX_PRN];
+
+    // Circular code-phase distance in chips
+    auto codeError = [](double a, double b) {
+        double d = std::fabs(a - b);
+        return std::min(d, CaCodeTable::CHIPS - d);
+    };
+
+    bool ok = true;
+    double totalGen = 0, totalAcq = 0;
+    for (int spoof = 0; spoof < 2; spoof++) {
+        Constellation sats = buildGpsConstellation();
+        VisibilityEngine visibility;
+        VisibleSet visible;
+        visible.reserve(sats.size());
+        SignalGenerator gen(sc);
+        AcquisitionEngine acq(ac);
+        std::vector<SignalSource> truth;
+        truth.reserve(2 * sats.size());
+
+        long long missed = 0, wrong = 0, falseAcq = 0, noCopy = 0, signals = 0, allocs = 0;
+        double tGen = 0, tAcq = 0;
+        for (int s = 0; s < seconds; s++) {
+            double t = 5000.0 + s;
+            sats.update(t);
+            visibility.setSatellites(sats);
+            visibility.visibleAll(rx[0], rx[1], rx[2], visible);
+            gen.setSky(sats, visible, rx[0], rx[1], rx[2], 1234.0, t, spoof ? &spoofer : nullptr);
+            truth.assign(gen.getSources().begin(), gen.getSources().end());
+
+            long long before = allocationCount();
+            double t0 = nowSeconds();
+            gen.generate(n, re.data(), im.data());
+            double t1 = nowSeconds();
+            acq.search(re.data(), im.data(), prns, CaCodeTable::MAX_PRN, res);
+            double t2 = nowSeconds();
+            allocs += allocationCount() - before;
+            tGen += t1 - t0;
+            tAcq += t2 - t1;
+
+            for (const auto& r : res) {
+                // The strongest signal of this PRN must be at the peak; with a
+                // spoofer that is the counterfeit, and the authentic copy must
+                // be the second peak
+                const SignalSource* strong = nullptr;
+                const SignalSource* weak = nullptr;
+                for (const auto& src : truth) {
+                    if (src.prn != r.prn) continue;
+                    if (!strong || src.amplitude > strong->amplitude) { weak = strong; strong = &src; }
+                    else weak = &src;
+                }
+                if (!strong) { falseAcq += r.acquired; continue; }
+                signals++;
+                if (!r.acquired) { missed++; continue; }
+                if (codeError(r.codePhase, strong->codePhase) > 0.5 ||
+                    std::fabs(r.doppler - strong->doppler) > ac.dopplerStep) wrong++;
+                if (weak && (r.secondMetric < ac.threshold ||
+                             codeError(r.secondCodePhase, weak->codePhase) > 0.5)) noCopy++;
+            }
+        }
+        totalGen += tGen;
+        totalAcq += tAcq;
+        std::printf("  %s: %lld signals, %lld missed, %lld mislocated, %lld false, %lld without second peak\n",
+                    spoof ? "spoofed  " : "authentic", signals, missed, wrong, falseAcq, noCopy);
+        std::printf("             generate %6.1f Msamples/s (%zu sources), acquire %2d PRNs %6.1f ms/s, "
+                    "%lld allocations\n",
+                    seconds * sc.sampleRate / tGen / 1e6, truth.size(), CaCodeTable::MAX_PRN,
+                    tAcq / seconds * 1e3, allocs);
+        if (missed || wrong || falseAcq || noCopy || allocs) ok = false;
+    }
+    std::printf("  %d s of samples per run: %.1fx real time overall\n",
+                seconds, 2 * seconds / (totalGen + totalAcq));
+    if (!ok) std::printf("  FAIL: acquisition disagrees with the generated geometry or allocates\n");
+    return ok;
+}
+
+// ===== Tracking loops and correlator-level detection =====
+// Tracks a 32-satellite sky down to the horizon from Toronto for a few seconds, once clean and
+// once with a spoofer that starts aligned with the real signals 1 s in and
+// drags them off, and feeds the correlator measurements to the detector
+// every second. Pseudoranges are left clean, so only the signal-level
+// checks can fire. Returns false if a clean channel drifts or loses lock,
+// the clean run alarms, the drag-off is missed or steady-state tracking
+// allocates.
+static bool benchTracking() {
+    const int seconds = 5;
+    const double t0 = 10000.0, dragStart = 1.0, ramp = 20.0, clockBias = 1234.0;   // 13 in view
+    auto rx   = lla_to_ecef(43.6426, -79.3871, 200);
+    auto fake = lla_to_ecef(43.6426 + 2.0 / 111.0, -79.3871, 200);
+    SignalConfig sc;
+    const int block = (int)(sc.sampleRate * 0.02);
+    std::vector<float> re(block), im(block);
+    int prns[CaCodeTable::MAX_PRN];
+    for (int i = 0; i < CaCodeTable::MAX_PRN; i++) prns[i] = i + 1;
+    AcquisitionResult res[CaCodeTable::MAX_PRN];
+
+    bool ok = true;
+    for (int spoof = 0; spoof < 2; spoof++) {
+        Constellation sats = buildWalker(8, 4);
+        VisibilityEngine visibility(0.0);       // horizon mask: 12+ channels
+        VisibleSet visible;
+        visible.reserve(sats.size());
+        EpochPipeline pipeline(sats, Spoofer(fake[0], fake[1], fake[2], 0.0), clockBias);
+        SignalGenerator gen(sc);
+        AcquisitionEngine acq;
+        TrackingBank bank;
+        bank.reserve(CaCodeTable::MAX_PRN);
+
+        double tTrack = 0, maxCode = 0, maxDoppler = 0, maxCn0 = 0, minLock = 1;
+        long long allocs = 0;
+        int alarms = 0, firstAlarm = -1, visibleCount = 0;
+        for (int b = 0; b < seconds * 50; b++) {
+            double t = t0 + b * 0.02;
+            double power = spoof && t - t0 > dragStart ? std::min(1.0, (t - t0 - dragStart) / ramp) : 0.0;
+            Spoofer spoofer(fake[0], fake[1], fake[2], power);
+            sats.update(t);
+            visibility.setSatellites(sats);
+            visibility.visibleAll(rx[0], rx[1], rx[2], visible);
+            gen.setSky(sats, visible, rx[0], rx[1], rx[2], clockBias, t, &spoofer);
+            gen.generate(block, re.data(), im.data());
+            if (b == 0) {
+                acq.search(re.data(), im.data(), prns, CaCodeTable::MAX_PRN, res);
+                for (const auto& r : res)
+                    if (r.acquired) bank.addChannel(r.prn, r.codePhase, r.doppler);
+                visibleCount = visible.size();
+            }
+
+            long long before = allocationCount();
+            double start = nowSeconds();
+            bank.process(re.data(), im.data(), block);
+            tTrack += nowSeconds() - start;
+            if (b % 50 == 49) {
+                SignalQualityView q = bank.quality();
+                EpochResult e = pipeline.step(t + 0.02, rx[0], rx[1], rx[2], 1.0, false, &q);
+                if (e.valid && e.detection.spoofingDetected) {
+                    alarms++;
+                    if (firstAlarm < 0) firstAlarm = b / 50 + 1;
+                }
+            }
+            if (b >= 50) allocs += allocationCount() - before;
+
+            // Clean channels against the generated signals, after 1 s to settle
+            if (spoof || b % 50 != 49 || b < 50) continue;
+            SignalQualityView q = bank.quality();
+            for (int c = 0; c < bank.size(); c++)
+                for (const auto& src : gen.getSources()) {
+                    if (src.prn != bank.getPrn(c)) continue;
+                    double dc = std::fabs(bank.getCodePhase(c) - src.codePhase);
+                    maxCode    = std::max(maxCode, std::min(dc, CaCodeTable::CHIPS - dc));
+                    maxDoppler = std::max(maxDoppler, std::fabs(bank.getDoppler(c) - src.doppler));
+                    maxCn0     = std::max(maxCn0, std::fabs(q.cn0[c] - sc.cn0));
+                    minLock    = std::min(minLock, q.lock[c]);
+                }
+        }
+
+        std::printf("  %s: %2d of %2d visible tracked, %.1fx real time (%.1f ns per channel-sample), "
+                    "%lld allocations\n",
+                    spoof ? "drag-off " : "clean    ", bank.size(), visibleCount,
+                    seconds / tTrack, tTrack / (seconds * sc.sampleRate * bank.size()) * 1e9, allocs);
+        if (spoof) {
+            std::printf("             drag-off from %.0f s: first alarm at %d s, %d of %d epochs flagged\n",
+                        dragStart, firstAlarm, alarms, seconds);
+            if (firstAlarm < 0 || firstAlarm > dragStart + 2) ok = false;
+        } else {
+            std::printf("             max code error %.3f chips, Doppler error %.2f Hz, C/N0 error %.1f dB, "
+                        "min lock %.2f, %d alarms\n", maxCode, maxDoppler, maxCn0, minLock, alarms);
+            if (maxCode > 0.05 || maxDoppler > 10 || maxCn0 > 3 || minLock < 0.8 || alarms) ok = false;
+        }
+        if (bank.size() != visibleCount || allocs) ok = false;
+    }
+    if (!ok) std::printf("  FAIL: tracking drifted, missed the drag-off, alarmed when clean or allocated\n");
+    return ok;
+}
+
+// ===== Trace output: cost per epoch and steady-state allocations =====
+// Runs the pipeline with and without a trace, then reads the file back.
+// Returns false if tracing allocates after warm-up or the file is wrong.
+static bool benchTrace() {
+    auto start = lla_to_ecef(43.6426, -79.3871, 200);
+    auto end   = lla_to_ecef(43.6777, -79.6248, 200);
+    auto fake  = lla_to_ecef(43.6426, -79.3871, 200);
+    const int epochs = 200000;
+    const char* path = "gnss_bench_trace.bin";
+
+    double secs[2];
+    long long allocs = 0;
+    TraceRecord last = {};
+    bool ok = true;
+    for (int traced = 0; traced < 2; traced++) {
+        Constellation satellites = buildGpsConstellation();
+        EpochPipeline pipeline(satellites, Spoofer(fake[0], fake[1], fake[2]), 0.12);
+        TraceWriter trace;
+        std::string err;
+        if (traced && !trace.open(path, &err)) {
+            std::printf("  FAIL: %s\n", err.c_str());
+            return false;
+        }
+        long long before = 0;
+        double t0 = nowSeconds();
+        for (int e = 0; e < epochs; e++) {
+            if (e == 100) before = allocationCount();
+            double f = (double)e / epochs;
+            double rx = start[0] + f * (end[0] - start[0]);
+            double ry = start[1] + f * (end[1] - start[1]);
+            double rz = start[2] + f * (end[2] - start[2]);
+            bool spoof = e >= epochs / 2;
+            EpochResult r = pipeline.step(e * 1.0, rx, ry, rz, 1.0, spoof);
+            if (traced) {
+                last = makeTraceRecord(e * 1.0, rx, ry, rz, r, 7, spoof, false);
+                trace.append(last);
+            }
+        }
+        if (traced) allocs = allocationCount() - before;
+        if (traced && !trace.close()) ok = false;
+        secs[traced] = nowSeconds() - t0;
+    }
+
+    double mb = (double)epochs * sizeof(TraceRecord) / 1e6;
+    std::printf("  %d epochs, %zu-byte records (%.1f MB)\n", epochs, sizeof(TraceRecord), mb);
+    std::printf("  %-10s %12.3e epochs/s\n", "no trace", epochs / secs[0]);
+    std::printf("  %-10s %12.3e epochs/s  (%.0f ns/epoch overhead, %lld allocations after warm-up)\n",
+                "traced", epochs / secs[1], (secs[1] - secs[0]) / epochs * 1e9, allocs);
+
+    // Read back: header size, record count and the final record
+    std::FILE* f = std::fopen(path, "rb");
+    unsigned char head[32] = {0};
+    TraceRecord back = {};
+    if (!f || std::fread(head, 1, sizeof(head), f) != sizeof(head)) ok = false;
+    else {
+        uint32_t headerBytes = head[8] | head[9] << 8 | head[10] << 16 | (uint32_t)head[11] << 24;
+        uint64_t count = 0;
+        for (int i = 0; i < 8; i++) count |= (uint64_t)head[24 + i] << (8 * i);
+        long pos = (long)headerBytes + (long)(epochs - 1) * (long)sizeof(TraceRecord);
+        if (count != (uint64_t)epochs || std::fseek(f, pos, SEEK_SET) != 0 ||
+            std::fread(&back, sizeof(back), 1, f) != 1 ||
+            std::memcmp(&back, &last, sizeof(back)) != 0)
+            ok = false;
+    }
+    if (f) std::fclose(f);
+    std::remove(path);
+
+    if (allocs != 0) ok = false;
+    if (!ok) std::printf("  FAIL: trace allocates or does not read back\n");
+    return ok;
+}
+
+// Synthetic playback trace: run 0 as one block of `n` epochs, then runs 1
+// and 2 interleaved epoch by epoch (like a fleet). Epoch k of every run is
+// at t = 0.1 k, so trace index and time map back to each other.
+static double playbackError(int run, long long k, long long n) {
+    double e = 3.0 + 2.0 * std::sin(0.013 * k + run) + ((k * 2654435761u) % 1000) * 1e-3;
+    if (run == 1 && k > n / 3) e += 0.01 * (k - n / 3);                 // drag-off
+    return e;
+}
+
+static long long playbackIndex(int run, long long k, long long n) {
+    return run == 0 ? k : n + 2 * k + (run - 1);
+}
+
+// Level-of-detail pyramid over a large trace: build rate, query cost, and
+// checks that each query is bounded, covers its window and reports the
+// exact min/max of the records under its spans
+static bool benchPlayback() {
+    const long long n = 400000;
+    const char* path = "gnss_bench_playback.bin";
+    {
+        TraceWriter writer;
+        std::string err;
+        if (!writer.open(path, &err)) {
+            std::printf("  FAIL: %s\n", err.c_str());
+            return false;
+        }
+        TraceRecord t = {};
+        auto put = [&](int run, long long k) {
+            t.time = 0.1 * k;
+            t.run = run;
+            t.trueLat = 43.66 + 0.02 * std::sin(2e-5 * k + run);
+            t.trueLon = -79.5 + 0.1 * std::cos(2e-5 * k + run);
+            t.valid = k % 997 != 0;
+            t.estX = t.valid ? playbackError(run, k, n) : 0.0;
+            t.estLat = t.trueLat;
+            t.estLon = t.trueLon;
+            t.spoofActive = run == 1 && k > n / 3;
+            t.spoofDetected = t.valid && run == 1 && k > n / 3 + 50;
+            t.confidence = t.spoofDetected ? 1.0 : 0.1;
+            writer.append(t);
+        };
+        for (long long k = 0; k < n; k++) put(0, k);
+        for (long long k = 0; k < n; k++) { put(1, k); put(2, k); }
+        if (!writer.close()) {
+            std::printf("  FAIL: cannot write %s\n", path);
+            return false;
+        }
+    }
+
+    TraceReader trace;
+    std::string err;
+    bool ok = trace.open(path, &err);
+    if (!ok) std::printf("  FAIL: %s\n", err.c_str());
+    TracePyramid pyramid;
+    double buildSecs = 0;
+    if (ok) {
+        pyramid.reset(trace);
+        double t0 = nowSeconds();
+        while (!pyramid.complete()) pyramid.build(1 << 16);
+        buildSecs = nowSeconds() - t0;
+        ok = pyramid.built() == (uint64_t)(3 * n) && pyramid.runCount() == 3;
+        if (!ok) std::printf("  FAIL: built %llu records in %d runs\n",
+                             (unsigned long long)pyramid.built(), pyramid.runCount());
+    }
+
+    const int maxSpans = 512;
+    std::vector<TraceSpan> out;
+    out.reserve(maxSpans + 66);
+    Rng rng(5);
+    int checked = 0, recordLevel = 0;
+    long long allocs = 0;
+    double querySecs = 0;
+    for (int q = 0; ok && q < 300; q++) {
+        int run = q % 3;
+        double total = 0.1 * (n - 1);
+        double len = total * std::pow(10.0, -6.0 * rng.uniform());         // whole trace down to ~1 s
+        double t0 = -0.05 * total + rng.uniform() * (1.1 * total - len);
+        double t1 = t0 + len;
+        out.clear();
+        long long before = allocationCount();
+        double s0 = nowSeconds();
+        int level = pyramid.query(run, t0, t1, maxSpans, out);
+        querySecs += nowSeconds() - s0;
+        allocs += allocationCount() - before;
+        recordLevel += level < 0;
+        if (out.empty() != (t1 < 0) || (int)out.size() > maxSpans) {
+            std::printf("  FAIL: %zu spans for window %.1f..%.1f s\n", out.size(), t0, t1);
+            ok = false;
+            break;
+        }
+        if (out.empty()) { checked++; continue; }      // window ends before the trace starts
+        // Epochs under the spans, from their trace indices
+        auto epochOf = [&](uint64_t i) { return run == 0 ? (long long)i : ((long long)i - n) / 2; };
+        long long k0 = epochOf(out.front().first), k1 = epochOf(out.back().last);
+        long long want0 = std::max(0LL, std::min(n - 1, (long long)std::floor(t0 / 0.1)));
+        long long want1 = std::max(0LL, std::min(n - 1, (long long)std::floor(t1 / 0.1)));
+        float lo = 1e30f, hi = -1e30f, slo = 1e30f, shi = -1e30f;
+        for (long long k = k0; k <= k1; k++) {
+            if (!trace[playbackIndex(run, k, n)].valid) continue;
+            float e = (float)playbackError(run, k, n);
+            lo = std::min(lo, e);
+            hi = std::max(hi, e);
+        }
+        for (const TraceSpan& sp : out) {
+            slo = std::min(slo, sp.lo[CHANNEL_ERROR]);
+            shi = std::max(shi, sp.hi[CHANNEL_ERROR]);
+        }
+        if (k0 > want0 || k1 < want1 || lo != slo || hi != shi) {
+            std::printf("  FAIL: window %.1f..%.1f s run %d: epochs %lld..%lld for %lld..%lld, "
+                        "error %g..%g vs %g..%g\n", t0, t1, run, k0, k1, want0, want1, slo, shi, lo, hi);
+            ok = false;
+        }
+        checked++;
+    }
+    trace.close();
+    std::remove(path);
+
+    double mb = 3.0 * n * sizeof(TraceRecord) / 1e6;
+    std::printf("  %lld epochs in 3 runs (%.0f MB), %d-epoch level-0 spans\n", 3 * n, mb, TracePyramid::BASE);
+    std::printf("  %-22s %10.3f s  (%.3e epochs/s, %.0f MB/s from the page cache)\n", "pyramid build", buildSecs,
+                3 * n / buildSecs, mb / buildSecs);
+    std::printf("  %-22s %10.2f us/query  (%d windows from 1 s to the whole trace, %d at record level, "
+                "<= %d spans, %lld allocations)\n", "window query", querySecs / std::max(1, checked) * 1e6,
+                checked, recordLevel, maxSpans, allocs);
+    if (allocs != 0) ok = false;
+    if (!ok) std::printf("  FAIL: playback pyramid\n");
+    return ok;
+}
+
+// ===== Micro-benchmark suite: one entry per hot path =====
+// Each entry runs a fixed number of operations from fixed seeds, once to
+// warm up and then MICRO_REPEATS times; the best time is reported as
+// ns/op and the heap allocations over all repeats as allocations/op.
+// Paths whose cost depends on the sky are swept over constellation size.
+// Results are kept for the optional JSON report (gnss_bench --json).
+struct MicroResult {
+    const char* name;
+    int         satellites;     // constellation size, 0 if not swept
+    long long   ops;
+    double      nsPerOp;
+    double      allocsPerOp;
+};
+
+static const int MICRO_REPEATS = 5;
+static std::vector<MicroResult> g_micro;
+static volatile double g_sink = 0;
+
+// `body(n)` performs n operations and returns a value that depends on them
+template<class Body>
+static void micro(const char* name, int satellites, long long ops, Body body) {
+    g_sink = g_sink + body(std::max(1LL, ops / 10));
+    double best = 1e300;
+    long long before = allocationCount();
+    for (int rep = 0; rep < MICRO_REPEATS; rep++) {
+        double t0 = nowSeconds();
+        g_sink = g_sink + body(ops);
+        best = std::min(best, nowSeconds() - t0);
+    }
+    MicroResult r{name, satellites, ops, best / ops * 1e9,
+                  (double)(allocationCount() - before) / ((double)ops * MICRO_REPEATS)};
+    g_micro.push_back(r);
+    std::printf("  %-34s %6d %12.1f %12.3f\n", r.name, r.satellites, r.nsPerOp, r.allocsPerOp);
+}
+
+static void benchMicro() {
+    std::printf("  %-34s %6s %12s %12s\n", "path", "sats", "ns/op", "allocs/op");
+    g_micro.reserve(64);
+    auto home = lla_to_ecef(43.6426, -79.3871, 200);
+
+    const int layouts[][2] = {{6, 4}, {10, 12}, {16, 24}, {32, 48}};
+    for (auto& layout : layouts) {
+        Constellation sats = buildWalker(layout[0], layout[1]);
+        const int n = sats.size();
+        const long long perEpoch = std::max(2000, 100000 * 24 / n);
+
+        // One epoch as seen from Toronto: visible satellites, noisy ranges
+        sats.update(1000.0);
+        VisibilityEngine vis;
+        VisibleSet seen;
+        vis.setSatellites(sats);
+        vis.visibleAll(home[0], home[1], home[2], seen);
+        EpochBuffer epoch;
+        Rng rng(5);
+        for (int k = 0; k < seen.size(); k++) {
+            int i = seen.satellite(k);
+            double pos[3] = {sats.getX(i), sats.getY(i), sats.getZ(i)}, vel[3];
+            sats.getVelocity(i, vel);
+            epoch.push(pos[0], pos[1], pos[2], vel,
+                       signalRange(pos, vel, home[0], home[1], home[2]) + 36000.0 + 2.0 * rng.gaussian(), i);
+        }
+        const EpochView view = epoch.view();
+
+        std::vector<Satellite> views;
+        for (int i = 0; i < n; i++) views.emplace_back(sats, i);
+        micro("Satellite::update", n, 2000000, [&](long long ops) {
+            double t = 0;
+            for (long long done = 0; done < ops; t += 1.0)
+                for (int i = 0; i < n && done < ops; i++, done++) views[i].update(t);
+            return views[0].getX();
+        });
+        micro("Constellation::update (per sat)", n, 4000000, [&](long long ops) {
+            long long epochs = ops / n;
+            for (long long e = 0; e < epochs; e++) sats.update(e * 0.1);
+            return sats.getX(n - 1);
+        });
+        sats.beginSteps(0.0, 0.01);
+        micro("Constellation::step (per sat)", n, 4000000, [&](long long ops) {
+            long long epochs = ops / n;
+            for (long long e = 0; e < epochs; e++) sats.step();
+            return sats.getX(n - 1);
+        });
+        sats.update(1000.0);
+
+        Receiver receiver(home[0], home[1], home[2]);
+        std::vector<double> pos(3 * n), vel(3 * n);
+        for (int i = 0; i < n; i++) {
+            pos[3 * i] = sats.getX(i); pos[3 * i + 1] = sats.getY(i); pos[3 * i + 2] = sats.getZ(i);
+            sats.getVelocity(i, &vel[3 * i]);
+        }
+        micro("Receiver::distanceTo", n, 4000000, [&](long long ops) {
+            double sum = 0;
+            for (long long done = 0; done < ops;)
+                for (int i = 0; i < n && done < ops; i++, done++)
+                    sum += receiver.distanceTo(&pos[3 * i], &vel[3 * i]);
+            return sum;
+        });
+
+        Spoofer spoofer(home[0] + 3000, home[1] - 2000, home[2] + 1000);
+        std::vector<double> spoofed(view.count);
+        micro("Spoofer::spoofPseudoranges", n, perEpoch * 4, [&](long long ops) {
+            for (long long k = 0; k < ops; k++) spoofer.spoofPseudoranges(view, 36000.0, spoofed.data());
+            return spoofed[0];
+        });
+
+        AttackEngine attack(AttackProfile::fromSpoofer(spoofer));
+        AttackProfile drag;
+        drag.followReceiver = true;
+        drag.velocityX = 5.0;
+        drag.powerStart = 0.0;
+        drag.rampTime = 60.0;
+        drag.includeSatellite(SYSTEM_GPS, 1, false);
+        attack.add(drag);
+        micro("AttackEngine::apply (2 spoofers)", n, perEpoch * 4, [&](long long ops) {
+            for (long long k = 0; k < ops; k++)
+                attack.apply(30.0, home[0], home[1], home[2], 36000.0, view, spoofed.data());
+            return spoofed[0];
+        });
+
+        Detector detector;
+        detector.reserve(n);
+        micro("Detector::analyze", n, perEpoch * 4, [&](long long ops) {
+            double c = 0;
+            for (long long k = 0; k < ops; k++)
+                c += detector.analyze(home[0] + (k & 63), home[1], home[2], 36000.0, 1.0, view).confidence;
+            return c;
+        });
+
+        micro("solvePositionLeastSquares", n, perEpoch, [&](long long ops) {
+            double sum = 0;
+            for (long long k = 0; k < ops; k++)
+                sum += solvePositionLeastSquares(view, home[0] + 100, home[1] - 100, home[2] + 100)[3];
+            return sum;
+        });
+
+        auto fake = lla_to_ecef(43.6426, -79.3871, 200);
+        EpochPipeline pipeline(sats, Spoofer(fake[0], fake[1], fake[2]), 0.12);
+        micro("EpochPipeline::step", n, perEpoch, [&](long long ops) {
+            double sum = 0;
+            for (long long k = 0; k < ops; k++)
+                sum += pipeline.step(1000.0 + k, home[0] + k % 1000, home[1], home[2], 1.0, false).estX;
+            return sum;
+        });
+    }
+
+    micro("lla_to_ecef", 0, 2000000, [&](long long ops) {
+        double sum = 0;
+        for (long long k = 0; k < ops; k++)
+            sum += lla_to_ecef(-80.0 + (k % 1600) * 0.1, (k % 3600) * 0.1 - 180, 200)[2];
+        return sum;
+    });
+    micro("ecef_to_lla", 0, 1000000, [&](long long ops) {
+        double sum = 0;
+        for (long long k = 0; k < ops; k++)
+            sum += ecef_to_lla(home[0] + k % 5000, home[1], home[2] - k % 3000)[0];
+        return sum;
+    });
+
+    // Batch forms, per point, in blocks of 1024
+    const int block = 1024;
+    std::vector<double> lat(block), lon(block), alt(block, 200.0), bx(block), by(block), bz(block);
+    for (int i = 0; i < block; i++) {
+        lat[i] = -80.0 + (i % 1600) * 0.1;
+        lon[i] = i * 0.1 - 180;
+    }
+    micro("lla_to_ecef (batch)", 0, 20000000, [&](long long ops) {
+        for (long long done = 0; done < ops; done += block)
+            lla_to_ecef(lat.data(), lon.data(), alt.data(), block, bx.data(), by.data(), bz.data());
+        return bz[0];
+    });
+    micro("ecef_to_lla (batch)", 0, 20000000, [&](long long ops) {
+        for (long long done = 0; done < ops; done += block)
+            ecef_to_lla(bx.data(), by.data(), bz.data(), block, lat.data(), lon.data(), alt.data());
+        return lat[0];
+    });
+
+    // The whole scenario, setup included, per epoch it simulates (5 waypoints)
+    for (bool spoof : {false, true})
+        micro(spoof ? "runScenario (spoofed, per epoch)" : "runScenario (per epoch)", 24,
+              5LL * 2000, [&](long long ops) {
+            double sum = 0;
+            for (long long k = 0; k < ops; k += 5) sum += runScenario(spoof).truePath.size();
+            return sum;
+        });
+}
+
+// Writes the suite's results as JSON; returns false if the file cannot be written
+static bool writeMicroJson(const char* path) {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"suite\": \"gnss_bench\",\n  \"schema\": 1,\n");
+    std::fprintf(f, "  \"repeats\": %d,\n  \"hardware_threads\": %u,\n",
+                 MICRO_REPEATS, std::thread::hardware_concurrency());
+    std::fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < g_micro.size(); i++) {
+        const MicroResult& r = g_micro[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"satellites\": %d, \"ops\": %lld, "
+                        "\"ns_per_op\": %.3f, \"allocs_per_op\": %.6f}%s\n",
+                     r.name, r.satellites, r.ops, r.nsPerOp, r.allocsPerOp,
+                     i + 1 < g_micro.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* jsonPath = nullptr;
+    bool microOnly = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--json") && i + 1 < argc) jsonPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--micro")) microOnly = true;
+        else {
+            std::fprintf(stderr, "usage: gnss_bench [--micro] [--json <file>]\n");
+            return 2;
+        }
+    }
+
+    std::cout << "gnss_bench — hot-path micro-benchmarks\n\n";
+    benchMicro();
+    if (jsonPath && !writeMicroJson(jsonPath)) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath);
+        return 1;
+    }
+    if (microOnly) return 0;
+
+    std::cout << "\ngnss_bench — constellation propagation\n\n";
+    benchPropagation();
+    std::cout << "\ngnss_bench — high-rate trajectories\n\n";
+    bool trajectoryOk = benchTrajectory();
+    std::cout << "\ngnss_bench — broadcast ephemeris replay\n\n";
+    benchEphemeris();
+    std::cout << "\ngnss_bench — least-squares position solver\n\n";
+    benchSolver();
+    std::cout << "\ngnss_bench — multi-GNSS solver\n\n";
+    bool multiOk = benchMultiGnss();
+    std::cout << "\ngnss_bench — light time and Earth rotation\n\n";
+    bool pathOk = benchSignalPath();
+    std::cout << "\ngnss_bench — epoch pipeline heap allocations\n\n";
+    bool allocOk = checkEpochAllocations();
+    std::cout << "\ngnss_bench — atmospheric and satellite-clock errors\n\n";
+    bool errorsOk = benchMeasurementErrors();
+    std::cout << "\ngnss_bench — batch geodetic conversion\n\n";
+    bool geodesyOk = benchGeodesy();
+    std::cout << "\ngnss_bench — spoofing detector\n\n";
+    bool detectorOk = benchDetector();
+    std::cout << "\ngnss_bench — time-varying attack profiles\n\n";
+    bool attackOk = benchAttacks();
+    std::cout << "\ngnss_bench — RAIM fault detection and exclusion\n\n";
+    bool raimOk = benchRaim();
+    std::cout << "\ngnss_bench — EKF navigation engine\n\n";
+    bool navOk = benchNavFilter();
+    std::cout << "\ngnss_bench — memoized parameter sweeps\n\n";
+    bool sweepOk = benchSweep();
+    std::cout << "\ngnss_bench — ROC and detection-latency evaluation\n\n";
+    bool evaluationOk = benchEvaluation();
+    std::cout << "\ngnss_bench — fleet simulation\n\n";
+    bool fleetOk = benchFleet();
+    std::cout << "\ngnss_bench — elevation-mask visibility\n\n";
+    bool visibilityOk = benchVisibility();
+    std::cout << "\ngnss_bench — signal generation and acquisition\n\n";
+    bool signalOk = benchSignal();
+    std::cout << "\ngnss_bench — tracking loops\n\n";
+    bool trackingOk = benchTracking();
+    std::cout << "\ngnss_bench — binary trace output\n\n";
+    bool traceOk = benchTrace();
+    std::cout << "\ngnss_bench — trace playback level of detail\n\n";
+    bool playbackOk = benchPlayback();
+    return trajectoryOk && multiOk && pathOk && allocOk && errorsOk && geodesyOk && detectorOk && attackOk && raimOk && navOk && sweepOk && evaluationOk && fleetOk && visibilityOk && signalOk && trackingOk && traceOk
+        && playbackOk ? 0 : 1;
+}
@@ -1,23 +1,34 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include "Satellite.h"
+#include <string>
+#include "Constellation.h"
+#include "GnssSystems.h"
+#include "Scenario.h"
 #include "Visualizer_gl.h"
 
-int main() {
-    const double earthRadius  = 6371000.0;
-    const double angularSpeed = 0.001;
-
-    std::vector<Satellite> satellites;
-    const double inclination = 55.0 * M_PI / 180.0;
-    for (int p = 0; p < 6; p++) {
-        double planeRotation = p * (2 * M_PI / 6);
-        for (int s = 0; s < 4; s++) {
-            double phase = s * (2 * M_PI / 4);
-            satellites.emplace_back(26571000.0, phase + planeRotation, inclination);
+// gnss_gl                  3D constellation view (GPS)
+// gnss_gl -c <file>        3D view of the Walker shells in <file>
+//                          (e.g. data/constellations.txt)
+// gnss_gl <trace.bin>      playback of a gnss_sim trace
+int main(int argc, char* argv[]) {
+    Constellation satellites = buildGpsConstellation();
+    if (argc >= 3 && std::string(argv[1]) == "-c") {
+        std::vector<WalkerShell> shells;
+        std::string err;
+        if (!loadConstellations(argv[2], shells, &err)) {
+            std::cerr << "Constellation load failed: " << err << "\n";
+            return 1;
         }
+        satellites = buildConstellation(shells);
+    } else if (argc >= 2) {
+        runPlayback(argv[1]);
+        return 0;
     }
 
+    const double earthRadius  = 6371000.0;
+    const double angularSpeed = 0.001;
+
     runGLVisualizer(satellites, earthRadius, angularSpeed);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,444 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/glcorearb.h>
+
+#include "Constellation.h"
+#include "Visibility.h"
+#include "Renderer_gl.h"
+#include "Playback_gl.h"
+#include "TraceReader.h"
+#include "TraceWriter.h"
+
+// Offscreen frame-time benchmark of the sky view: renders into a pbuffer
+// of a surfaceless EGL display, so it runs on Mesa llvmpipe without a GPU
+// or a window system. Each scene is drawn by the retained-mode SkyRenderer
+// (GL 3.3 core) and by a reference copy of the original immediate-mode
+// frame (compatibility context), and the centre pixels are compared.
+// Then trace playback is timed at several zoom levels of a long trace.
+
+static const int WIDTH = 1280, HEIGHT = 720;
+static const double EARTH_RADIUS = 6371000.0;
+
+// ===== EGL =====
+struct Offscreen {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLConfig  config = nullptr;
+    EGLSurface surface = EGL_NO_SURFACE;
+};
+
+static bool openDisplay(Offscreen& o, std::string& err) {
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    o.display = getPlatformDisplay
+        ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+        : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if (o.display == EGL_NO_DISPLAY || !eglInitialize(o.display, &major, &minor)) {
+        err = "no EGL display";
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint attr[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                           EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+                           EGL_DEPTH_SIZE, 24, EGL_NONE};
+    EGLint n = 0;
+    if (!eglChooseConfig(o.display, attr, &o.config, 1, &n) || n < 1) {
+        err = "no RGBA8 + depth pbuffer config";
+        return false;
+    }
+    const EGLint size[] = {EGL_WIDTH, WIDTH, EGL_HEIGHT, HEIGHT, EGL_NONE};
+    o.surface = eglCreatePbufferSurface(o.display, o.config, size);
+    if (o.surface == EGL_NO_SURFACE) {
+        err = "cannot create pbuffer";
+        return false;
+    }
+    return true;
+}
+
+static EGLContext makeContext(Offscreen& o, bool core) {
+    const EGLint coreAttr[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                               EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    const EGLint compatAttr[] = {EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+                                 EGL_NONE};
+    EGLContext c = eglCreateContext(o.display, o.config, EGL_NO_CONTEXT, core ? coreAttr : compatAttr);
+    if (c != EGL_NO_CONTEXT && !eglMakeCurrent(o.display, o.surface, o.surface, c)) {
+        eglDestroyContext(o.display, c);
+        return EGL_NO_CONTEXT;
+    }
+    return c;
+}
+
+// ===== Immediate-mode reference =====
+// Fixed-function entry points are not in the core header; fetch them.
+#define GL_QUAD_STRIP    0x0008
+#define GL_MODELVIEW     0x1700
+#define GL_PROJECTION    0x1701
+#define GL_POINT_SMOOTH  0x0B10
+
+struct LegacyGL {
+    void (*begin)(GLenum);
+    void (*end)();
+    void (*vertex3d)(double, double, double);
+    void (*color3f)(float, float, float);
+    void (*color4f)(float, float, float, float);
+    void (*matrixMode)(GLenum);
+    void (*loadIdentity)();
+    void (*loadMatrixd)(const double*);
+    void (*pushMatrix)();
+    void (*popMatrix)();
+    void (*rotated)(double, double, double, double);
+
+    bool load() {
+        void** fn[] = {(void**)&begin, (void**)&end, (void**)&vertex3d, (void**)&color3f, (void**)&color4f,
+                       (void**)&matrixMode, (void**)&loadIdentity, (void**)&loadMatrixd,
+                       (void**)&pushMatrix, (void**)&popMatrix, (void**)&rotated};
+        const char* names[] = {"glBegin", "glEnd", "glVertex3d", "glColor3f", "glColor4f", "glMatrixMode",
+                               "glLoadIdentity", "glLoadMatrixd", "glPushMatrix", "glPopMatrix", "glRotated"};
+        for (int i = 0; i < 11; i++)
+            if (!(*fn[i] = (void*)eglGetProcAddress(names[i]))) return false;
+        return true;
+    }
+};
+
+// Frame as the visualizer drew it before the retained-mode port, with the
+// fleet receivers added the same way as the satellites (one glBegin each)
+static void legacyFrame(const LegacyGL& gl, const Constellation& sats, const VisibleSet& visible,
+                        const std::vector<double>& fx, const std::vector<double>& fy, const std::vector<double>& fz,
+                        std::vector<std::array<double,3>>& trail, double rx, double ry, double rz,
+                        const OrbitCamera& cam)
+{
+    const double S = 1.0 / EARTH_RADIUS;
+    const double satR = sats.getRadius(0) * S;
+    trail.push_back({rx, ry, rz});
+    if (trail.size() > 500) trail.erase(trail.begin());
+
+    glViewport(0, 0, WIDTH, HEIGHT);
+    glClearColor(0.02f, 0.02f, 0.08f, 1);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_POINT_SMOOTH);
+
+    gl.matrixMode(GL_PROJECTION); gl.loadIdentity();
+    double asp = (double)WIDTH / HEIGHT, f = 1.0 / std::tan(22.5 * M_PI / 180), zN = 0.01, zF = 200;
+    double pr[16] = {f / asp, 0, 0, 0, 0, f, 0, 0, 0, 0, (zF + zN) / (zN - zF), -1, 0, 0, 2 * zF * zN / (zN - zF), 0};
+    gl.loadMatrixd(pr);
+    gl.matrixMode(GL_MODELVIEW); gl.loadIdentity();
+    double yr = cam.yaw * M_PI / 180, pp = cam.pitch * M_PI / 180;
+    double cx = cam.dist * std::cos(pp) * std::sin(yr), cy = cam.dist * std::sin(pp), cz = cam.dist * std::cos(pp) * std::cos(yr);
+    double vx = -cx, vy = -cy, vz = -cz, vl = std::sqrt(vx*vx + vy*vy + vz*vz);
+    vx /= vl; vy /= vl; vz /= vl;
+    double sx = -vz, sz = vx, sl = std::sqrt(sx*sx + sz*sz);
+    sx /= sl; sz /= sl;
+    double ux = -sz*vy, uy = sz*vx - sx*vz, uz = sx*vy;
+    double mv[16] = {sx, ux, -vx, 0, 0, uy, -vy, 0, sz, uz, -vz, 0,
+                     -(sx*cx + sz*cz), -(ux*cx + uy*cy + uz*cz), (vx*cx + vy*cy + vz*cz), 1};
+    gl.loadMatrixd(mv);
+
+    auto circle = [&](double r, int seg) {
+        gl.begin(GL_LINE_LOOP);
+        for (int i = 0; i < seg; i++) { double a = 2 * M_PI * i / seg; gl.vertex3d(r * std::cos(a), r * std::sin(a), 0); }
+        gl.end();
+    };
+    gl.color3f(0.1f, 0.25f, 0.55f);
+    for (int i = 0; i < 18; i++) {
+        double lat0 = M_PI * (-0.5 + i / 18.0), lat1 = M_PI * (-0.5 + (i + 1) / 18.0);
+        gl.begin(GL_QUAD_STRIP);
+        for (int j = 0; j <= 36; j++) {
+            double lng = 2 * M_PI * j / 36, x = std::cos(lng), y = std::sin(lng);
+            gl.vertex3d(x * std::cos(lat0), y * std::cos(lat0), std::sin(lat0));
+            gl.vertex3d(x * std::cos(lat1), y * std::cos(lat1), std::sin(lat1));
+        }
+        gl.end();
+    }
+    glLineWidth(1); gl.color3f(0.25f, 0.25f, 0.5f); circle(1.001, 64);
+    for (int p = 0; p < 6; p++) {
+        gl.pushMatrix(); gl.rotated(p * 60, 0, 0, 1); gl.rotated(55, 1, 0, 0);
+        gl.color3f(0.15f, 0.15f, 0.15f); circle(satR, 64);
+        gl.popMatrix();
+    }
+    for (int i = 0; i < sats.size(); i++) {
+        glPointSize(6); gl.color3f(1, 0.9f, 0.2f);
+        gl.begin(GL_POINTS); gl.vertex3d(sats.getX(i) * S, sats.getY(i) * S, sats.getZ(i) * S); gl.end();
+    }
+    for (size_t i = 0; i < fx.size(); i++) {
+        glPointSize(3); gl.color3f(0.3f, 0.8f, 1);
+        gl.begin(GL_POINTS); gl.vertex3d(fx[i] * S, fy[i] * S, fz[i] * S); gl.end();
+    }
+    gl.color4f(0.2f, 1, 0.3f, 0.18f);
+    gl.begin(GL_LINES);
+    for (int k = 0; k < visible.size(); k++) {
+        int i = visible.satellite(k);
+        gl.vertex3d(sats.getX(i) * S, sats.getY(i) * S, sats.getZ(i) * S);
+        gl.vertex3d(rx, ry, rz);
+    }
+    gl.end();
+    glLineWidth(2); gl.color3f(0.8f, 0.2f, 0.2f);
+    gl.begin(GL_LINE_STRIP);
+    for (auto& p : trail) gl.vertex3d(p[0], p[1], p[2]);
+    gl.end();
+    glPointSize(10); gl.color3f(1, 0.2f, 0.2f);
+    gl.begin(GL_POINTS); gl.vertex3d(rx, ry, rz); gl.end();
+}
+
+// ===== Scenes =====
+struct Scene {
+    const char* name;
+    int planes, perPlane;
+    double radius;          // m
+    int receivers;
+};
+
+static void buildScene(const Scene& s, Constellation& sats,
+                       std::vector<double>& fx, std::vector<double>& fy, std::vector<double>& fz)
+{
+    const double incl = 55.0 * M_PI / 180.0;
+    for (int p = 0; p < s.planes; p++) {
+        double node = p * (2 * M_PI / s.planes);
+        for (int k = 0; k < s.perPlane; k++)
+            sats.add(s.radius, k * (2 * M_PI / s.perPlane) + node, incl, node);
+    }
+    // Fleet receivers scattered over the globe (fixed seed)
+    unsigned state = 12345;
+    auto uniform = [&]() { state = state * 1664525u + 1013904223u; return (state >> 8) / 16777216.0; };
+    for (int i = 0; i < s.receivers; i++) {
+        double lat = std::asin(2 * uniform() - 1), lng = 2 * M_PI * uniform();
+        fx.push_back(EARTH_RADIUS * std::cos(lat) * std::cos(lng));
+        fy.push_back(EARTH_RADIUS * std::cos(lat) * std::sin(lng));
+        fz.push_back(EARTH_RADIUS * std::sin(lat));
+    }
+}
+
+struct FrameStats {
+    double msPerFrame;
+    unsigned char centre[4];
+};
+
+// Renders the same sequence of simulated instants through `frame` for
+// every renderer (so the final images are comparable), after a warm-up
+template <typename Frame>
+static FrameStats timeFrames(Constellation& sats, VisibilityEngine& visibility, VisibleSet& visible, Frame frame) {
+    using clock = std::chrono::steady_clock;
+    const double angularSpeed = 0.001;
+    const int warmup = 5, frames = 60;
+    double renderSeconds = 0;
+    for (int f = 0; f < warmup + frames; f++) {
+        double simTime = f * 200.0 / 60.0;
+        double theta = angularSpeed * simTime;
+        double rx = std::cos(theta), ry = std::sin(theta);
+        sats.update(simTime);
+        visibility.setSatellites(sats);
+        visibility.visibleAll(rx * EARTH_RADIUS, ry * EARTH_RADIUS, 0.0, visible);
+
+        auto t0 = clock::now();
+        frame(rx, ry, 0.0);
+        glFinish();
+        double s = std::chrono::duration<double>(clock::now() - t0).count();
+        if (f >= warmup) renderSeconds += s;
+    }
+    FrameStats st;
+    st.msPerFrame = 1000.0 * renderSeconds / frames;
+    glReadPixels(WIDTH / 2, HEIGHT / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, st.centre);
+    return st;
+}
+
+// ===== Trace playback =====
+// Four receivers interleaved epoch by epoch at 10 Hz, receiver 1 dragged
+// off by a spoofer halfway through
+static bool benchPlayback(Offscreen& o, long long epochs) {
+    const char* path = "gnss_glbench_trace.bin";
+    const int runs = 4;
+    {
+        TraceWriter writer;
+        std::string err;
+        if (!writer.open(path, &err)) {
+            std::cout << "Playback: " << err << "\n";
+            return false;
+        }
+        TraceRecord t = {};
+        for (long long k = 0; k < epochs; k++)
+            for (int r = 0; r < runs; r++) {
+                double a = 2e-5 * k + r;
+                t.time = 0.1 * k;
+                t.run = r;
+                t.trueLat = 43.66 + 0.02 * std::sin(a);
+                t.trueLon = -79.5 + 0.1 * std::cos(a);
+                t.valid = 1;
+                t.spoofActive = r == 1 && k > epochs / 2;
+                t.spoofDetected = r == 1 && k > epochs / 2 + 100;
+                double drift = t.spoofActive ? 0.02 * (k - epochs / 2) : 0.0;
+                t.estX = 3.0 + 2.0 * std::sin(0.013 * k + r) + drift;
+                t.estLat = t.trueLat + drift / 111000.0;
+                t.estLon = t.trueLon;
+                t.confidence = t.spoofDetected ? 1.0 : 0.1;
+                t.inNoFly = t.trueLon < -79.58;
+                writer.append(t);
+            }
+        if (!writer.close()) {
+            std::cout << "Playback: cannot write " << path << "\n";
+            return false;
+        }
+    }
+
+    TraceReader trace;
+    std::string err;
+    EGLContext core = makeContext(o, true);
+    PlaybackView view;
+    bool ok = trace.open(path, &err) && core != EGL_NO_CONTEXT && view.init(&err);
+    if (ok) {
+        using clock = std::chrono::steady_clock;
+        auto t0 = clock::now();
+        view.open(trace);
+        while (!view.summary().complete()) view.load(1 << 18);
+        double buildSecs = std::chrono::duration<double>(clock::now() - t0).count();
+        std::printf("\n  playback: %lld epochs x %d receivers (%.0f MB), pyramid built in %.3f s\n",
+                    epochs, runs, (double)trace.size() * sizeof(TraceRecord) / 1e6, buildSecs);
+        std::printf("  %-16s %12s %10s %10s %12s\n", "window", "epochs/run", "level", "vertices", "ms/frame");
+
+        const double total = 0.1 * (epochs - 1);
+        const double windows[] = {total, total / 100, total / 10000, 1.0};
+        for (double len : windows) {
+            PlaybackWindow w;
+            w.start = 0.5 * total - 0.5 * len;
+            w.end = w.start + len;
+            const int frames = 30;
+            double secs = 0;
+            for (int f = 0; f < frames + 3; f++) {
+                w.cursor = w.start + len * f / (frames + 3);
+                auto s0 = clock::now();
+                view.draw(WIDTH, HEIGHT, w);
+                glFinish();
+                if (f >= 3) secs += std::chrono::duration<double>(clock::now() - s0).count();
+            }
+            char name[32];
+            std::snprintf(name, sizeof(name), "%.1f s", len);
+            char level[16];
+            std::snprintf(level, sizeof(level), view.lastLevel() < 0 ? "records" : "%d", view.lastLevel());
+            std::printf("  %-16s %12.0f %10s %10d %12.2f\n", name, len / 0.1, level,
+                        view.lastVertexCount(), 1000.0 * secs / frames);
+            if (glGetError() != GL_NO_ERROR) {
+                std::printf("    FAIL: GL error\n");
+                ok = false;
+            }
+        }
+        view.release();
+    } else {
+        std::cout << "Playback: " << (err.empty() ? "no OpenGL 3.3 core context" : err) << "\n";
+    }
+    if (core != EGL_NO_CONTEXT) {
+        eglMakeCurrent(o.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(o.display, core);
+    }
+    trace.close();
+    std::remove(path);
+    return ok;
+}
+
+int main() {
+    std::cout << "gnss_glbench — offscreen sky view frame times (" << WIDTH << "x" << HEIGHT << ")\n\n";
+    Offscreen o;
+    std::string err;
+    if (!openDisplay(o, err)) {
+        std::cout << "EGL: " << err << "\n";
+        return 1;
+    }
+
+    const Scene scenes[] = {
+        {"GPS-like 24 sats", 6, 4, 26571000.0, 0},
+        {"1000 sats + 1000 rx", 40, 25, 6921000.0, 1000},
+        {"5000 sats + 5000 rx", 50, 100, 6921000.0, 5000},
+    };
+    const OrbitCamera camera;
+    bool ok = true;
+    std::printf("  %-22s %16s %16s %9s\n", "scene", "immediate", "retained", "speedup");
+
+    for (const Scene& s : scenes) {
+        Constellation sats;
+        std::vector<double> fx, fy, fz;
+        buildScene(s, sats, fx, fy, fz);
+        VisibilityEngine visibility;
+        VisibleSet visible;
+        visible.reserve(sats.size());
+
+        // Immediate mode, compatibility profile
+        FrameStats legacy{};
+        bool haveLegacy = false;
+        EGLContext compat = makeContext(o, false);
+        LegacyGL gl;
+        if (compat != EGL_NO_CONTEXT && gl.load()) {
+            std::vector<std::array<double,3>> trail;
+            legacy = timeFrames(sats, visibility, visible, [&](double rx, double ry, double rz) {
+                legacyFrame(gl, sats, visible, fx, fy, fz, trail, rx, ry, rz, camera);
+            });
+            haveLegacy = true;
+        }
+        eglMakeCurrent(o.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (compat != EGL_NO_CONTEXT) eglDestroyContext(o.display, compat);
+
+        // Retained mode, 3.3 core
+        EGLContext core = makeContext(o, true);
+        if (core == EGL_NO_CONTEXT) {
+            std::cout << "EGL: cannot create an OpenGL 3.3 core context\n";
+            return 1;
+        }
+        SkyRenderer renderer;
+        if (!renderer.init(&err)) {
+            std::cout << "Renderer: " << err << "\n";
+            return 1;
+        }
+        const double S = 1.0 / EARTH_RADIUS;
+        renderer.setOrbits(sats, S);
+        FrameStats retained = timeFrames(sats, visibility, visible, [&](double rx, double ry, double rz) {
+            renderer.pushReceiver(rx, ry, rz);
+            renderer.setSatellites(sats, S);
+            renderer.setSignals(sats, visible, S);
+            renderer.setReceivers(fx.data(), fy.data(), fz.data(), (int)fx.size(), S);
+            renderer.draw(WIDTH, HEIGHT, camera);
+        });
+        GLenum glErr = glGetError();
+        renderer.release();
+        eglMakeCurrent(o.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(o.display, core);
+
+        char legacyText[32] = "n/a", speedText[16] = "";
+        if (haveLegacy) {
+            std::snprintf(legacyText, sizeof(legacyText), "%.2f ms", legacy.msPerFrame);
+            std::snprintf(speedText, sizeof(speedText), "%.1fx", legacy.msPerFrame / retained.msPerFrame);
+        }
+        char retainedText[32];
+        std::snprintf(retainedText, sizeof(retainedText), "%.2f ms", retained.msPerFrame);
+        std::printf("  %-22s %16s %16s %9s   (%.0f fps retained)\n",
+                    s.name, legacyText, retainedText, speedText, 1000.0 / retained.msPerFrame);
+
+        if (glErr != GL_NO_ERROR) {
+            std::printf("    FAIL: GL error 0x%x\n", glErr);
+            ok = false;
+        }
+        // The view centre is the Earth disc in both renderers
+        if (haveLegacy)
+            for (int c = 0; c < 3; c++)
+                if (std::abs(legacy.centre[c] - retained.centre[c]) > 8) {
+                    std::printf("    FAIL: centre pixel %d,%d,%d (immediate) vs %d,%d,%d (retained)\n",
+                                legacy.centre[0], legacy.centre[1], legacy.centre[2],
+                                retained.centre[0], retained.centre[1], retained.centre[2]);
+                    ok = false;
+                    break;
+                }
+    }
+
+    if (!benchPlayback(o, 500000)) ok = false;
+
+    eglDestroySurface(o.display, o.surface);
+    eglTerminate(o.display);
+    return ok ? 0 : 1;
+}
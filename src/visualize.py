@@ -1,32 +1,61 @@
-import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib.patches as patches
 import matplotlib.animation as animation
 import numpy as np
-import subprocess
+import struct
+import sys
 import os
 
-# ── Run the C++ sim to generate both CSVs ──────────────────────────────────
+# ── Load the binary trace written by gnss_sim (zero-copy) ───────────────────
 BUILD = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'build')
-
-def run_sim(mode, outfile):
-    args = [os.path.join(BUILD, 'gnss_sim')]
-    if mode == 'spoof':
-        args.append('spoof')
-    subprocess.run(args, cwd=BUILD, capture_output=True)
-    src = os.path.join(BUILD, 'output.csv')
-    dst = os.path.join(BUILD, outfile)
-    if os.path.exists(src):
-        os.replace(src, dst)
-    return dst
-
-print("Running simulations...")
-normal_csv  = run_sim('normal', 'output_normal.csv')
-spoofed_csv = run_sim('spoof',  'output_spoof.csv')
+TRACE = sys.argv[1] if len(sys.argv) > 1 else os.path.join(BUILD, 'trace.bin')
+
+def load_trace(path):
+    """Memory-maps a GNSSTRC1 trace as a numpy structured array.
+
+    The dtype is built from the schema in the file header, so columns are
+    read by name (trace['est_lat']) straight from the page cache."""
+    with open(path, 'rb') as f:
+        magic, header_size, record_size, n_fields, _, count = \
+            struct.unpack('<8sIIIIQ', f.read(32))
+        if magic != b'GNSSTRC1':
+            raise ValueError(f'{path}: not a gnss_sim trace')
+        fields = f.read(n_fields * 40)
+    names, formats, offsets = [], [], []
+    for i in range(n_fields):
+        name, typ, off, _ = struct.unpack_from('<24s8sII', fields, i * 40)
+        names.append(name.split(b'\0')[0].decode())
+        formats.append(typ.split(b'\0')[0].decode())
+        offsets.append(off)
+    dtype = np.dtype({'names': names, 'formats': formats,
+                      'offsets': offsets, 'itemsize': record_size})
+    if count == 0:   # writer did not finish; use whatever was flushed
+        count = (os.path.getsize(path) - header_size) // record_size
+    return np.memmap(path, dtype=dtype, mode='r', offset=header_size, shape=(count,))
+
+def run_view(trace, run_id):
+    """Contiguous slice (a view, not a copy) holding one run's epochs."""
+    idx = np.flatnonzero(trace['run'] == run_id)
+    return trace[idx[0]:idx[-1] + 1] if len(idx) else trace[:0]
+
+PLOTTED = ('true_lat', 'true_lon', 'est_lat', 'est_lon', 'in_no_fly', 'spoof_detected')
+
+def valid_columns(run, names=PLOTTED):
+    """The named columns of a run's valid epochs. Masking whole records
+    would copy every field out of the memmap; masking column by column
+    copies only the ones plotted."""
+    keep = run['valid'] == 1
+    return {name: run[name][keep] for name in names}
+
+if not os.path.exists(TRACE):
+    sys.exit(f'{TRACE} not found; run: gnss_sim --trace {TRACE}')
+trace  = load_trace(TRACE)
+normal = valid_columns(run_view(trace, 0))
+spoof  = valid_columns(run_view(trace, 1))
 
 # ── Waypoints ──────────────────────────────────────────────────────────────
-true_lons = [-79.3871, -79.4500, -79.5200, -79.5800, -79.6248]
-true_lats = [ 43.6426,  43.6500,  43.6600,  43.6700,  43.6777]
+true_lons = normal['true_lon']
+true_lats = normal['true_lat']
 fake_lat,    fake_lon    = 43.6426, -79.3871   # CN Tower
 pearson_lat, pearson_lon = 43.6777, -79.6248
 
@@ -105,14 +134,13 @@ def animate(frame):
 
     # Normal
     n_true.set_data(true_lons[:idx+1],  true_lats[:idx+1])
-    n_est.set_data(true_lons[:idx+1],   true_lats[:idx+1])
+    n_est.set_data(normal['est_lon'][:idx+1], normal['est_lat'][:idx+1])
     n_dots.set_data(true_lons[:idx+1],  true_lats[:idx+1])
     n_drone.set_data([true_lons[idx]],  [true_lats[idx]])
 
-    dlat = true_lats[idx] - pearson_lat
-    dlon = true_lons[idx] - pearson_lon
-    dist_pearson = np.sqrt((dlat*111)**2 + (dlon*111*np.cos(np.radians(43.66)))**2)
-    in_nfz = dist_pearson < 2.0
+    in_nfz = bool(normal['in_no_fly'][idx])
+    err_n = np.sqrt(((normal['est_lat'][idx] - true_lats[idx])*111000)**2 +
+                    ((normal['est_lon'][idx] - true_lons[idx])*111000*np.cos(np.radians(43.66)))**2)
 
     if in_nfz:
         n_drone.set_color('#ff4422')
@@ -120,16 +148,20 @@ def animate(frame):
         n_status.set_color('#ff4422')
     else:
         n_drone.set_color('#44ff77')
-        n_status.set_text('GPS error < 0.001 m  ✓')
+        n_status.set_text(f'GPS error {err_n:.3f} m  ✓')
         n_status.set_color('#44ff77')
 
     # Spoof
-    s_true.set_data(true_lons[:idx+1], true_lats[:idx+1])
-    s_dots.set_data(true_lons[:idx+1], true_lats[:idx+1])
-    s_drone.set_data([true_lons[idx]], [true_lats[idx]])
-
-    if idx > 0:
-        s_gap.set_data([fake_lon, true_lons[idx]], [fake_lat, true_lats[idx]])
+    sidx = min(idx, len(spoof['true_lat']) - 1)
+    s_true.set_data(spoof['true_lon'][:sidx+1], spoof['true_lat'][:sidx+1])
+    s_dots.set_data(spoof['true_lon'][:sidx+1], spoof['true_lat'][:sidx+1])
+    s_drone.set_data([spoof['true_lon'][sidx]], [spoof['true_lat'][sidx]])
+    est_lat, est_lon = spoof['est_lat'][sidx], spoof['est_lon'][sidx]
+    s_fake.set_data([est_lon], [est_lat])
+    in_nfz = bool(spoof['in_no_fly'][sidx])
+
+    if sidx > 0:
+        s_gap.set_data([est_lon, spoof['true_lon'][sidx]], [est_lat, spoof['true_lat'][sidx]])
     else:
         s_gap.set_data([], [])
 
@@ -137,20 +169,22 @@ def animate(frame):
     t = frame * 0.4
     r = 0.013 + 0.004*np.sin(t)
     th = np.linspace(0, 2*np.pi, 64)
-    s_ring.set_data(fake_lon + r*np.cos(th), fake_lat + r*np.sin(th))
+    s_ring.set_data(est_lon + r*np.cos(th), est_lat + r*np.sin(th))
 
     if s_ann[0]: s_ann[0].remove(); s_ann[0] = None
 
-    dlat2 = true_lats[idx] - fake_lat
-    dlon2 = true_lons[idx] - fake_lon
+    dlat2 = spoof['true_lat'][sidx] - est_lat
+    dlon2 = spoof['true_lon'][sidx] - est_lon
+    detected = bool(spoof['spoof_detected'][sidx])
     err_km = np.sqrt((dlat2*111)**2 + (dlon2*111*np.cos(np.radians(43.66)))**2)
 
     if in_nfz:
         s_drone.set_color('#ff0000')
-        s_status.set_text(f'🚨 IN NO-FLY ZONE — {err_km:.1f} km error UNDETECTED!')
+        s_status.set_text(f'🚨 IN NO-FLY ZONE — {err_km:.1f} km error ' +
+                          ('(spoofing detected)' if detected else 'UNDETECTED!'))
         s_status.set_color('#ff2222')
-        mid_lon = (fake_lon + true_lons[idx]) / 2
-        mid_lat = (fake_lat + true_lats[idx]) / 2
+        mid_lon = (est_lon + spoof['true_lon'][sidx]) / 2
+        mid_lat = (est_lat + spoof['true_lat'][sidx]) / 2
         s_ann[0] = ax_s.annotate(
             f'{err_km:.1f} km\nhidden by spoofer',
             xy=(mid_lon, mid_lat), ha='center', color='#ff6633',